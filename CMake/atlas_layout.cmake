@@ -0,0 +1,102 @@
+# Generates atlas_layout.hpp from the atlas JSON, so the frame rectangles and the card to layer
+# mapping are compile-time constants that cannot drift from the atlas.
+#
+#   cmake -DATLAS_JSON=<cards.json> -DATLAS_LAYOUT_HEADER=<atlas_layout.hpp> -P atlas_layout.cmake
+#
+# Layers follow the frame names in sorted order, which is also the order the atlas cache and the
+# texture loaders use. Faces are recognised by their "<rank>_of_<suit>" names and the back by a
+# "cardback" prefix; anything else is an error.
+cmake_minimum_required(VERSION 3.24)
+
+if(NOT DEFINED ATLAS_JSON OR NOT DEFINED ATLAS_LAYOUT_HEADER)
+    message(FATAL_ERROR
+        "Usage: cmake -DATLAS_JSON=... -DATLAS_LAYOUT_HEADER=... -P ${CMAKE_CURRENT_LIST_FILE}")
+endif()
+
+file(READ "${ATLAS_JSON}" atlas_json)
+string(JSON frame_count LENGTH "${atlas_json}" frames)
+if(frame_count EQUAL 0)
+    message(FATAL_ERROR "${ATLAS_JSON} has no frames")
+endif()
+
+set(frame_names "")
+math(EXPR last_frame "${frame_count} - 1")
+foreach(i RANGE ${last_frame})
+    string(JSON name MEMBER "${atlas_json}" frames ${i})
+    list(APPEND frame_names "${name}")
+endforeach()
+list(SORT frame_names)
+
+set(ranks ace 2 3 4 5 6 7 8 9 10 jack queen king)
+set(suits clubs diamonds hearts spades)
+foreach(suit IN LISTS suits)
+    foreach(rank IN LISTS ranks)
+        set(face_layer_${suit}_${rank} -1)
+    endforeach()
+endforeach()
+set(back_layer -1)
+set(face_pattern "^(ace|[2-9]|10|jack|queen|king)_of_(clubs|diamonds|hearts|spades)2?\\.png$")
+
+set(frame_rows "")
+set(layer 0)
+foreach(name IN LISTS frame_names)
+    foreach(field x y w h)
+        string(JSON ${field} GET "${atlas_json}" frames "${name}" ${field})
+    endforeach()
+    string(APPEND frame_rows "    atlas_frame{\"${name}\", ${x}, ${y}, ${w}, ${h}},\n")
+
+    if(name MATCHES "${face_pattern}")
+        if(NOT face_layer_${CMAKE_MATCH_2}_${CMAKE_MATCH_1} EQUAL -1)
+            message(FATAL_ERROR
+                "${ATLAS_JSON} has two frames for ${CMAKE_MATCH_1} of ${CMAKE_MATCH_2}")
+        endif()
+        set(face_layer_${CMAKE_MATCH_2}_${CMAKE_MATCH_1} ${layer})
+    elseif(name MATCHES "^cardback")
+        set(back_layer ${layer})
+    else()
+        message(FATAL_ERROR
+            "${ATLAS_JSON} has a frame that is neither a face nor the back: ${name}")
+    endif()
+    math(EXPR layer "${layer} + 1")
+endforeach()
+
+set(face_rows "")
+foreach(suit IN LISTS suits)
+    set(row "")
+    foreach(rank IN LISTS ranks)
+        list(APPEND row ${face_layer_${suit}_${rank}})
+    endforeach()
+    list(JOIN row ", " row)
+    string(APPEND face_rows "    std::array<std::int32_t, 13>{${row}}, // ${suit}\n")
+endforeach()
+
+file(WRITE "${ATLAS_LAYOUT_HEADER}" "\
+// Generated from Assets/cards.json by CMake/atlas_layout.cmake; edit the JSON, not this file
+#ifndef _GAME_ATLAS_LAYOUT_HPP__
+#define _GAME_ATLAS_LAYOUT_HPP__
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+// One frame rectangle of the atlas image
+struct atlas_frame
+{
+    std::string_view name;
+    std::int32_t     x, y, w, h;
+};
+
+// Every frame, in texture layer order
+constexpr auto atlas_frames = std::array<atlas_frame, ${frame_count}>{
+${frame_rows}};
+
+// Layer of each face by suit (clubs, diamonds, hearts, spades) and rank (ace = 0 ... king = 12),
+// -1 where the atlas has no frame for it
+constexpr auto atlas_face_layers = std::array<std::array<std::int32_t, 13>, 4>{
+${face_rows}};
+
+// Layer of the card back, -1 if the atlas has none
+constexpr auto atlas_back_layer = std::int32_t(${back_layer});
+
+#endif // _GAME_ATLAS_LAYOUT_HPP__
+")
@@ -9,4 +9,7 @@ glad_add_library(glad
     EXTENSIONS
         GL_ARB_bindless_texture
         GL_EXT_texture_compression_s3tc
+        GL_ARB_shader_draw_parameters
+        GL_KHR_parallel_shader_compile
+        GL_ARB_pipeline_statistics_query
 )
@@ -0,0 +1,227 @@
+#include "asset_pack.hpp"
+#include "atlas_cache.hpp"
+#include "cards.hpp"
+#include "pixel_convert.hpp"
+#include "texture_compression.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Asset benchmarks read Assets/ and Shaders/ through assets(), like the game: from assets.pack
+// next to the binary or in the working directory, else from loose files
+
+namespace {
+
+// Decoded once and shared, so slicing and encoding benchmarks measure only their own work. The
+// frames come from the generated atlas_layout.hpp.
+struct atlas_fixture
+{
+    std::shared_ptr<asset_image> image;
+};
+
+auto shared_atlas() -> const atlas_fixture*
+{
+    static const auto fixture = []() -> std::optional<atlas_fixture> {
+        auto image = load_png_data();
+        if (!image)
+        {
+            return std::nullopt;
+        }
+        return atlas_fixture{image.value()};
+    }();
+    return fixture ? &fixture.value() : nullptr;
+}
+
+// One run per kernel this machine supports, the kernel passed as the first argument
+void kernel_arguments(benchmark::internal::Benchmark* benchmark)
+{
+    for (const auto kernel : supported_pixel_kernels())
+    {
+        benchmark->Arg(std::int64_t(kernel));
+    }
+}
+
+// As above, crossed with RGB and RGBA sources
+void kernel_channel_arguments(benchmark::internal::Benchmark* benchmark)
+{
+    for (const auto kernel : supported_pixel_kernels())
+    {
+        benchmark->Args({std::int64_t(kernel), 3});
+        benchmark->Args({std::int64_t(kernel), 4});
+    }
+}
+
+} // namespace
+
+static void BM_LoadPngData(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        auto image = load_png_data();
+        if (!image)
+        {
+            state.SkipWithError(image.error().c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(image.value()->data());
+    }
+}
+BENCHMARK(BM_LoadPngData)->Unit(benchmark::kMillisecond);
+
+static void BM_LoadJsonData(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        auto json = load_json_data();
+        if (!json)
+        {
+            state.SkipWithError(json.error().c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(json.value().size());
+    }
+}
+BENCHMARK(BM_LoadJsonData)->Unit(benchmark::kMicrosecond);
+
+static void BM_ReadFileContent(benchmark::State& state)
+{
+    const auto path  = std::filesystem::path("Shaders/card.frag");
+    auto       bytes = std::size_t(0);
+    for (auto _ : state)
+    {
+        auto content = read_file_content(path);
+        if (!content)
+        {
+            state.SkipWithError(content.error().c_str());
+            return;
+        }
+        bytes += content->size();
+        benchmark::DoNotOptimize(content->data());
+    }
+    state.SetBytesProcessed(std::int64_t(bytes));
+}
+BENCHMARK(BM_ReadFileContent)->Unit(benchmark::kMicrosecond);
+
+// The lookup alone: a hashed table-of-contents search when the pack holds the asset
+static void BM_ReadAssetView(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        auto view = assets().read(card_atlas_json_asset);
+        if (!view)
+        {
+            state.SkipWithError(view.error().c_str());
+            return;
+        }
+        benchmark::DoNotOptimize(view->bytes.data());
+    }
+}
+BENCHMARK(BM_ReadAssetView)->Unit(benchmark::kNanosecond);
+
+// A frame's worth of synthetic pixels to premultiplied RGBA, per kernel and source channel count
+static void BM_ConvertPixels(benchmark::State& state)
+{
+    const auto  kernel     = pixel_kernel(state.range(0));
+    const auto  conversion = pixel_conversion{.channels    = std::int32_t(state.range(1)),
+                                              .premultiply = true};
+    const auto& frame      = atlas_frames.front();
+    const auto  count      = std::size_t(frame.w) * frame.h;
+    auto        source     = std::vector<std::uint8_t>(count * std::size_t(conversion.channels));
+    auto        pixels     = std::vector<std::uint8_t>(count * 4);
+    for (auto i = std::size_t(0); i < source.size(); ++i)
+    {
+        source[i] = std::uint8_t(i * 37);
+    }
+    for (auto _ : state)
+    {
+        convert_pixels(source.data(), pixels.data(), count, conversion, kernel);
+        benchmark::ClobberMemory();
+    }
+    state.SetLabel(std::string(pixel_kernel_name(kernel)));
+    state.SetBytesProcessed(std::int64_t(state.iterations() * pixels.size()));
+}
+BENCHMARK(BM_ConvertPixels)->Apply(kernel_channel_arguments)->Unit(benchmark::kMicrosecond);
+
+static void BM_SliceAtlasFrame(benchmark::State& state)
+{
+    const auto* atlas = shared_atlas();
+    if (atlas == nullptr)
+    {
+        state.SkipWithError("Failed to load the card atlas");
+        return;
+    }
+    const auto  kernel = pixel_kernel(state.range(0));
+    const auto& frame  = atlas_frames.front();
+    auto        pixels = std::vector<std::uint8_t>(std::size_t(frame.w) * frame.h * 4);
+    for (auto _ : state)
+    {
+        slice_atlas_frame(*atlas->image, frame, pixels.data(), kernel);
+        benchmark::ClobberMemory();
+    }
+    state.SetLabel(std::string(pixel_kernel_name(kernel)));
+    state.SetBytesProcessed(std::int64_t(state.iterations() * pixels.size()));
+}
+BENCHMARK(BM_SliceAtlasFrame)->Apply(kernel_arguments)->Unit(benchmark::kMicrosecond);
+
+// Every layer, spread over as many threads as the argument
+static void BM_SliceAtlas(benchmark::State& state)
+{
+    const auto* atlas = shared_atlas();
+    if (atlas == nullptr)
+    {
+        state.SkipWithError("Failed to load the card atlas");
+        return;
+    }
+    auto bytes = std::size_t(0);
+    for (auto _ : state)
+    {
+        auto sliced = slice_atlas(*atlas->image, std::size_t(state.range(0)));
+        benchmark::DoNotOptimize(sliced->pixels.data());
+        bytes += sliced->pixels.size();
+    }
+    state.SetBytesProcessed(std::int64_t(bytes));
+}
+BENCHMARK(BM_SliceAtlas)->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+static void BM_GenerateMipChain(benchmark::State& state)
+{
+    const auto* atlas = shared_atlas();
+    if (atlas == nullptr)
+    {
+        state.SkipWithError("Failed to load the card atlas");
+        return;
+    }
+    const auto& frame = atlas_frames.front();
+    auto        layer = std::vector<std::uint8_t>(std::size_t(frame.w) * frame.h * 4);
+    slice_atlas_frame(*atlas->image, frame, layer.data());
+    for (auto _ : state)
+    {
+        auto chain = generate_mip_chain(layer.data(), frame.w, frame.h);
+        benchmark::DoNotOptimize(chain.data());
+    }
+}
+BENCHMARK(BM_GenerateMipChain)->Unit(benchmark::kMicrosecond);
+
+static void BM_EncodeBc3Layer(benchmark::State& state)
+{
+    const auto* atlas = shared_atlas();
+    if (atlas == nullptr)
+    {
+        state.SkipWithError("Failed to load the card atlas");
+        return;
+    }
+    const auto& frame = atlas_frames.front();
+    auto        layer = std::vector<std::uint8_t>(std::size_t(frame.w) * frame.h * 4);
+    slice_atlas_frame(*atlas->image, frame, layer.data());
+    for (auto _ : state)
+    {
+        auto blocks = encode_bc3(layer.data(), frame.w, frame.h);
+        benchmark::DoNotOptimize(blocks.data());
+    }
+    state.SetBytesProcessed(std::int64_t(state.iterations() * layer.size()));
+}
+BENCHMARK(BM_EncodeBc3Layer)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,187 @@
+#include <nlohmann/json.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+
+constexpr auto generic_error = 1;
+constexpr auto no_error      = 0;
+
+// Compares two Google Benchmark JSON reports (--benchmark_out_format=json) and fails when any
+// benchmark got slower than the threshold allows. With repetitions, the median aggregate is
+// compared; otherwise the single run is.
+
+namespace {
+
+struct compare_arguments
+{
+    std::filesystem::path baseline;
+    std::filesystem::path current;
+    double                threshold_percent = 10.0;
+    bool                  update_baseline   = false;
+};
+
+// Nanoseconds per iteration, keyed by run name (the benchmark name without aggregate suffix)
+auto read_report(const std::filesystem::path& path)
+    -> std::optional<std::map<std::string, double>>
+{
+    auto in = std::ifstream(path);
+    if (!in)
+    {
+        return std::nullopt;
+    }
+
+    auto report = nlohmann::json::parse(in, nullptr, false);
+    if (report.is_discarded() || !report.contains("benchmarks"))
+    {
+        return std::nullopt;
+    }
+
+    constexpr auto to_nanoseconds = [](std::string_view unit) {
+        return unit == "s" ? 1e9 : unit == "ms" ? 1e6 : unit == "us" ? 1e3 : 1.0;
+    };
+
+    auto times   = std::map<std::string, double>();
+    auto medians = std::map<std::string, double>();
+    for (const auto& run : report["benchmarks"])
+    {
+        if (run.value("error_occurred", false))
+        {
+            continue;
+        }
+        const auto name = run.value("run_name", run.value("name", std::string()));
+        const auto unit = run.value("time_unit", std::string("ns"));
+        const auto time = run.value("real_time", 0.0) * to_nanoseconds(unit);
+        if (run.value("run_type", "iteration") == "aggregate")
+        {
+            if (run.value("aggregate_name", "") == "median")
+            {
+                medians[name] = time;
+            }
+        }
+        else if (!times.contains(name))
+        {
+            times[name] = time;
+        }
+    }
+    for (const auto& [name, time] : medians)
+    {
+        times[name] = time;
+    }
+    return times;
+}
+
+auto compare_reports(const compare_arguments& arguments) -> int
+{
+    if (!std::filesystem::exists(arguments.baseline) || arguments.update_baseline)
+    {
+        auto error = std::error_code();
+        std::filesystem::copy_file(arguments.current,
+                                   arguments.baseline,
+                                   std::filesystem::copy_options::overwrite_existing,
+                                   error);
+        if (error)
+        {
+            std::fprintf(stderr, "Failed to save baseline: %s\n", error.message().c_str());
+            return generic_error;
+        }
+        std::printf("Saved %s as the new baseline\n", arguments.baseline.string().c_str());
+        return no_error;
+    }
+
+    const auto baseline = read_report(arguments.baseline);
+    const auto current  = read_report(arguments.current);
+    if (!baseline || !current)
+    {
+        std::fprintf(stderr,
+                     "Failed to read benchmark report: %s\n",
+                     (!baseline ? arguments.baseline : arguments.current).string().c_str());
+        return generic_error;
+    }
+
+    auto regressions = 0;
+    std::printf("%-48s %14s %14s %9s\n", "benchmark", "baseline ns", "current ns", "change");
+    for (const auto& [name, current_time] : current.value())
+    {
+        const auto found = baseline->find(name);
+        if (found == baseline->end() || found->second <= 0.0)
+        {
+            std::printf("%-48s %14s %14.1f %9s\n", name.c_str(), "-", current_time, "new");
+            continue;
+        }
+
+        const auto change    = (current_time / found->second - 1.0) * 100.0;
+        const auto regressed = change > arguments.threshold_percent;
+        regressions += regressed ? 1 : 0;
+        std::printf("%-48s %14.1f %14.1f %+8.1f%%%s\n",
+                    name.c_str(),
+                    found->second,
+                    current_time,
+                    change,
+                    regressed ? "  REGRESSION" : "");
+    }
+    for (const auto& [name, time] : baseline.value())
+    {
+        if (!current->contains(name))
+        {
+            std::printf("%-48s %14.1f %14s %9s\n", name.c_str(), time, "-", "missing");
+        }
+    }
+
+    if (regressions > 0)
+    {
+        std::printf("%d benchmark(s) slower than the %.1f%% threshold\n",
+                    regressions,
+                    arguments.threshold_percent);
+        return generic_error;
+    }
+    return no_error;
+}
+
+void print_usage()
+{
+    std::fprintf(stderr,
+                 "Usage: solitaire_bench_compare BASELINE CURRENT [--threshold PERCENT] "
+                 "[--update]\n"
+                 "       A missing BASELINE is created from CURRENT\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    auto arguments  = compare_arguments{};
+    auto positional = 0;
+    for (auto i = 1; i < argc; ++i)
+    {
+        const auto argument = std::string_view(argv[i]);
+        if (argument == "--threshold" && i + 1 < argc)
+        {
+            arguments.threshold_percent = std::strtod(argv[++i], nullptr);
+        }
+        else if (argument == "--update")
+        {
+            arguments.update_baseline = true;
+        }
+        else if (positional < 2 && !argument.starts_with("--"))
+        {
+            (positional++ == 0 ? arguments.baseline : arguments.current) = argument;
+        }
+        else
+        {
+            print_usage();
+            return generic_error;
+        }
+    }
+    if (positional != 2)
+    {
+        print_usage();
+        return generic_error;
+    }
+    return compare_reports(arguments);
+}
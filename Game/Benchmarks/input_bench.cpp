@@ -0,0 +1,109 @@
+#include "hit_grid.hpp"
+#include "table_layout.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+namespace {
+
+// Cards scattered over a table that grows with the count, so piles stay a few cards deep
+auto make_rects(std::int64_t count, float& width, float& height) -> std::vector<hit_rect>
+{
+    width       = float(count) * 4.0f;
+    height      = 1000.0f;
+    auto random = std::mt19937(1);
+    auto x      = std::uniform_real_distribution<float>(0.0f, width);
+    auto y      = std::uniform_real_distribution<float>(0.0f, height);
+    auto rects  = std::vector<hit_rect>();
+    for (auto i = std::int64_t(0); i < count; ++i)
+    {
+        rects.push_back(card_bounds({x(random), y(random), 0, true}));
+    }
+    return rects;
+}
+
+auto make_points(float width, float height) -> std::vector<table_point>
+{
+    auto random = std::mt19937(2);
+    auto x      = std::uniform_real_distribution<float>(0.0f, width);
+    auto y      = std::uniform_real_distribution<float>(0.0f, height);
+    auto points = std::vector<table_point>(1024);
+    for (auto& point : points)
+    {
+        point = {x(random), y(random)};
+    }
+    return points;
+}
+
+auto make_grid(const std::vector<hit_rect>& rects, float width, float height) -> hit_grid
+{
+    auto grid = hit_grid();
+    grid.reset(width, height, card_width_px, card_height_px);
+    for (auto id = std::size_t(0); id < rects.size(); ++id)
+    {
+        grid.set(std::uint32_t(id), rects[id]);
+    }
+    return grid;
+}
+
+} // namespace
+
+static void BM_HitGridTopmost(benchmark::State& state)
+{
+    auto       width = 0.0f, height = 0.0f;
+    const auto rects  = make_rects(state.range(0), width, height);
+    const auto points = make_points(width, height);
+    const auto grid   = make_grid(rects, width, height);
+    auto       next   = std::size_t(0);
+    for (auto _ : state)
+    {
+        const auto& point = points[next++ % points.size()];
+        benchmark::DoNotOptimize(grid.topmost(point.x, point.y));
+    }
+}
+BENCHMARK(BM_HitGridTopmost)->Arg(52)->Arg(1024)->Arg(16384);
+
+// The scan the grid replaces, for comparison
+static void BM_LinearTopmost(benchmark::State& state)
+{
+    auto       width = 0.0f, height = 0.0f;
+    const auto rects  = make_rects(state.range(0), width, height);
+    const auto points = make_points(width, height);
+    auto       next   = std::size_t(0);
+    for (auto _ : state)
+    {
+        const auto& point = points[next++ % points.size()];
+        auto        found = std::int64_t(-1);
+        for (auto id = std::int64_t(rects.size()); id-- > 0;)
+        {
+            const auto& r = rects[id];
+            if (point.x >= r.left && point.x <= r.right && point.y >= r.bottom && point.y <= r.top)
+            {
+                found = id;
+                break;
+            }
+        }
+        benchmark::DoNotOptimize(found);
+    }
+}
+BENCHMARK(BM_LinearTopmost)->Arg(52)->Arg(1024)->Arg(16384);
+
+// A drag: one card follows the cursor and looks for where it would land
+static void BM_HitGridDragStep(benchmark::State& state)
+{
+    auto       width = 0.0f, height = 0.0f;
+    const auto rects  = make_rects(state.range(0), width, height);
+    const auto points = make_points(width, height);
+    auto       grid   = make_grid(rects, width, height);
+    auto       next   = std::size_t(0);
+    for (auto _ : state)
+    {
+        const auto& point  = points[next++ % points.size()];
+        const auto  bounds = card_bounds({point.x, point.y, 0, true});
+        grid.set(0, bounds);
+        benchmark::DoNotOptimize(grid.best_overlap(bounds));
+    }
+}
+BENCHMARK(BM_HitGridDragStep)->Arg(52)->Arg(1024)->Arg(16384);
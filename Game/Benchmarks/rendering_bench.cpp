@@ -0,0 +1,99 @@
+#include "card_animator.hpp"
+#include "cards.hpp"
+#include "table_layout.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace {
+
+// Cards spread over the table, every fourth one face down
+auto make_cards(std::int64_t count) -> std::vector<card>
+{
+    auto cards = std::vector<card>();
+    for (auto i = std::int64_t(0); i < count; ++i)
+    {
+        cards.push_back({float(i % 10) * 130.0f + 60.0f,
+                         float(i / 10 % 8) * 110.0f + 90.0f,
+                         std::int32_t(i % 52),
+                         i % 4 != 0});
+    }
+    return cards;
+}
+
+} // namespace
+
+static void BM_BuildCardInstances(benchmark::State& state)
+{
+    const auto cards     = make_cards(state.range(0));
+    auto       instances = std::vector<card_instance>();
+    for (auto _ : state)
+    {
+        build_card_instances(cards, all_layers_resident, instances);
+        benchmark::DoNotOptimize(instances.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BuildCardInstances)->Arg(52)->Arg(1024)->Arg(16384);
+
+// Mid-stream: half the layers resident, so the fallback path is taken as well
+static void BM_BuildCardInstancesStreaming(benchmark::State& state)
+{
+    const auto cards     = make_cards(state.range(0));
+    auto       instances = std::vector<card_instance>();
+    for (auto _ : state)
+    {
+        build_card_instances(cards, 0x5555'5555'5555'5555, instances);
+        benchmark::DoNotOptimize(instances.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BuildCardInstancesStreaming)->Arg(52)->Arg(1024);
+
+// The per-frame work of the headless scene: lay the table out, then pack it
+static void BM_LayoutAndBatchTable(benchmark::State& state)
+{
+    const auto deal      = deal_klondike(shuffle_deck(1), 3);
+    auto       cards     = std::vector<card>();
+    auto       instances = std::vector<card_instance>();
+    for (auto _ : state)
+    {
+        layout_table(deal, table_metrics{}, cards);
+        build_card_instances(cards, all_layers_resident, instances);
+        benchmark::DoNotOptimize(instances.data());
+    }
+}
+BENCHMARK(BM_LayoutAndBatchTable);
+
+// One frame of animation: every tween evaluated and written out as instance data. The tweens
+// outlast the run and mix every easing, as a win cascade, deal and auto-complete together would.
+static void BM_AnimateCards(benchmark::State& state)
+{
+    auto animator = card_animator();
+    for (auto i = std::int64_t(0); i < state.range(0); ++i)
+    {
+        animator.add({float(i % 10) * 130.0f,
+                      1000.0f,
+                      float(i % 7) * 200.0f,
+                      84.0f,
+                      double(i % 100) * 0.01,
+                      1.0e6f,
+                      card_easing(i % 4),
+                      std::int32_t(i % 52),
+                      i % 4 != 0});
+    }
+
+    auto instances = std::vector<card_instance>();
+    auto now       = 0.0;
+    for (auto _ : state)
+    {
+        now += 1.0 / 120.0;
+        animator.update(now);
+        instances.clear();
+        animator.write_instances(all_layers_resident, instances);
+        benchmark::DoNotOptimize(instances.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AnimateCards)->Arg(52)->Arg(10'000);
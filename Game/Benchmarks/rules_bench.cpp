@@ -0,0 +1,157 @@
+#include "klondike.hpp"
+#include "move_history.hpp"
+#include "solver.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace {
+
+// A long game of first-legal-moves, backing out of dead ends
+auto make_history(std::size_t move_count) -> move_history
+{
+    auto history = move_history(deal_klondike(shuffle_deck(5), 1));
+    auto moves   = move_list{};
+    while (history.size() < move_count)
+    {
+        generate_moves(history.state(), moves);
+        if (moves.size == 0)
+        {
+            history.jump_to(history.position() / 2);
+            continue;
+        }
+        history.apply(moves[history.size() % moves.size]);
+    }
+    return history;
+}
+
+} // namespace
+
+static void BM_ShuffleAndDeal(benchmark::State& state)
+{
+    auto seed = std::uint64_t(1);
+    for (auto _ : state)
+    {
+        auto deal = deal_klondike(shuffle_deck(seed++), 1);
+        benchmark::DoNotOptimize(deal.hash);
+    }
+}
+BENCHMARK(BM_ShuffleAndDeal);
+
+static void BM_GenerateMoves(benchmark::State& state)
+{
+    const auto deal  = deal_klondike(shuffle_deck(1), 1);
+    auto       moves = move_list{};
+    for (auto _ : state)
+    {
+        generate_moves(deal, moves);
+        benchmark::DoNotOptimize(moves.size);
+    }
+}
+BENCHMARK(BM_GenerateMoves);
+
+// Apply and undo every legal move along a fixed line of play
+static void BM_ApplyUndoMoves(benchmark::State& state)
+{
+    auto       positions = std::vector<klondike_state>();
+    auto       position  = deal_klondike(shuffle_deck(3), 1);
+    auto       moves     = move_list{};
+    for (auto step = 0; step < 64; ++step)
+    {
+        positions.push_back(position);
+        generate_moves(position, moves);
+        if (moves.size == 0)
+        {
+            break;
+        }
+        auto move = moves[step % moves.size];
+        apply_move(position, move);
+    }
+
+    auto applied = std::int64_t(0);
+    for (auto _ : state)
+    {
+        for (auto& current : positions)
+        {
+            generate_moves(current, moves);
+            for (auto move : moves)
+            {
+                apply_move(current, move);
+                undo_move(current, move);
+            }
+            applied += std::int64_t(moves.size);
+        }
+        benchmark::DoNotOptimize(positions.data());
+    }
+    state.SetItemsProcessed(applied);
+}
+BENCHMARK(BM_ApplyUndoMoves);
+
+// One step back and forth through a long game
+static void BM_HistoryUndoRedo(benchmark::State& state)
+{
+    auto history = make_history(10'000);
+    history.jump_to(history.size() / 2);
+    for (auto _ : state)
+    {
+        history.undo();
+        history.redo();
+        benchmark::DoNotOptimize(history.state().hash);
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_HistoryUndoRedo);
+
+// Random access: restore the nearest keyframe and replay the rest
+static void BM_HistoryJump(benchmark::State& state)
+{
+    auto history  = make_history(10'000);
+    auto position = std::size_t(1);
+    for (auto _ : state)
+    {
+        position = (position * 7919 + 13) % history.size();
+        history.jump_to(position);
+        benchmark::DoNotOptimize(history.state().hash);
+    }
+}
+BENCHMARK(BM_HistoryJump);
+
+static void BM_TranspositionTableInsert(benchmark::State& state)
+{
+    auto table = transposition_table(64 << 20);
+    auto hash  = std::uint64_t(0x9E3779B97F4A7C15);
+    for (auto _ : state)
+    {
+        // Fresh table every million inserts so the load factor stays representative
+        if (table.size() > 1'000'000)
+        {
+            state.PauseTiming();
+            table.clear();
+            state.ResumeTiming();
+        }
+        hash = hash * 6364136223846793005ull + 1442695040888963407ull;
+        benchmark::DoNotOptimize(table.insert(hash));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TranspositionTableInsert);
+
+// The same eight deals every iteration under a fixed node budget, so the time only moves when
+// the search itself gets faster or slower
+static void BM_SolveDeals(benchmark::State& state)
+{
+    const auto options = solver_options{.thread_count  = std::size_t(state.range(0)),
+                                        .memory_budget = 32 << 20,
+                                        .node_limit    = 200'000};
+    auto       nodes   = std::uint64_t(0);
+    for (auto _ : state)
+    {
+        for (auto seed = std::uint64_t(1); seed <= 8; ++seed)
+        {
+            nodes += solve_klondike(deal_klondike(shuffle_deck(seed), 1), options).nodes;
+        }
+    }
+    state.counters["nodes/s"] = benchmark::Counter(double(nodes), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_SolveDeals)->Arg(1)->Arg(4)->Unit(benchmark::kMillisecond)->UseRealTime();
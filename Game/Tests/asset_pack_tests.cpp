@@ -0,0 +1,168 @@
+#include "asset_pack.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// A scratch tree of loose assets, removed when the test ends
+class asset_directory
+{
+public:
+    explicit asset_directory(std::string_view name)
+        : directory_(std::filesystem::temp_directory_path() / name)
+    {
+        std::filesystem::remove_all(directory_);
+        std::filesystem::create_directories(directory_);
+    }
+    ~asset_directory() { std::filesystem::remove_all(directory_); }
+
+    auto path() const -> const std::filesystem::path& { return directory_; }
+
+    auto write(std::string_view name, std::string_view content) const -> std::filesystem::path
+    {
+        const auto path = directory_ / name;
+        std::filesystem::create_directories(path.parent_path());
+        auto out = std::ofstream(path, std::ios::binary | std::ios::trunc);
+        out.write(content.data(), std::streamsize(content.size()));
+        return path;
+    }
+
+private:
+    std::filesystem::path directory_;
+};
+
+auto as_string(std::span<const std::byte> bytes) -> std::string
+{
+    return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+}
+
+} // namespace
+
+// Every entry comes back byte for byte, aligned, and found through the hashed table of contents
+TEST(AssetPackTest, RoundTripsEntriesAligned)
+{
+    const auto directory = asset_directory("solitaire_asset_pack_round_trip");
+    auto       sources   = std::vector<asset_pack_source>();
+    for (auto i = 0; i < 40; ++i)
+    {
+        const auto name = "Assets/file_" + std::to_string(i) + ".bin";
+        sources.push_back({name, directory.write(name, std::string(std::size_t(i) * 37, char(i)))});
+    }
+    sources.push_back({"Shaders/card.frag", directory.write("Shaders/card.frag", "void main(){}")});
+    const auto pack_path = directory.path() / "assets.pack";
+    ASSERT_TRUE(write_asset_pack(pack_path, sources).has_value());
+
+    const auto pack = asset_pack::open(pack_path);
+    ASSERT_TRUE(pack.has_value()) << pack.error();
+    ASSERT_EQ(pack->entries().size(), sources.size());
+    for (const auto& source : sources)
+    {
+        const auto* entry = pack->find(source.name);
+        ASSERT_NE(entry, nullptr) << source.name;
+        EXPECT_EQ(pack->name(*entry), source.name);
+        EXPECT_EQ(entry->hash, asset_name_hash(source.name));
+
+        const auto bytes = pack->bytes(*entry);
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(bytes.data()) % asset_pack_alignment, 0u);
+        auto expected = std::ifstream(source.path, std::ios::binary);
+        EXPECT_EQ(as_string(bytes), std::string(std::istreambuf_iterator<char>(expected), {}));
+    }
+    EXPECT_EQ(pack->find("Assets/missing.bin"), nullptr);
+    EXPECT_EQ(pack->find("Assets/file_1.bi"), nullptr);
+
+    const auto duplicate = std::vector<asset_pack_source>{sources[0], sources[0]};
+    EXPECT_FALSE(write_asset_pack(directory.path() / "duplicate.pack", duplicate).has_value());
+}
+
+TEST(AssetPackTest, RejectsDamagedPacks)
+{
+    const auto directory = asset_directory("solitaire_asset_pack_damaged");
+    const auto sources   = std::vector<asset_pack_source>{
+        {"Assets/a.json", directory.write("Assets/a.json", "{\"a\": 1}")},
+        {"Assets/b.json", directory.write("Assets/b.json", std::string(1000, 'b'))}};
+    const auto pack_path = directory.path() / "assets.pack";
+    ASSERT_TRUE(write_asset_pack(pack_path, sources).has_value());
+    ASSERT_TRUE(asset_pack::open(pack_path).has_value());
+
+    // Cut into the last entry's data
+    std::filesystem::resize_file(pack_path, std::filesystem::file_size(pack_path) - 10);
+    EXPECT_FALSE(asset_pack::open(pack_path).has_value());
+
+    // A different magic
+    ASSERT_TRUE(write_asset_pack(pack_path, sources).has_value());
+    {
+        auto file = std::fstream(pack_path, std::ios::in | std::ios::out | std::ios::binary);
+        file.write("XXXX", 4);
+    }
+    EXPECT_FALSE(asset_pack::open(pack_path).has_value());
+
+    // An entry count that would run past the end of the file
+    ASSERT_TRUE(write_asset_pack(pack_path, sources).has_value());
+    {
+        auto       file  = std::fstream(pack_path, std::ios::in | std::ios::out | std::ios::binary);
+        const auto count = std::uint32_t(0x10000000);
+        file.seekp(offsetof(asset_pack_header, entry_count));
+        file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    }
+    EXPECT_FALSE(asset_pack::open(pack_path).has_value());
+
+    EXPECT_FALSE(asset_pack::open(directory.path() / "missing.pack").has_value());
+}
+
+// The pack answers first, loose files fill the gaps, and loose_first flips the order
+TEST(AssetPackTest, FileSystemFallsBackToLooseFiles)
+{
+    const auto directory = asset_directory("solitaire_asset_pack_file_system");
+    const auto packed    = directory.write("packed/Shaders/card.vert", "packed vertex");
+    const auto pack_path = directory.path() / "build" / "assets.pack";
+    const auto sources   = std::vector<asset_pack_source>{{"Shaders/card.vert", packed}};
+    ASSERT_TRUE(write_asset_pack(pack_path, sources).has_value());
+    const auto loose = directory.path() / "checkout";
+    directory.write("checkout/Shaders/card.vert", "loose vertex");
+    directory.write("checkout/Shaders/card.frag", "loose fragment");
+
+    auto pack = asset_pack::open(pack_path);
+    ASSERT_TRUE(pack.has_value()) << pack.error();
+    auto file_system = asset_file_system(std::move(pack.value()), {loose});
+    EXPECT_EQ(file_system.root(), pack_path.parent_path());
+
+    const auto vertex = file_system.read("Shaders/card.vert");
+    ASSERT_TRUE(vertex.has_value()) << vertex.error();
+    EXPECT_TRUE(vertex->from_pack);
+    EXPECT_EQ(vertex->text(), "packed vertex");
+
+    const auto fragment = file_system.read("Shaders/card.frag");
+    ASSERT_TRUE(fragment.has_value()) << fragment.error();
+    EXPECT_FALSE(fragment->from_pack);
+    EXPECT_EQ(fragment->text(), "loose fragment");
+    EXPECT_EQ(file_system.loose_path("Shaders/card.frag"), loose / "Shaders/card.frag");
+
+    EXPECT_FALSE(file_system.read("Shaders/missing.geom").has_value());
+    EXPECT_FALSE(file_system.stamp("Shaders/missing.geom").has_value());
+
+    // Packing keeps the source's stamp, so caches keyed on it do not go stale
+    const auto packed_stamp = file_system.stamp("Shaders/card.vert");
+    ASSERT_TRUE(packed_stamp.has_value());
+    EXPECT_EQ(packed_stamp->size, std::filesystem::file_size(packed));
+    EXPECT_EQ(packed_stamp->write_time,
+              std::filesystem::last_write_time(packed).time_since_epoch().count());
+
+    file_system.set_lookup(asset_lookup::loose_first);
+    const auto overridden = file_system.read("Shaders/card.vert");
+    ASSERT_TRUE(overridden.has_value()) << overridden.error();
+    EXPECT_FALSE(overridden->from_pack);
+    EXPECT_EQ(overridden->text(), "loose vertex");
+    EXPECT_EQ(file_system.stamp("Shaders/card.vert")->size, std::string("loose vertex").size());
+
+    // A view keeps its mapping alive after the file system is gone
+    const auto survivor = vertex.value();
+    file_system         = asset_file_system(std::nullopt, {loose});
+    EXPECT_EQ(survivor.text(), "packed vertex");
+    EXPECT_EQ(file_system.root(), loose);
+}
@@ -0,0 +1,111 @@
+#include "atlas_cache.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+TEST(AtlasCacheTest, CookedLayersMatchSourceFrames)
+{
+    const auto cache_path = std::filesystem::temp_directory_path() / "atlas_cache_tests.atlas";
+    auto       cook_result = cook_atlas_cache(cache_path);
+    ASSERT_TRUE(cook_result.has_value()) << cook_result.error();
+
+    auto cache_result = open_atlas_cache(cache_path);
+    ASSERT_TRUE(cache_result.has_value()) << cache_result.error();
+    auto cache = cache_result.value();
+
+    auto image     = load_png_data();
+    auto json_data = load_json_data();
+    ASSERT_TRUE(image.has_value());
+    ASSERT_TRUE(json_data.has_value());
+
+    const auto& frames = json_data.value()["frames"];
+    ASSERT_EQ(cache->layer_count(), static_cast<std::int32_t>(frames.size()));
+
+    // Every named layer holds exactly the rows of its frame, as premultiplied RGBA
+    const auto conversion =
+        pixel_conversion{.channels = image.value()->channels(), .premultiply = true};
+    auto expected_row = std::vector<std::uint8_t>(std::size_t(cache->layer_width()) * 4);
+    for (const auto& [card_name, frame_data] : frames.items())
+    {
+        const auto layer = cache->layer_for_name(card_name);
+        ASSERT_TRUE(layer.has_value()) << card_name;
+
+        const auto x           = frame_data["x"].get<std::int32_t>();
+        const auto y           = frame_data["y"].get<std::int32_t>();
+        const auto row_bytes   = expected_row.size();
+        const auto* layer_data = cache->layer_data(layer.value());
+        for (auto row = 0; row < cache->layer_height(); ++row)
+        {
+            convert_pixels(image.value()->stride_of_data_at(x, y + row),
+                           expected_row.data(),
+                           std::size_t(cache->layer_width()),
+                           conversion,
+                           pixel_kernel::scalar);
+            ASSERT_EQ(std::memcmp(layer_data + row * row_bytes, expected_row.data(), row_bytes), 0)
+                << card_name << " row " << row;
+        }
+    }
+
+    EXPECT_FALSE(cache->layer_for_name("not_a_card.png").has_value());
+    std::filesystem::remove(cache_path);
+}
+
+// The compiled-in layout is what the build generated from the same cards.json the game ships
+TEST(AtlasCacheTest, GeneratedLayoutMatchesJson)
+{
+    auto json_data = load_json_data();
+    ASSERT_TRUE(json_data.has_value()) << json_data.error();
+
+    const auto& frames = json_data.value()["frames"];
+    ASSERT_EQ(frames.size(), atlas_frames.size());
+    auto layer = std::size_t(0);
+    for (const auto& [card_name, frame_data] : frames.items())
+    {
+        const auto& frame = atlas_frames[layer++];
+        EXPECT_EQ(frame.name, card_name);
+        EXPECT_EQ(frame.x, frame_data["x"].get<std::int32_t>()) << card_name;
+        EXPECT_EQ(frame.y, frame_data["y"].get<std::int32_t>()) << card_name;
+        EXPECT_EQ(frame.w, frame_data["w"].get<std::int32_t>()) << card_name;
+        EXPECT_EQ(frame.h, frame_data["h"].get<std::int32_t>()) << card_name;
+    }
+    EXPECT_TRUE(atlas_frames[std::size_t(card_back_layer)].name.starts_with("cardback"));
+}
+
+// Threads only split the layers between them, and every kernel cuts the same bytes
+TEST(AtlasCacheTest, SlicingMatchesOnEveryKernelAndWorkerCount)
+{
+    auto image = load_png_data();
+    ASSERT_TRUE(image.has_value()) << image.error();
+
+    auto serial   = slice_atlas(*image.value());
+    auto parallel = slice_atlas(*image.value(), 4);
+    ASSERT_TRUE(serial.has_value()) << serial.error();
+    ASSERT_TRUE(parallel.has_value()) << parallel.error();
+    EXPECT_EQ(parallel->names, serial->names);
+    EXPECT_TRUE(parallel->pixels == serial->pixels);
+
+    const auto& frame       = atlas_frames[std::size_t(card_back_layer)];
+    const auto  layer_bytes = std::size_t(frame.w) * frame.h * 4;
+    const auto* expected    = serial->pixels.data() + std::size_t(card_back_layer) * layer_bytes;
+    for (const auto kernel : supported_pixel_kernels())
+    {
+        auto layer = std::vector<std::uint8_t>(layer_bytes);
+        slice_atlas_frame(*image.value(), frame, layer.data(), kernel);
+        EXPECT_EQ(std::memcmp(layer.data(), expected, layer_bytes), 0) << pixel_kernel_name(kernel);
+    }
+}
+
+TEST(AtlasCacheTest, RejectsGarbage)
+{
+    const auto cache_path = std::filesystem::temp_directory_path() / "atlas_cache_garbage.atlas";
+    {
+        auto out = std::ofstream(cache_path, std::ios::binary);
+        out << "definitely not an atlas cache, but long enough to hold a header........";
+    }
+
+    EXPECT_FALSE(open_atlas_cache(cache_path).has_value());
+    std::filesystem::remove(cache_path);
+}
@@ -0,0 +1,145 @@
+#include "card_animator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr auto all_easings = {card_easing::linear,
+                              card_easing::ease_out_cubic,
+                              card_easing::ease_in_out_cubic,
+                              card_easing::bounce};
+
+auto random_tweens(std::size_t count, std::uint32_t seed) -> std::vector<card_tween>
+{
+    auto random   = std::mt19937(seed);
+    auto position = std::uniform_real_distribution<float>(-200.0f, 1600.0f);
+    auto start    = std::uniform_real_distribution<double>(10.0, 12.0);
+    auto duration = std::uniform_real_distribution<float>(0.05f, 2.0f);
+    auto tweens   = std::vector<card_tween>();
+    for (auto i = std::size_t(0); i < count; ++i)
+    {
+        tweens.push_back({position(random),
+                          position(random),
+                          position(random),
+                          position(random),
+                          start(random),
+                          duration(random),
+                          card_easing(random() % 4),
+                          std::int32_t(random() % 53),
+                          random() % 3 != 0});
+    }
+    return tweens;
+}
+
+} // namespace
+
+TEST(CardAnimatorTest, EasingsStartAndEndInPlace)
+{
+    for (const auto easing : all_easings)
+    {
+        EXPECT_FLOAT_EQ(ease_card(easing, 0.0f).first, 0.0f);
+        EXPECT_FLOAT_EQ(ease_card(easing, 0.0f).second, 0.0f);
+        EXPECT_NEAR(ease_card(easing, 1.0f).first, 1.0f, 1e-6f);
+        EXPECT_NEAR(ease_card(easing, 1.0f).second, 1.0f, 1e-6f);
+    }
+
+    // Cubic easings never overshoot; the bounce lands, rises again and lands for good
+    for (auto t = 0.0f; t <= 1.0f; t += 1.0f / 64.0f)
+    {
+        EXPECT_LE(ease_card(card_easing::ease_out_cubic, t).first, 1.0f);
+        EXPECT_LE(ease_card(card_easing::ease_in_out_cubic, t).first, 1.0f);
+    }
+    EXPECT_NEAR(ease_card(card_easing::bounce, 1.0f / 2.75f).second, 1.0f, 1e-5f);
+    EXPECT_NEAR(ease_card(card_easing::bounce, 1.5f / 2.75f).second, 0.75f, 1e-5f);
+    EXPECT_FLOAT_EQ(ease_card(card_easing::bounce, 0.5f).first, 0.5f); // x is linear
+}
+
+// The vectorized update against ease_card, one tween at a time, while tweens finish and the
+// rest are compacted
+TEST(CardAnimatorTest, UpdateMatchesScalarReference)
+{
+    const auto tweens   = random_tweens(10'000, 1);
+    auto       animator = card_animator();
+    for (const auto& tween : tweens)
+    {
+        animator.add(tween);
+    }
+    const auto epoch = tweens.front().start;
+
+    auto remaining = tweens;
+    auto instances = std::vector<card_instance>();
+    for (auto now = 10.5; now < 14.5; now += 0.25)
+    {
+        // Same float arithmetic as the animator, so both agree on what has finished
+        const auto time     = float(now - epoch);
+        const auto progress = [&](const card_tween& tween) {
+            return (time - float(tween.start - epoch)) * (1.0f / tween.duration);
+        };
+        const auto finished = std::erase_if(
+            remaining, [&](const auto& tween) { return progress(tween) >= 1.0f; });
+
+        ASSERT_EQ(animator.update(now), finished) << "at " << now;
+        instances.clear();
+        animator.write_instances(all_layers_resident, instances);
+        ASSERT_EQ(instances.size(), remaining.size()) << "at " << now;
+
+        for (auto i = std::size_t(0); i < instances.size(); ++i)
+        {
+            const auto& tween = remaining[i];
+            const auto  t     = std::min(std::max(progress(tween), 0.0f), 1.0f);
+            const auto [ease_x, ease_y] = ease_card(tween.easing, t);
+            const auto x = tween.from_x + (tween.to_x - tween.from_x) * ease_x;
+            const auto y = tween.from_y + (tween.to_y - tween.from_y) * ease_y;
+            EXPECT_NEAR(instances[i].x, x, 0.01f);
+            EXPECT_NEAR(instances[i].y, y, 0.01f);
+            EXPECT_EQ(instances[i].layer,
+                      resolve_card_layer(tween.index, tween.face_up, all_layers_resident));
+        }
+    }
+
+    animator.update(100.0);
+    EXPECT_TRUE(animator.empty());
+    EXPECT_EQ(animator.animating_layers(), 0u);
+}
+
+TEST(CardAnimatorTest, WaitsAtTheStartAndStopsAtTheEnd)
+{
+    auto animator = card_animator();
+    animator.add({0.0f, 0.0f, 100.0f, 50.0f, 2.0, 1.0f, card_easing::linear, 7, true});
+    animator.add({0.0f, 0.0f, 100.0f, 50.0f, 1.0, 4.0f, card_easing::linear, 9, false});
+    EXPECT_EQ(animator.animating_layers(), (1u << 7) | (1u << 9));
+
+    auto instances = std::vector<card_instance>();
+    EXPECT_EQ(animator.update(1.5), 0u);
+    animator.write_instances(all_layers_resident, instances);
+    ASSERT_EQ(instances.size(), 2u);
+    EXPECT_FLOAT_EQ(instances[0].x, 0.0f); // Not started yet
+    EXPECT_EQ(instances[0].layer, 7);
+    EXPECT_FLOAT_EQ(instances[1].x, 12.5f);
+    EXPECT_FLOAT_EQ(instances[1].y, 6.25f);
+    EXPECT_EQ(instances[1].layer, card_back_layer);
+
+    // The first one finishes; the other keeps its place and state
+    EXPECT_EQ(animator.update(3.0), 1u);
+    EXPECT_EQ(animator.animating_layers(), 1u << 9);
+    instances.clear();
+    animator.write_instances(all_layers_resident & ~(std::uint64_t(1) << card_back_layer),
+                             instances);
+    ASSERT_EQ(instances.size(), 1u);
+    EXPECT_FLOAT_EQ(instances[0].x, 50.0f);
+    EXPECT_EQ(instances[0].layer, placeholder_layer);
+
+    EXPECT_EQ(animator.update(5.0), 1u);
+    EXPECT_TRUE(animator.empty());
+
+    // An empty animator starts a new epoch, so late tweens keep their precision
+    animator.add({0.0f, 0.0f, 8.0f, 0.0f, 86'400.0, 0.5f, card_easing::linear, 1, true});
+    animator.update(86'400.25);
+    instances.clear();
+    animator.write_instances(all_layers_resident, instances);
+    EXPECT_FLOAT_EQ(instances[0].x, 4.0f);
+}
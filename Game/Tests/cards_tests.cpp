@@ -1,7 +1,19 @@
 #include "cards.hpp"
 
+// clang-format off
+#include <glad/gl.h>
+#include <GLFW/glfw3.h>
+// clang-format on
+
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+
 TEST(CardsTest, LoadJsonData)
 {
     load_json_data();
@@ -18,4 +30,304 @@ TEST(CardsTest, LoadPngData)
     ASSERT_GT(asset_image->height(), 0);
     ASSERT_GT(asset_image->channels(), 0);
     ASSERT_NE(asset_image->data(), nullptr);
-}
\ No newline at end of file
+}
+
+TEST(CardsTest, BuildCardInstancesResolvesBackLayer)
+{
+    const auto cards = std::vector<card>{
+        {10.0f, 20.0f, 5, true},
+        {30.0f, 40.0f, 5, false},
+    };
+
+    auto instances = std::vector<card_instance>();
+    build_card_instances(cards, all_layers_resident, instances);
+
+    ASSERT_EQ(instances.size(), cards.size());
+    EXPECT_FLOAT_EQ(instances[0].x, 10.0f);
+    EXPECT_FLOAT_EQ(instances[0].y, 20.0f);
+    EXPECT_EQ(instances[0].layer, 5);
+    EXPECT_FLOAT_EQ(instances[1].x, 30.0f);
+    EXPECT_EQ(instances[1].layer, card_back_layer);
+}
+
+TEST(CardsTest, BuildCardInstancesUsesPlaceholdersWhileStreaming)
+{
+    const auto cards = std::vector<card>{
+        {0.0f, 0.0f, 5, true},
+        {0.0f, 0.0f, 6, true},
+    };
+
+    auto instances = std::vector<card_instance>();
+
+    // Nothing resident yet: everything is the procedural placeholder
+    build_card_instances(cards, 0, instances);
+    EXPECT_EQ(instances[0].layer, placeholder_layer);
+    EXPECT_EQ(instances[1].layer, placeholder_layer);
+
+    // Back and one face resident: the other face shows the back until it arrives
+    const auto resident = (std::uint64_t(1) << card_back_layer) | (std::uint64_t(1) << 5);
+    build_card_instances(cards, resident, instances);
+    EXPECT_EQ(instances[0].layer, 5);
+    EXPECT_EQ(instances[1].layer, card_back_layer);
+}
+
+namespace {
+
+// card.frag's distance into a rounded corner for a point in layout pixels: at most
+// 2 * card_corner_fraction where the card is opaque, fading out over a pixel beyond that.
+// Infinite outside the card's quad.
+auto corner_distance(const card_instance& instance, float x, float y) -> float
+{
+    const auto u = std::abs(x - instance.x) / (card_width_px * 0.5f);
+    const auto v = std::abs(y - instance.y) / (card_height_px * 0.5f);
+    if (u > 1.0f || v > 1.0f)
+    {
+        return std::numeric_limits<float>::infinity();
+    }
+    const auto inner = 1.0f - 2.0f * card_corner_fraction;
+    return std::hypot(std::max(u - inner, 0.0f), std::max(v - inner, 0.0f));
+}
+
+// Points of each card that card.frag gives any coverage and no later card fully covers, on a
+// quarter-pixel grid, that fall outside the extents culling left it; hidden cards have none
+auto uncovered_points_outside_extents(const std::vector<card_instance>& cards) -> std::int32_t
+{
+    auto culled = cards;
+    for (auto i = std::size_t(0); i < culled.size(); ++i)
+    {
+        culled[i].layer = std::int32_t(i);
+    }
+    auto       stats = card_cull_stats{};
+    const auto kept  = cull_card_instances(culled, stats);
+    culled.resize(kept);
+
+    constexpr auto edge = 2.0f * card_corner_fraction;
+    constexpr auto fade = 2.0f / card_width_px + 2.0f / card_height_px; // fwidth(corner)
+    constexpr auto step = 0.25f;
+    auto           missing = 0;
+    for (auto i = std::size_t(0); i < cards.size(); ++i)
+    {
+        const auto& card    = cards[i];
+        const auto* trimmed = static_cast<const card_instance*>(nullptr);
+        for (const auto& instance : culled)
+        {
+            trimmed = instance.layer == std::int32_t(i) ? &instance : trimmed;
+        }
+
+        // Sampled at the middle of each grid cell, clear of the quad's own edges
+        const auto card_left = card.x - card_width_px * 0.5f;
+        const auto card_top  = card.y + card_height_px * 0.5f;
+        for (auto row = 0; row < std::int32_t(card_height_px / step); ++row)
+        {
+            const auto y = card_top - (float(row) + 0.5f) * step;
+            for (auto column = 0; column < std::int32_t(card_width_px / step); ++column)
+            {
+                const auto x = card_left + (float(column) + 0.5f) * step;
+                auto shows = corner_distance(card, x, y) < edge + fade;
+                for (auto j = i + 1; j < cards.size() && shows; ++j)
+                {
+                    shows = corner_distance(cards[j], x, y) > edge;
+                }
+                if (!shows)
+                {
+                    continue;
+                }
+
+                const auto scale  = 1.0f / float(card_extent_full);
+                const auto inside = trimmed != nullptr &&
+                                    x >= card_left + trimmed->left * scale * card_width_px &&
+                                    x <= card_left + trimmed->right * scale * card_width_px &&
+                                    y <= card_top - trimmed->top * scale * card_height_px &&
+                                    y >= card_top - trimmed->bottom * scale * card_height_px;
+                missing += inside ? 0 : 1;
+            }
+        }
+    }
+    return missing;
+}
+
+} // namespace
+
+TEST(CardsTest, CullDropsCardsStackedUnderneath)
+{
+    // A foundation: every card at the same place, only the last one shows
+    auto instances = std::vector<card_instance>(5, card_instance{100.0f, 200.0f, 3});
+    auto stats     = card_cull_stats{};
+    ASSERT_EQ(cull_card_instances(instances, stats), 1u);
+    EXPECT_EQ(instances[0].left, 0);
+    EXPECT_EQ(instances[0].top, 0);
+    EXPECT_EQ(instances[0].right, card_extent_full);
+    EXPECT_EQ(instances[0].bottom, card_extent_full);
+    EXPECT_EQ(stats.cards, 5u);
+    EXPECT_EQ(stats.hidden_cards, 4u);
+    EXPECT_DOUBLE_EQ(stats.visible_pixels, stats.quad_pixels / 5.0);
+}
+
+TEST(CardsTest, CullTrimsTableauFanToTopStrips)
+{
+    // Cards overlapping downwards by 30 pixels, like a tableau pile
+    constexpr auto fan_offset = 30.0f;
+    auto           instances  = std::vector<card_instance>();
+    for (auto i = 0; i < 4; ++i)
+    {
+        instances.push_back({100.0f, 500.0f - fan_offset * float(i), i});
+    }
+    auto stats = card_cull_stats{};
+    ASSERT_EQ(cull_card_instances(instances, stats), 4u);
+
+    // The covered cards keep their full width and the strip above the next card's rounded
+    // corners, plus the seam
+    const auto strip =
+        (fan_offset + card_height_px * card_corner_fraction + 1.0f) / card_height_px;
+    for (auto i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(instances[i].layer, i);
+        EXPECT_EQ(instances[i].left, 0);
+        EXPECT_EQ(instances[i].top, 0);
+        EXPECT_EQ(instances[i].right, card_extent_full);
+        EXPECT_NEAR(instances[i].bottom / float(card_extent_full), strip, 1e-4f) << i;
+    }
+    EXPECT_EQ(instances[3].bottom, card_extent_full);
+    EXPECT_EQ(stats.hidden_cards, 0u);
+    EXPECT_LT(stats.visible_pixels, stats.quad_pixels * 0.5);
+}
+
+TEST(CardsTest, CullTrimsWasteFanToLeftStrips)
+{
+    // The waste fans out to the right
+    constexpr auto fan_offset = 20.0f;
+    auto           instances  = std::vector<card_instance>{
+        {300.0f, 800.0f, 1},
+        {300.0f + fan_offset, 800.0f, 2},
+    };
+    auto stats = card_cull_stats{};
+    ASSERT_EQ(cull_card_instances(instances, stats), 2u);
+    EXPECT_EQ(instances[0].left, 0);
+    EXPECT_EQ(instances[0].top, 0);
+    EXPECT_NEAR(instances[0].right / float(card_extent_full),
+                (fan_offset + card_width_px * card_corner_fraction + 1.0f) / card_width_px,
+                1e-4f);
+    EXPECT_EQ(instances[0].bottom, card_extent_full);
+}
+
+TEST(CardsTest, CullLeavesSeparateCardsWhole)
+{
+    // Side by side, and one overlapping the others only where their corners are rounded
+    auto instances = std::vector<card_instance>{
+        {100.0f, 100.0f, 1},
+        {100.0f + card_width_px, 100.0f, 2},
+        {100.0f + card_width_px * 0.95f, 100.0f + card_height_px * 0.95f, 3},
+    };
+    const auto original = instances;
+    auto       stats    = card_cull_stats{};
+    ASSERT_EQ(cull_card_instances(instances, stats), 3u);
+    for (auto i = std::size_t(0); i < instances.size(); ++i)
+    {
+        EXPECT_EQ(instances[i].layer, original[i].layer);
+        EXPECT_EQ(instances[i].left, 0);
+        EXPECT_EQ(instances[i].top, 0);
+        EXPECT_EQ(instances[i].right, card_extent_full);
+        EXPECT_EQ(instances[i].bottom, card_extent_full);
+    }
+    EXPECT_DOUBLE_EQ(stats.visible_pixels, stats.quad_pixels);
+}
+
+// Trimming keeps everything that shows through a covering card's rounded corners, whatever
+// the fan step. Cards at exactly the same place are the one exception: there the card below
+// only adds to the anti-aliased rim of the one above, and is dropped (see HeadlessTest).
+TEST(CardsTest, CullKeepsWhatShowsThroughRoundedCorners)
+{
+    for (const auto offset : {1.0f, 2.5f, 7.0f, 10.5f, 14.0f, 16.0f, 17.5f, 30.0f, 90.0f})
+    {
+        auto down  = std::vector<card_instance>();
+        auto right = std::vector<card_instance>();
+        auto slant = std::vector<card_instance>();
+        for (auto i = 0; i < 4; ++i)
+        {
+            down.push_back({200.0f, 500.0f - offset * float(i), 0});
+            right.push_back({200.0f + offset * float(i), 500.0f, 0});
+            slant.push_back({200.0f + 1.5f * float(i), 500.0f - offset * float(i), 0});
+        }
+        EXPECT_EQ(uncovered_points_outside_extents(down), 0) << "down by " << offset;
+        EXPECT_EQ(uncovered_points_outside_extents(right), 0) << "right by " << offset;
+        EXPECT_EQ(uncovered_points_outside_extents(slant), 0) << "slanted by " << offset;
+    }
+}
+
+// Draw submission must not scale with the number of cards: one upload plus one instanced call.
+// Meant to be run under Mesa llvmpipe (LIBGL_ALWAYS_SOFTWARE=1) so results are comparable.
+TEST(CardsTest, DrawCardsCpuTimeIsFlat)
+{
+    if (!glfwInit())
+    {
+        GTEST_SKIP() << "GLFW could not initialize (no display?)";
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    auto* window = glfwCreateWindow(1400, 1000, "cards_tests", nullptr, nullptr);
+    if (window == nullptr)
+    {
+        glfwTerminate();
+        GTEST_SKIP() << "No OpenGL 4.6 context available";
+    }
+    glfwMakeContextCurrent(window);
+    ASSERT_NE(gladLoadGL(glfwGetProcAddress), 0);
+
+    auto cr_result = create_card_renderer();
+    ASSERT_TRUE(cr_result.has_value()) << cr_result.error();
+    auto cr = cr_result.value();
+
+    // Submission alone: culling is per-card work, and random cards cover each other at random
+    cr->cull_hidden_cards = false;
+
+    auto rng       = std::mt19937(1234);
+    auto x_dist    = std::uniform_real_distribution<float>(0.0f, 1400.0f);
+    auto y_dist    = std::uniform_real_distribution<float>(0.0f, 1000.0f);
+    auto face_dist = std::uniform_int_distribution<std::int32_t>(0, 51);
+
+    // Median CPU time spent inside draw_cards; the GPU is drained outside the timed region
+    auto median_frame_time = [&](std::size_t card_count) {
+        auto cards = std::vector<card>(card_count);
+        for (auto& c : cards)
+        {
+            c = {x_dist(rng), y_dist(rng), face_dist(rng), (face_dist(rng) % 2) == 0};
+        }
+
+        constexpr auto warmup_frames = 10;
+        constexpr auto timed_frames  = 100;
+        auto           samples       = std::vector<double>();
+        for (auto frame = 0; frame < warmup_frames + timed_frames; ++frame)
+        {
+            glClear(GL_COLOR_BUFFER_BIT);
+            const auto start = std::chrono::steady_clock::now();
+            draw_cards(cr, cards);
+            const auto stop = std::chrono::steady_clock::now();
+            glFinish();
+
+            if (frame >= warmup_frames)
+            {
+                samples.push_back(std::chrono::duration<double, std::micro>(stop - start).count());
+            }
+        }
+        std::ranges::nth_element(samples, samples.begin() + samples.size() / 2);
+        return samples[samples.size() / 2];
+    };
+
+    const auto baseline_us = median_frame_time(3);
+    auto       largest_us  = baseline_us;
+    for (const auto count : {3uz, 100uz, 1'000uz, 10'000uz})
+    {
+        const auto frame_us = median_frame_time(count);
+        largest_us          = std::max(largest_us, frame_us);
+        std::printf("draw_cards: %6zu cards -> %8.1f us/frame CPU\n", count, frame_us);
+    }
+
+    // 10k per-card draw calls would cost tens of milliseconds; the batch only adds packing
+    EXPECT_LT(largest_us, baseline_us + 1000.0);
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+}
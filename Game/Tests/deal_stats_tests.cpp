@@ -0,0 +1,110 @@
+#include "deal_stats.hpp"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+namespace {
+
+auto temporary_deal_file() -> std::filesystem::path
+{
+    auto path = std::filesystem::temp_directory_path() / "solitaire_deal_stats_test.bin";
+    std::filesystem::remove(path);
+    return path;
+}
+
+auto make_records(std::uint64_t first_seed, std::size_t count) -> std::vector<deal_record>
+{
+    auto records = std::vector<deal_record>(count);
+    for (auto i = std::size_t(0); i < count; ++i)
+    {
+        records[i].seed            = first_seed + i;
+        records[i].outcome         = deal_outcome(i % 3);
+        records[i].solution_length = std::uint16_t(100 + i);
+        records[i].stock_passes    = std::uint8_t(i % 5);
+        records[i].positions       = std::uint32_t(i * 1000);
+    }
+    return records;
+}
+
+auto same_record(const deal_record& a, const deal_record& b) -> bool
+{
+    return a.seed == b.seed && a.outcome == b.outcome &&
+           a.solution_length == b.solution_length && a.stock_passes == b.stock_passes &&
+           a.positions == b.positions;
+}
+
+} // namespace
+
+TEST(DealStatsTest, ChunksRoundTrip)
+{
+    const auto path    = temporary_deal_file();
+    const auto records = make_records(50, 10);
+    {
+        auto writer = deal_stats_writer::open(path, 1, 50);
+        ASSERT_TRUE(writer.has_value()) << writer.error();
+        ASSERT_TRUE(writer->append_chunk(std::span(records).first(4)).has_value());
+        ASSERT_TRUE(writer->append_chunk(std::span(records).subspan(4)).has_value());
+        EXPECT_EQ(writer->next_seed(), 60u);
+
+        // Chunks must continue where the file left off
+        EXPECT_FALSE(writer->append_chunk(std::span(records).first(1)).has_value());
+    }
+
+    auto read = read_deal_stats(path);
+    ASSERT_TRUE(read.has_value()) << read.error();
+    ASSERT_EQ(read->size(), records.size());
+    for (auto i = std::size_t(0); i < records.size(); ++i)
+    {
+        EXPECT_TRUE(same_record(read.value()[i], records[i])) << "record " << i;
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(DealStatsTest, ResumesAfterTornChunk)
+{
+    const auto path    = temporary_deal_file();
+    const auto records = make_records(1, 8);
+    {
+        auto writer = deal_stats_writer::open(path, 3, 1);
+        ASSERT_TRUE(writer.has_value()) << writer.error();
+        ASSERT_TRUE(writer->append_chunk(std::span(records).first(4)).has_value());
+        ASSERT_TRUE(writer->append_chunk(std::span(records).subspan(4)).has_value());
+    }
+
+    // Simulate a crash part-way through writing the second chunk
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 5);
+
+    EXPECT_FALSE(deal_stats_writer::open(path, 1, 1).has_value());    // Draw count mismatch
+    EXPECT_FALSE(deal_stats_writer::open(path, 3, 1000).has_value()); // Another seed range
+
+    auto writer = deal_stats_writer::open(path, 3, 1);
+    ASSERT_TRUE(writer.has_value()) << writer.error();
+    EXPECT_EQ(writer->next_seed(), 5u);
+    ASSERT_TRUE(writer->append_chunk(std::span(records).subspan(4)).has_value());
+
+    auto read = read_deal_stats(path);
+    ASSERT_TRUE(read.has_value()) << read.error();
+    ASSERT_EQ(read->size(), records.size());
+    EXPECT_TRUE(same_record(read->back(), records.back()));
+    std::filesystem::remove(path);
+}
+
+TEST(DealStatsTest, ParallelAnalysisMatchesSerial)
+{
+    const auto options = solver_options{.memory_budget = 8 << 20, .node_limit = 200'000};
+
+    auto parallel = std::vector<deal_record>(8);
+    analyse_deals(100, 1, options, 4, parallel);
+
+    auto table = transposition_table(options.memory_budget);
+    for (const auto& record : parallel)
+    {
+        const auto serial = analyse_deal(record.seed, 1, options, table);
+        EXPECT_EQ(serial.outcome, record.outcome) << "seed " << record.seed;
+        if (record.outcome == deal_outcome::winnable)
+        {
+            EXPECT_GT(record.solution_length, 0);
+        }
+    }
+}
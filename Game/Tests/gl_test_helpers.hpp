@@ -0,0 +1,38 @@
+#ifndef _GAME_GL_TEST_HELPERS_HPP__
+#define _GAME_GL_TEST_HELPERS_HPP__
+
+#include "headless.hpp"
+
+// clang-format off
+#include <glad/gl.h>
+// clang-format on
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+// Runs `body` with a GL context, skipping the test where EGL is not available
+inline void with_context(std::int32_t width, std::int32_t height, const std::function<void()>& body)
+{
+    auto result = run_offscreen(width, height, body);
+    if (!result && result.error().find("EGL") != std::string::npos)
+    {
+        GTEST_SKIP() << result.error();
+    }
+    ASSERT_TRUE(result.has_value()) << result.error();
+}
+
+// The bound framebuffer's RGBA8 pixels, bottom row first
+inline auto read_pixels(std::int32_t width, std::int32_t height) -> std::vector<std::uint8_t>
+{
+    auto pixels = std::vector<std::uint8_t>(std::size_t(width) * std::size_t(height) * 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    return pixels;
+}
+
+#endif // _GAME_GL_TEST_HELPERS_HPP__
@@ -0,0 +1,318 @@
+#include "cards.hpp"
+#include "headless.hpp"
+#include "table_layout.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr auto rank_names = std::array{"ace", "2", "3",  "4",    "5",     "6",   "7",
+                                       "8",   "9", "10", "jack", "queen", "king"};
+constexpr auto suit_names = std::array{"clubs", "diamonds", "hearts", "spades"};
+
+auto frame_name_at(const nlohmann::json& frames, std::int32_t layer) -> std::string
+{
+    auto iterator = frames.begin();
+    std::advance(iterator, layer);
+    return iterator.key();
+}
+
+} // namespace
+
+TEST(HeadlessTest, FaceLayersMatchAtlasFrames)
+{
+    const auto json_data = load_json_data();
+    ASSERT_TRUE(json_data.has_value()) << json_data.error();
+    const auto& frames = json_data.value()["frames"];
+
+    EXPECT_EQ(frame_name_at(frames, card_back_layer).rfind("cardback", 0), 0u);
+    for (auto suit = 0; suit < 4; ++suit)
+    {
+        for (auto rank = 0; rank < 13; ++rank)
+        {
+            // Some frames carry a "2" suffix for the alternative artwork
+            const auto expected = std::string(rank_names[rank]) + "_of_" + suit_names[suit];
+            const auto name     = frame_name_at(frames, card_face_layer(suit, rank));
+            EXPECT_EQ(name.rfind(expected, 0), 0u) << name << " is not " << expected;
+        }
+    }
+}
+
+TEST(HeadlessTest, LayoutPlacesEveryCardOnScreen)
+{
+    const auto metrics = table_metrics{};
+    auto       state   = deal_klondike(shuffle_deck(1), 3);
+    auto       cards   = std::vector<card>();
+
+    for (auto step = 0; step < 40; ++step)
+    {
+        layout_table(state, metrics, cards);
+        ASSERT_EQ(cards.size(), 52u);
+        for (const auto& c : cards)
+        {
+            EXPECT_GE(c.x - card_width_px * 0.5f, 0.0f);
+            EXPECT_LE(c.x + card_width_px * 0.5f, metrics.width);
+            EXPECT_GE(c.y - card_height_px * 0.5f, 0.0f);
+            EXPECT_LE(c.y + card_height_px * 0.5f, metrics.height);
+        }
+
+        auto moves = move_list{};
+        generate_moves(state, moves);
+        if (moves.size == 0)
+        {
+            break;
+        }
+        auto move = moves[0];
+        apply_move(state, move);
+    }
+}
+
+TEST(HeadlessTest, LayoutShowsOnlyTableauTopsFaceUp)
+{
+    const auto state = deal_klondike(shuffle_deck(7), 1);
+    auto       cards = std::vector<card>();
+    layout_table(state, table_metrics{}, cards);
+
+    // A fresh deal shows one face-up card per tableau pile and nothing else
+    const auto face_up = std::ranges::count_if(cards, [](const card& c) { return c.face_up; });
+    EXPECT_EQ(face_up, 7);
+}
+
+TEST(HeadlessTest, SummarizeFrameTimesUsesNearestRank)
+{
+    auto times = std::vector<double>();
+    for (auto i = 100; i >= 1; --i)
+    {
+        times.push_back(double(i));
+    }
+
+    const auto stats = summarize_frame_times(times);
+    EXPECT_DOUBLE_EQ(stats.p50, 50.0);
+    EXPECT_DOUBLE_EQ(stats.p90, 90.0);
+    EXPECT_DOUBLE_EQ(stats.p99, 99.0);
+    EXPECT_DOUBLE_EQ(stats.max, 100.0);
+    EXPECT_DOUBLE_EQ(stats.mean, 50.5);
+
+    const auto empty = summarize_frame_times({});
+    EXPECT_DOUBLE_EQ(empty.max, 0.0);
+}
+
+TEST(HeadlessTest, ParseOptions)
+{
+    auto arguments = std::array<const char*, 11>{"--frames",
+                                                 "12",
+                                                 "--size",
+                                                 "640x480",
+                                                 "--dump-frame",
+                                                 "3",
+                                                 "--no-shader-cache",
+                                                 "--dump-frame",
+                                                 "7",
+                                                 "--seed",
+                                                 "9"};
+    const auto options =
+        parse_headless_options(int(arguments.size()), const_cast<char**>(arguments.data()));
+    ASSERT_TRUE(options.has_value()) << options.error();
+    EXPECT_EQ(options->frame_count, 12);
+    EXPECT_EQ(options->width, 640);
+    EXPECT_EQ(options->height, 480);
+    EXPECT_EQ(options->seed, 9u);
+    EXPECT_EQ(options->dump_frames, (std::vector<std::int32_t>{3, 7}));
+    EXPECT_FALSE(options->shader_cache);
+
+    auto bad = std::array<const char*, 2>{"--size", "640"};
+    EXPECT_FALSE(parse_headless_options(int(bad.size()), const_cast<char**>(bad.data())));
+}
+
+TEST(HeadlessTest, RendersAndDumpsFrames)
+{
+    auto options           = headless_options{};
+    options.width          = 700;
+    options.height         = 500;
+    options.frame_count    = 8;
+    options.warmup         = 2;
+    options.dump_frames    = {4};
+    options.dump_directory = std::filesystem::temp_directory_path();
+
+    const auto report = run_headless(options);
+    if (!report && report.error().find("EGL") != std::string::npos)
+    {
+        GTEST_SKIP() << report.error();
+    }
+    ASSERT_TRUE(report.has_value()) << report.error();
+    EXPECT_EQ(report->cpu_ms.size(), 8u);
+    EXPECT_EQ(report->gpu_ms.size(), 8u);
+    EXPECT_FALSE(report->renderer.empty());
+    EXPECT_GT(report->shader_stats.milliseconds, 0.0);
+
+    const auto dump = options.dump_directory / "frame_00004.png";
+    EXPECT_TRUE(std::filesystem::exists(dump));
+    std::filesystem::remove(dump);
+}
+
+// Culling draws the same frames from far fewer fragments
+TEST(HeadlessTest, CullingCutsFragmentsNotPixels)
+{
+    const auto directory = std::filesystem::temp_directory_path();
+    auto       run       = [&](bool cull) {
+        auto options           = headless_options{};
+        options.frame_count    = 60;
+        options.warmup         = 2;
+        options.cull_cards     = cull;
+        options.dump_frames    = {50};
+        options.dump_directory = directory / (cull ? "culled" : "unculled");
+        std::filesystem::create_directories(options.dump_directory);
+        return run_headless(options);
+    };
+    const auto culled   = run(true);
+    const auto unculled = run(false);
+    if (!culled && culled.error().find("EGL") != std::string::npos)
+    {
+        GTEST_SKIP() << culled.error();
+    }
+    ASSERT_TRUE(culled.has_value()) << culled.error();
+    ASSERT_TRUE(unculled.has_value()) << unculled.error();
+
+    // The CPU's estimate always, the driver's count where it has pipeline statistics
+    EXPECT_GT(culled->cull_stats.hidden_cards, 0u);
+    EXPECT_LT(culled->cull_stats.visible_pixels, culled->cull_stats.quad_pixels * 0.75);
+    EXPECT_EQ(unculled->cull_stats.cards, 0u);
+    if (culled->fragments_measured)
+    {
+        std::printf("Fragments per frame: %.0f unculled, %.0f culled\n",
+                    double(unculled->fragments) / 60.0,
+                    double(culled->fragments) / 60.0);
+        EXPECT_LT(culled->fragments, unculled->fragments * 3 / 4);
+    }
+
+    auto load = [&](bool cull) {
+        const auto path = directory / (cull ? "culled" : "unculled") / "frame_00050.png";
+        auto       size = std::array<int, 3>{};
+        auto*      data = stbi_load(path.string().c_str(), &size[0], &size[1], &size[2], 4);
+        auto pixels = std::vector<std::uint8_t>(data, data + (data ? size[0] * size[1] * 4 : 0));
+        stbi_image_free(data);
+        std::filesystem::remove_all(path.parent_path());
+        return pixels;
+    };
+    const auto culled_pixels   = load(true);
+    const auto unculled_pixels = load(false);
+    ASSERT_FALSE(culled_pixels.empty());
+    ASSERT_EQ(culled_pixels.size(), unculled_pixels.size());
+    // The anti-aliased corners of stacked cards blend once now, not once per card underneath;
+    // everything else matches
+    auto changed = 0;
+    for (auto i = std::size_t(0); i < culled_pixels.size(); i += 4)
+    {
+        for (auto channel = std::size_t(0); channel < 4; ++channel)
+        {
+            if (std::abs(culled_pixels[i + channel] - unculled_pixels[i + channel]) > 1)
+            {
+                ++changed;
+                break;
+            }
+        }
+    }
+    EXPECT_LT(changed, 1000) << "of " << culled_pixels.size() / 4 << " pixels";
+}
+
+// The table fills any framebuffer the same way, at full and at half render scale, and the half
+// scale frame shades a quarter of the fragments
+TEST(HeadlessTest, FitsTheTableIntoEveryFramebufferSize)
+{
+    constexpr auto sizes = std::array<std::array<std::int32_t, 2>, 6>{{
+        {640, 360},
+        {1400, 1000},
+        {1000, 1400},
+        {1920, 1080},
+        {2560, 1440},
+        {3840, 2160},
+    }};
+    constexpr auto felt  = std::array<int, 3>{51, 77, 77}; // The clear colour
+    const auto directory = std::filesystem::temp_directory_path() / "render_scale";
+
+    for (const auto& [width, height] : sizes)
+    {
+        auto fragments = std::array<std::uint64_t, 2>{};
+        for (const auto scale : {1.0f, 0.5f})
+        {
+            auto options           = headless_options{};
+            options.width          = width;
+            options.height         = height;
+            options.render_scale   = scale;
+            options.frame_count    = 3;
+            options.warmup         = 0;
+            options.dump_frames    = {0};
+            options.dump_directory = directory;
+            std::filesystem::create_directories(directory);
+
+            const auto report = run_headless(options);
+            if (!report && report.error().find("EGL") != std::string::npos)
+            {
+                GTEST_SKIP() << report.error();
+            }
+            ASSERT_TRUE(report.has_value()) << report.error();
+            EXPECT_EQ(report->render_width, std::int32_t(std::lround(width * scale)));
+            EXPECT_EQ(report->render_height, std::int32_t(std::lround(height * scale)));
+            fragments[scale < 1.0f ? 1 : 0] = report->fragments_measured ? report->fragments : 0;
+
+            const auto path = directory / "frame_00000.png";
+            auto       size = std::array<int, 3>{};
+            auto*      data = stbi_load(path.string().c_str(), &size[0], &size[1], &size[2], 4);
+            ASSERT_NE(data, nullptr) << path.string();
+            ASSERT_EQ(size[0], width);
+            ASSERT_EQ(size[1], height);
+
+            // Everything that is not felt, in framebuffer columns and rows from the top
+            auto min_x = width, max_x = -1, min_y = height, max_y = -1;
+            for (auto y = 0; y < height; ++y)
+            {
+                for (auto x = 0; x < width; ++x)
+                {
+                    const auto* pixel = data + (std::size_t(y) * width + x) * 4;
+                    auto        away  = 0;
+                    for (auto channel = 0; channel < 3; ++channel)
+                    {
+                        away = std::max(away, std::abs(pixel[channel] - felt[channel]));
+                    }
+                    if (away > 2)
+                    {
+                        min_x = std::min(min_x, x);
+                        max_x = std::max(max_x, x);
+                        min_y = std::min(min_y, y);
+                        max_y = std::max(max_y, y);
+                    }
+                }
+            }
+            stbi_image_free(data);
+            std::filesystem::remove(path);
+
+            // Inside the table as fitted and centred, and spread across most of its width
+            const auto metrics = table_metrics{};
+            const auto fit     = std::min(width / metrics.width, height / metrics.height);
+            const auto left    = (width - metrics.width * fit) * 0.5f;
+            const auto top     = (height - metrics.height * fit) * 0.5f;
+            const auto label   = std::to_string(width) + "x" + std::to_string(height) + " at " +
+                               std::to_string(scale);
+            ASSERT_GE(max_x, 0) << label << ": nothing drawn";
+            EXPECT_GE(min_x, left - 2.0f) << label;
+            EXPECT_LE(max_x, left + metrics.width * fit + 2.0f) << label;
+            EXPECT_GE(min_y, top - 2.0f) << label;
+            EXPECT_LE(max_y, top + metrics.height * fit + 2.0f) << label;
+            EXPECT_GE(max_x - min_x, metrics.width * fit * 0.8f) << label;
+        }
+        if (fragments[0] > 0)
+        {
+            EXPECT_LT(fragments[1], fragments[0] * 35 / 100) << width << "x" << height;
+        }
+    }
+    std::filesystem::remove_all(directory);
+}
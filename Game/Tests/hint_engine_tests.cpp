@@ -0,0 +1,207 @@
+#include "hint_engine.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+using std::chrono::microseconds;
+
+constexpr auto deal_count = 8;
+constexpr auto play_moves = 40;
+
+auto is_legal(const klondike_state& state, klondike_move move) -> bool
+{
+    // Flags are filled in by apply_move, so only the move itself is compared
+    move.flags = 0;
+    auto legal = move_list{};
+    generate_moves(state, legal);
+    return std::find(legal.begin(), legal.end(), move) != legal.end();
+}
+
+// Every foundation at queen, kings on the first four piles
+auto nearly_won() -> klondike_state
+{
+    auto state        = klondike_state{};
+    state.foundations = 0xCCCC;
+    for (auto suit = 0; suit < suit_count; ++suit)
+    {
+        state.tableau[suit][0]   = make_card(suit, rank_count - 1);
+        state.tableau_size[suit] = 1;
+    }
+    state.hash = compute_hash(state);
+    return state;
+}
+
+struct quality_row
+{
+    std::int64_t budget_us = 0;
+    double       score     = 0.0; // Mean evaluate_position after the moves, over the deals
+    double       depth     = 0.0; // Mean depth searched per hint
+    double       nodes     = 0.0; // Mean nodes per hint
+    std::int32_t wins      = 0;
+};
+
+// Plays each deal by always taking the hint found in `budget`
+auto play_by_hints(microseconds budget) -> quality_row
+{
+    auto row    = quality_row{budget.count()};
+    auto hints  = 0;
+    auto search = hint_search();
+    for (auto seed = 1; seed <= deal_count; ++seed)
+    {
+        auto state = deal_klondike(shuffle_deck(std::uint64_t(seed)));
+        for (auto i = 0; i < play_moves && !is_won(state); ++i)
+        {
+            search.reset(state);
+            search.step(budget);
+            const auto move = search.best().move();
+            if (!move)
+            {
+                break;
+            }
+            EXPECT_TRUE(is_legal(state, *move)) << "seed " << seed << ", move " << i;
+            row.depth += search.best().depth;
+            row.nodes += double(search.best().nodes);
+            ++hints;
+
+            auto played = *move;
+            apply_move(state, played);
+        }
+        row.score += evaluate_position(state);
+        row.wins += is_won(state) ? 1 : 0;
+    }
+    row.score /= deal_count;
+    row.depth /= std::max(hints, 1);
+    row.nodes /= std::max(hints, 1);
+    return row;
+}
+
+} // namespace
+
+TEST(HintEngineTest, EvaluatesProgress)
+{
+    const auto deal = deal_klondike(shuffle_deck(1));
+    auto       won  = klondike_state{};
+    won.foundations = 0xDDDD;
+    EXPECT_GT(evaluate_position(nearly_won()), evaluate_position(deal));
+    EXPECT_GT(evaluate_position(won), evaluate_position(nearly_won()));
+}
+
+// An answer is ready before anything is searched, and stays legal as the search refines it
+TEST(HintEngineTest, AlwaysHasALegalAnswer)
+{
+    const auto deal   = deal_klondike(shuffle_deck(2));
+    auto       search = hint_search();
+    search.reset(deal);
+    EXPECT_FALSE(search.finished());
+    ASSERT_TRUE(search.best().move().has_value());
+    EXPECT_TRUE(is_legal(deal, *search.best().move()));
+    EXPECT_EQ(search.best().depth, 0);
+
+    for (auto i = 0; i < 20 && !search.finished(); ++i)
+    {
+        search.step(microseconds(200));
+        ASSERT_TRUE(search.best().move().has_value());
+        EXPECT_TRUE(is_legal(deal, *search.best().move()));
+    }
+    EXPECT_GT(search.best().nodes, 0u);
+    EXPECT_GE(search.best().score, evaluate_position(deal));
+}
+
+TEST(HintEngineTest, StepKeepsToItsBudget)
+{
+    constexpr auto budget = microseconds(500);
+
+    auto search = hint_search(hint_options{.node_limit = 50'000'000});
+    search.reset(deal_klondike(shuffle_deck(3)));
+    auto worst = microseconds(0);
+    for (auto i = 0; i < 20 && !search.finished(); ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        search.step(budget);
+        const auto spent = std::chrono::duration_cast<microseconds>(
+            std::chrono::steady_clock::now() - start);
+        worst = std::max(worst, spent);
+    }
+    // A few nodes past the deadline at most; the margin is for a busy machine
+    EXPECT_LT(worst, budget + microseconds(1500));
+}
+
+// Slices of any size add up to the same search as one long call
+TEST(HintEngineTest, ResumingMatchesOneLongStep)
+{
+    const auto options = hint_options{.node_limit = 20'000};
+    const auto deal    = deal_klondike(shuffle_deck(4));
+
+    auto whole = hint_search(options);
+    whole.reset(deal);
+    ASSERT_TRUE(whole.step(std::chrono::seconds(60)));
+
+    auto sliced = hint_search(options);
+    sliced.reset(deal);
+    auto slices = 0;
+    while (!sliced.step(microseconds(20)))
+    {
+        ++slices;
+    }
+    EXPECT_GT(slices, 1);
+    EXPECT_EQ(sliced.best().line, whole.best().line);
+    EXPECT_EQ(sliced.best().score, whole.best().score);
+    EXPECT_EQ(sliced.best().depth, whole.best().depth);
+    EXPECT_EQ(sliced.best().nodes, whole.best().nodes);
+}
+
+TEST(HintEngineTest, FindsTheWinningLine)
+{
+    auto search = hint_search();
+    search.reset(nearly_won());
+    ASSERT_TRUE(search.step(std::chrono::seconds(10)));
+    ASSERT_TRUE(search.best().solved);
+    ASSERT_EQ(search.best().line.size(), 4u);
+
+    auto state = nearly_won();
+    for (auto move : search.best().line)
+    {
+        ASSERT_TRUE(is_legal(state, move));
+        apply_move(state, move);
+    }
+    EXPECT_TRUE(is_won(state));
+
+    // Nothing to search once won
+    search.reset(state);
+    EXPECT_TRUE(search.finished());
+}
+
+// Hint quality against search time on a fixed set of deals: each deal is played by always
+// taking the hint, and the positions reached are scored
+TEST(HintEngineTest, HintQualityAgainstSearchTime)
+{
+    const auto budgets = std::array{microseconds(50), microseconds(500), microseconds(5000)};
+
+    auto rows = std::vector<quality_row>();
+    for (const auto budget : budgets)
+    {
+        rows.push_back(play_by_hints(budget));
+    }
+
+    std::printf("%10s %10s %8s %10s %6s\n", "Budget us", "Score", "Depth", "Nodes", "Wins");
+    for (const auto& row : rows)
+    {
+        std::printf("%10lld %10.1f %8.2f %10.0f %6d\n",
+                    static_cast<long long>(row.budget_us),
+                    row.score,
+                    row.depth,
+                    row.nodes,
+                    row.wins);
+    }
+
+    // More time searches deeper, and the deepest search plays at least as well as the shallowest
+    EXPECT_GT(rows.back().depth, rows.front().depth);
+    EXPECT_GE(rows.back().score, rows.front().score);
+}
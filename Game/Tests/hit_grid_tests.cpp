@@ -0,0 +1,219 @@
+#include "hit_grid.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr auto card_width  = 120.0f;
+constexpr auto card_height = 168.0f;
+
+// Many tables side by side: enough room that cards pile up a few deep, as on a real table
+struct random_layout
+{
+    float                 width;
+    float                 height;
+    std::vector<hit_rect> rects;
+};
+
+auto card_at(float x, float y) -> hit_rect
+{
+    return {x - card_width * 0.5f, y - card_height * 0.5f, x + card_width * 0.5f,
+            y + card_height * 0.5f};
+}
+
+auto make_layout(std::uint32_t seed, std::size_t count) -> random_layout
+{
+    auto random = std::mt19937(seed);
+    auto layout = random_layout{float(count) * 4.0f, 1000.0f, {}};
+
+    // Half scattered (some hanging off the edges), half fanned down in columns
+    auto x = std::uniform_real_distribution<float>(-100.0f, layout.width + 100.0f);
+    auto y = std::uniform_real_distribution<float>(-100.0f, layout.height + 100.0f);
+    while (layout.rects.size() < count / 2)
+    {
+        layout.rects.push_back(card_at(x(random), y(random)));
+    }
+    while (layout.rects.size() < count)
+    {
+        const auto column_x = x(random);
+        auto       column_y = layout.height - card_height;
+        for (auto depth = 0; depth < 13 && layout.rects.size() < count; ++depth)
+        {
+            layout.rects.push_back(card_at(column_x, column_y));
+            column_y -= depth < 6 ? 14.0f : 34.0f;
+        }
+    }
+    return layout;
+}
+
+auto index_layout(const random_layout& layout) -> hit_grid
+{
+    auto grid = hit_grid();
+    grid.reset(layout.width, layout.height, card_width, card_height);
+    for (auto id = std::size_t(0); id < layout.rects.size(); ++id)
+    {
+        grid.set(std::uint32_t(id), layout.rects[id]);
+    }
+    return grid;
+}
+
+auto linear_topmost(const std::vector<hit_rect>& rects, float x, float y)
+    -> std::optional<std::uint32_t>
+{
+    for (auto id = rects.size(); id-- > 0;)
+    {
+        const auto& r = rects[id];
+        if (x >= r.left && x <= r.right && y >= r.bottom && y <= r.top)
+        {
+            return std::uint32_t(id);
+        }
+    }
+    return std::nullopt;
+}
+
+auto linear_best_overlap(const std::vector<hit_rect>& rects, const hit_rect& query)
+    -> std::optional<std::uint32_t>
+{
+    auto best      = std::optional<std::uint32_t>();
+    auto best_area = 0.0f;
+    for (auto id = std::size_t(0); id < rects.size(); ++id)
+    {
+        const auto& r      = rects[id];
+        const auto  width  = std::min(r.right, query.right) - std::max(r.left, query.left);
+        const auto  height = std::min(r.top, query.top) - std::max(r.bottom, query.bottom);
+        const auto  area   = width > 0.0f && height > 0.0f ? width * height : 0.0f;
+        if (area > 0.0f && area >= best_area)
+        {
+            best      = std::uint32_t(id);
+            best_area = area;
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+TEST(HitGridTest, EmptyGridFindsNothing)
+{
+    auto grid = hit_grid();
+    EXPECT_FALSE(grid.topmost(10.0f, 10.0f).has_value());
+    EXPECT_FALSE(grid.best_overlap({0.0f, 0.0f, 10.0f, 10.0f}).has_value());
+
+    grid.reset(1000.0f, 1000.0f, card_width, card_height);
+    EXPECT_FALSE(grid.topmost(10.0f, 10.0f).has_value());
+}
+
+TEST(HitGridTest, HigherIdWinsAndEdgesAreInclusive)
+{
+    auto grid = hit_grid();
+    grid.reset(1000.0f, 1000.0f, card_width, card_height);
+    grid.set(0, card_at(100.0f, 100.0f));
+    grid.set(1, card_at(110.0f, 100.0f));
+
+    EXPECT_EQ(grid.topmost(105.0f, 100.0f), 1u);
+    EXPECT_EQ(grid.topmost(40.0f, 100.0f), 0u);  // Left edge of the first card
+    EXPECT_EQ(grid.topmost(170.0f, 184.0f), 1u); // Top-right corner of the second
+    EXPECT_FALSE(grid.topmost(171.0f, 100.0f).has_value());
+}
+
+TEST(HitGridTest, RandomLayoutsMatchLinearScan)
+{
+    for (auto seed = 1u; seed <= 4; ++seed)
+    {
+        const auto layout = make_layout(seed, 4096);
+        const auto grid   = index_layout(layout);
+
+        auto random = std::mt19937(seed * 31);
+        auto x      = std::uniform_real_distribution<float>(-150.0f, layout.width + 150.0f);
+        auto y      = std::uniform_real_distribution<float>(-150.0f, layout.height + 150.0f);
+        for (auto query = 0; query < 20000; ++query)
+        {
+            const auto qx = x(random);
+            const auto qy = y(random);
+            ASSERT_EQ(grid.topmost(qx, qy), linear_topmost(layout.rects, qx, qy))
+                << "seed " << seed << " at " << qx << ", " << qy;
+        }
+        for (auto query = 0; query < 2000; ++query)
+        {
+            const auto rect = card_at(x(random), y(random));
+            ASSERT_EQ(grid.best_overlap(rect), linear_best_overlap(layout.rects, rect))
+                << "seed " << seed;
+        }
+    }
+}
+
+TEST(HitGridTest, IncrementalMovesMatchRebuild)
+{
+    auto layout = make_layout(7, 2048);
+    auto grid   = index_layout(layout);
+
+    // Mostly small drags within a cell, some jumps across the table
+    auto random = std::mt19937(99);
+    auto pick   = std::uniform_int_distribution<std::size_t>(0, layout.rects.size() - 1);
+    auto nudge  = std::uniform_real_distribution<float>(-30.0f, 30.0f);
+    auto x      = std::uniform_real_distribution<float>(0.0f, layout.width);
+    auto y      = std::uniform_real_distribution<float>(0.0f, layout.height);
+    for (auto step = 0; step < 20000; ++step)
+    {
+        const auto id   = pick(random);
+        auto&      rect = layout.rects[id];
+        if (step % 10 == 0)
+        {
+            rect = card_at(x(random), y(random));
+        }
+        else
+        {
+            const auto dx = nudge(random), dy = nudge(random);
+            rect          = {rect.left + dx, rect.bottom + dy, rect.right + dx, rect.top + dy};
+        }
+        grid.set(std::uint32_t(id), rect);
+    }
+
+    const auto rebuilt = index_layout(layout);
+    for (auto query = 0; query < 20000; ++query)
+    {
+        const auto qx       = x(random);
+        const auto qy       = y(random);
+        const auto expected = linear_topmost(layout.rects, qx, qy);
+        ASSERT_EQ(grid.topmost(qx, qy), expected);
+        ASSERT_EQ(rebuilt.topmost(qx, qy), expected);
+    }
+}
+
+TEST(HitGridTest, RemoveAndTruncate)
+{
+    auto layout = make_layout(3, 1024);
+    auto grid   = index_layout(layout);
+
+    // Removing the top card of a stack uncovers the one beneath
+    const auto& top = layout.rects.back();
+    const auto  cx  = (top.left + top.right) * 0.5f;
+    const auto  cy  = (top.bottom + top.top) * 0.5f;
+    ASSERT_EQ(grid.topmost(cx, cy), std::uint32_t(layout.rects.size() - 1));
+    grid.remove(std::uint32_t(layout.rects.size() - 1));
+    EXPECT_FALSE(grid.contains(std::uint32_t(layout.rects.size() - 1)));
+    layout.rects.pop_back();
+    EXPECT_EQ(grid.topmost(cx, cy), linear_topmost(layout.rects, cx, cy));
+
+    grid.truncate(512);
+    layout.rects.resize(512);
+    EXPECT_FALSE(grid.contains(600));
+    auto random = std::mt19937(5);
+    auto x      = std::uniform_real_distribution<float>(0.0f, layout.width);
+    auto y      = std::uniform_real_distribution<float>(0.0f, layout.height);
+    for (auto query = 0; query < 5000; ++query)
+    {
+        const auto qx = x(random);
+        const auto qy = y(random);
+        ASSERT_EQ(grid.topmost(qx, qy), linear_topmost(layout.rects, qx, qy));
+    }
+
+    // Ids can be set again after being removed
+    grid.set(600, card_at(cx, cy));
+    EXPECT_EQ(grid.topmost(cx, cy), 600u);
+}
@@ -0,0 +1,244 @@
+#include "klondike.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+auto shuffled_deck(std::uint32_t seed) -> std::array<card_code, deck_size>
+{
+    auto deck = std::array<card_code, deck_size>();
+    std::iota(deck.begin(), deck.end(), card_code(0));
+    std::shuffle(deck.begin(), deck.end(), std::mt19937(seed));
+    return deck;
+}
+
+auto card_total(const klondike_state& state) -> std::int32_t
+{
+    auto total = state.stock_size + state.waste_size;
+    for (auto pile = 0; pile < tableau_count; ++pile)
+    {
+        total += state.tableau_size[pile];
+    }
+    for (auto suit = 0; suit < suit_count; ++suit)
+    {
+        total += foundation_count(state, suit);
+    }
+    return total;
+}
+
+} // namespace
+
+TEST(KlondikeTest, DealLayout)
+{
+    const auto deck  = shuffled_deck(1);
+    const auto state = deal_klondike(deck);
+
+    for (auto pile = 0; pile < tableau_count; ++pile)
+    {
+        EXPECT_EQ(state.tableau_size[pile], pile + 1);
+        EXPECT_EQ(state.face_down[pile], pile);
+    }
+    EXPECT_EQ(state.tableau[0][0], deck[0]);
+    EXPECT_EQ(state.tableau[6][0], deck[6]);
+    EXPECT_EQ(state.stock_size, stock_capacity);
+    EXPECT_EQ(state.stock[stock_capacity - 1], deck[28]);
+    EXPECT_EQ(state.waste_size, 0);
+    EXPECT_EQ(state.foundations, 0);
+    EXPECT_EQ(state.hash, compute_hash(state));
+}
+
+// Seeds name deals in files shared between machines, so the shuffle must never change
+TEST(KlondikeTest, ShuffleIsPortable)
+{
+    const auto deck = shuffle_deck(1);
+    EXPECT_EQ(std::vector<card_code>(deck.begin(), deck.begin() + 8),
+              (std::vector<card_code>{25, 6, 10, 31, 4, 49, 40, 5}));
+    EXPECT_EQ(shuffle_deck(2)[0], 40);
+
+    auto sorted = deck;
+    std::sort(sorted.begin(), sorted.end());
+    for (auto card = std::size_t(0); card < deck_size; ++card)
+    {
+        EXPECT_EQ(sorted[card], card);
+    }
+}
+
+TEST(KlondikeTest, GeneratesFoundationAndRunMoves)
+{
+    auto state                = klondike_state{};
+    state.tableau[0]          = {make_card(0, 0)};              // Ace of clubs
+    state.tableau_size[0]     = 1;
+    state.tableau[1]          = {make_card(2, 9), make_card(3, 8), make_card(1, 7)}; // 10H 9S 8D
+    state.tableau_size[1]     = 3;
+    state.tableau[2]          = {make_card(0, 9)};              // 10 of clubs
+    state.tableau_size[2]     = 1;
+    state.hash                = compute_hash(state);
+
+    auto moves = move_list{};
+    generate_moves(state, moves);
+
+    const auto has_move = [&](klondike_move wanted) {
+        return std::find(moves.begin(), moves.end(), wanted) != moves.end();
+    };
+    EXPECT_TRUE(has_move({0, pile_foundation + 0, 1, 0}));
+    // 9S 8D onto the 10 of clubs? No: 9S is black like the 10 of clubs
+    EXPECT_FALSE(has_move({1, 2, 2, 0}));
+    // The whole run starting at 10H cannot go anywhere, and no king means no empty-pile moves
+    EXPECT_FALSE(has_move({1, 3, 3, 0}));
+    EXPECT_EQ(moves[0].to, pile_foundation);
+}
+
+// The generator leaves out moves that never help the solver; the rules still allow them
+TEST(KlondikeTest, LegalityCoversMovesTheGeneratorPrunes)
+{
+    auto state            = klondike_state{};
+    state.tableau[0]      = {make_card(3, 12), make_card(1, 11)}; // KS QD, both face up
+    state.tableau_size[0] = 2;
+    state.tableau[1]      = {make_card(0, 3), make_card(2, 12)}; // 4C face down under KH
+    state.tableau_size[1] = 2;
+    state.face_down[1]    = 1;
+    state.waste           = {make_card(0, 12)}; // KC
+    state.waste_size      = 1;
+    state.foundations     = 0x0002; // Ace and two of clubs
+    state.hash            = compute_hash(state);
+
+    auto moves = move_list{};
+    generate_moves(state, moves);
+    const auto generated = [&](klondike_move wanted) {
+        return std::find(moves.begin(), moves.end(), wanted) != moves.end();
+    };
+
+    // Kings to the second empty pile, and a whole king pile to another empty one
+    for (const auto move : {klondike_move{1, 3, 1, 0},
+                            klondike_move{pile_waste, 3, 1, 0},
+                            klondike_move{0, 2, 2, 0}})
+    {
+        EXPECT_FALSE(generated(move));
+        EXPECT_TRUE(is_legal_move(state, move));
+    }
+    EXPECT_TRUE(generated({1, 2, 1, 0}));
+    EXPECT_TRUE(is_legal_move(state, {1, 2, 1, 0}));
+
+    // Only kings go to empty piles, face-down cards never move, and foundations take one card
+    // of their own suit in order
+    EXPECT_FALSE(is_legal_move(state, {pile_foundation + 0, 2, 1, 0}));
+    EXPECT_FALSE(is_legal_move(state, {pile_foundation + 0, 0, 1, 0}));
+    EXPECT_FALSE(is_legal_move(state, {1, 2, 2, 0}));
+    EXPECT_FALSE(is_legal_move(state, {0, 2, 1, 0}));
+    EXPECT_FALSE(is_legal_move(state, {0, pile_foundation + 1, 1, 0}));
+    EXPECT_FALSE(is_legal_move(state, {pile_waste, pile_foundation + 0, 1, 0}));
+    EXPECT_FALSE(is_legal_move(state, {0, pile_waste, 1, 0}));
+    EXPECT_FALSE(is_legal_move(state, {0, 0, 1, 0}));
+    EXPECT_FALSE(is_legal_move(state, {0, 13, 1, 0}));
+
+    // No stock: the waste turns over whole, and nothing is drawn
+    EXPECT_TRUE(is_legal_move(state, {pile_waste, pile_stock, 1, 0}));
+    EXPECT_FALSE(is_legal_move(state, {pile_stock, pile_waste, 1, 0}));
+    EXPECT_FALSE(is_legal_move(state, {pile_waste, pile_stock, 2, 0}));
+}
+
+// Everything the generator offers is legal, on both draw counts and deep into games
+TEST(KlondikeTest, GeneratedMovesAreLegal)
+{
+    auto rng = std::mt19937(7);
+    for (auto game = 0; game < 200; ++game)
+    {
+        auto state = deal_klondike(shuffled_deck(game), game % 2 == 0 ? 1 : 3);
+        for (auto step = 0; step < 300; ++step)
+        {
+            auto moves = move_list{};
+            generate_moves(state, moves);
+            if (moves.size == 0)
+            {
+                break;
+            }
+            for (const auto& move : moves)
+            {
+                ASSERT_TRUE(is_legal_move(state, move)) << int(move.from) << " -> " << int(move.to);
+            }
+
+            auto move = moves[std::uniform_int_distribution<std::size_t>(0, moves.size - 1)(rng)];
+            apply_move(state, move);
+        }
+    }
+}
+
+TEST(KlondikeTest, ApplyUndoRoundTripsRandomPlayouts)
+{
+    auto rng = std::mt19937(42);
+    for (auto game = 0; game < 200; ++game)
+    {
+        const auto start = deal_klondike(shuffled_deck(game), game % 2 == 0 ? 1 : 3);
+        auto       state = start;
+        auto       path  = std::vector<std::pair<klondike_state, klondike_move>>();
+
+        for (auto step = 0; step < 300; ++step)
+        {
+            auto moves = move_list{};
+            generate_moves(state, moves);
+            if (moves.size == 0)
+            {
+                break;
+            }
+
+            auto move   = moves[std::uniform_int_distribution<std::size_t>(0, moves.size - 1)(rng)];
+            auto before = state;
+            apply_move(state, move);
+            ASSERT_EQ(state.hash, compute_hash(state));
+            ASSERT_EQ(card_total(state), 52);
+            path.emplace_back(before, move);
+        }
+
+        // Unwind everything and land exactly on the deal
+        while (!path.empty())
+        {
+            undo_move(state, path.back().second);
+            ASSERT_EQ(state, path.back().first);
+            path.pop_back();
+        }
+        ASSERT_EQ(state, start);
+    }
+}
+
+// Reports generator throughput; the target is tens of millions per second in optimized builds
+TEST(KlondikeTest, MoveGenerationThroughput)
+{
+    auto states = std::vector<klondike_state>();
+    auto rng    = std::mt19937(7);
+    for (auto game = 0; game < 64; ++game)
+    {
+        auto state = deal_klondike(shuffled_deck(1000 + game));
+        for (auto step = 0; step < 40; ++step)
+        {
+            auto moves = move_list{};
+            generate_moves(state, moves);
+            auto move = moves[std::uniform_int_distribution<std::size_t>(0, moves.size - 1)(rng)];
+            apply_move(state, move);
+        }
+        states.push_back(state);
+    }
+
+    constexpr auto iterations  = 2'000'000;
+    auto           moves       = move_list{};
+    auto           total_moves = std::size_t(0);
+    const auto     start       = std::chrono::steady_clock::now();
+    for (auto i = 0; i < iterations; ++i)
+    {
+        generate_moves(states[i % states.size()], moves);
+        total_moves += moves.size;
+    }
+    const auto seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("generate_moves: %.1f M positions/s (%zu moves)\n",
+                iterations / seconds / 1e6,
+                total_moves);
+    EXPECT_GT(total_moves, 0u);
+}
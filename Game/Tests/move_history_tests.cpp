@@ -0,0 +1,146 @@
+#include "move_history.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+// A random legal move, or false when the position has none
+auto random_move(const klondike_state& state, std::mt19937& random, klondike_move& move) -> bool
+{
+    auto moves = move_list{};
+    generate_moves(state, moves);
+    if (moves.size == 0)
+    {
+        return false;
+    }
+    move = moves[std::uniform_int_distribution<std::size_t>(0, moves.size - 1)(random)];
+    return true;
+}
+
+} // namespace
+
+TEST(MoveHistoryTest, KeyframesRoundTrip)
+{
+    auto random = std::mt19937(1);
+    auto state  = deal_klondike(shuffle_deck(1), 3);
+    for (auto step = 0; step < 500; ++step)
+    {
+        ASSERT_EQ(unpack_keyframe(pack_keyframe(state)), state) << "step " << step;
+
+        auto move = klondike_move{};
+        if (!random_move(state, random, move))
+        {
+            break;
+        }
+        apply_move(state, move);
+    }
+}
+
+TEST(MoveHistoryTest, UndoRedoAtTheEnds)
+{
+    const auto deal    = deal_klondike(shuffle_deck(2), 1);
+    auto       history = move_history(deal);
+    EXPECT_FALSE(history.undo());
+    EXPECT_FALSE(history.redo());
+
+    auto random = std::mt19937(2);
+    auto move   = klondike_move{};
+    ASSERT_TRUE(random_move(history.state(), random, move));
+    history.apply(move);
+    const auto after = history.state();
+
+    EXPECT_TRUE(history.undo());
+    EXPECT_EQ(history.state(), deal);
+    EXPECT_FALSE(history.undo());
+    EXPECT_TRUE(history.redo());
+    EXPECT_EQ(history.state(), after);
+    EXPECT_FALSE(history.redo());
+
+    // A new move after an undo drops what could have been redone
+    history.undo();
+    ASSERT_TRUE(random_move(history.state(), random, move));
+    history.apply(move);
+    EXPECT_EQ(history.size(), 1u);
+    EXPECT_FALSE(history.redo());
+}
+
+// Random play, undo, redo and jumps, checked against a snapshot of every position
+TEST(MoveHistoryTest, RandomCyclesMatchSnapshots)
+{
+    constexpr auto cycles = 100'000;
+
+    const auto deal      = deal_klondike(shuffle_deck(3), 3);
+    auto       history   = move_history(deal, 16);
+    auto       snapshots = std::vector<klondike_state>{deal};
+    auto       random    = std::mt19937(3);
+    auto       action    = std::uniform_int_distribution<std::int32_t>(0, 99);
+    for (auto cycle = 0; cycle < cycles; ++cycle)
+    {
+        const auto roll = action(random);
+        auto       move = klondike_move{};
+        if (roll < 55 && random_move(history.state(), random, move))
+        {
+            history.apply(move);
+            snapshots.resize(history.position());
+            snapshots.push_back(history.state());
+        }
+        else if (roll < 80)
+        {
+            history.undo();
+        }
+        else if (roll < 97)
+        {
+            history.redo();
+        }
+        else
+        {
+            history.jump_to(std::uniform_int_distribution<std::size_t>(0, history.size())(random));
+        }
+
+        ASSERT_EQ(history.size() + 1, snapshots.size()) << "cycle " << cycle;
+        ASSERT_EQ(history.state(), snapshots[history.position()]) << "cycle " << cycle;
+        ASSERT_EQ(history.state().hash, compute_hash(history.state())) << "cycle " << cycle;
+    }
+
+    // Every position is reachable by a jump from anywhere
+    for (auto position = std::size_t(0); position <= history.size(); position += 7)
+    {
+        history.jump_to(history.size() - position);
+        ASSERT_EQ(history.state(), snapshots[history.size() - position]);
+        history.jump_to(position);
+        ASSERT_EQ(history.state(), snapshots[position]);
+    }
+}
+
+TEST(MoveHistoryTest, MemoryPerMove)
+{
+    constexpr auto move_count = std::size_t(100'000);
+
+    auto history = move_history(deal_klondike(shuffle_deck(4), 1));
+    auto random  = std::mt19937(4);
+    while (history.size() < move_count)
+    {
+        // Back out of dead ends and carry on from an earlier position
+        auto move = klondike_move{};
+        if (random_move(history.state(), random, move))
+        {
+            history.apply(move);
+        }
+        else
+        {
+            history.jump_to(history.position() / 2);
+        }
+    }
+
+    const auto bytes_per_move = double(history.memory_bytes()) / double(history.size());
+    std::printf("%zu moves in %zu bytes: %.2f bytes per move (snapshots: %zu)\n",
+                history.size(),
+                history.memory_bytes(),
+                bytes_per_move,
+                sizeof(klondike_state));
+    EXPECT_LT(bytes_per_move, 6.0);
+}
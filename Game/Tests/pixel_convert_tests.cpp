@@ -0,0 +1,134 @@
+#include "pixel_convert.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+auto random_bytes(std::size_t count, std::uint32_t seed) -> std::vector<std::uint8_t>
+{
+    auto engine = std::mt19937(seed);
+    auto bytes  = std::vector<std::uint8_t>(count);
+    for (auto& byte : bytes)
+    {
+        byte = std::uint8_t(engine());
+    }
+    return bytes;
+}
+
+} // namespace
+
+TEST(PixelConvertTest, PremultiplyRoundsToNearest)
+{
+    for (auto color = 0; color < 256; ++color)
+    {
+        for (auto alpha = 0; alpha < 256; ++alpha)
+        {
+            const auto expected = std::lround(color * alpha / 255.0);
+            ASSERT_EQ(premultiply_channel(std::uint8_t(color), std::uint8_t(alpha)), expected)
+                << color << " * " << alpha;
+        }
+    }
+}
+
+TEST(PixelConvertTest, ExpandsEveryChannelCount)
+{
+    const auto source = std::array<std::uint8_t, 4>{10, 20, 30, 40};
+    const auto cases  = std::array<std::array<std::uint8_t, 4>, 4>{{
+        {10, 10, 10, 255}, // Grey
+        {10, 10, 10, 20},  // Grey + alpha
+        {10, 20, 30, 255}, // RGB
+        {10, 20, 30, 40},  // RGBA
+    }};
+    for (auto channels = 1; channels <= 4; ++channels)
+    {
+        auto rgba = std::array<std::uint8_t, 4>{};
+        convert_pixels(source.data(), rgba.data(), 1, {.channels = channels}, pixel_kernel::scalar);
+        EXPECT_EQ(rgba, cases[std::size_t(channels - 1)]) << channels << " channels";
+    }
+
+    auto rgba = std::array<std::uint8_t, 4>{};
+    convert_pixels(source.data(),
+                   rgba.data(),
+                   1,
+                   {.channels = 4, .premultiply = true},
+                   pixel_kernel::scalar);
+    EXPECT_EQ(rgba, (std::array<std::uint8_t, 4>{2, 3, 5, 40}));
+}
+
+// Every kernel, channel count and alpha mode, over lengths that end in every possible tail and
+// from unaligned addresses
+TEST(PixelConvertTest, KernelsMatchScalarBitForBit)
+{
+    constexpr auto max_pixels = std::size_t(300);
+    const auto     source     = random_bytes(max_pixels * 4 + 1, 7);
+
+    for (const auto kernel : supported_pixel_kernels())
+    {
+        for (auto channels = 1; channels <= 4; ++channels)
+        {
+            for (const auto premultiply : {false, true})
+            {
+                const auto conversion = pixel_conversion{channels, premultiply};
+                for (auto count = std::size_t(0); count <= max_pixels; count += count < 40 ? 1 : 37)
+                {
+                    auto expected = std::vector<std::uint8_t>(count * 4 + 1);
+                    auto actual   = std::vector<std::uint8_t>(count * 4 + 1);
+                    convert_pixels(source.data() + 1,
+                                   expected.data() + 1,
+                                   count,
+                                   conversion,
+                                   pixel_kernel::scalar);
+                    convert_pixels(source.data() + 1, actual.data() + 1, count, conversion, kernel);
+                    ASSERT_EQ(actual, expected)
+                        << pixel_kernel_name(kernel) << ", " << channels << " channels, "
+                        << (premultiply ? "premultiplied" : "straight") << ", " << count;
+                }
+            }
+        }
+    }
+}
+
+TEST(PixelConvertTest, RectPacksRowsAndFlips)
+{
+    // 3x2 RGB frame at (1, 1) of a 5x4 image; every byte holds its row
+    constexpr auto image_width = 5, channels = 3, width = 3, height = 2;
+    auto           image = std::vector<std::uint8_t>(image_width * 4 * channels);
+    for (auto row = 0; row < 4; ++row)
+    {
+        std::fill_n(image.begin() + row * image_width * channels,
+                    image_width * channels,
+                    std::uint8_t(row));
+    }
+    const auto* frame  = image.data() + (image_width + 1) * channels;
+    const auto  stride = std::size_t(image_width * channels);
+
+    for (const auto flip : {false, true})
+    {
+        auto rgba = std::vector<std::uint8_t>(width * height * 4);
+        convert_rect(frame, stride, width, height, rgba.data(), {channels, false, flip});
+        for (auto row = 0; row < height; ++row)
+        {
+            const auto expected = std::uint8_t(flip ? 2 - row : 1 + row);
+            for (auto column = 0; column < width; ++column)
+            {
+                const auto* pixel = rgba.data() + (row * width + column) * 4;
+                EXPECT_EQ(pixel[0], expected) << row << ", " << column;
+                EXPECT_EQ(pixel[3], 255) << row << ", " << column;
+            }
+        }
+    }
+}
+
+TEST(PixelConvertTest, BestKernelIsSupported)
+{
+    const auto kernels = supported_pixel_kernels();
+    ASSERT_FALSE(kernels.empty());
+    EXPECT_EQ(kernels.front(), pixel_kernel::scalar);
+    EXPECT_EQ(kernels.back(), best_pixel_kernel());
+}
@@ -0,0 +1,171 @@
+#include "profiler.hpp"
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+namespace {
+
+auto count_named(const profile_capture& capture, const char* name) -> std::size_t
+{
+    return std::ranges::count_if(capture.events, [name](const profile_event& event) {
+        return std::strcmp(event.name, name) == 0;
+    });
+}
+
+} // namespace
+
+TEST(ProfilerTest, RecordsNothingOutsideCapture)
+{
+    {
+        PROFILE_SCOPE("outside");
+    }
+    begin_profiler_capture();
+    const auto capture = end_profiler_capture();
+    EXPECT_EQ(count_named(capture, "outside"), 0u);
+}
+
+TEST(ProfilerTest, NestedScopesAreContained)
+{
+    begin_profiler_capture();
+    {
+        PROFILE_SCOPE("outer");
+        {
+            PROFILE_SCOPE("inner");
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+    const auto capture = end_profiler_capture();
+
+    ASSERT_EQ(count_named(capture, "outer"), 1u);
+    ASSERT_EQ(count_named(capture, "inner"), 1u);
+    const auto find = [&](const char* name) {
+        return *std::ranges::find_if(capture.events, [name](const profile_event& event) {
+            return std::strcmp(event.name, name) == 0;
+        });
+    };
+    const auto outer = find("outer");
+    const auto inner = find("inner");
+    EXPECT_EQ(outer.track, profile_track::cpu);
+    EXPECT_GE(inner.duration_ns, 2'000'000u);
+    EXPECT_LE(outer.start_ns, inner.start_ns);
+    EXPECT_GE(outer.start_ns + outer.duration_ns, inner.start_ns + inner.duration_ns);
+}
+
+TEST(ProfilerTest, EachThreadGetsItsOwnRing)
+{
+    constexpr auto thread_count      = 4;
+    constexpr auto scopes_per_thread = 1000;
+
+    begin_profiler_capture();
+    {
+        auto threads = std::vector<std::jthread>();
+        for (auto i = 0; i < thread_count; ++i)
+        {
+            threads.emplace_back([] {
+                PROFILE_THREAD_NAME("worker");
+                for (auto j = 0; j < scopes_per_thread; ++j)
+                {
+                    PROFILE_SCOPE("work");
+                }
+            });
+        }
+    }
+    const auto capture = end_profiler_capture();
+
+    EXPECT_EQ(count_named(capture, "work"), std::size_t(thread_count * scopes_per_thread));
+    EXPECT_EQ(capture.dropped, 0u);
+
+    auto threads = std::vector<std::uint32_t>();
+    for (const auto& event : capture.events)
+    {
+        if (std::strcmp(event.name, "work") == 0)
+        {
+            threads.push_back(event.thread);
+            EXPECT_EQ(capture.thread_names[event.thread], "worker");
+        }
+    }
+    std::ranges::sort(threads);
+    EXPECT_EQ(std::ranges::unique(threads).begin() - threads.begin(), thread_count);
+}
+
+TEST(ProfilerTest, LongCaptureKeepsTheNewestEvents)
+{
+    constexpr auto scope_count = 100'000;
+
+    begin_profiler_capture();
+    for (auto i = 0; i < scope_count; ++i)
+    {
+        PROFILE_SCOPE("spin");
+    }
+    const auto capture = end_profiler_capture();
+
+    const auto kept = count_named(capture, "spin");
+    EXPECT_GT(kept, 0u);
+    EXPECT_LT(kept, std::size_t(scope_count));
+    EXPECT_EQ(kept + capture.dropped, std::size_t(scope_count));
+}
+
+TEST(ProfilerTest, WritesChromeTrace)
+{
+    begin_profiler_capture();
+    {
+        PROFILE_SCOPE("quoted \"name\"");
+    }
+    const auto capture = end_profiler_capture();
+
+    const auto path = std::filesystem::temp_directory_path() / "profiler_tests_trace.json";
+    ASSERT_TRUE(write_chrome_trace(path, capture).has_value());
+
+    auto       in    = std::ifstream(path);
+    const auto trace = nlohmann::json::parse(in);
+    std::filesystem::remove(path);
+
+    auto found = false;
+    for (const auto& event : trace["traceEvents"])
+    {
+        if (event["ph"] == "X" && event["name"] == "quoted \"name\"")
+        {
+            found = true;
+            EXPECT_EQ(event["cat"], "cpu");
+            EXPECT_EQ(event["pid"], 1);
+            EXPECT_GE(event["dur"].get<double>(), 0.0);
+        }
+    }
+    EXPECT_TRUE(found);
+}
+
+TEST(ProfilerTest, ToggleWritesNumberedTraces)
+{
+    const auto previous = std::filesystem::current_path();
+    const auto scratch  = std::filesystem::temp_directory_path() / "profiler_tests_toggle";
+    std::filesystem::remove_all(scratch);
+    std::filesystem::create_directories(scratch);
+    std::filesystem::current_path(scratch);
+
+    auto paths = std::vector<std::filesystem::path>();
+    for (auto i = 0; i < 2; ++i)
+    {
+        auto started = toggle_profiler_capture();
+        ASSERT_TRUE(started.has_value());
+        EXPECT_TRUE(started->empty());
+        EXPECT_TRUE(is_profiler_capturing());
+
+        auto written = toggle_profiler_capture();
+        ASSERT_TRUE(written.has_value()) << written.error();
+        EXPECT_FALSE(is_profiler_capturing());
+        paths.push_back(written.value());
+    }
+
+    std::filesystem::current_path(previous);
+    EXPECT_EQ(paths[0], "solitaire_trace_000.json");
+    EXPECT_EQ(paths[1], "solitaire_trace_001.json");
+    EXPECT_TRUE(std::filesystem::exists(scratch / paths[1]));
+    std::filesystem::remove_all(scratch);
+}
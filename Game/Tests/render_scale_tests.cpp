@@ -0,0 +1,165 @@
+#include "render_scale.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+namespace {
+
+constexpr auto framebuffer_sizes = std::array<std::pair<std::int32_t, std::int32_t>, 6>{{
+    {640, 360},
+    {1400, 1000},
+    {1000, 1400},
+    {1920, 1080},
+    {2560, 1440},
+    {3840, 2160},
+}};
+
+// Frames at the controller's scale under a GPU cost proportional to the pixels drawn; returns
+// how often the scale changed
+auto run_frames(dynamic_resolution& dynamic, double full_scale_ms, std::int32_t frames)
+    -> std::int32_t
+{
+    auto changes = 0;
+    for (auto frame = 0; frame < frames; ++frame)
+    {
+        const auto scale = double(dynamic.scale());
+        changes += dynamic.update(full_scale_ms * scale * scale) ? 1 : 0;
+    }
+    return changes;
+}
+
+} // namespace
+
+TEST(RenderScaleTest, FitsTheTableIntoAnyFramebuffer)
+{
+    const auto metrics = table_metrics{};
+    for (const auto& [width, height] : framebuffer_sizes)
+    {
+        const auto viewport = fit_table_viewport(metrics, width, height);
+        EXPECT_EQ(viewport.render_width, width);
+        EXPECT_EQ(viewport.render_height, height);
+        EXPECT_FALSE(viewport.scaled());
+
+        // The whole table shows, touching the framebuffer's edges one way and centred the other
+        const auto& area = viewport.area;
+        EXPECT_LE(area.left, 1e-3f) << width << "x" << height;
+        EXPECT_LE(area.bottom, 1e-3f) << width << "x" << height;
+        EXPECT_GE(area.right, metrics.width - 1e-3f) << width << "x" << height;
+        EXPECT_GE(area.top, metrics.height - 1e-3f) << width << "x" << height;
+        EXPECT_NEAR(area.left + area.right, metrics.width, 1e-2f);
+        EXPECT_NEAR(area.bottom + area.top, metrics.height, 1e-2f);
+        EXPECT_TRUE(std::abs(area.left) < 1e-3f || std::abs(area.bottom) < 1e-3f);
+
+        // Uniform: a table pixel is as wide as it is tall
+        EXPECT_NEAR((area.right - area.left) * viewport.scale, float(width), 1e-2f);
+        EXPECT_NEAR((area.top - area.bottom) * viewport.scale, float(height), 1e-2f);
+    }
+}
+
+TEST(RenderScaleTest, RenderSizeFollowsTheScale)
+{
+    auto viewport = fit_table_viewport(table_metrics{}, 1920, 1080, 0.5f);
+    EXPECT_EQ(viewport.render_width, 960);
+    EXPECT_EQ(viewport.render_height, 540);
+    EXPECT_TRUE(viewport.scaled());
+
+    // Clamped to the supported range, and never empty
+    viewport = fit_table_viewport(table_metrics{}, 1920, 1080, 0.01f);
+    EXPECT_EQ(viewport.render_width, 480);
+    viewport = fit_table_viewport(table_metrics{}, 1920, 1080, 2.0f);
+    EXPECT_EQ(viewport.render_width, 1920);
+    viewport = fit_table_viewport(table_metrics{}, 0, 0);
+    EXPECT_EQ(viewport.framebuffer_width, 1);
+    EXPECT_EQ(viewport.render_height, 1);
+}
+
+TEST(RenderScaleTest, FramebufferToTableInvertsTheProjection)
+{
+    for (const auto& [width, height] : framebuffer_sizes)
+    {
+        const auto viewport = fit_table_viewport(table_metrics{}, width, height);
+        const auto& area    = viewport.area;
+
+        const auto origin = framebuffer_to_table(viewport, 0.0f, 0.0f);
+        EXPECT_NEAR(origin.x, area.left, 1e-3f);
+        EXPECT_NEAR(origin.y, area.bottom, 1e-3f);
+        const auto corner = framebuffer_to_table(viewport, float(width), float(height));
+        EXPECT_NEAR(corner.x, area.right, 1e-2f);
+        EXPECT_NEAR(corner.y, area.top, 1e-2f);
+
+        // Mapping the table's centre back through the projection lands in the middle
+        const auto centre = framebuffer_to_table(viewport, width * 0.5f, height * 0.5f);
+        EXPECT_NEAR(centre.x, table_metrics{}.width * 0.5f, 1e-2f);
+        EXPECT_NEAR(centre.y, table_metrics{}.height * 0.5f, 1e-2f);
+    }
+}
+
+TEST(RenderScaleTest, TextureLodFollowsTheCardsOnScreenSize)
+{
+    // Cards shown at the layers' own size sample every level
+    const auto texel_width = card_width_px;
+    const auto full_size   = fit_table_viewport(table_metrics{}, 1400, 1000);
+    auto       lod         = choose_card_texture_lod(full_size, texel_width);
+    EXPECT_FLOAT_EQ(lod.min_lod, 0.0f);
+    EXPECT_FLOAT_EQ(lod.bias, 0.0f);
+
+    // A quarter of the size on screen skips the two finest levels
+    lod = choose_card_texture_lod(fit_table_viewport(table_metrics{}, 350, 250), texel_width);
+    EXPECT_FLOAT_EQ(lod.min_lod, 2.0f);
+
+    // Between levels the finer one stays available
+    lod = choose_card_texture_lod(fit_table_viewport(table_metrics{}, 1000, 1000), texel_width);
+    EXPECT_FLOAT_EQ(lod.min_lod, 0.0f);
+
+    // Larger than the layers: nothing below level 0
+    lod = choose_card_texture_lod(fit_table_viewport(table_metrics{}, 3840, 2160), texel_width);
+    EXPECT_FLOAT_EQ(lod.min_lod, 0.0f);
+
+    // Half the render size is one level finer than the render size alone would sample
+    lod = choose_card_texture_lod(fit_table_viewport(table_metrics{}, 1400, 1000, 0.5f),
+                                  texel_width);
+    EXPECT_FLOAT_EQ(lod.min_lod, 0.0f);
+    EXPECT_FLOAT_EQ(lod.bias, -1.0f);
+}
+
+TEST(RenderScaleTest, DynamicResolutionSettlesUnderLoad)
+{
+    auto dynamic = dynamic_resolution();
+    EXPECT_FLOAT_EQ(dynamic.scale(), max_render_scale);
+
+    // Twice the budget at full scale: the pixel count has to halve, a scale of about 0.7
+    const auto full_scale_ms = 2.0 * 1000.0 / 60.0;
+    run_frames(dynamic, full_scale_ms, 600);
+    const auto settled = dynamic.scale();
+    EXPECT_LT(settled, 0.75f);
+    EXPECT_GE(settled, 0.5f);
+    EXPECT_LT(dynamic.smoothed_ms(), 1000.0 / 60.0);
+
+    // Settled: it stays there instead of stepping up and back down
+    EXPECT_EQ(run_frames(dynamic, full_scale_ms, 2000), 0);
+    EXPECT_FLOAT_EQ(dynamic.scale(), settled);
+}
+
+TEST(RenderScaleTest, DynamicResolutionClimbsBackWhenTheLoadDrops)
+{
+    auto dynamic = dynamic_resolution();
+    run_frames(dynamic, 4.0 * 1000.0 / 60.0, 600);
+    EXPECT_FLOAT_EQ(dynamic.scale(), 0.5f); // The floor, even though it is still over budget
+
+    // A step at a time, and each only after the frames at the previous one settled
+    const auto changes = run_frames(dynamic, 5.0, 1000);
+    EXPECT_FLOAT_EQ(dynamic.scale(), max_render_scale);
+    EXPECT_EQ(changes, 4);
+}
+
+TEST(RenderScaleTest, DynamicResolutionIgnoresMissingTimings)
+{
+    auto dynamic = dynamic_resolution({.settle_frames = 1});
+    EXPECT_FALSE(dynamic.update(0.0));
+    EXPECT_FALSE(dynamic.update(-1.0));
+    EXPECT_FLOAT_EQ(dynamic.scale(), max_render_scale);
+}
@@ -0,0 +1,197 @@
+#include "replay.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct recorded_session
+{
+    std::vector<klondike_state> positions; // After each step, the deal first
+    std::vector<replay_event>   events;
+};
+
+// Plays random moves with undos, redos and pointer input in between, recording both to `path`
+// and to the returned session
+auto record_session(const std::filesystem::path& path, std::uint64_t seed, std::int32_t length)
+    -> recorded_session
+{
+    auto writer = replay_writer::create(path, seed, 3, 1'700'000'000'000ull, 8);
+    EXPECT_TRUE(writer.has_value());
+
+    auto history = move_history(deal_klondike(shuffle_deck(seed), 3));
+    auto session = recorded_session{{history.state()}, {}};
+    auto random  = std::mt19937(std::uint32_t(seed));
+    auto moves   = move_list{};
+    auto time    = std::uint32_t(0);
+    for (auto action = 0; action < length; ++action)
+    {
+        time += random() % 500;
+        const auto roll = random() % 10;
+        generate_moves(history.state(), moves);
+        if (roll < 5 && moves.size > 0)
+        {
+            history.apply(moves[random() % moves.size]);
+            writer->record_move(time, history.move_at(history.position() - 1));
+        }
+        else if (roll < 7 && history.undo())
+        {
+            writer->record_undo(time, history.move_at(history.position()));
+        }
+        else if (roll < 8 && history.redo())
+        {
+            writer->record_redo(time, history.move_at(history.position() - 1));
+        }
+        else
+        {
+            writer->record_pointer(time, replay_event_kind::pointer_move, 100.5f + roll, 200.0f);
+            session.events.push_back(
+                {time, replay_event_kind::pointer_move, 0, 0, {}, std::int16_t(101 + roll), 200});
+            continue;
+        }
+        session.positions.push_back(history.state());
+        EXPECT_EQ(writer->state(), history.state());
+    }
+    EXPECT_TRUE(writer->finish().has_value());
+    return session;
+}
+
+auto corrupt(const std::filesystem::path& path, std::size_t offset) -> void
+{
+    auto file = std::fstream(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekg(std::streamoff(offset));
+    const auto byte = char(file.get() ^ 0x5A);
+    file.seekp(std::streamoff(offset));
+    file.put(byte);
+}
+
+} // namespace
+
+class ReplayTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const auto* test = ::testing::UnitTest::GetInstance()->current_test_info();
+        path_            = std::filesystem::temp_directory_path() /
+                ("replay_test_" + std::string(test->name()) + ".replay");
+    }
+
+    void TearDown() override { std::filesystem::remove(path_); }
+
+    std::filesystem::path path_;
+};
+
+TEST_F(ReplayTest, SeeksToEveryStep)
+{
+    const auto session = record_session(path_, 11, 3000);
+
+    auto replay = replay_reader::open(path_);
+    ASSERT_TRUE(replay.has_value()) << replay.error();
+    EXPECT_EQ(replay->header().seed, 11u);
+    EXPECT_EQ(replay->header().draw_count, 3);
+    EXPECT_EQ(replay->header().start_time, 1'700'000'000'000ull);
+    ASSERT_EQ(replay->step_count() + 1, session.positions.size());
+    EXPECT_GT(replay->index().size(), replay->step_count() / 8);
+    EXPECT_EQ(replay->deal(), session.positions.front());
+
+    // Backwards, so every seek restores a keyframe rather than running on from the last one
+    for (auto step = replay->step_count() + 1; step-- > 0;)
+    {
+        ASSERT_EQ(replay->state_at(step), session.positions[step]) << "step " << step;
+    }
+
+    const auto pointer = std::find_if(replay->events().begin(),
+                                      replay->events().end(),
+                                      [](const auto& e) { return !is_replay_step(e.kind); });
+    ASSERT_NE(pointer, replay->events().end());
+    EXPECT_EQ(pointer->time, session.events.front().time);
+    EXPECT_EQ(pointer->x, session.events.front().x);
+    EXPECT_EQ(pointer->y, session.events.front().y);
+}
+
+TEST_F(ReplayTest, VerifiesRecordedSessions)
+{
+    for (auto seed = std::uint64_t(1); seed <= 20; ++seed)
+    {
+        const auto session = record_session(path_, seed, 400);
+        auto       replay  = replay_reader::open(path_);
+        ASSERT_TRUE(replay.has_value()) << replay.error();
+
+        const auto summary = verify_replay(replay.value());
+        ASSERT_TRUE(summary.has_value()) << "seed " << seed << ": " << summary.error();
+        EXPECT_EQ(summary->steps + 1, session.positions.size());
+        EXPECT_EQ(summary->final_hash, session.positions.back().hash);
+    }
+}
+
+TEST_F(ReplayTest, EmptySession)
+{
+    auto writer = replay_writer::create(path_, 5, 1, 0);
+    ASSERT_TRUE(writer.has_value());
+    ASSERT_TRUE(writer->finish().has_value());
+
+    auto replay = replay_reader::open(path_);
+    ASSERT_TRUE(replay.has_value()) << replay.error();
+    EXPECT_EQ(replay->step_count(), 0u);
+    EXPECT_EQ(replay->state_at(10), replay->deal());
+    EXPECT_TRUE(verify_replay(replay.value()).has_value());
+}
+
+TEST_F(ReplayTest, RejectsDamagedFiles)
+{
+    record_session(path_, 3, 500);
+    const auto size = std::filesystem::file_size(path_);
+
+    // Any flipped byte before the footer fails the checksum
+    for (const auto offset : {std::size_t(30), std::size_t(size / 2), std::size_t(size - 60)})
+    {
+        record_session(path_, 3, 500);
+        corrupt(path_, offset);
+        const auto replay = replay_reader::open(path_);
+        ASSERT_FALSE(replay.has_value()) << "offset " << offset;
+        EXPECT_NE(replay.error().find("checksum"), std::string::npos) << replay.error();
+    }
+
+    // A session that was never finished has no footer
+    record_session(path_, 3, 500);
+    std::filesystem::resize_file(path_, size - 8);
+    EXPECT_FALSE(replay_reader::open(path_).has_value());
+
+    // Neither does a file that is not a replay at all
+    std::ofstream(path_, std::ios::trunc) << "definitely not a replay, but long enough to check";
+    EXPECT_FALSE(replay_reader::open(path_).has_value());
+    EXPECT_FALSE(replay_reader::open(path_.string() + ".missing").has_value());
+}
+
+TEST_F(ReplayTest, VerifyCatchesIllegalMoves)
+{
+    record_session(path_, 4, 200);
+
+    // Rewrite the first move to somewhere it cannot go and fix the checksum up, so only the
+    // re-simulation can notice
+    auto bytes = std::vector<char>(std::filesystem::file_size(path_));
+    std::ifstream(path_, std::ios::binary).read(bytes.data(), std::streamsize(bytes.size()));
+    const auto body_size = bytes.size() - sizeof(replay_footer);
+    auto*      footer    = reinterpret_cast<replay_footer*>(bytes.data() + body_size);
+    auto*      events    = reinterpret_cast<replay_event*>(bytes.data() + sizeof(replay_header));
+    auto*      first     = std::find_if(events, events + footer->event_count, [](const auto& e) {
+        return e.kind == replay_event_kind::move;
+    });
+    ASSERT_NE(first, events + footer->event_count);
+    first->move.to   = pile_stock;
+    footer->checksum = replay_checksum(std::as_bytes(std::span(bytes.data(), body_size)));
+    std::ofstream(path_, std::ios::binary | std::ios::trunc)
+        .write(bytes.data(), std::streamsize(bytes.size()));
+
+    auto replay = replay_reader::open(path_);
+    ASSERT_TRUE(replay.has_value()) << replay.error();
+    const auto summary = verify_replay(replay.value());
+    ASSERT_FALSE(summary.has_value());
+    EXPECT_NE(summary.error().find("illegal move"), std::string::npos) << summary.error();
+}
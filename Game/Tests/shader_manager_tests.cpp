@@ -0,0 +1,252 @@
+#include "gl_test_helpers.hpp"
+#include "headless.hpp"
+#include "shader_manager.hpp"
+
+// clang-format off
+#include <glad/gl.h>
+// clang-format on
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace {
+
+// A copy of the card shaders in a scratch directory, so tests can edit them and leave a cache
+class shader_directory
+{
+public:
+    explicit shader_directory(std::string_view name)
+        : directory_(std::filesystem::temp_directory_path() / name)
+    {
+        std::filesystem::remove_all(directory_);
+        std::filesystem::create_directories(directory_);
+        const auto sources = card_shader_paths();
+        std::filesystem::copy_file(sources.vertex, paths().vertex);
+        std::filesystem::copy_file(sources.fragment, paths().fragment);
+    }
+    ~shader_directory() { std::filesystem::remove_all(directory_); }
+
+    auto paths() const -> shader_paths
+    {
+        return {directory_ / "card.vert", directory_ / "card.frag"};
+    }
+    auto cache() const -> std::filesystem::path { return directory_ / "card.program"; }
+
+    void append_to_fragment(std::string_view text) const
+    {
+        auto out = std::ofstream(paths().fragment, std::ios::app);
+        out << text;
+    }
+
+private:
+    std::filesystem::path directory_;
+};
+
+auto binary_formats() -> GLint
+{
+    auto format_count = GLint(0);
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    return format_count;
+}
+
+// Polls `done` until it returns true or a few seconds have passed
+template <typename Predicate>
+auto wait_for(Predicate done) -> bool
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!done())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+constexpr auto broken_fragment = "#version 450 core\nvoid main() { gl_FragColor = oops; }\n";
+
+} // namespace
+
+TEST(ShaderManagerTest, CacheKeyCoversSourcesAndDriver)
+{
+    const auto sources = shader_sources{"vertex", "fragment"};
+    const auto key     = program_cache_key(sources, "Mesa\nllvmpipe\n4.5\n");
+    EXPECT_EQ(key, program_cache_key(sources, "Mesa\nllvmpipe\n4.5\n"));
+    EXPECT_NE(key, program_cache_key({"vertex ", "fragment"}, "Mesa\nllvmpipe\n4.5\n"));
+    EXPECT_NE(key, program_cache_key(sources, "Mesa\nllvmpipe\n4.6\n"));
+    EXPECT_NE(key, program_cache_key({"vertexf", "ragment"}, "Mesa\nllvmpipe\n4.5\n"));
+}
+
+TEST(ShaderManagerTest, WatcherSeesEdits)
+{
+    auto directory = shader_directory("solitaire_shader_watch");
+    auto wakes     = std::atomic<int>(0);
+    auto watcher   = shader_watcher({directory.paths().vertex, directory.paths().fragment},
+                                  [&wakes] { ++wakes; },
+                                  std::chrono::milliseconds(5));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(watcher.take_changed());
+
+    directory.append_to_fragment("// edited\n");
+    EXPECT_TRUE(wait_for([&] { return wakes > 0; }));
+    EXPECT_TRUE(watcher.take_changed());
+    EXPECT_FALSE(watcher.take_changed()); // Reported once
+}
+
+TEST(ShaderManagerTest, CompileAndLinkErrorsCarryTheLog)
+{
+    with_context(64, 64, [] {
+        const auto fragment = compile_shader(broken_fragment, GL_FRAGMENT_SHADER, "broken.frag");
+        ASSERT_FALSE(fragment.has_value());
+        EXPECT_TRUE(fragment.error().starts_with("broken.frag: "));
+        EXPECT_GT(fragment.error().size(), std::string_view("broken.frag: ").size());
+
+        // Both compile on their own, but nothing defines the vertex stage's main
+        const auto vertex = compile_shader(
+            "#version 450 core\nvoid helper() {}\n", GL_VERTEX_SHADER, "no_main.vert");
+        const auto sources  = read_shader_sources(card_shader_paths());
+        const auto fragment_ok =
+            compile_shader(sources->fragment, GL_FRAGMENT_SHADER, "card.frag");
+        ASSERT_TRUE(vertex.has_value()) << vertex.error();
+        ASSERT_TRUE(fragment_ok.has_value()) << fragment_ok.error();
+        const auto program = link_shader_program(vertex.value(), fragment_ok.value());
+        EXPECT_FALSE(program.has_value());
+        EXPECT_FALSE(program.error().empty());
+        glDeleteShader(vertex.value());
+        glDeleteShader(fragment_ok.value());
+    });
+}
+
+// Startup with and without the cache, and every way the cache can fail to apply
+TEST(ShaderManagerTest, BinaryCacheRoundTrip)
+{
+    with_context(64, 64, [] {
+        if (binary_formats() == 0)
+        {
+            GTEST_SKIP() << "The driver offers no program binary formats";
+        }
+        const auto directory = shader_directory("solitaire_shader_cache");
+
+        auto cold = build_program(directory.paths(), directory.cache());
+        ASSERT_TRUE(cold.has_value()) << cold.error();
+        EXPECT_FALSE(cold->stats.from_cache);
+        ASSERT_TRUE(std::filesystem::exists(directory.cache()));
+
+        auto warm = build_program(directory.paths(), directory.cache());
+        ASSERT_TRUE(warm.has_value()) << warm.error();
+        EXPECT_TRUE(warm->stats.from_cache);
+        EXPECT_EQ(glGetUniformLocation(cold->program, "uSize"),
+                  glGetUniformLocation(warm->program, "uSize"));
+        std::printf("Card shader program: %.3f ms compiled, %.3f ms from the binary cache\n",
+                    cold->stats.milliseconds,
+                    warm->stats.milliseconds);
+
+        auto uncached =
+            build_program(directory.paths(), directory.cache(), shader_caching::disabled);
+        ASSERT_TRUE(uncached.has_value()) << uncached.error();
+        EXPECT_FALSE(uncached->stats.from_cache);
+
+        // An edited source no longer matches the key
+        directory.append_to_fragment("// edited\n");
+        auto edited = build_program(directory.paths(), directory.cache());
+        ASSERT_TRUE(edited.has_value()) << edited.error();
+        EXPECT_FALSE(edited->stats.from_cache);
+
+        // A truncated file is rejected, then rewritten by the compile that replaces it
+        std::filesystem::resize_file(directory.cache(),
+                                     std::filesystem::file_size(directory.cache()) / 2);
+        auto truncated = build_program(directory.paths(), directory.cache());
+        ASSERT_TRUE(truncated.has_value()) << truncated.error();
+        EXPECT_FALSE(truncated->stats.from_cache);
+        auto repaired = build_program(directory.paths(), directory.cache());
+        ASSERT_TRUE(repaired.has_value()) << repaired.error();
+        EXPECT_TRUE(repaired->stats.from_cache);
+
+        // A binary the driver refuses falls back to compiling too
+        {
+            auto file = std::fstream(directory.cache(),
+                                     std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(sizeof(program_cache_header));
+            file << "not a program binary";
+        }
+        auto rejected = build_program(directory.paths(), directory.cache());
+        ASSERT_TRUE(rejected.has_value()) << rejected.error();
+        EXPECT_FALSE(rejected->stats.from_cache);
+
+        for (const auto* built : {&cold.value(),
+                                  &warm.value(),
+                                  &uncached.value(),
+                                  &edited.value(),
+                                  &truncated.value(),
+                                  &repaired.value(),
+                                  &rejected.value()})
+        {
+            glDeleteProgram(built->program);
+        }
+    });
+}
+
+TEST(ShaderManagerTest, PendingProgramFinishesOrReportsBothStages)
+{
+    with_context(64, 64, [] {
+        const auto sources = read_shader_sources(card_shader_paths());
+        ASSERT_TRUE(sources.has_value()) << sources.error();
+
+        auto pending = pending_program(sources.value());
+        EXPECT_TRUE(wait_for([&] { return pending.ready(); }));
+        const auto program = pending.finish();
+        ASSERT_TRUE(program.has_value()) << program.error();
+        auto linked = GLint();
+        glGetProgramiv(program.value(), GL_LINK_STATUS, &linked);
+        EXPECT_EQ(linked, GL_TRUE);
+        glDeleteProgram(program.value());
+
+        auto broken = pending_program({sources->vertex, broken_fragment});
+        EXPECT_TRUE(wait_for([&] { return broken.ready(); }));
+        const auto failed = broken.finish();
+        ASSERT_FALSE(failed.has_value());
+        EXPECT_TRUE(failed.error().starts_with("fragment shader: "));
+    });
+}
+
+// Edits are rebuilt in the background; a broken edit is reported and leaves nothing to swap
+TEST(ShaderManagerTest, ReloaderRebuildsEditedShaders)
+{
+    with_context(64, 64, [] {
+        const auto directory = shader_directory("solitaire_shader_reload");
+        auto       reloader  = shader_reloader(directory.paths(), [] {});
+        EXPECT_FALSE(reloader.poll().has_value());
+        EXPECT_FALSE(reloader.compiling());
+
+        const auto next_result = [&] {
+            auto result = std::optional<std::expected<GLuint, error_message_t>>();
+            wait_for([&] { return (result = reloader.poll()).has_value(); });
+            return result;
+        };
+
+        directory.append_to_fragment("// edited\n");
+        const auto rebuilt = next_result();
+        ASSERT_TRUE(rebuilt.has_value());
+        ASSERT_TRUE(rebuilt->has_value()) << rebuilt->error();
+        EXPECT_NE(rebuilt->value(), 0u);
+        glDeleteProgram(rebuilt->value());
+
+        {
+            auto out = std::ofstream(directory.paths().fragment, std::ios::trunc);
+            out << broken_fragment;
+        }
+        const auto failed = next_result();
+        ASSERT_TRUE(failed.has_value());
+        EXPECT_FALSE(failed->has_value());
+        EXPECT_FALSE(reloader.compiling());
+    });
+}
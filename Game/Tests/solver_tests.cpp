@@ -0,0 +1,134 @@
+#include "solver.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+auto replays_to_win(klondike_state state, const std::vector<klondike_move>& moves) -> bool
+{
+    for (auto move : moves)
+    {
+        // Flags are filled in by apply_move, so only the move itself is compared
+        move.flags = 0;
+        auto legal = move_list{};
+        generate_moves(state, legal);
+        if (std::find(legal.begin(), legal.end(), move) == legal.end())
+        {
+            return false;
+        }
+        apply_move(state, move);
+    }
+    return is_won(state);
+}
+
+} // namespace
+
+TEST(SolverTest, TranspositionTableDeduplicatesAcrossThreads)
+{
+    auto table = transposition_table(1 << 20);
+    EXPECT_TRUE(table.insert(42));
+    EXPECT_FALSE(table.insert(42));
+    EXPECT_TRUE(table.insert(0)); // Tagged, so not confused with an empty slot
+    EXPECT_FALSE(table.insert(0));
+    table.clear();
+    EXPECT_EQ(table.size(), 0u);
+    EXPECT_TRUE(table.insert(42));
+
+    // Every clear forgets, including the one that wraps the generation tag around
+    for (auto round = 0; round < 300; ++round)
+    {
+        table.clear();
+        ASSERT_TRUE(table.insert(42)) << "round " << round;
+        ASSERT_FALSE(table.insert(42)) << "round " << round;
+    }
+    table.clear();
+
+    // Every thread inserts the same keys; each key must be reported new exactly once
+    constexpr auto key_count  = 20000;
+    auto           first_seen = std::atomic<std::int32_t>(0);
+    {
+        auto threads = std::vector<std::jthread>();
+        for (auto thread = 0; thread < 4; ++thread)
+        {
+            threads.emplace_back([&] {
+                for (auto key = 1; key <= key_count; ++key)
+                {
+                    if (table.insert(std::uint64_t(key) * 0x9E3779B97F4A7C15ull))
+                    {
+                        ++first_seen;
+                    }
+                }
+            });
+        }
+    }
+    EXPECT_EQ(first_seen.load(), key_count);
+    EXPECT_EQ(table.size(), std::size_t(key_count));
+    EXPECT_EQ(table.overflows(), 0u);
+}
+
+TEST(SolverTest, FinishesNearlyWonPosition)
+{
+    // Every foundation at queen, kings on the first four piles
+    auto state        = klondike_state{};
+    state.foundations = 0xCCCC;
+    for (auto suit = 0; suit < suit_count; ++suit)
+    {
+        state.tableau[suit][0]   = make_card(suit, rank_count - 1);
+        state.tableau_size[suit] = 1;
+    }
+    state.hash = compute_hash(state);
+
+    const auto result = solve_klondike(state, solver_options{.thread_count = 2});
+    ASSERT_EQ(result.status, solve_status::solved);
+    EXPECT_EQ(result.moves.size(), 4u);
+    EXPECT_TRUE(replays_to_win(state, result.moves));
+}
+
+TEST(SolverTest, ReportsDeadPositionUnsolvable)
+{
+    // The two of clubs sits on its own ace with nowhere to go
+    auto state            = klondike_state{};
+    state.foundations     = 0xDDD0;
+    state.tableau[0][0]   = make_card(0, 0);
+    state.tableau[0][1]   = make_card(0, 1);
+    state.tableau_size[0] = 2;
+    state.face_down[0]    = 1;
+    state.hash            = compute_hash(state);
+
+    const auto result = solve_klondike(state, solver_options{.thread_count = 4});
+    EXPECT_EQ(result.status, solve_status::unsolvable);
+}
+
+TEST(SolverTest, SolutionsReplayOnRealDeals)
+{
+    auto solved = 0;
+    for (auto seed = 1u; seed <= 8; ++seed)
+    {
+        const auto deal    = deal_klondike(shuffle_deck(seed));
+        const auto options = solver_options{
+            .thread_count = 4, .memory_budget = 16 << 20, .node_limit = 2'000'000};
+        const auto result  = solve_klondike(deal, options);
+        if (result.status == solve_status::solved)
+        {
+            ++solved;
+            EXPECT_TRUE(replays_to_win(deal, result.moves)) << "seed " << seed;
+        }
+    }
+    // Most draw-one deals are winnable
+    EXPECT_GT(solved, 0);
+}
+
+TEST(SolverTest, CancelledSearchIsUnknown)
+{
+    auto stop_source = std::stop_source();
+    stop_source.request_stop();
+
+    const auto result =
+        solve_klondike(deal_klondike(shuffle_deck(3)), solver_options{}, stop_source.get_token());
+    EXPECT_EQ(result.status, solve_status::unknown);
+}
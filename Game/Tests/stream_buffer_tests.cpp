@@ -0,0 +1,173 @@
+#include "cards.hpp"
+#include "gl_test_helpers.hpp"
+#include "headless.hpp"
+#include "stream_buffer.hpp"
+
+// clang-format off
+#include <glad/gl.h>
+// clang-format on
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+// What the GPU sees at an allocation, read back through GL rather than the mapping
+auto read_back(const stream_allocation<card_instance>& allocation) -> std::vector<card_instance>
+{
+    auto instances = std::vector<card_instance>(allocation.data.size());
+    glBindBuffer(GL_COPY_READ_BUFFER, allocation.buffer);
+    glGetBufferSubData(GL_COPY_READ_BUFFER,
+                       allocation.offset,
+                       GLsizeiptr(instances.size() * sizeof(card_instance)),
+                       instances.data());
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    return instances;
+}
+
+} // namespace
+
+// Writes through the mapping are visible to GL without any flush, at element-aligned offsets
+TEST(StreamBufferTest, AllocationsAreCoherentAndElementAligned)
+{
+    with_context(64, 64, [] {
+        auto stream = stream_buffer::create(1024, 3);
+        ASSERT_TRUE(stream.has_value()) << stream.error();
+
+        auto previous_end = GLintptr(0);
+        for (auto batch = 0; batch < 4; ++batch)
+        {
+            const auto allocation = stream->allocate<card_instance>(5 + batch);
+            ASSERT_EQ(allocation.data.size(), std::size_t(5 + batch));
+            EXPECT_EQ(allocation.offset % GLintptr(sizeof(card_instance)), 0);
+            EXPECT_EQ(GLintptr(allocation.first() * sizeof(card_instance)), allocation.offset);
+            EXPECT_GE(allocation.offset, previous_end);
+            previous_end = allocation.offset + GLintptr(allocation.data.size_bytes());
+
+            for (auto i = std::size_t(0); i < allocation.data.size(); ++i)
+            {
+                allocation.data[i] = {float(batch), float(i), std::int32_t(batch * 100 + i)};
+            }
+            const auto seen = read_back(allocation);
+            for (auto i = std::size_t(0); i < seen.size(); ++i)
+            {
+                EXPECT_EQ(seen[i].layer, std::int32_t(batch * 100 + i));
+            }
+        }
+        EXPECT_EQ(stream->stats().wraps, 0u);
+        EXPECT_EQ(stream->stats().grows, 0u);
+    });
+}
+
+TEST(StreamBufferTest, FramesRotateThroughRegionsAndGrowForLargeBatches)
+{
+    with_context(64, 64, [] {
+        constexpr auto region_bytes = 100 * sizeof(card_instance);
+        auto           stream       = stream_buffer::create(region_bytes, 3);
+        ASSERT_TRUE(stream.has_value()) << stream.error();
+
+        // One region per frame, round robin
+        auto regions = std::vector<std::size_t>();
+        for (auto frame = 0; frame < 6; ++frame)
+        {
+            stream->begin_frame();
+            regions.push_back(std::size_t(stream->allocate<card_instance>(10).offset) /
+                              region_bytes);
+            stream->end_frame();
+        }
+        EXPECT_EQ(regions, (std::vector<std::size_t>{1, 2, 0, 1, 2, 0}));
+
+        // A region that fills up mid-frame moves on to the next one
+        stream->begin_frame();
+        const auto first  = stream->allocate<card_instance>(60);
+        const auto second = stream->allocate<card_instance>(60);
+        EXPECT_EQ(std::size_t(first.offset) / region_bytes, 1u);
+        EXPECT_EQ(std::size_t(second.offset) / region_bytes, 2u);
+        EXPECT_EQ(stream->stats().wraps, 1u);
+
+        // A batch larger than a region reallocates; the earlier allocation stays readable
+        first.data[0]     = {1.0f, 2.0f, 42};
+        const auto large  = stream->allocate<card_instance>(1000);
+        const auto before = read_back(first);
+        ASSERT_EQ(large.data.size(), 1000u);
+        EXPECT_NE(large.buffer, first.buffer);
+        EXPECT_EQ(stream->buffer(), large.buffer);
+        EXPECT_EQ(stream->stats().grows, 1u);
+        EXPECT_GE(stream->stats().region_bytes, 1000 * sizeof(card_instance));
+        EXPECT_EQ(before[0].layer, 42);
+        stream->end_frame();
+
+        for (auto frame = 0; frame < 4; ++frame)
+        {
+            stream->begin_frame();
+            EXPECT_EQ(stream->allocate<card_instance>(1000).data.size(), 1000u);
+            stream->end_frame();
+        }
+        EXPECT_EQ(stream->stats().grows, 1u);
+    });
+}
+
+// Frames drawn from every region, and after the storage grew, match the first one. With a
+// single region each frame waits for the last, which shows up as fence wait time.
+TEST(StreamBufferTest, CardsDrawnFromEveryRegionMatch)
+{
+    constexpr auto width  = 640;
+    constexpr auto height = 480;
+    with_context(width, height, [] {
+        auto renderer_result = create_card_renderer(texture_loading::blocking);
+        ASSERT_TRUE(renderer_result.has_value()) << renderer_result.error();
+        auto cr = renderer_result.value();
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        glUniform1i(cr->uCardTextures, 0);
+        set_card_projection(cr, width, height);
+
+        auto cards = std::vector<card>();
+        for (auto i = 0; i < 52; ++i)
+        {
+            cards.push_back({40.0f + 10.0f * i, 60.0f + 6.0f * i, i, i % 3 != 0});
+        }
+        const auto draw_frame = [&] {
+            cr->stream->begin_frame();
+            glClear(GL_COLOR_BUFFER_BIT);
+            draw_cards(cr, cards);
+            cr->stream->end_frame();
+            return read_pixels(width, height);
+        };
+
+        const auto reference = draw_frame();
+        for (auto frame = 0; frame < 5; ++frame)
+        {
+            EXPECT_TRUE(draw_frame() == reference) << "frame " << frame;
+        }
+
+        // A batch too large for a region, then the same frame from the new storage. Culled, the
+        // stacked copies would shrink to the top one before reaching the stream.
+        auto many             = std::vector<card>(20'000, cards.front());
+        cr->cull_hidden_cards = false;
+        draw_cards(cr, many);
+        cr->cull_hidden_cards = true;
+        EXPECT_EQ(cr->stream->stats().grows, 1u);
+        EXPECT_TRUE(draw_frame() == reference);
+
+        // One region: every frame waits for the GPU to finish the one before
+        auto single = stream_buffer::create(stream_buffer::default_region_bytes, 1);
+        ASSERT_TRUE(single.has_value()) << single.error();
+        *cr->stream = std::move(single.value());
+        for (auto frame = 0; frame < 20; ++frame)
+        {
+            cr->stream->begin_frame();
+            draw_cards(cr, many);
+            cr->stream->end_frame();
+        }
+        const auto& stats = cr->stream->stats();
+        EXPECT_LE(stats.stalls, stats.frames);
+        EXPECT_GE(stats.wait_ms, stats.max_wait_ms);
+        std::printf("Single region, 20 frames of 20000 cards: %llu stalls, %.3f ms waiting\n",
+                    static_cast<unsigned long long>(stats.stalls),
+                    stats.wait_ms);
+    });
+}
@@ -0,0 +1,171 @@
+#include "cards.hpp"
+#include "gl_test_helpers.hpp"
+#include "headless.hpp"
+#include "table_grid.hpp"
+#include "table_layout.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <span>
+#include <string>
+#include <vector>
+
+// Tiles fill the framebuffer row by row from the top left, never overlap and keep the aspect
+TEST(TableGridTest, LayoutTilesTablesTopLeftFirst)
+{
+    const auto metrics = table_metrics{};
+    const auto tiles   = layout_table_grid(64, 1400, 1000, metrics);
+    ASSERT_EQ(tiles.size(), 64u);
+    EXPECT_FLOAT_EQ(tiles[0].scale, 1.0f / 8.0f);
+    EXPECT_FLOAT_EQ(tiles[0].x, 0.0f);
+    EXPECT_FLOAT_EQ(tiles[0].y, 1000.0f - 125.0f);
+    EXPECT_FLOAT_EQ(tiles[63].x, 1400.0f - 175.0f);
+    EXPECT_FLOAT_EQ(tiles[63].y, 0.0f);
+    for (auto i = std::size_t(1); i < tiles.size(); ++i)
+    {
+        EXPECT_FLOAT_EQ(tiles[i].scale, tiles[0].scale);
+        const auto same_row = i % 8 != 0;
+        if (same_row)
+        {
+            EXPECT_GE(tiles[i].x, tiles[i - 1].x + metrics.width * tiles[i].scale - 1e-3f);
+            EXPECT_FLOAT_EQ(tiles[i].y, tiles[i - 1].y);
+        }
+        else
+        {
+            EXPECT_LE(tiles[i].y + metrics.height * tiles[i].scale, tiles[i - 1].y + 1e-3f);
+        }
+    }
+
+    // Five tables take a 3x2 grid; a wide framebuffer centres each table in its cell
+    const auto wide = layout_table_grid(5, 3000, 1000, metrics);
+    ASSERT_EQ(wide.size(), 5u);
+    EXPECT_FLOAT_EQ(wide[0].scale, 0.5f);
+    EXPECT_FLOAT_EQ(wide[0].x, 150.0f);
+    EXPECT_FLOAT_EQ(wide[3].y, 0.0f);
+    EXPECT_TRUE(layout_table_grid(0, 1400, 1000, metrics).empty());
+}
+
+TEST(TableGridTest, ParseTableOptions)
+{
+    auto arguments = std::array<const char*, 3>{"--tables", "64", "--table-sweep"};
+    const auto options =
+        parse_headless_options(int(arguments.size()), const_cast<char**>(arguments.data()));
+    ASSERT_TRUE(options.has_value()) << options.error();
+    EXPECT_EQ(options->table_count, 64);
+    EXPECT_TRUE(options->table_sweep);
+
+    auto bad = std::array<const char*, 2>{"--tables", "-1"};
+    EXPECT_FALSE(parse_headless_options(int(bad.size()), const_cast<char**>(bad.data())));
+}
+
+// One table in a full-size tile goes through the same transform as draw_cards, so the two
+// agree pixel for pixel; four quarter-size tables then come out of a single multi-draw
+TEST(TableGridTest, GridMatchesDrawCardsAndDrawsInOneCall)
+{
+    constexpr auto width  = 1400;
+    constexpr auto height = 1000;
+    with_context(width, height, [] {
+        auto renderer_result = create_card_renderer(texture_loading::blocking);
+        ASSERT_TRUE(renderer_result.has_value()) << renderer_result.error();
+        auto cr          = renderer_result.value();
+        auto grid_result = create_table_grid_renderer();
+        ASSERT_TRUE(grid_result.has_value()) << grid_result.error();
+        auto grid = grid_result.value();
+        glViewport(0, 0, width, height);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        set_table_grid_projection(*grid, width, height);
+        set_card_projection(cr, width, height);
+        glUniform1i(cr->uCardTextures, 0);
+
+        const auto metrics = table_metrics{};
+        auto       tables  = std::vector<std::vector<card>>(4);
+        for (auto i = 0; i < 4; ++i)
+        {
+            layout_table(deal_klondike(shuffle_deck(std::uint64_t(i + 1))), metrics, tables[i]);
+        }
+
+        glClear(GL_COLOR_BUFFER_BIT);
+        const auto background = read_pixels(width, height);
+        draw_cards(cr, tables[0]);
+        const auto reference = read_pixels(width, height);
+        ASSERT_FALSE(reference == background);
+
+        const auto full = std::array{table_tile{0.0f, 0.0f, 1.0f}};
+        set_table_grid_tiles(*grid, full);
+        glClear(GL_COLOR_BUFFER_BIT);
+        draw_table_grid(cr, *grid, std::span(tables).first(1));
+        EXPECT_TRUE(read_pixels(width, height) == reference);
+
+        // Again with the region all but full, so the whole batch has to move to the next one;
+        // the commands move with the instances
+        const auto region_slots = cr->stream->stats().region_bytes / sizeof(card_instance);
+        cr->stream->allocate<card_instance>(region_slots - 10);
+        const auto wraps = cr->stream->stats().wraps;
+        glClear(GL_COLOR_BUFFER_BIT);
+        draw_table_grid(cr, *grid, std::span(tables).first(1));
+        EXPECT_EQ(cr->stream->stats().wraps, wraps + 1);
+        EXPECT_TRUE(read_pixels(width, height) == reference);
+
+        // Each quarter shows its own deal: the bottom-right one matches table 3 drawn alone in
+        // the same tile
+        set_table_grid_tiles(*grid, layout_table_grid(4, width, height, metrics));
+        const auto draw_calls = cr->draw_calls;
+        glClear(GL_COLOR_BUFFER_BIT);
+        draw_table_grid(cr, *grid, tables);
+        EXPECT_EQ(cr->draw_calls, draw_calls + 1);
+        const auto grid_pixels = read_pixels(width, height);
+
+        const auto last_tile = std::array{layout_table_grid(4, width, height, metrics)[3]};
+        set_table_grid_tiles(*grid, last_tile);
+        glClear(GL_COLOR_BUFFER_BIT);
+        draw_table_grid(cr, *grid, std::span(tables).subspan(3));
+        const auto alone = read_pixels(width, height);
+        EXPECT_FALSE(grid_pixels == alone);
+
+        auto differing = 0;
+        for (auto y = 0; y < height / 2; ++y)
+        {
+            for (auto x = width / 2; x < width; ++x)
+            {
+                const auto at   = (std::size_t(y) * width + std::size_t(x)) * 4;
+                const auto same = std::equal(&grid_pixels[at], &grid_pixels[at + 4], &alone[at]);
+                differing += same ? 0 : 1;
+            }
+        }
+        EXPECT_EQ(differing, 0);
+
+        destroy_table_grid_renderer(*grid);
+    });
+}
+
+// Submission stays one draw per frame whatever the table count; only packing grows
+TEST(TableGridTest, HeadlessTablesSubmitOneDrawPerFrame)
+{
+    auto options        = headless_options{};
+    options.width       = 700;
+    options.height      = 500;
+    options.frame_count = 6;
+    options.warmup      = 2;
+
+    auto reports = std::vector<headless_report>();
+    for (const auto table_count : {1, 16, 64})
+    {
+        options.table_count = table_count;
+        auto report         = run_headless(options);
+        if (!report && report.error().find("EGL") != std::string::npos)
+        {
+            GTEST_SKIP() << report.error();
+        }
+        ASSERT_TRUE(report.has_value()) << report.error();
+        EXPECT_EQ(report->table_count, table_count);
+        EXPECT_EQ(report->cards_per_frame, std::size_t(table_count) * 52);
+        EXPECT_EQ(report->draw_calls, 6u);
+        EXPECT_EQ(report->submit_ms.size(), 6u);
+        reports.push_back(std::move(report.value()));
+    }
+    print_table_scaling(reports);
+}
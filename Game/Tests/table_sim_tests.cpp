@@ -0,0 +1,431 @@
+#include "gl_test_helpers.hpp"
+#include "headless.hpp"
+#include "spsc_queue.hpp"
+#include "table_sim.hpp"
+#include "triple_buffer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr auto stress_count = 200000;
+constexpr auto drag_steps   = 12;
+
+auto last_pile_top(const table_view& view) -> table_point
+{
+    const auto& top = view.cards.back();
+    return {top.x, top.y};
+}
+
+auto dealt_table() -> table_view
+{
+    auto view = table_view{};
+    reset_table(view, 1);
+    return view;
+}
+
+auto pointer(input_kind kind, table_point point, double time) -> input_event
+{
+    return {.kind = kind, .x = point.x, .y = point.y, .time = time};
+}
+
+// Seconds on the steady clock, for a simulation running on its own thread
+auto steady_seconds() -> double
+{
+    return double(latency_clock_ns()) / 1e9;
+}
+
+// Polls the render end of `simulation` until `done` holds for the newest snapshot
+template <typename Predicate>
+auto wait_for_snapshot(table_simulation& simulation, Predicate done) -> bool
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        simulation.acquire_snapshot();
+        if (done(simulation.snapshot()))
+        {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+} // namespace
+
+TEST(TableSimTest, QueueKeepsOrderAcrossThreads)
+{
+    auto queue = spsc_queue<std::uint32_t, 64>();
+    for (auto i = 0u; i < 64; ++i)
+    {
+        EXPECT_TRUE(queue.push(i));
+    }
+    EXPECT_FALSE(queue.push(64)); // Full
+    EXPECT_EQ(queue.pop(), 0u);
+    EXPECT_TRUE(queue.push(64));
+    for (auto i = 1u; i <= 64; ++i)
+    {
+        EXPECT_EQ(queue.pop(), i);
+    }
+    EXPECT_FALSE(queue.pop().has_value());
+    EXPECT_TRUE(queue.empty());
+
+    // Every value arrives exactly once and in order while both ends run flat out
+    auto producer = std::jthread([&] {
+        for (auto i = 0u; i < std::uint32_t(stress_count); ++i)
+        {
+            while (!queue.push(i))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+    auto expected = 0u;
+    while (expected < std::uint32_t(stress_count))
+    {
+        if (const auto value = queue.pop())
+        {
+            ASSERT_EQ(*value, expected);
+            ++expected;
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(TableSimTest, TripleBufferHandsOverWholeValues)
+{
+    struct frame
+    {
+        std::uint32_t                  sequence = 0;
+        std::array<std::uint32_t, 32> copies{};
+    };
+    auto buffer = triple_buffer<frame>();
+    EXPECT_FALSE(buffer.acquire());
+
+    auto written = std::atomic<bool>(false);
+    auto writer  = std::jthread([&] {
+        for (auto i = 1u; i <= std::uint32_t(stress_count); ++i)
+        {
+            auto& slot    = buffer.write_slot();
+            slot.sequence = i;
+            slot.copies.fill(i);
+            buffer.publish();
+        }
+        written = true;
+    });
+
+    // Never torn, never older than what was read before; values in between may be skipped
+    auto last = 0u;
+    while (true)
+    {
+        const auto done = written.load();
+        if (!buffer.acquire())
+        {
+            if (done)
+            {
+                break;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+        const auto& value = buffer.read_slot();
+        ASSERT_GT(value.sequence, last);
+        for (const auto copy : value.copies)
+        {
+            ASSERT_EQ(copy, value.sequence);
+        }
+        last = value.sequence;
+    }
+    writer.join();
+    EXPECT_EQ(last, std::uint32_t(stress_count));
+}
+
+// A synthetic drag, fed tick by tick without a thread: every tick that changes the table
+// publishes one snapshot, and only picking up and letting go change its static layer
+TEST(TableSimTest, SyntheticDragStreamPublishesSnapshots)
+{
+    constexpr auto tick = table_simulation::tick_seconds;
+
+    auto simulation = table_simulation(dealt_table(), 0.0);
+    ASSERT_TRUE(simulation.acquire_snapshot()); // The dealt table, before any tick
+    EXPECT_EQ(simulation.snapshot().static_cards.size(), 52u);
+    EXPECT_TRUE(simulation.snapshot().moving_cards.empty());
+    const auto dealt_version = simulation.snapshot().static_version;
+
+    // Idle ticks publish nothing
+    simulation.advance_to(4 * tick);
+    EXPECT_FALSE(simulation.acquire_snapshot());
+    EXPECT_EQ(simulation.counters().ticks, 4u);
+
+    const auto start = last_pile_top(simulation.view());
+    ASSERT_TRUE(simulation.push(pointer(input_kind::pointer_down, start, 4.5 * tick)));
+    simulation.advance_to(5 * tick);
+    ASSERT_TRUE(simulation.acquire_snapshot());
+    const auto picked_up = simulation.snapshot();
+    EXPECT_EQ(picked_up.static_cards.size(), 51u);
+    ASSERT_EQ(picked_up.moving_cards.size(), 1u);
+    EXPECT_NE(picked_up.static_version, dealt_version);
+    EXPECT_DOUBLE_EQ(picked_up.time, 5 * tick);
+    EXPECT_NE(picked_up.input_ns, 0u);
+
+    // Several moves in one tick come out as one snapshot with the card where the last left it
+    for (auto step = 1; step <= drag_steps; ++step)
+    {
+        const auto to = table_point{start.x - 10.0f * step, start.y + 5.0f * step};
+        simulation.push(pointer(input_kind::pointer_move, to, 5.5 * tick));
+    }
+    simulation.advance_to(6 * tick);
+    ASSERT_TRUE(simulation.acquire_snapshot());
+    const auto dragged = simulation.snapshot();
+    ASSERT_EQ(dragged.moving_cards.size(), 1u);
+    EXPECT_FLOAT_EQ(dragged.moving_cards[0].x, start.x - 10.0f * drag_steps);
+    EXPECT_EQ(dragged.static_version, picked_up.static_version);
+    EXPECT_GE(dragged.input_ns, picked_up.input_ns);
+
+    // Letting go slides the card back; once it lands it rejoins the static layer
+    simulation.push(pointer(input_kind::pointer_up, start, 6.5 * tick));
+    simulation.advance_to(7 * tick);
+    ASSERT_TRUE(simulation.acquire_snapshot());
+    EXPECT_EQ(simulation.snapshot().moving_cards.size(), 1u);
+    EXPECT_EQ(simulation.snapshot().static_cards.size(), 51u);
+    simulation.advance_to(7 * tick + 1.0);
+    ASSERT_TRUE(simulation.acquire_snapshot());
+    EXPECT_TRUE(simulation.snapshot().moving_cards.empty());
+    EXPECT_EQ(simulation.snapshot().static_cards.size(), 52u);
+    EXPECT_TRUE(simulation.view().animator.empty());
+
+    const auto counters = simulation.counters();
+    EXPECT_EQ(counters.events, std::uint64_t(2 + drag_steps));
+    EXPECT_EQ(counters.queue_latency.count, counters.events);
+    EXPECT_EQ(counters.dropped_events, 0u);
+    EXPECT_LE(counters.ticks, std::uint64_t(7 + table_simulation::max_catch_up_ticks));
+}
+
+TEST(TableSimTest, FullQueueDropsEvents)
+{
+    auto       simulation = table_simulation(dealt_table(), 0.0);
+    const auto key        = input_event{.kind = input_kind::key, .key = std::uint16_t('X')};
+    for (auto i = std::size_t(0); i < input_queue_capacity; ++i)
+    {
+        ASSERT_TRUE(simulation.push(key));
+    }
+    EXPECT_FALSE(simulation.push(key));
+    EXPECT_EQ(simulation.counters().dropped_events, 1u);
+
+    simulation.advance_to(table_simulation::tick_seconds);
+    EXPECT_EQ(simulation.counters().events, std::uint64_t(input_queue_capacity));
+    EXPECT_TRUE(simulation.push(key));
+}
+
+// The same stream with the simulation on its own thread: input reaches the snapshots, and an
+// idle table stops ticking
+TEST(TableSimTest, ThreadedSimulationAppliesInputAndIdles)
+{
+    auto       simulation = table_simulation(dealt_table(), steady_seconds());
+    const auto start      = last_pile_top(simulation.view());
+    auto       published  = std::atomic<std::uint64_t>(0);
+    simulation.start(steady_seconds, [&] { ++published; });
+
+    simulation.push(pointer(input_kind::pointer_down, start, steady_seconds()));
+    const auto moved = table_point{start.x - 80.0f, start.y};
+    simulation.push(pointer(input_kind::pointer_move, moved, steady_seconds()));
+    EXPECT_TRUE(wait_for_snapshot(simulation, [&](const table_snapshot& snapshot) {
+        return snapshot.moving_cards.size() == 1 && snapshot.moving_cards[0].x == moved.x;
+    }));
+
+    simulation.push(pointer(input_kind::pointer_up, start, steady_seconds()));
+    EXPECT_TRUE(wait_for_snapshot(simulation, [](const table_snapshot& snapshot) {
+        return snapshot.moving_cards.empty() && snapshot.static_cards.size() == 52;
+    }));
+    EXPECT_GT(published.load(), 2u);
+
+    // Settled: the thread waits for input instead of ticking
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const auto published_idle = published.load();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(published.load(), published_idle);
+
+    simulation.stop();
+    const auto counters = simulation.counters();
+    EXPECT_EQ(counters.events, 3u);
+    EXPECT_EQ(counters.queue_latency.count, 3u);
+    EXPECT_FALSE(simulation.view().drag.has_value());
+}
+
+// The hint search runs a slice per tick; H shows its move without playing it and P plays it
+TEST(TableSimTest, HintKeysShowAndPlayTheSearchedMove)
+{
+    constexpr auto tick = table_simulation::tick_seconds;
+
+    auto       simulation = table_simulation(dealt_table(), 0.0);
+    auto       time       = 0.0;
+    const auto run        = [&](std::int32_t ticks) {
+        for (auto i = 0; i < ticks; ++i)
+        {
+            time += tick;
+            simulation.advance_to(time);
+        }
+    };
+    run(4);
+    EXPECT_GT(simulation.hint().best().nodes, 0u);
+    EXPECT_GE(simulation.counters().hint_time.count, 1u);
+    EXPECT_LT(simulation.counters().hint_time.max_ms(), 50.0);
+    const auto dealt = simulation.view().state;
+    const auto best  = simulation.hint().best().move();
+    ASSERT_TRUE(best.has_value());
+
+    simulation.push({.kind = input_kind::key, .key = std::uint16_t('H'), .time = time});
+    run(1);
+    EXPECT_EQ(simulation.view().state, dealt);
+    EXPECT_FALSE(simulation.view().animator.empty());
+    run(120);
+    EXPECT_TRUE(simulation.view().animator.empty());
+
+    simulation.push({.kind = input_kind::key, .key = std::uint16_t('P'), .time = time});
+    run(1);
+    auto expected = dealt;
+    auto played   = *best;
+    apply_move(expected, played);
+    EXPECT_EQ(simulation.view().state, expected);
+    EXPECT_FALSE(simulation.view().animator.empty());
+    EXPECT_EQ(simulation.hint().root(), expected); // Searching the new position already
+}
+
+TEST(TableSimTest, PresenterInterpolatesAndCountsLatency)
+{
+    auto presenter                  = table_presenter{};
+    presenter.previous.time         = 1.0;
+    presenter.previous.moving_cards = {{0.0f, 0.0f, 5, true}};
+    presenter.current.time          = 1.0 + table_simulation::tick_seconds;
+    presenter.current.moving_cards  = {{100.0f, 50.0f, 5, true}, {10.0f, 20.0f, 7, false}};
+    presenter.current.input_ns      = 1000;
+
+    // Frames lag one tick behind, so at the current snapshot's time plus half a tick the cards
+    // are halfway there
+    const auto now = presenter.current.time + table_simulation::tick_seconds * 0.5;
+    EXPECT_FLOAT_EQ(presentation_alpha(presenter, now), 0.5f);
+    EXPECT_FLOAT_EQ(presentation_alpha(presenter, 0.0), 0.0f);
+    EXPECT_FLOAT_EQ(presentation_alpha(presenter, 5.0), 1.0f);
+
+    auto cards = std::vector<card>();
+    interpolate_moving_cards(presenter.previous, presenter.current, 0.25f, cards);
+    ASSERT_EQ(cards.size(), 2u);
+    EXPECT_FLOAT_EQ(cards[0].x, 25.0f);
+    EXPECT_FLOAT_EQ(cards[0].y, 12.5f);
+    EXPECT_FLOAT_EQ(cards[1].x, 10.0f); // Just started moving
+    EXPECT_FALSE(cards[1].face_up);
+
+    // Input is counted once, by the first frame that shows it
+    count_presented_input(presenter, 4000);
+    count_presented_input(presenter, 9000);
+    EXPECT_EQ(presenter.input_to_photon.count, 1u);
+    EXPECT_EQ(presenter.input_to_photon.max_ns, 3000u);
+}
+
+TEST(TableSimTest, ReceiveSnapshotInvalidatesWhatChanged)
+{
+    constexpr auto tick = table_simulation::tick_seconds;
+
+    auto simulation = table_simulation(dealt_table(), 0.0);
+    auto presenter  = table_presenter{};
+    auto pacer      = frame_pacer();
+    ASSERT_TRUE(receive_snapshot(presenter, simulation, pacer));
+    EXPECT_TRUE(pacer.next_frame().rebuild_static);
+    EXPECT_FALSE(receive_snapshot(presenter, simulation, pacer));
+    EXPECT_FALSE(pacer.next_frame().render);
+
+    const auto start = last_pile_top(simulation.view());
+    simulation.push(pointer(input_kind::pointer_down, start, 0.5 * tick));
+    simulation.advance_to(tick);
+    ASSERT_TRUE(receive_snapshot(presenter, simulation, pacer));
+    EXPECT_TRUE(pacer.next_frame().rebuild_static);
+    EXPECT_EQ(pacer.wait_timeout(), frame_pacer::tick_seconds); // Interpolating the held card
+
+    simulation.push(pointer(input_kind::pointer_move, {start.x, start.y - 40.0f}, 1.5 * tick));
+    simulation.advance_to(2 * tick);
+    ASSERT_TRUE(receive_snapshot(presenter, simulation, pacer));
+    const auto plan = pacer.next_frame();
+    EXPECT_TRUE(plan.render);
+    EXPECT_FALSE(plan.rebuild_static);
+}
+
+// A snapshot drawn at alpha 1 is the frame draw_table_frame draws for the same view
+TEST(TableSimTest, SnapshotFrameMatchesViewFrame)
+{
+    constexpr auto width  = 1400;
+    constexpr auto height = 1000;
+
+    auto failure = std::string();
+    auto result  = run_offscreen(width, height, [&] {
+        auto renderer_result = create_card_renderer(texture_loading::blocking);
+        if (!renderer_result)
+        {
+            failure = renderer_result.error();
+            return;
+        }
+        auto cr = renderer_result.value();
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glUniform1i(glGetUniformLocation(cr->shader_program, "uCardTextures"), 0);
+
+        // A card slides back while another is held
+        auto view = dealt_table();
+        animate_table(view, 5.0);
+        const auto start = last_pile_top(view);
+        begin_drag(view, start);
+        move_drag(view, {start.x - 200.0f, start.y + 100.0f});
+        end_drag(view);
+        animate_table(view, 5.05);
+        for (auto i = view.cards.size() - 1; i-- > 0 && !view.drag;)
+        {
+            const auto centre = table_point{view.cards[i].x, view.cards[i].y};
+            if (view.cards[i].face_up && card_under(view, centre) == i)
+            {
+                begin_drag(view, centre);
+            }
+        }
+        ASSERT_TRUE(view.drag.has_value());
+        move_drag(view, {700.0f, 300.0f});
+
+        const auto full     = frame_plan{true, true, true};
+        const auto viewport = fit_table_viewport(table_metrics{}, width, height);
+        auto       renderer = table_renderer{};
+        ASSERT_TRUE(draw_table_frame(cr, renderer, view, full, viewport));
+        const auto direct = read_pixels(width, height);
+
+        auto snapshot = table_snapshot{};
+        take_table_snapshot(view, snapshot);
+        ASSERT_EQ(snapshot.moving_cards.size(), 2u);
+        EXPECT_EQ(snapshot.moving_cards.back().index, view.cards[view.drag->card].index);
+
+        auto snapshot_renderer = table_renderer{};
+        glClear(GL_COLOR_BUFFER_BIT);
+        ASSERT_TRUE(
+            draw_snapshot_frame(cr, snapshot_renderer, snapshot, snapshot, 1.0f, full, viewport));
+        EXPECT_TRUE(read_pixels(width, height) == direct);
+
+        destroy_card_layer_cache(renderer.layer_cache);
+        destroy_card_layer_cache(snapshot_renderer.layer_cache);
+    });
+    if (!result && result.error().find("EGL") != std::string::npos)
+    {
+        GTEST_SKIP() << result.error();
+    }
+    ASSERT_TRUE(result.has_value()) << result.error();
+    EXPECT_TRUE(failure.empty()) << failure;
+}
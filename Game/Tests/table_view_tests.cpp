@@ -0,0 +1,469 @@
+#include "gl_test_helpers.hpp"
+#include "headless.hpp"
+#include "table_view.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+constexpr auto idle_iterations = 500;
+constexpr auto drag_steps      = 30;
+
+// Centre of the face-up card on top of the last tableau pile
+auto last_pile_top(const table_view& view) -> table_point
+{
+    const auto& top = view.cards.back();
+    return {top.x, top.y};
+}
+
+} // namespace
+
+TEST(TableViewTest, IdleTableWaitsForEvents)
+{
+    auto pacer = frame_pacer();
+
+    // The first frame allocates and fills the cached layer
+    ASSERT_EQ(pacer.wait_timeout(), 0.0);
+    const auto first = pacer.next_frame();
+    EXPECT_TRUE(first.render);
+    EXPECT_TRUE(first.resize);
+    EXPECT_TRUE(first.rebuild_static);
+
+    for (auto i = 0; i < idle_iterations; ++i)
+    {
+        EXPECT_FALSE(pacer.wait_timeout().has_value());
+        EXPECT_FALSE(pacer.next_frame().render);
+    }
+    EXPECT_EQ(pacer.counters().frames, 1u);
+    EXPECT_EQ(pacer.counters().static_rebuilds, 1u);
+    EXPECT_EQ(pacer.counters().idle_waits, std::uint64_t(idle_iterations));
+}
+
+TEST(TableViewTest, StreamingAndAnimationTick)
+{
+    auto pacer = frame_pacer();
+    pacer.next_frame();
+
+    pacer.set_streaming(true);
+    EXPECT_EQ(pacer.wait_timeout(), frame_pacer::tick_seconds);
+    EXPECT_FALSE(pacer.next_frame().render); // Pumping uploads alone draws nothing
+    pacer.set_streaming(false);
+
+    pacer.set_compiling(true);
+    EXPECT_EQ(pacer.wait_timeout(), frame_pacer::tick_seconds);
+    EXPECT_FALSE(pacer.next_frame().render);
+    pacer.set_compiling(false);
+
+    pacer.set_animating(true);
+    EXPECT_EQ(pacer.wait_timeout(), frame_pacer::tick_seconds);
+    const auto plan = pacer.next_frame();
+    EXPECT_TRUE(plan.render);
+    EXPECT_FALSE(plan.rebuild_static);
+    pacer.set_animating(false);
+    EXPECT_FALSE(pacer.wait_timeout().has_value());
+
+    auto continuous = frame_pacer(true);
+    continuous.next_frame();
+    EXPECT_EQ(continuous.wait_timeout(), 0.0);
+    EXPECT_TRUE(continuous.next_frame().render);
+}
+
+TEST(TableViewTest, CardUnderPicksTopmost)
+{
+    auto view = table_view{};
+    reset_table(view, 1);
+
+    const auto top = view.cards.size() - 1;
+    EXPECT_EQ(card_under(view, last_pile_top(view)), top);
+
+    // The strip of the card beneath that the fan leaves showing
+    const auto& under = view.cards[top - 1];
+    EXPECT_EQ(card_under(view, {under.x, under.y + card_height_px * 0.5f - 1.0f}), top - 1);
+    EXPECT_FALSE(card_under(view, {1.0f, 1.0f}).has_value());
+}
+
+TEST(TableViewTest, DragFindsDropPile)
+{
+    auto view = table_view{};
+    reset_table(view, 1);
+
+    const auto start = last_pile_top(view);
+    begin_drag(view, start);
+    ASSERT_TRUE(view.drag.has_value());
+    EXPECT_EQ(view.drag->drop_pile, std::uint8_t(6));
+
+    const auto foundation = pile_origin(view.metrics, 3, true);
+    move_drag(view, {foundation.x + 10.0f, foundation.y - 10.0f});
+    EXPECT_EQ(view.drag->drop_pile, std::uint8_t(pile_foundation));
+
+    const auto tableau = pile_origin(view.metrics, 2, false);
+    move_drag(view, {tableau.x - 20.0f, tableau.y - 30.0f});
+    EXPECT_EQ(view.drag->drop_pile, std::uint8_t(2));
+
+    // The held card is picked where it was moved to
+    EXPECT_EQ(card_under(view, {tableau.x - 20.0f, tableau.y - 30.0f}), view.drag->card);
+
+    move_drag(view, {1.0f, 1.0f}); // Nothing down there
+    EXPECT_FALSE(view.drag->drop_pile.has_value());
+}
+
+TEST(TableViewTest, DragRebuildsStaticLayerOnlyOnPickUpAndDrop)
+{
+    auto view = table_view{};
+    reset_table(view, 1);
+    view.pacer.next_frame();
+
+    const auto start = last_pile_top(view);
+    begin_drag(view, start);
+    ASSERT_TRUE(view.drag.has_value());
+    EXPECT_TRUE(view.pacer.next_frame().rebuild_static);
+
+    auto static_cards  = std::vector<card>();
+    auto dynamic_cards = std::vector<card>();
+    for (auto step = 1; step <= drag_steps; ++step)
+    {
+        move_drag(view, {start.x - 10.0f * step, start.y + 5.0f * step});
+        const auto plan = view.pacer.next_frame();
+        EXPECT_TRUE(plan.render);
+        EXPECT_FALSE(plan.rebuild_static);
+    }
+    split_table_layers(view, static_cards, dynamic_cards);
+    ASSERT_EQ(dynamic_cards.size(), 1u);
+    EXPECT_FLOAT_EQ(dynamic_cards[0].x, start.x - 10.0f * drag_steps);
+    EXPECT_EQ(static_cards.size(), 51u);
+
+    end_drag(view);
+    EXPECT_TRUE(view.pacer.next_frame().rebuild_static);
+    EXPECT_FLOAT_EQ(view.cards.back().x, start.x); // Back on its pile
+
+    // Pick-up, every drag step, drop
+    EXPECT_EQ(view.pacer.counters().frames, std::uint64_t(1 + 1 + drag_steps + 1));
+    EXPECT_EQ(view.pacer.counters().static_rebuilds, 3u);
+}
+
+TEST(TableViewTest, DroppedCardSlidesBack)
+{
+    auto view = table_view{};
+    reset_table(view, 1);
+    animate_table(view, 5.0);
+    view.pacer.next_frame();
+
+    const auto start = last_pile_top(view);
+    begin_drag(view, start);
+    move_drag(view, {start.x - 200.0f, start.y + 100.0f});
+    end_drag(view);
+    EXPECT_FLOAT_EQ(view.cards.back().x, start.x); // Laid out where it comes to rest
+
+    // On its way back it is in neither layer, and cannot be picked up again
+    auto static_cards  = std::vector<card>();
+    auto dynamic_cards = std::vector<card>();
+    split_table_layers(view, static_cards, dynamic_cards);
+    EXPECT_EQ(static_cards.size(), 51u);
+    EXPECT_TRUE(dynamic_cards.empty());
+    ASSERT_EQ(view.animator.size(), 1u);
+    begin_drag(view, start);
+    EXPECT_FALSE(view.drag.has_value());
+
+    EXPECT_TRUE(view.pacer.next_frame().rebuild_static);
+    animate_table(view, 5.05);
+    EXPECT_EQ(view.pacer.wait_timeout(), frame_pacer::tick_seconds);
+    const auto plan = view.pacer.next_frame();
+    EXPECT_TRUE(plan.render);
+    EXPECT_FALSE(plan.rebuild_static);
+    auto instances = std::vector<card_instance>();
+    view.animator.write_instances(all_layers_resident, instances);
+    ASSERT_EQ(instances.size(), 1u);
+    EXPECT_LT(instances[0].x, start.x);
+    EXPECT_GT(instances[0].x, start.x - 200.0f);
+
+    // Landing puts it back into the static layer
+    animate_table(view, 6.0);
+    EXPECT_TRUE(view.animator.empty());
+    EXPECT_TRUE(view.pacer.next_frame().rebuild_static);
+    EXPECT_FALSE(view.pacer.wait_timeout().has_value());
+    split_table_layers(view, static_cards, dynamic_cards);
+    EXPECT_EQ(static_cards.size(), 52u);
+}
+
+TEST(TableViewTest, DealFliesTableauFromStock)
+{
+    auto view = table_view{};
+    reset_table(view, 2);
+    animate_deal(view, 0.0);
+    ASSERT_EQ(view.animator.size(), 28u);
+
+    // Before it starts, every card waits face down on the stock
+    animate_table(view, 0.0);
+    auto instances = std::vector<card_instance>();
+    view.animator.write_instances(all_layers_resident, instances);
+    const auto stock = pile_origin(view.metrics, 0, true);
+    for (const auto& instance : instances)
+    {
+        EXPECT_FLOAT_EQ(instance.x, stock.x);
+        EXPECT_EQ(instance.layer, card_back_layer);
+    }
+
+    auto static_cards  = std::vector<card>();
+    auto dynamic_cards = std::vector<card>();
+    split_table_layers(view, static_cards, dynamic_cards);
+    EXPECT_EQ(static_cards.size(), 24u); // Just the stock
+
+    animate_table(view, 10.0);
+    EXPECT_TRUE(view.animator.empty());
+    split_table_layers(view, static_cards, dynamic_cards);
+    EXPECT_EQ(static_cards.size(), 52u);
+}
+
+TEST(TableViewTest, AutoCompleteWinsAndCascades)
+{
+    // Everything up but the kings, which sit alone on the first four piles
+    auto state        = klondike_state{};
+    state.foundations = 0xCCCC;
+    for (auto suit = 0; suit < suit_count; ++suit)
+    {
+        state.tableau[suit][0]    = make_card(suit, rank_count - 1);
+        state.tableau_size[suit] = 1;
+    }
+    state.hash = compute_hash(state);
+
+    auto view = table_view{};
+    load_table(view, state);
+    auto_complete(view, 1.0);
+    EXPECT_TRUE(is_won(view.state));
+    EXPECT_EQ(view.animator.size(), 4u);
+
+    // The kings are still on their way up
+    animate_table(view, 1.1);
+    EXPECT_FALSE(view.cascading);
+
+    // Once they land the cascade takes every card off the foundations
+    animate_table(view, 5.0);
+    EXPECT_TRUE(view.cascading);
+    EXPECT_EQ(view.animator.size(), 52u);
+    view.pacer.next_frame();
+    EXPECT_EQ(view.pacer.wait_timeout(), frame_pacer::tick_seconds);
+
+    auto static_cards  = std::vector<card>();
+    auto dynamic_cards = std::vector<card>();
+    split_table_layers(view, static_cards, dynamic_cards);
+    EXPECT_TRUE(static_cards.empty());
+
+    animate_table(view, 600.0);
+    EXPECT_TRUE(view.animator.empty());
+    EXPECT_TRUE(view.cascading); // The trails stay up
+    view.pacer.next_frame();
+    EXPECT_FALSE(view.pacer.wait_timeout().has_value());
+}
+
+TEST(TableViewTest, DrawCallsOverIdleAndDrag)
+{
+    constexpr auto width  = 1400;
+    constexpr auto height = 1000;
+
+    auto failure = std::string();
+    auto result  = run_offscreen(width, height, [&] {
+        auto renderer_result = create_card_renderer(texture_loading::blocking);
+        if (!renderer_result)
+        {
+            failure = renderer_result.error();
+            return;
+        }
+        auto cr = renderer_result.value();
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glUniform1i(glGetUniformLocation(cr->shader_program, "uCardTextures"), 0);
+
+        auto       view     = table_view{};
+        auto       renderer = table_renderer{};
+        const auto viewport = fit_table_viewport(table_metrics{}, width, height);
+        reset_table(view, 1);
+
+        const auto run_frame = [&] {
+            const auto plan = view.pacer.next_frame();
+            if (plan.render)
+            {
+                ASSERT_TRUE(draw_table_frame(cr, renderer, view, plan, viewport));
+            }
+        };
+
+        // Idle: one frame to fill the cache, then nothing at all
+        for (auto i = 0; i < idle_iterations; ++i)
+        {
+            run_frame();
+        }
+        EXPECT_EQ(view.pacer.counters().frames, 1u);
+        EXPECT_EQ(cr->draw_calls, 1u);
+
+        // Drag: the pick-up rebuilds the cache, then each step draws just the held card
+        const auto start = last_pile_top(view);
+        begin_drag(view, start);
+        run_frame();
+        const auto calls_after_pick_up = cr->draw_calls;
+        EXPECT_EQ(calls_after_pick_up, 3u); // Cache rebuild plus the held card
+        for (auto step = 1; step <= drag_steps; ++step)
+        {
+            move_drag(view, {start.x - 10.0f * step, start.y - 20.0f * step});
+            run_frame();
+        }
+        EXPECT_EQ(view.pacer.counters().frames, std::uint64_t(2 + drag_steps));
+        EXPECT_EQ(cr->draw_calls - calls_after_pick_up, std::uint64_t(drag_steps));
+
+        // The composited frame matches drawing every card directly
+        const auto composited = read_pixels(width, height);
+        glClear(GL_COLOR_BUFFER_BIT);
+        draw_cards(cr, renderer.static_cards);
+        draw_cards(cr, renderer.dynamic_cards);
+        EXPECT_TRUE(composited == read_pixels(width, height));
+
+        destroy_card_layer_cache(renderer.layer_cache);
+    });
+    if (!result && result.error().find("EGL") != std::string::npos)
+    {
+        GTEST_SKIP() << result.error();
+    }
+    ASSERT_TRUE(result.has_value()) << result.error();
+    EXPECT_TRUE(failure.empty()) << failure;
+}
+
+// Half the render scale draws the same frame from a quarter of the pixels: only the edges of
+// the cards differ once it is stretched back up
+TEST(TableViewTest, ReducedRenderScaleStretchesTheSameFrame)
+{
+    constexpr auto width  = 1400;
+    constexpr auto height = 1000;
+
+    auto failure = std::string();
+    auto result  = run_offscreen(width, height, [&] {
+        auto renderer_result = create_card_renderer(texture_loading::blocking);
+        if (!renderer_result)
+        {
+            failure = renderer_result.error();
+            return;
+        }
+        auto cr = renderer_result.value();
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glUniform1i(glGetUniformLocation(cr->shader_program, "uCardTextures"), 0);
+
+        // A held card as well, so the dynamic layer goes through the scaled frame too
+        auto view = table_view{};
+        reset_table(view, 1);
+        const auto start = last_pile_top(view);
+        begin_drag(view, start);
+        move_drag(view, {start.x - 200.0f, start.y + 150.0f});
+
+        const auto full = frame_plan{true, true, true};
+        auto       draw = [&](float scale) {
+            auto renderer = table_renderer{};
+            auto viewport = fit_table_viewport(table_metrics{}, width, height, scale);
+            glClear(GL_COLOR_BUFFER_BIT);
+            EXPECT_TRUE(draw_table_frame(cr, renderer, view, full, viewport));
+            EXPECT_EQ(renderer.layer_cache.width, viewport.render_width);
+            EXPECT_EQ(renderer.scene.width, viewport.scaled() ? viewport.render_width : 0);
+            auto pixels = read_pixels(width, height);
+            destroy_card_layer_cache(renderer.layer_cache);
+            destroy_card_layer_cache(renderer.scene);
+            return pixels;
+        };
+        const auto sharp   = draw(1.0f);
+        const auto reduced = draw(0.5f);
+
+        auto changed = std::size_t(0);
+        for (auto i = std::size_t(0); i < sharp.size(); i += 4)
+        {
+            for (auto channel = std::size_t(0); channel < 3; ++channel)
+            {
+                if (std::abs(sharp[i + channel] - reduced[i + channel]) > 48)
+                {
+                    ++changed;
+                    break;
+                }
+            }
+        }
+        EXPECT_LT(changed, sharp.size() / 4 / 20) << "of " << sharp.size() / 4 << " pixels";
+    });
+    if (!result && result.error().find("EGL") != std::string::npos)
+    {
+        GTEST_SKIP() << result.error();
+    }
+    ASSERT_TRUE(result.has_value()) << result.error();
+    EXPECT_TRUE(failure.empty()) << failure;
+}
+
+// The cascade draws into the cached layer, one draw call a frame however long its trails get
+TEST(TableViewTest, CascadeLeavesTrailsInTheCachedLayer)
+{
+    constexpr auto width  = 1400;
+    constexpr auto height = 1000;
+    constexpr auto frames = 240;
+
+    auto failure = std::string();
+    auto result  = run_offscreen(width, height, [&] {
+        auto renderer_result = create_card_renderer(texture_loading::blocking);
+        if (!renderer_result)
+        {
+            failure = renderer_result.error();
+            return;
+        }
+        auto cr = renderer_result.value();
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glUniform1i(glGetUniformLocation(cr->shader_program, "uCardTextures"), 0);
+
+        auto won        = klondike_state{};
+        won.foundations = 0xDDDD;
+        won.hash        = compute_hash(won);
+
+        auto view     = table_view{};
+        auto renderer = table_renderer{};
+        load_table(view, won);
+
+        // Pixels still showing the clear colour, as seen in the corner before anything reaches it
+        auto       clear      = std::array<std::uint8_t, 4>();
+        const auto background = [&] {
+            const auto pixels = read_pixels(width, height);
+            auto       count  = std::size_t(0);
+            for (auto i = std::size_t(0); i < pixels.size(); i += 4)
+            {
+                count += pixels[i] == clear[0] && pixels[i + 1] == clear[1] &&
+                         pixels[i + 2] == clear[2];
+            }
+            return count;
+        };
+
+        auto first_calls = std::uint64_t(0);
+        auto shown       = std::size_t(0);
+        for (auto frame = 0; frame < frames; ++frame)
+        {
+            animate_table(view, frame / 60.0);
+            const auto plan = view.pacer.next_frame();
+            ASSERT_TRUE(plan.render);
+            ASSERT_TRUE(draw_table_frame(
+                cr, renderer, view, plan, fit_table_viewport(table_metrics{}, width, height)));
+            if (frame == 0)
+            {
+                glReadPixels(0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, clear.data());
+                first_calls = cr->draw_calls;
+                shown       = background();
+            }
+        }
+        ASSERT_TRUE(view.cascading);
+        EXPECT_EQ(cr->draw_calls - first_calls, std::uint64_t(frames - 1));
+
+        // Far more of the table is covered than the cards themselves would cover
+        EXPECT_LT(background() * 2, shown);
+
+        destroy_card_layer_cache(renderer.layer_cache);
+    });
+    if (!result && result.error().find("EGL") != std::string::npos)
+    {
+        GTEST_SKIP() << result.error();
+    }
+    ASSERT_TRUE(result.has_value()) << result.error();
+    EXPECT_TRUE(failure.empty()) << failure;
+}
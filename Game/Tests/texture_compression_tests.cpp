@@ -0,0 +1,141 @@
+#include "texture_compression.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+
+namespace {
+
+constexpr auto card_width  = 256;
+constexpr auto card_height = 372;
+
+// Card-like test image: white face, red pips with soft edges, black text strokes, a
+// gradient band and transparent rounded corners
+auto make_card_image() -> std::vector<std::uint8_t>
+{
+    auto rgba = std::vector<std::uint8_t>(std::size_t(card_width) * card_height * 4);
+    for (auto y = 0; y < card_height; ++y)
+    {
+        for (auto x = 0; x < card_width; ++x)
+        {
+            auto* texel = rgba.data() + (std::size_t(y) * card_width + x) * 4;
+            auto  r = 250, g = 250, b = 245;
+
+            const auto pip = std::hypot(x - 128.0, y - 186.0);
+            if (pip < 60.0)
+            {
+                const auto edge = std::clamp(60.0 - pip, 0.0, 1.0);
+                r               = int(200 * edge + r * (1.0 - edge));
+                g               = int(20 * edge + g * (1.0 - edge));
+                b               = int(30 * edge + b * (1.0 - edge));
+            }
+            if (x > 16 && x < 40 && y > 16 && y < 60 && (x + y) % 7 < 3)
+            {
+                r = g = b = 10;
+            }
+            if (y > 300 && y < 340)
+            {
+                r = x;
+                g = 255 - x;
+                b = (x + y) % 256;
+            }
+
+            // Rounded corners with radius 12
+            const auto corner_x = std::max({12 - x, x - (card_width - 13), 0});
+            const auto corner_y = std::max({12 - y, y - (card_height - 13), 0});
+            const auto outside  = std::hypot(double(corner_x), double(corner_y)) > 12.0;
+
+            texel[0] = std::uint8_t(r);
+            texel[1] = std::uint8_t(g);
+            texel[2] = std::uint8_t(b);
+            texel[3] = outside ? 0 : 255;
+        }
+    }
+    return rgba;
+}
+
+} // namespace
+
+TEST(TextureCompressionTest, MipChainReachesOneByOne)
+{
+    const auto image = make_card_image();
+    const auto chain = generate_mip_chain(image.data(), card_width, card_height);
+
+    ASSERT_EQ(std::ssize(chain), mip_level_count(card_width, card_height));
+    EXPECT_EQ(chain.size(), 9u);
+    EXPECT_EQ(chain[1].width, 128);
+    EXPECT_EQ(chain[1].height, 186);
+    EXPECT_EQ(chain.back().width, 1);
+    EXPECT_EQ(chain.back().height, 1);
+}
+
+TEST(TextureCompressionTest, FlatBlockRoundTripsExactly)
+{
+    auto block = std::array<std::uint8_t, 64>();
+    for (auto pixel = 0; pixel < 16; ++pixel)
+    {
+        block[pixel * 4 + 0] = 255;
+        block[pixel * 4 + 1] = 0;
+        block[pixel * 4 + 2] = 0;
+        block[pixel * 4 + 3] = 128;
+    }
+
+    auto encoded = std::array<std::uint8_t, bc3_block_bytes>();
+    encode_bc3_block(block.data(), encoded.data());
+    const auto decoded = decode_bc3(encoded.data(), 4, 4);
+
+    EXPECT_TRUE(std::equal(block.begin(), block.end(), decoded.begin()));
+}
+
+TEST(TextureCompressionTest, RoundTripPsnrPerLevel)
+{
+    const auto image = make_card_image();
+    const auto chain = generate_mip_chain(image.data(), card_width, card_height);
+
+    for (const auto& level : chain)
+    {
+        const auto encoded = encode_bc3(level.pixels.data(), level.width, level.height);
+        ASSERT_EQ(encoded.size(), bc3_image_size(level.width, level.height));
+
+        const auto decoded = decode_bc3(encoded.data(), level.width, level.height);
+        const auto quality = psnr(level.pixels.data(), decoded.data(), decoded.size());
+        std::printf("BC3 %3dx%3d: %.2f dB\n", level.width, level.height, quality);
+        // The tiny levels are mostly edges, which 4x4 blocks with two endpoints reproduce worst
+        const auto minimum_quality = level.width == card_width ? 38.0 : 26.0;
+        EXPECT_GT(quality, minimum_quality) << level.width << "x" << level.height;
+    }
+}
+
+TEST(TextureCompressionTest, ParallelEncodeMatchesSerialAndReportsSavings)
+{
+    const auto image  = make_card_image();
+    auto       chains = std::vector<std::vector<mip_level>>();
+    for (auto layer = 0; layer < 4; ++layer)
+    {
+        chains.push_back(generate_mip_chain(image.data(), card_width, card_height));
+    }
+
+    const auto serial   = encode_bc3_layers(chains, 1);
+    const auto parallel = encode_bc3_layers(chains, 8);
+    ASSERT_EQ(serial, parallel);
+
+    auto compressed_bytes = std::size_t(0);
+    for (const auto& level : serial)
+    {
+        compressed_bytes += level.front().size();
+    }
+    const auto rgba8_bytes        = std::size_t(card_width) * card_height * 4;
+    auto       mipped_rgba8_bytes = std::size_t(0);
+    for (const auto& level : chains.front())
+    {
+        mipped_rgba8_bytes += level.pixels.size();
+    }
+
+    std::printf("Per layer: RGBA8 %zu B, RGBA8 + mips %zu B, BC3 + mips %zu B (saves %zu B)\n",
+                rgba8_bytes,
+                mipped_rgba8_bytes,
+                compressed_bytes,
+                rgba8_bytes - compressed_bytes);
+    EXPECT_LT(compressed_bytes, rgba8_bytes / 2);
+}
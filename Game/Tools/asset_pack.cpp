@@ -0,0 +1,140 @@
+#include "asset_pack.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <string_view>
+#include <vector>
+
+constexpr auto generic_error = 1;
+constexpr auto no_error      = 0;
+
+namespace {
+
+// Asset names are paths relative to the root with forward slashes, whatever the platform
+auto collect_sources(const std::filesystem::path& root, const std::vector<std::string>& inputs)
+    -> std::expected<std::vector<asset_pack_source>, error_message_t>
+{
+    auto sources = std::vector<asset_pack_source>();
+    for (const auto& input : inputs)
+    {
+        const auto path = root / input;
+        if (std::filesystem::is_regular_file(path))
+        {
+            sources.push_back({std::filesystem::path(input).generic_string(), path});
+        }
+        else if (std::filesystem::is_directory(path))
+        {
+            // Sorted, so the same tree always produces the same pack
+            auto files = std::vector<std::filesystem::path>();
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(path))
+            {
+                if (entry.is_regular_file())
+                {
+                    files.push_back(entry.path());
+                }
+            }
+            std::ranges::sort(files);
+            for (const auto& file : files)
+            {
+                sources.push_back({file.lexically_relative(root).generic_string(), file});
+            }
+        }
+        else
+        {
+            return std::unexpected("No such file or directory: " + path.string());
+        }
+    }
+    return sources;
+}
+
+auto list_pack(const std::filesystem::path& path) -> int
+{
+    auto pack = asset_pack::open(path);
+    if (!pack)
+    {
+        std::fprintf(stderr, "%s\n", pack.error().c_str());
+        return generic_error;
+    }
+    for (const auto& entry : pack->entries())
+    {
+        const auto name = pack->name(entry);
+        std::printf("%016llx %10llu %10llu  %.*s\n",
+                    static_cast<unsigned long long>(entry.hash),
+                    static_cast<unsigned long long>(entry.offset),
+                    static_cast<unsigned long long>(entry.size),
+                    int(name.size()),
+                    name.data());
+    }
+    std::printf("%zu entries, %zu bytes\n", pack->entries().size(), pack->file()->size());
+    return no_error;
+}
+
+void print_usage()
+{
+    std::fprintf(stderr,
+                 "Usage: solitaire_pack --output FILE [--root DIR] FILE|DIR...\n"
+                 "       solitaire_pack --list FILE\n");
+}
+
+} // namespace
+
+// ----------------------------------------------------------------
+/// @brief Packs asset files and directories, named relative to --root, into one asset pack.
+/// @return 0 for no error, everything else is error
+int main(int argc, char** argv)
+{
+    auto output = std::filesystem::path();
+    auto root   = std::filesystem::current_path();
+    auto list   = std::filesystem::path();
+    auto inputs = std::vector<std::string>();
+    for (auto i = 1; i < argc; ++i)
+    {
+        const auto argument = std::string_view(argv[i]);
+        const auto has_next = i + 1 < argc;
+        if (argument == "--output" && has_next)
+        {
+            output = argv[++i];
+        }
+        else if (argument == "--root" && has_next)
+        {
+            root = argv[++i];
+        }
+        else if (argument == "--list" && has_next)
+        {
+            list = argv[++i];
+        }
+        else if (!argument.starts_with("--"))
+        {
+            inputs.emplace_back(argument);
+        }
+        else
+        {
+            print_usage();
+            return generic_error;
+        }
+    }
+
+    if (!list.empty())
+    {
+        return list_pack(list);
+    }
+    if (output.empty() || inputs.empty())
+    {
+        print_usage();
+        return generic_error;
+    }
+
+    auto sources = collect_sources(root, inputs);
+    if (!sources)
+    {
+        std::fprintf(stderr, "%s\n", sources.error().c_str());
+        return generic_error;
+    }
+    if (auto result = write_asset_pack(output, sources.value()); !result)
+    {
+        std::fprintf(stderr, "Failed to write asset pack: %s\n", result.error().c_str());
+        return generic_error;
+    }
+    std::printf("Packed %zu assets into %s\n", sources->size(), output.string().c_str());
+    return no_error;
+}
@@ -0,0 +1,167 @@
+#include "atlas_cache.hpp"
+#include "cards.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <thread>
+
+constexpr auto generic_error = 1;
+constexpr auto no_error      = 0;
+
+namespace {
+
+// Touches every byte of the mapped layers, which is what the texture upload does
+auto checksum_layers(const atlas_cache& cache) -> std::uint64_t
+{
+    const auto* bytes = reinterpret_cast<const std::uint8_t*>(cache.layers_data());
+    return std::accumulate(bytes, bytes + cache.layers_size(), std::uint64_t(0));
+}
+
+auto elapsed_ms(std::chrono::steady_clock::time_point start) -> double
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+// Per-layer GPU memory of the cache against a single-level RGBA8 layer
+void print_memory_report(const atlas_cache& cache)
+{
+    const auto rgba8_bytes = std::size_t(cache.layer_width()) * cache.layer_height() * 4;
+    auto       layer_bytes = std::size_t(0);
+    for (auto level = 0; level < cache.mip_levels(); ++level)
+    {
+        layer_bytes += cache.level(level).layer_stride;
+    }
+
+    std::printf("%s, %d mip levels: %zu bytes per layer (RGBA8 level 0 alone: %zu, %+lld)\n",
+                cache.format() == atlas_format::bc3 ? "BC3" : "RGBA8",
+                cache.mip_levels(),
+                layer_bytes,
+                rgba8_bytes,
+                static_cast<long long>(layer_bytes) - static_cast<long long>(rgba8_bytes));
+}
+
+/// Compares the current PNG+JSON startup path with cold and warm cache loads
+auto run_benchmark(const std::filesystem::path& cache_path) -> int
+{
+    constexpr auto iterations = 5;
+
+    auto current_ms = 0.0;
+    for (auto i = 0; i < iterations; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        auto       image = load_png_data();
+        if (!image)
+        {
+            std::fprintf(stderr, "Current path failed to load the PNG\n");
+            return generic_error;
+        }
+        auto slice_result = slice_atlas(*image.value());
+        current_ms += elapsed_ms(start);
+        if (!slice_result)
+        {
+            std::fprintf(stderr, "Current path failed: %s\n", slice_result.error().c_str());
+            return generic_error;
+        }
+    }
+
+    auto cold_ms = 0.0;
+    auto warm_ms = 0.0;
+    auto sum     = std::uint64_t(0);
+    for (auto i = 0; i < iterations; ++i)
+    {
+        evict_file_from_page_cache(cache_path);
+        auto start = std::chrono::steady_clock::now();
+        auto cold  = open_atlas_cache(cache_path);
+        if (!cold)
+        {
+            std::fprintf(stderr, "Cache load failed: %s\n", cold.error().c_str());
+            return generic_error;
+        }
+        sum += checksum_layers(*cold.value());
+        cold_ms += elapsed_ms(start);
+
+        start     = std::chrono::steady_clock::now();
+        auto warm = open_atlas_cache(cache_path);
+        sum += checksum_layers(*warm.value());
+        warm_ms += elapsed_ms(start);
+    }
+
+    std::printf("PNG decode + slice              : %8.2f ms\n", current_ms / iterations);
+    std::printf("Cooked cache, cold page cache   : %8.2f ms\n", cold_ms / iterations);
+    std::printf("Cooked cache, warm page cache   : %8.2f ms\n", warm_ms / iterations);
+    std::printf("(layer checksum %llu)\n", static_cast<unsigned long long>(sum));
+    return no_error;
+}
+
+} // namespace
+
+// ----------------------------------------------------------------
+/// @brief Cooks Assets/cards.png, sliced along the compiled-in atlas layout, into
+///        Assets/cards.atlas.
+///        Run from the directory holding assets.pack or Assets/.
+/// @return 0 for no error, everything else is error
+int main(int argc, char** argv)
+{
+    auto benchmark = false;
+    auto force     = false;
+    auto format    = atlas_format::rgba8;
+    for (auto i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--benchmark") == 0)
+        {
+            benchmark = true;
+        }
+        else if (std::strcmp(argv[i], "--force") == 0)
+        {
+            force = true;
+        }
+        else if (std::strcmp(argv[i], "--format") == 0 && i + 1 < argc &&
+                 (std::strcmp(argv[i + 1], "rgba8") == 0 || std::strcmp(argv[i + 1], "bc3") == 0))
+        {
+            format = std::strcmp(argv[++i], "bc3") == 0 ? atlas_format::bc3 : atlas_format::rgba8;
+        }
+        else
+        {
+            std::fprintf(stderr,
+                         "Usage: %s [--force] [--format rgba8|bc3] [--benchmark]\n",
+                         argv[0]);
+            return generic_error;
+        }
+    }
+
+    const auto cache_path   = atlas_cache_path();
+    auto       cache_result = open_atlas_cache(cache_path);
+    if (force || !cache_result.has_value() || cache_result.value()->format() != format)
+    {
+        // Release the old mapping before the file is replaced
+        cache_result = std::unexpected(error_message_t());
+
+        const auto start = std::chrono::steady_clock::now();
+        if (auto cook_result =
+                cook_atlas_cache(cache_path, format, std::thread::hardware_concurrency());
+            !cook_result)
+        {
+            std::fprintf(stderr, "Failed to cook atlas cache: %s\n", cook_result.error().c_str());
+            return generic_error;
+        }
+        std::printf("Cooked %s in %.2f ms\n", cache_path.string().c_str(), elapsed_ms(start));
+
+        cache_result = open_atlas_cache(cache_path);
+        if (!cache_result)
+        {
+            std::fprintf(stderr, "Cooked cache does not load: %s\n", cache_result.error().c_str());
+            return generic_error;
+        }
+    }
+    else
+    {
+        std::printf("Atlas cache is up to date: %s\n", cache_path.string().c_str());
+    }
+
+    print_memory_report(*cache_result.value());
+
+    return benchmark ? run_benchmark(cache_path) : no_error;
+}
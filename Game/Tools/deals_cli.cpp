@@ -0,0 +1,194 @@
+#include "deal_stats.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+#include <thread>
+
+constexpr auto generic_error = 1;
+constexpr auto no_error      = 0;
+
+namespace {
+
+struct deals_arguments
+{
+    std::filesystem::path output       = "deals.bin";
+    std::uint64_t         first_seed   = 1;
+    std::uint64_t         count        = 100'000;
+    std::uint8_t          draw_count   = 1;
+    std::size_t           worker_count = std::max(std::thread::hardware_concurrency(), 1u);
+    std::size_t           chunk_size   = 1024;
+    solver_options        options      = {.memory_budget = 256 << 20, .node_limit = 1'000'000};
+    bool                  summary_only = false;
+};
+
+auto seconds_since(std::chrono::steady_clock::time_point start) -> double
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void print_summary(std::span<const deal_record> records)
+{
+    auto outcomes = std::array<std::uint64_t, 3>();
+    auto lengths  = std::uint64_t(0);
+    auto passes   = std::uint64_t(0);
+    for (const auto& record : records)
+    {
+        ++outcomes[std::size_t(record.outcome)];
+        if (record.outcome == deal_outcome::winnable)
+        {
+            lengths += record.solution_length;
+            passes += record.stock_passes;
+        }
+    }
+
+    const auto winnable = outcomes[std::size_t(deal_outcome::winnable)];
+    std::printf("%zu deals: %llu winnable (%.1f%%), %llu unwinnable, %llu unknown\n",
+                records.size(),
+                static_cast<unsigned long long>(winnable),
+                records.empty() ? 0.0 : 100.0 * winnable / records.size(),
+                static_cast<unsigned long long>(outcomes[std::size_t(deal_outcome::unwinnable)]),
+                static_cast<unsigned long long>(outcomes[std::size_t(deal_outcome::unknown)]));
+    if (winnable > 0)
+    {
+        // The solver stops at the first win it finds, so these are not minimum move counts
+        std::printf("Solution lengths (first line found) average %.1f moves and %.2f stock "
+                    "passes\n",
+                    double(lengths) / winnable,
+                    double(passes) / winnable);
+    }
+}
+
+auto generate_deals(const deals_arguments& arguments) -> int
+{
+    auto writer =
+        deal_stats_writer::open(arguments.output, arguments.draw_count, arguments.first_seed);
+    if (!writer)
+    {
+        std::fprintf(stderr, "%s\n", writer.error().c_str());
+        return generic_error;
+    }
+
+    const auto end_seed   = arguments.first_seed + arguments.count;
+    const auto start_seed = writer->next_seed();
+    if (start_seed > arguments.first_seed)
+    {
+        std::printf("Resuming %s at seed %llu\n",
+                    arguments.output.string().c_str(),
+                    static_cast<unsigned long long>(start_seed));
+    }
+
+    auto       records = std::vector<deal_record>(arguments.chunk_size);
+    const auto start   = std::chrono::steady_clock::now();
+    for (auto seed = start_seed; seed < end_seed; seed += records.size())
+    {
+        records.resize(std::min<std::uint64_t>(arguments.chunk_size, end_seed - seed));
+
+        const auto chunk_start = std::chrono::steady_clock::now();
+        analyse_deals(
+            seed, arguments.draw_count, arguments.options, arguments.worker_count, records);
+        if (auto result = writer->append_chunk(records); !result)
+        {
+            std::fprintf(stderr, "%s\n", result.error().c_str());
+            return generic_error;
+        }
+
+        std::printf("Seeds %llu-%llu: %.1f deals/s (%.1f overall)\n",
+                    static_cast<unsigned long long>(seed),
+                    static_cast<unsigned long long>(seed + records.size() - 1),
+                    records.size() / seconds_since(chunk_start),
+                    (seed + records.size() - start_seed) / seconds_since(start));
+    }
+
+    auto all_records = read_deal_stats(arguments.output);
+    if (!all_records)
+    {
+        std::fprintf(stderr, "%s\n", all_records.error().c_str());
+        return generic_error;
+    }
+    print_summary(all_records.value());
+    return no_error;
+}
+
+void print_usage()
+{
+    std::fprintf(stderr,
+                 "Usage: solitaire_deals [--out FILE] [--first-seed N] [--count N] [--draw 1|3]\n"
+                 "                       [--threads N] [--chunk N] [--nodes N] [--memory MB]\n"
+                 "       solitaire_deals --summary FILE\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    auto arguments = deals_arguments{};
+    for (auto i = 1; i < argc; ++i)
+    {
+        const auto argument = std::string_view(argv[i]);
+        const auto has_next = i + 1 < argc;
+        if (argument == "--summary" && has_next)
+        {
+            arguments.summary_only = true;
+            arguments.output       = argv[++i];
+        }
+        else if (argument == "--out" && has_next)
+        {
+            arguments.output = argv[++i];
+        }
+        else if (argument == "--first-seed" && has_next)
+        {
+            arguments.first_seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--count" && has_next)
+        {
+            arguments.count = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--draw" && has_next)
+        {
+            arguments.draw_count = std::uint8_t(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (argument == "--threads" && has_next)
+        {
+            arguments.worker_count = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--chunk" && has_next)
+        {
+            arguments.chunk_size = std::max<std::size_t>(std::strtoul(argv[++i], nullptr, 10), 1);
+        }
+        else if (argument == "--nodes" && has_next)
+        {
+            arguments.options.node_limit = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--memory" && has_next)
+        {
+            arguments.options.memory_budget = std::strtoull(argv[++i], nullptr, 10) << 20;
+        }
+        else
+        {
+            print_usage();
+            return generic_error;
+        }
+    }
+
+    if (arguments.summary_only)
+    {
+        auto records = read_deal_stats(arguments.output);
+        if (!records)
+        {
+            std::fprintf(stderr, "%s\n", records.error().c_str());
+            return generic_error;
+        }
+        print_summary(records.value());
+        return no_error;
+    }
+    if (arguments.draw_count != 1 && arguments.draw_count != 3)
+    {
+        print_usage();
+        return generic_error;
+    }
+    return generate_deals(arguments);
+}
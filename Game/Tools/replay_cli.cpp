@@ -0,0 +1,263 @@
+#include "replay.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+constexpr auto generic_error = 1;
+constexpr auto no_error      = 0;
+
+namespace {
+
+struct replay_arguments
+{
+    std::vector<std::filesystem::path> inputs;
+    std::optional<std::uint64_t>       seek_step;
+    std::filesystem::path              record_directory;
+    std::uint64_t                      first_seed = 1;
+    std::uint64_t                      count      = 1000;
+    std::int32_t                       length     = 300; // Actions per generated session
+    std::uint32_t                      repeat     = 1;   // Verification passes, for timing
+};
+
+auto seconds_since(std::chrono::steady_clock::time_point start) -> double
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Random play with undos, redos and pointer input, as a stand-in for real sessions
+auto record_session(const std::filesystem::path& path, std::uint64_t seed, std::int32_t length)
+    -> std::expected<void, error_message_t>
+{
+    const auto draw_count = std::uint8_t(seed % 2 == 0 ? 3 : 1);
+    auto       writer     = replay_writer::create(path, seed, draw_count, 0);
+    if (!writer)
+    {
+        return std::unexpected(writer.error());
+    }
+
+    auto history = move_history(writer->state());
+    auto moves   = move_list{};
+    auto random  = seed * 0x9E3779B97F4A7C15ull;
+    auto next    = [&random] {
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+        return random;
+    };
+    auto time = std::uint32_t(0);
+    for (auto action = 0; action < length; ++action)
+    {
+        time += std::uint32_t(next() % 800);
+        const auto roll = next() % 10;
+        generate_moves(history.state(), moves);
+        if (roll < 6 && moves.size > 0)
+        {
+            history.apply(moves[next() % moves.size]);
+            writer->record_move(time, history.move_at(history.position() - 1));
+        }
+        else if (roll < 7 && history.undo())
+        {
+            writer->record_undo(time, history.move_at(history.position()));
+        }
+        else if (roll < 8 && history.redo())
+        {
+            writer->record_redo(time, history.move_at(history.position() - 1));
+        }
+        else
+        {
+            writer->record_pointer(
+                time, replay_event_kind::pointer_move, float(next() % 1400), float(next() % 1000));
+        }
+    }
+    return writer->finish();
+}
+
+auto record_sessions(const replay_arguments& arguments) -> int
+{
+    std::error_code error;
+    std::filesystem::create_directories(arguments.record_directory, error);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (auto seed = arguments.first_seed; seed < arguments.first_seed + arguments.count; ++seed)
+    {
+        const auto name = "session_" + std::to_string(seed) + ".replay";
+        if (auto result = record_session(arguments.record_directory / name, seed, arguments.length);
+            !result)
+        {
+            std::fprintf(stderr, "%s\n", result.error().c_str());
+            return generic_error;
+        }
+    }
+    std::printf("Recorded %llu sessions in %.3f s\n",
+                static_cast<unsigned long long>(arguments.count),
+                seconds_since(start));
+    return no_error;
+}
+
+// Every .replay file in the directories given, and the files given directly
+auto collect_inputs(const std::vector<std::filesystem::path>& inputs)
+    -> std::vector<std::filesystem::path>
+{
+    auto files = std::vector<std::filesystem::path>();
+    for (const auto& input : inputs)
+    {
+        if (!std::filesystem::is_directory(input))
+        {
+            files.push_back(input);
+            continue;
+        }
+        for (const auto& entry : std::filesystem::directory_iterator(input))
+        {
+            if (entry.is_regular_file() && entry.path().extension() == ".replay")
+            {
+                files.push_back(entry.path());
+            }
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+auto seek_replays(const std::vector<std::filesystem::path>& files, std::uint64_t step) -> int
+{
+    auto result = no_error;
+    for (const auto& file : files)
+    {
+        auto replay = replay_reader::open(file);
+        if (!replay)
+        {
+            std::fprintf(stderr, "%s\n", replay.error().c_str());
+            result = generic_error;
+            continue;
+        }
+        const auto state = replay->state_at(step);
+        std::printf("%s: step %llu of %llu, position %016llx\n",
+                    file.string().c_str(),
+                    static_cast<unsigned long long>(std::min(step, replay->step_count())),
+                    static_cast<unsigned long long>(replay->step_count()),
+                    static_cast<unsigned long long>(state.hash));
+    }
+    return result;
+}
+
+auto verify_replays(const std::vector<std::filesystem::path>& files, std::uint32_t repeat) -> int
+{
+    auto failures = std::uint64_t(0);
+    auto steps    = std::uint64_t(0);
+    auto won      = std::uint64_t(0);
+    auto checked  = std::uint64_t(0);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (auto pass = 0u; pass < repeat; ++pass)
+    {
+        for (const auto& file : files)
+        {
+            ++checked;
+            auto replay  = replay_reader::open(file);
+            auto summary = replay ? verify_replay(replay.value())
+                                  : std::unexpected(replay.error());
+            if (!summary)
+            {
+                // Report each bad file once, not once per pass
+                if (pass == 0)
+                {
+                    std::fprintf(
+                        stderr, "%s: %s\n", file.string().c_str(), summary.error().c_str());
+                }
+                ++failures;
+                continue;
+            }
+            steps += summary->steps;
+            won += summary->won ? 1 : 0;
+        }
+    }
+    const auto elapsed = seconds_since(start);
+
+    std::printf("%llu replays, %llu failed, %llu won; %llu steps in %.3f s "
+                "(%.0f replays/s, %.0f steps/s)\n",
+                static_cast<unsigned long long>(checked),
+                static_cast<unsigned long long>(failures),
+                static_cast<unsigned long long>(won),
+                static_cast<unsigned long long>(steps),
+                elapsed,
+                checked / std::max(elapsed, 1e-9),
+                steps / std::max(elapsed, 1e-9));
+    return failures == 0 ? no_error : generic_error;
+}
+
+void print_usage()
+{
+    std::fprintf(stderr,
+                 "Usage: solitaire_replay [--repeat N] FILE|DIR...\n"
+                 "       solitaire_replay --seek STEP FILE|DIR...\n"
+                 "       solitaire_replay --record DIR [--first-seed N] [--count N] "
+                 "[--length N]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    auto arguments = replay_arguments{};
+    for (auto i = 1; i < argc; ++i)
+    {
+        const auto argument = std::string_view(argv[i]);
+        const auto has_next = i + 1 < argc;
+        if (argument == "--seek" && has_next)
+        {
+            arguments.seek_step = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--record" && has_next)
+        {
+            arguments.record_directory = argv[++i];
+        }
+        else if (argument == "--first-seed" && has_next)
+        {
+            arguments.first_seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--count" && has_next)
+        {
+            arguments.count = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--length" && has_next)
+        {
+            arguments.length = std::int32_t(std::strtol(argv[++i], nullptr, 10));
+        }
+        else if (argument == "--repeat" && has_next)
+        {
+            arguments.repeat = std::max<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10), 1);
+        }
+        else if (!argument.starts_with("--"))
+        {
+            arguments.inputs.emplace_back(argument);
+        }
+        else
+        {
+            print_usage();
+            return generic_error;
+        }
+    }
+
+    if (!arguments.record_directory.empty())
+    {
+        return record_sessions(arguments);
+    }
+    if (arguments.inputs.empty())
+    {
+        print_usage();
+        return generic_error;
+    }
+
+    const auto files = collect_inputs(arguments.inputs);
+    if (arguments.seek_step)
+    {
+        return seek_replays(files, *arguments.seek_step);
+    }
+    return verify_replays(files, arguments.repeat);
+}
@@ -0,0 +1,192 @@
+#include "solver.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+
+constexpr auto generic_error = 1;
+constexpr auto no_error      = 0;
+
+namespace {
+
+struct solver_arguments
+{
+    std::uint64_t  seed       = 1;
+    std::uint8_t   draw_count = 1;
+    solver_options options    = {.node_limit = 20'000'000};
+    bool           benchmark  = false;
+    std::uint32_t  seed_count = 32; // Deals per thread count in benchmark mode
+};
+
+auto pile_name(std::uint8_t pile) -> std::string
+{
+    if (is_tableau(pile))
+    {
+        return "tableau " + std::to_string(pile + 1);
+    }
+    if (is_foundation(pile))
+    {
+        return "foundation " + std::to_string(pile - pile_foundation + 1);
+    }
+    return pile == pile_waste ? "waste" : "stock";
+}
+
+auto status_name(solve_status status) -> const char*
+{
+    switch (status)
+    {
+    case solve_status::solved: return "winnable";
+    case solve_status::unsolvable: return "unwinnable";
+    default: return "unknown";
+    }
+}
+
+auto seconds_since(std::chrono::steady_clock::time_point start) -> double
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+auto solve_one(const solver_arguments& arguments) -> int
+{
+    const auto start  = std::chrono::steady_clock::now();
+    const auto deal   = deal_klondike(shuffle_deck(arguments.seed), arguments.draw_count);
+    const auto result = solve_klondike(deal, arguments.options);
+
+    std::printf("Seed %llu (draw %u): %s, %llu positions in %.3f s\n",
+                static_cast<unsigned long long>(arguments.seed),
+                arguments.draw_count,
+                status_name(result.status),
+                static_cast<unsigned long long>(result.nodes),
+                seconds_since(start));
+    for (auto index = std::size_t(0); index < result.moves.size(); ++index)
+    {
+        const auto& move = result.moves[index];
+        std::printf("%4zu: %s -> %s (%u)\n",
+                    index + 1,
+                    pile_name(move.from).c_str(),
+                    pile_name(move.to).c_str(),
+                    move.count);
+    }
+    return no_error;
+}
+
+/// Solves a fixed seed set with 1, 2, 4, ... threads up to every hardware thread and reports
+/// solves/second and the speed-up over one thread
+auto run_benchmark(const solver_arguments& arguments) -> int
+{
+    const auto hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    auto       thread_counts    = std::vector<std::size_t>();
+    for (auto count = std::size_t(1); count < hardware_threads; count *= 2)
+    {
+        thread_counts.push_back(count);
+    }
+    thread_counts.push_back(hardware_threads);
+
+    std::printf("%u deals from seed %llu, draw %u, %llu position limit per deal\n",
+                arguments.seed_count,
+                static_cast<unsigned long long>(arguments.seed),
+                arguments.draw_count,
+                static_cast<unsigned long long>(arguments.options.node_limit));
+
+    // One table for every solve, so the timings measure searching rather than allocating and
+    // zeroing a fresh table per deal
+    auto table                 = transposition_table(arguments.options.memory_budget);
+    auto single_thread_seconds = 0.0;
+    for (const auto thread_count : thread_counts)
+    {
+        auto options         = arguments.options;
+        options.thread_count = thread_count;
+        options.table        = &table;
+
+        auto       counts = std::array<std::uint32_t, 3>();
+        auto       nodes  = std::uint64_t(0);
+        const auto start  = std::chrono::steady_clock::now();
+        for (auto seed = arguments.seed; seed < arguments.seed + arguments.seed_count; ++seed)
+        {
+            const auto deal   = deal_klondike(shuffle_deck(seed), arguments.draw_count);
+            const auto result = solve_klondike(deal, options);
+            ++counts[std::size_t(result.status)];
+            nodes += result.nodes;
+        }
+        const auto seconds = seconds_since(start);
+        if (thread_count == 1)
+        {
+            single_thread_seconds = seconds;
+        }
+
+        std::printf("%3zu threads: %8.2f solves/s %7.2f M positions/s  x%.2f  "
+                    "(%u winnable, %u unwinnable, %u unknown)\n",
+                    thread_count,
+                    arguments.seed_count / seconds,
+                    nodes / seconds / 1e6,
+                    single_thread_seconds / seconds,
+                    counts[std::size_t(solve_status::solved)],
+                    counts[std::size_t(solve_status::unsolvable)],
+                    counts[std::size_t(solve_status::unknown)]);
+    }
+    return no_error;
+}
+
+void print_usage()
+{
+    std::fprintf(stderr,
+                 "Usage: solitaire_solver [--seed N] [--draw 1|3] [--threads N] [--memory MB]\n"
+                 "                        [--nodes N] [--bench [--seeds N]]\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    auto arguments = solver_arguments{};
+    for (auto i = 1; i < argc; ++i)
+    {
+        const auto argument = std::string_view(argv[i]);
+        const auto has_next = i + 1 < argc;
+        if (argument == "--bench")
+        {
+            arguments.benchmark = true;
+        }
+        else if (argument == "--seed" && has_next)
+        {
+            arguments.seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--seeds" && has_next)
+        {
+            arguments.seed_count = std::uint32_t(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (argument == "--draw" && has_next)
+        {
+            arguments.draw_count = std::uint8_t(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (argument == "--threads" && has_next)
+        {
+            arguments.options.thread_count = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (argument == "--memory" && has_next)
+        {
+            arguments.options.memory_budget = std::strtoull(argv[++i], nullptr, 10) << 20;
+        }
+        else if (argument == "--nodes" && has_next)
+        {
+            arguments.options.node_limit = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else
+        {
+            print_usage();
+            return generic_error;
+        }
+    }
+    if (arguments.draw_count != 1 && arguments.draw_count != 3)
+    {
+        print_usage();
+        return generic_error;
+    }
+
+    return arguments.benchmark ? run_benchmark(arguments) : solve_one(arguments);
+}
@@ -0,0 +1,342 @@
+#include "asset_pack.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <numeric>
+#include <ranges>
+#include <unordered_set>
+
+namespace {
+
+auto align_up(std::uint64_t value, std::uint64_t alignment) -> std::uint64_t
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+auto write_time_of(const std::filesystem::path& path, std::error_code& error) -> std::int64_t
+{
+    return std::int64_t(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+}
+
+} // namespace
+
+asset_pack::asset_pack(std::filesystem::path path, std::shared_ptr<mapped_file> file)
+    : path_(std::move(path))
+    , file_(std::move(file))
+{
+    const auto* header = reinterpret_cast<const asset_pack_header*>(file_->data());
+    const auto* first  = reinterpret_cast<const asset_pack_entry*>(header + 1);
+    entries_           = {first, header->entry_count};
+    names_             = reinterpret_cast<const char*>(first + header->entry_count);
+}
+
+auto asset_pack::open(const std::filesystem::path& path)
+    -> std::expected<asset_pack, error_message_t>
+{
+    auto file = map_file(path);
+    if (!file)
+    {
+        return std::unexpected(file.error());
+    }
+
+    const auto& mapping = *file.value();
+    if (mapping.size() < sizeof(asset_pack_header))
+    {
+        return std::unexpected("Asset pack is truncated: " + path.string());
+    }
+    const auto* header = reinterpret_cast<const asset_pack_header*>(mapping.data());
+    if (header->magic != asset_pack_magic || header->version != asset_pack_version)
+    {
+        return std::unexpected("Asset pack has an unknown format: " + path.string());
+    }
+
+    // Counts are checked before they are multiplied, so a corrupt one cannot overflow
+    const auto names_offset =
+        sizeof(asset_pack_header) + std::uint64_t(header->entry_count) * sizeof(asset_pack_entry);
+    if (header->entry_count > mapping.size() / sizeof(asset_pack_entry) ||
+        names_offset + header->names_size > mapping.size())
+    {
+        return std::unexpected("Asset pack is corrupt: " + path.string());
+    }
+
+    auto pack = asset_pack(path, std::move(file.value()));
+    for (const auto& entry : pack.entries_)
+    {
+        if (entry.offset % asset_pack_alignment != 0 || entry.offset > mapping.size() ||
+            entry.size > mapping.size() - entry.offset ||
+            std::uint64_t(entry.name_offset) + entry.name_length > header->names_size)
+        {
+            return std::unexpected("Asset pack is corrupt: " + path.string());
+        }
+    }
+    if (!std::ranges::is_sorted(pack.entries_, {}, &asset_pack_entry::hash))
+    {
+        return std::unexpected("Asset pack table of contents is not sorted: " + path.string());
+    }
+    return pack;
+}
+
+auto asset_pack::find(std::string_view name) const -> const asset_pack_entry*
+{
+    const auto hash = asset_name_hash(name);
+    for (auto it = std::ranges::lower_bound(entries_, hash, {}, &asset_pack_entry::hash);
+         it != entries_.end() && it->hash == hash;
+         ++it)
+    {
+        // Equal hashes from different names only cost another compare
+        if (this->name(*it) == name)
+        {
+            return &*it;
+        }
+    }
+    return nullptr;
+}
+
+auto asset_pack::name(const asset_pack_entry& entry) const -> std::string_view
+{
+    return {names_ + entry.name_offset, entry.name_length};
+}
+
+auto asset_pack::bytes(const asset_pack_entry& entry) const -> std::span<const std::byte>
+{
+    return file_->bytes().subspan(entry.offset, entry.size);
+}
+
+asset_file_system::asset_file_system(std::optional<asset_pack>          pack,
+                                     std::vector<std::filesystem::path> loose_roots,
+                                     asset_lookup                       lookup)
+    : pack_(std::move(pack))
+    , loose_roots_(std::move(loose_roots))
+    , lookup_(lookup)
+{
+    if (pack_)
+    {
+        root_ = pack_->path().parent_path();
+    }
+    else
+    {
+        root_ = loose_roots_.empty() ? std::filesystem::current_path() : loose_roots_.front();
+    }
+}
+
+auto asset_file_system::read_pack(std::string_view name) const -> std::optional<asset_view>
+{
+    if (!pack_)
+    {
+        return std::nullopt;
+    }
+    const auto* entry = pack_->find(name);
+    if (entry == nullptr)
+    {
+        return std::nullopt;
+    }
+    return asset_view{pack_->bytes(*entry), pack_->file(), true};
+}
+
+auto asset_file_system::read_loose(std::string_view name) const -> std::optional<asset_view>
+{
+    // Opening is the existence check; a root without the file costs one failed open
+    for (const auto& root : loose_roots_)
+    {
+        if (auto file = map_file(root / name); file.has_value())
+        {
+            const auto bytes = file.value()->bytes();
+            return asset_view{bytes, std::move(file.value()), false};
+        }
+    }
+    return std::nullopt;
+}
+
+auto asset_file_system::read(std::string_view name) const
+    -> std::expected<asset_view, error_message_t>
+{
+    auto view = lookup_ == asset_lookup::pack_first ? read_pack(name) : read_loose(name);
+    if (!view)
+    {
+        view = lookup_ == asset_lookup::pack_first ? read_loose(name) : read_pack(name);
+    }
+    if (!view)
+    {
+        return std::unexpected("Asset not found in the pack or on disk: " + std::string(name));
+    }
+    return std::move(view.value());
+}
+
+auto asset_file_system::stamp(std::string_view name) const
+    -> std::expected<asset_stamp, error_message_t>
+{
+    const auto* entry = pack_ ? pack_->find(name) : nullptr;
+    const auto  loose = entry == nullptr || lookup_ == asset_lookup::loose_first
+                            ? loose_path(name)
+                            : std::nullopt;
+    if (loose)
+    {
+        auto error      = std::error_code();
+        auto size       = std::filesystem::file_size(loose.value(), error);
+        auto write_time = write_time_of(loose.value(), error);
+        if (!error)
+        {
+            return asset_stamp{std::uint64_t(size), write_time};
+        }
+    }
+    if (entry != nullptr)
+    {
+        return asset_stamp{entry->size, entry->write_time};
+    }
+    return std::unexpected("Asset not found in the pack or on disk: " + std::string(name));
+}
+
+auto asset_file_system::loose_path(std::string_view name) const
+    -> std::optional<std::filesystem::path>
+{
+    for (const auto& root : loose_roots_)
+    {
+        auto path = root / name;
+        if (std::filesystem::is_regular_file(path))
+        {
+            return path;
+        }
+    }
+    return std::nullopt;
+}
+
+auto asset_name_hash(std::string_view name) -> std::uint64_t
+{
+    auto hash = std::uint64_t(0xCBF29CE484222325ull);
+    for (const auto c : name)
+    {
+        hash = (hash ^ std::uint8_t(c)) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+auto write_asset_pack(const std::filesystem::path& path, std::span<const asset_pack_source> sources)
+    -> std::expected<void, error_message_t>
+{
+    auto seen = std::unordered_set<std::string_view>();
+    for (const auto& source : sources)
+    {
+        if (!seen.insert(source.name).second)
+        {
+            return std::unexpected("Asset is packed twice: " + source.name);
+        }
+    }
+
+    // Table of contents in hash order; names stay in source order
+    auto order = std::vector<std::size_t>(sources.size());
+    std::iota(order.begin(), order.end(), std::size_t(0));
+    std::ranges::stable_sort(order, {}, [&](std::size_t i) {
+        return asset_name_hash(sources[i].name);
+    });
+
+    auto name_offsets = std::vector<std::uint32_t>(sources.size());
+    auto names        = std::string();
+    for (auto i = std::size_t(0); i < sources.size(); ++i)
+    {
+        name_offsets[i] = std::uint32_t(names.size());
+        names += sources[i].name;
+    }
+
+    auto entries = std::vector<asset_pack_entry>();
+    auto offset  = align_up(sizeof(asset_pack_header) +
+                               sources.size() * sizeof(asset_pack_entry) + names.size(),
+                           asset_pack_alignment);
+    for (const auto i : order)
+    {
+        auto error      = std::error_code();
+        auto size       = std::filesystem::file_size(sources[i].path, error);
+        auto write_time = write_time_of(sources[i].path, error);
+        if (error)
+        {
+            return std::unexpected("Failed to stat " + sources[i].path.string() + ": " +
+                                   error.message());
+        }
+        entries.push_back({asset_name_hash(sources[i].name),
+                           offset,
+                           std::uint64_t(size),
+                           write_time,
+                           name_offsets[i],
+                           std::uint32_t(sources[i].name.size())});
+        offset = align_up(offset + size, asset_pack_alignment);
+    }
+
+    auto directory_error = std::error_code();
+    std::filesystem::create_directories(path.parent_path(), directory_error);
+
+    // Write to a temporary file and rename, so a running game never maps a half-written pack
+    auto temporary_path = path;
+    temporary_path += ".tmp";
+    {
+        auto out = std::ofstream(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            return std::unexpected("Failed to create asset pack: " + temporary_path.string());
+        }
+
+        const auto header = asset_pack_header{asset_pack_magic,
+                                              asset_pack_version,
+                                              std::uint32_t(entries.size()),
+                                              std::uint32_t(names.size())};
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(entries.data()),
+                  std::streamsize(entries.size() * sizeof(asset_pack_entry)));
+        out.write(names.data(), std::streamsize(names.size()));
+
+        for (auto e = std::size_t(0); e < entries.size(); ++e)
+        {
+            const auto& source = sources[order[e]];
+            auto        file   = map_file(source.path);
+            if (!file || file.value()->size() != entries[e].size)
+            {
+                return std::unexpected("Asset changed while packing: " + source.path.string());
+            }
+            const auto padding = std::string(entries[e].offset - std::uint64_t(out.tellp()), '\0');
+            out.write(padding.data(), std::streamsize(padding.size()));
+            out.write(reinterpret_cast<const char*>(file.value()->data()),
+                      std::streamsize(file.value()->size()));
+        }
+        if (!out)
+        {
+            return std::unexpected("Failed to write asset pack: " + temporary_path.string());
+        }
+    }
+
+    auto rename_error = std::error_code();
+    std::filesystem::rename(temporary_path, path, rename_error);
+    if (rename_error)
+    {
+        return std::unexpected("Failed to move asset pack into place: " + rename_error.message());
+    }
+    return {};
+}
+
+auto executable_directory() -> std::filesystem::path
+{
+    auto error      = std::error_code();
+    auto executable = std::filesystem::read_symlink("/proc/self/exe", error);
+    if (error)
+    {
+        return std::filesystem::current_path();
+    }
+    return executable.parent_path();
+}
+
+auto assets() -> asset_file_system&
+{
+    static auto file_system = [] {
+        auto roots = std::vector<std::filesystem::path>{std::filesystem::current_path()};
+        if (auto directory = executable_directory(); directory != roots.front())
+        {
+            roots.push_back(std::move(directory));
+        }
+        for (const auto& directory : std::views::reverse(roots))
+        {
+            if (auto pack = asset_pack::open(directory / asset_pack_file_name); pack.has_value())
+            {
+                return asset_file_system(std::move(pack.value()), roots);
+            }
+        }
+        return asset_file_system(std::nullopt, roots);
+    }();
+    return file_system;
+}
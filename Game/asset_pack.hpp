@@ -0,0 +1,157 @@
+#ifndef _GAME_ASSET_PACK_HPP__
+#define _GAME_ASSET_PACK_HPP__
+
+#include "mapped_file.hpp"
+#include "types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Every asset the game reads at startup, packed into one file that is mapped once. Laid out as:
+//   asset_pack_header | asset_pack_entry[entry_count] | name bytes | padding | entry data ...
+// The table of contents is sorted by the hash of each name, so a lookup is a binary search over
+// 40-byte entries followed by one name compare. Entry data starts at a multiple of
+// asset_pack_alignment from the start of the file, which makes every entry at least as aligned as
+// anything it holds needs and lets it be handed out as a span of the mapping.
+constexpr auto asset_pack_magic     = std::uint32_t(0x4B415053); // "SPAK"
+constexpr auto asset_pack_version   = std::uint32_t(1);
+constexpr auto asset_pack_alignment = std::uint64_t(64);
+constexpr auto asset_pack_file_name = std::string_view("assets.pack");
+
+struct asset_pack_header
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t entry_count;
+    std::uint32_t names_size; // Bytes of name data after the entry table
+};
+
+struct asset_pack_entry
+{
+    std::uint64_t hash;        // asset_name_hash of the name
+    std::uint64_t offset;      // From the start of the file
+    std::uint64_t size;
+    std::int64_t  write_time;  // Of the source file when packed, so stamps survive packing
+    std::uint32_t name_offset; // Relative to the end of the entry table
+    std::uint32_t name_length;
+};
+
+// Size and modification time of an asset, wherever it was found
+struct asset_stamp
+{
+    std::uint64_t size       = 0;
+    std::int64_t  write_time = 0;
+
+    auto operator==(const asset_stamp&) const -> bool = default;
+};
+
+// A file to put in a pack under `name`
+struct asset_pack_source
+{
+    std::string           name;
+    std::filesystem::path path;
+};
+
+// Read-only view of a pack, straight from a mapping of the file
+class asset_pack
+{
+public:
+    // Maps `path` and checks the header and that every entry lies inside the file
+    static auto open(const std::filesystem::path& path)
+        -> std::expected<asset_pack, error_message_t>;
+
+    auto find(std::string_view name) const -> const asset_pack_entry*;
+    auto entries() const -> std::span<const asset_pack_entry> { return entries_; }
+    auto name(const asset_pack_entry& entry) const -> std::string_view;
+    auto bytes(const asset_pack_entry& entry) const -> std::span<const std::byte>;
+    auto file() const -> const std::shared_ptr<mapped_file>& { return file_; }
+    auto path() const -> const std::filesystem::path& { return path_; }
+
+private:
+    asset_pack(std::filesystem::path path, std::shared_ptr<mapped_file> file);
+
+    std::filesystem::path             path_;
+    std::shared_ptr<mapped_file>      file_;
+    std::span<const asset_pack_entry> entries_;
+    const char*                       names_ = nullptr;
+};
+
+// Bytes of one asset. `file` keeps the mapping they point into alive, so a view can outlive the
+// file system that handed it out.
+struct asset_view
+{
+    std::span<const std::byte>   bytes;
+    std::shared_ptr<mapped_file> file;
+    bool                         from_pack = false;
+
+    auto text() const -> std::string_view
+    {
+        return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+    }
+};
+
+enum class asset_lookup
+{
+    pack_first, // Loose files only fill in what the pack lacks
+    loose_first // Loose files override the pack, for editing assets without repacking
+};
+
+// Resolves asset names such as "Assets/cards.png" to bytes: from the mounted pack without any
+// file system access, or from a loose file under one of the search roots, which is mapped too.
+// Configure it before loading starts; reads may then happen from any thread.
+class asset_file_system
+{
+public:
+    asset_file_system(std::optional<asset_pack>          pack,
+                      std::vector<std::filesystem::path> loose_roots,
+                      asset_lookup                       lookup = asset_lookup::pack_first);
+
+    auto read(std::string_view name) const -> std::expected<asset_view, error_message_t>;
+    auto stamp(std::string_view name) const -> std::expected<asset_stamp, error_message_t>;
+
+    // The first loose copy of `name`, for tools that watch or rewrite sources
+    auto loose_path(std::string_view name) const -> std::optional<std::filesystem::path>;
+
+    // Where caches derived from the assets are kept: next to the pack, else the first loose root
+    auto root() const -> const std::filesystem::path& { return root_; }
+    auto pack() const -> const std::optional<asset_pack>& { return pack_; }
+
+    void set_lookup(asset_lookup lookup) { lookup_ = lookup; }
+
+private:
+    auto read_pack(std::string_view name) const -> std::optional<asset_view>;
+    auto read_loose(std::string_view name) const -> std::optional<asset_view>;
+
+    std::optional<asset_pack>          pack_;
+    std::vector<std::filesystem::path> loose_roots_;
+    std::filesystem::path              root_;
+    asset_lookup                       lookup_;
+};
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+// 64-bit FNV-1a of an asset name
+auto asset_name_hash(std::string_view name) -> std::uint64_t;
+
+// Packs `sources` into `path`; names must be unique
+auto write_asset_pack(const std::filesystem::path& path, std::span<const asset_pack_source> sources)
+    -> std::expected<void, error_message_t>;
+
+// Directory holding the running executable, or the working directory if it cannot be found
+auto executable_directory() -> std::filesystem::path;
+
+// The process-wide asset file system. On first use it mounts assets.pack from the executable's
+// directory, else the working directory, and searches both for loose files, working directory
+// first. The game therefore starts from any directory once the pack sits next to it, and a
+// development checkout without a pack still runs from its loose files.
+auto assets() -> asset_file_system&;
+
+#endif // _GAME_ASSET_PACK_HPP__
@@ -0,0 +1,364 @@
+#include "atlas_cache.hpp"
+#include "texture_compression.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+namespace {
+
+constexpr auto layers_alignment = std::uint64_t(4096);
+constexpr auto level_alignment  = std::uint64_t(16);
+
+auto align_up(std::uint64_t value, std::uint64_t alignment) -> std::uint64_t
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+auto name_entries(const atlas_cache_header* header) -> const atlas_cache_name_entry*
+{
+    return reinterpret_cast<const atlas_cache_name_entry*>(
+        reinterpret_cast<const std::byte*>(header) + header->names_offset);
+}
+
+} // namespace
+
+auto atlas_cache::layer_for_name(std::string_view name) const -> std::optional<std::int32_t>
+{
+    const auto* entries    = name_entries(header_);
+    const auto* name_bytes = reinterpret_cast<const char*>(entries + header_->layer_count);
+    for (auto i = std::uint32_t(0); i < header_->layer_count; ++i)
+    {
+        const auto entry_name =
+            std::string_view(name_bytes + entries[i].name_offset, entries[i].name_length);
+        if (entry_name == name)
+        {
+            return std::int32_t(entries[i].layer);
+        }
+    }
+    return std::nullopt;
+}
+
+auto atlas_cache_path() -> std::filesystem::path
+{
+    return assets().root() / "Assets/cards.atlas";
+}
+
+auto cook_atlas_cache(const std::filesystem::path& cache_path,
+                      atlas_format                 format,
+                      std::size_t                  worker_count)
+    -> std::expected<void, error_message_t>
+{
+    // Stamp the sources before reading them so an edit during cooking invalidates the result
+    auto png_stamp_result = read_source_stamp(card_atlas_png_asset);
+    if (!png_stamp_result)
+    {
+        return std::unexpected(png_stamp_result.error());
+    }
+    auto json_stamp_result = read_source_stamp(card_atlas_json_asset);
+    if (!json_stamp_result)
+    {
+        return std::unexpected(json_stamp_result.error());
+    }
+
+    auto asset_image_result = load_png_data();
+    if (!asset_image_result)
+    {
+        return std::unexpected("Failed to load PNG data: " + asset_image_result.error());
+    }
+    auto sliced_result = slice_atlas(*asset_image_result.value(), worker_count);
+    if (!sliced_result)
+    {
+        return std::unexpected(sliced_result.error());
+    }
+    const auto& sliced = sliced_result.value();
+
+    // Mip chains are independent per layer
+    const auto layer_bytes = std::size_t(sliced.layer_width) * sliced.layer_height * 4;
+    auto       chains      = std::vector<std::vector<mip_level>>(std::size_t(sliced.layer_count()));
+    {
+        auto next_layer = std::atomic<std::size_t>(0);
+        auto workers    = std::vector<std::jthread>();
+        for (auto i = std::size_t(0); i < std::clamp<std::size_t>(worker_count, 1, chains.size());
+             ++i)
+        {
+            workers.emplace_back([&] {
+                for (auto layer = next_layer.fetch_add(1); layer < chains.size();
+                     layer      = next_layer.fetch_add(1))
+                {
+                    chains[layer] = generate_mip_chain(sliced.pixels.data() + layer * layer_bytes,
+                                                       sliced.layer_width,
+                                                       sliced.layer_height);
+                }
+            });
+        }
+    }
+
+    // Level data indexed [level][layer], either raw or block compressed
+    auto level_layers = std::vector<std::vector<std::vector<std::uint8_t>>>();
+    if (format == atlas_format::bc3)
+    {
+        level_layers = encode_bc3_layers(chains, worker_count);
+    }
+    else
+    {
+        level_layers.resize(chains.front().size());
+        for (auto level = std::size_t(0); level < level_layers.size(); ++level)
+        {
+            for (auto& chain : chains)
+            {
+                level_layers[level].push_back(std::move(chain[level].pixels));
+            }
+        }
+    }
+
+    // Build the name table
+    auto entries    = std::vector<atlas_cache_name_entry>();
+    auto name_bytes = std::string();
+    for (auto layer = std::int32_t(0); layer < sliced.layer_count(); ++layer)
+    {
+        const auto& name = sliced.names[layer];
+        entries.push_back({std::uint32_t(name_bytes.size()),
+                           std::uint32_t(name.size()),
+                           std::uint32_t(layer)});
+        name_bytes += name;
+    }
+
+    auto header          = atlas_cache_header{};
+    header.magic         = atlas_cache_magic;
+    header.version       = atlas_cache_version;
+    header.layer_width   = std::uint32_t(sliced.layer_width);
+    header.layer_height  = std::uint32_t(sliced.layer_height);
+    header.layer_count   = std::uint32_t(sliced.layer_count());
+    header.format        = format;
+    header.mip_levels    = std::uint32_t(level_layers.size());
+    header.png_stamp     = png_stamp_result.value();
+    header.json_stamp    = json_stamp_result.value();
+    header.levels_offset = sizeof(atlas_cache_header);
+    header.names_offset  = header.levels_offset + level_layers.size() * sizeof(atlas_cache_level);
+
+    const auto names_end =
+        header.names_offset + entries.size() * sizeof(atlas_cache_name_entry) + name_bytes.size();
+
+    auto levels = std::vector<atlas_cache_level>();
+    auto offset = align_up(names_end, layers_alignment);
+    for (auto level = std::size_t(0); level < level_layers.size(); ++level)
+    {
+        const auto& level_zero = chains.front()[level];
+        const auto  stride     = level_layers[level].front().size();
+        levels.push_back({std::uint32_t(level_zero.width),
+                          std::uint32_t(level_zero.height),
+                          offset,
+                          stride});
+        offset = align_up(offset + stride * entries.size(), level_alignment);
+    }
+
+    // The build no longer copies Assets/ next to the game, so the directory may not exist yet
+    auto directory_error = std::error_code();
+    std::filesystem::create_directories(cache_path.parent_path(), directory_error);
+
+    // Write to a temporary file and rename, so a half-written cache is never picked up
+    auto temporary_path = cache_path;
+    temporary_path += ".tmp";
+    {
+        auto out = std::ofstream(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            return std::unexpected("Failed to create atlas cache: " + temporary_path.string());
+        }
+
+        const auto pad_to = [&out](std::uint64_t position) {
+            const auto padding = std::string(position - std::uint64_t(out.tellp()), '\0');
+            out.write(padding.data(), std::streamsize(padding.size()));
+        };
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(levels.data()),
+                  std::streamsize(levels.size() * sizeof(atlas_cache_level)));
+        out.write(reinterpret_cast<const char*>(entries.data()),
+                  std::streamsize(entries.size() * sizeof(atlas_cache_name_entry)));
+        out.write(name_bytes.data(), std::streamsize(name_bytes.size()));
+        for (auto level = std::size_t(0); level < levels.size(); ++level)
+        {
+            pad_to(levels[level].offset);
+            for (const auto& layer : level_layers[level])
+            {
+                out.write(reinterpret_cast<const char*>(layer.data()),
+                          std::streamsize(layer.size()));
+            }
+        }
+        if (!out.good())
+        {
+            return std::unexpected("Failed to write atlas cache: " + temporary_path.string());
+        }
+    }
+
+    auto rename_error = std::error_code();
+    std::filesystem::rename(temporary_path, cache_path, rename_error);
+    if (rename_error)
+    {
+        return std::unexpected("Failed to move atlas cache into place: " + rename_error.message());
+    }
+
+    return {};
+}
+
+auto open_atlas_cache(const std::filesystem::path& cache_path)
+    -> std::expected<std::shared_ptr<atlas_cache>, error_message_t>
+{
+    auto file_result = map_file(cache_path);
+    if (!file_result)
+    {
+        return std::unexpected(file_result.error());
+    }
+    auto file = file_result.value();
+
+    if (file->size() < sizeof(atlas_cache_header))
+    {
+        return std::unexpected("Atlas cache is truncated: " + cache_path.string());
+    }
+
+    const auto* header = reinterpret_cast<const atlas_cache_header*>(file->data());
+    if (header->magic != atlas_cache_magic || header->version != atlas_cache_version)
+    {
+        return std::unexpected("Atlas cache has an unknown format: " + cache_path.string());
+    }
+    const auto levels_end =
+        header->levels_offset + std::uint64_t(header->mip_levels) * sizeof(atlas_cache_level);
+    if (header->mip_levels == 0 || levels_end > file->size() ||
+        (header->format != atlas_format::rgba8 && header->format != atlas_format::bc3))
+    {
+        return std::unexpected("Atlas cache is corrupt: " + cache_path.string());
+    }
+
+    const auto* levels = reinterpret_cast<const atlas_cache_level*>(file->data() +
+                                                                   header->levels_offset);
+    for (auto level = std::uint32_t(0); level < header->mip_levels; ++level)
+    {
+        const auto width  = std::int32_t(levels[level].width);
+        const auto height = std::int32_t(levels[level].height);
+        const auto stride = header->format == atlas_format::bc3
+                                ? std::uint64_t(bc3_image_size(width, height))
+                                : std::uint64_t(width) * height * 4;
+        if (levels[level].layer_stride != stride ||
+            levels[level].offset + stride * header->layer_count > file->size())
+        {
+            return std::unexpected("Atlas cache is corrupt: " + cache_path.string());
+        }
+    }
+
+    // Stale if cooked for a different atlas layout than the one compiled in
+    if (header->layer_count != atlas_frames.size() ||
+        header->layer_width != std::uint32_t(atlas_frames.front().w) ||
+        header->layer_height != std::uint32_t(atlas_frames.front().h))
+    {
+        return std::unexpected("Atlas cache is stale; it does not match the built-in layout");
+    }
+    const auto names_end =
+        header->names_offset + std::uint64_t(header->layer_count) * sizeof(atlas_cache_name_entry);
+    if (names_end > file->size())
+    {
+        return std::unexpected("Atlas cache is corrupt: " + cache_path.string());
+    }
+    const auto* entries    = name_entries(header);
+    const auto* name_bytes = reinterpret_cast<const char*>(entries + header->layer_count);
+    for (auto i = std::uint32_t(0); i < header->layer_count; ++i)
+    {
+        if (names_end + entries[i].name_offset + entries[i].name_length > file->size() ||
+            entries[i].layer != i ||
+            std::string_view(name_bytes + entries[i].name_offset, entries[i].name_length) !=
+                atlas_frames[i].name)
+        {
+            return std::unexpected("Atlas cache is stale; it does not match the built-in layout");
+        }
+    }
+
+    // Stale if either source changed since cooking
+    auto png_stamp_result  = read_source_stamp(card_atlas_png_asset);
+    auto json_stamp_result = read_source_stamp(card_atlas_json_asset);
+    if (png_stamp_result && png_stamp_result.value() != header->png_stamp)
+    {
+        return std::unexpected("Atlas cache is stale; PNG changed since cooking");
+    }
+    if (json_stamp_result && json_stamp_result.value() != header->json_stamp)
+    {
+        return std::unexpected("Atlas cache is stale; JSON changed since cooking");
+    }
+
+    return std::make_shared<atlas_cache>(std::move(file));
+}
+
+auto read_source_stamp(std::string_view asset_name)
+    -> std::expected<atlas_source_stamp, error_message_t>
+{
+    return assets().stamp(asset_name);
+}
+
+auto slice_atlas(const asset_image& image, std::size_t worker_count)
+    -> std::expected<sliced_atlas, error_message_t>
+{
+    if (!atlas_fits_image(image.width(), image.height()))
+    {
+        return std::unexpected(error_message_t("Atlas frames lie outside the image; the PNG does "
+                                               "not match the layout the game was built with"));
+    }
+
+    auto result         = sliced_atlas{};
+    result.layer_width  = atlas_frames.front().w;
+    result.layer_height = atlas_frames.front().h;
+
+    const auto layer_bytes = std::size_t(result.layer_width) * result.layer_height * 4;
+    result.pixels.resize(layer_bytes * atlas_frames.size());
+
+    for (const auto& frame : atlas_frames)
+    {
+        result.names.emplace_back(frame.name);
+    }
+
+    // Layers are independent; each worker claims the next one until none are left
+    {
+        auto next_layer = std::atomic<std::size_t>(0);
+        auto workers    = std::vector<std::jthread>();
+        for (auto i = std::size_t(0);
+             i < std::clamp<std::size_t>(worker_count, 1, atlas_frames.size());
+             ++i)
+        {
+            workers.emplace_back([&] {
+                for (auto layer = next_layer.fetch_add(1); layer < atlas_frames.size();
+                     layer      = next_layer.fetch_add(1))
+                {
+                    slice_atlas_frame(image,
+                                      atlas_frames[layer],
+                                      result.pixels.data() + layer * layer_bytes);
+                }
+            });
+        }
+    }
+
+    return result;
+}
+
+auto atlas_fits_image(std::int32_t width, std::int32_t height) -> bool
+{
+    return std::ranges::all_of(atlas_frames, [width, height](const atlas_frame& frame) {
+        return frame.x >= 0 && frame.y >= 0 && frame.x + frame.w <= width &&
+               frame.y + frame.h <= height;
+    });
+}
+
+void slice_atlas_frame(const asset_image& image,
+                       const atlas_frame& frame,
+                       std::uint8_t*      destination,
+                       pixel_kernel       kernel)
+{
+    const auto conversion = pixel_conversion{.channels = image.channels(), .premultiply = true};
+    convert_rect(image.stride_of_data_at(std::uint32_t(frame.x), std::uint32_t(frame.y)),
+                 std::size_t(image.width()) * std::size_t(image.channels()),
+                 frame.w,
+                 frame.h,
+                 destination,
+                 conversion,
+                 kernel);
+}
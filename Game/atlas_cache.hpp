@@ -0,0 +1,169 @@
+#ifndef _GAME_ATLAS_CACHE_HPP__
+#define _GAME_ATLAS_CACHE_HPP__
+
+#include "asset_pack.hpp"
+#include "cards.hpp"
+#include "mapped_file.hpp"
+#include "pixel_convert.hpp"
+#include "types.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Cooked form of Assets/cards.png + Assets/cards.json. The file is laid out as:
+//   atlas_cache_header | atlas_cache_level[mip_levels] | atlas_cache_name_entry[layer_count] |
+//   name bytes | padding | level 0 layers | level 1 layers | ...
+// Within a level the layers sit back to back, so each level can be handed to a single
+// glTexSubImage3D/glCompressedTexSubImage3D straight from the mapping. Level 0 starts on a
+// page boundary.
+constexpr auto atlas_cache_magic   = std::uint32_t(0x4C544153); // "SATL"
+constexpr auto atlas_cache_version = std::uint32_t(3);          // 3: colour premultiplied by alpha
+
+// Pixel encoding of every level in the cache
+enum class atlas_format : std::uint32_t
+{
+    rgba8 = 0, // Tightly packed RGBA8
+    bc3   = 1  // S3TC DXT5 blocks, see texture_compression.hpp
+};
+
+// Size and modification time of a source asset at cook time
+using atlas_source_stamp = asset_stamp;
+
+struct atlas_cache_header
+{
+    std::uint32_t      magic;
+    std::uint32_t      version;
+    std::uint32_t      layer_width;
+    std::uint32_t      layer_height;
+    std::uint32_t      layer_count;
+    atlas_format       format;
+    std::uint32_t      mip_levels;
+    std::uint32_t      reserved;
+    atlas_source_stamp png_stamp;
+    atlas_source_stamp json_stamp;
+    std::uint64_t      levels_offset;
+    std::uint64_t      names_offset;
+};
+
+struct atlas_cache_level
+{
+    std::uint32_t width;
+    std::uint32_t height;
+    std::uint64_t offset;       // From the start of the file
+    std::uint64_t layer_stride; // Bytes of one layer at this level
+};
+
+struct atlas_cache_name_entry
+{
+    std::uint32_t name_offset; // Relative to the end of the entry table
+    std::uint32_t name_length;
+    std::uint32_t layer;
+};
+
+// Atlas frames cut out into contiguous premultiplied RGBA8 layers, in atlas_frames order
+struct sliced_atlas
+{
+    std::int32_t              layer_width  = 0;
+    std::int32_t              layer_height = 0;
+    std::vector<std::string>  names;
+    std::vector<std::uint8_t> pixels;
+
+    auto layer_count() const -> std::int32_t { return static_cast<std::int32_t>(names.size()); }
+};
+
+// Read-only view of a cooked cache file
+class atlas_cache
+{
+public:
+    atlas_cache(std::shared_ptr<mapped_file> file)
+        : file_(std::move(file))
+        , header_(reinterpret_cast<const atlas_cache_header*>(file_->data()))
+    {
+    }
+
+    auto layer_width() const -> std::int32_t { return std::int32_t(header_->layer_width); }
+    auto layer_height() const -> std::int32_t { return std::int32_t(header_->layer_height); }
+    auto layer_count() const -> std::int32_t { return std::int32_t(header_->layer_count); }
+    auto format() const -> atlas_format { return header_->format; }
+    auto mip_levels() const -> std::int32_t { return std::int32_t(header_->mip_levels); }
+
+    auto level(std::int32_t level) const -> const atlas_cache_level&
+    {
+        return reinterpret_cast<const atlas_cache_level*>(file_->data() +
+                                                          header_->levels_offset)[level];
+    }
+
+    // Every layer of a level back to back, ready for a single 3D texture upload
+    auto level_data(std::int32_t level) const -> const std::byte*
+    {
+        return file_->data() + this->level(level).offset;
+    }
+    auto level_size(std::int32_t level) const -> std::size_t
+    {
+        return std::size_t(header_->layer_count) * this->level(level).layer_stride;
+    }
+    auto level_layer_data(std::int32_t level, std::int32_t layer) const -> const std::byte*
+    {
+        return level_data(level) + std::size_t(layer) * this->level(level).layer_stride;
+    }
+
+    // Level 0 shortcuts
+    auto layers_data() const -> const std::byte* { return level_data(0); }
+    auto layer_data(std::int32_t layer) const -> const std::byte*
+    {
+        return level_layer_data(0, layer);
+    }
+    auto layers_size() const -> std::size_t { return level_size(0); }
+
+    auto layer_for_name(std::string_view name) const -> std::optional<std::int32_t>;
+
+private:
+    std::shared_ptr<mapped_file> file_;
+    const atlas_cache_header*    header_;
+};
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+// Next to the asset pack, so the cooked cache is found from any working directory
+auto atlas_cache_path() -> std::filesystem::path;
+
+// Decodes the PNG, slices it along atlas_frames, builds every layer's mip chain and writes the
+// cooked cache to `cache_path`. Slicing and encoding are spread over `worker_count` threads.
+auto cook_atlas_cache(const std::filesystem::path& cache_path,
+                      atlas_format                 format       = atlas_format::rgba8,
+                      std::size_t                  worker_count = 1)
+    -> std::expected<void, error_message_t>;
+
+// Maps the cache and validates it against the current PNG/JSON stamps and the atlas layout the
+// game was built with
+auto open_atlas_cache(const std::filesystem::path& cache_path)
+    -> std::expected<std::shared_ptr<atlas_cache>, error_message_t>;
+
+// Stamp of a source asset, from the pack entry or the loose file that would be loaded
+auto read_source_stamp(std::string_view asset_name)
+    -> std::expected<atlas_source_stamp, error_message_t>;
+
+// Cuts every frame of atlas_frames out of the atlas image into its own layer, spreading the
+// layers over `worker_count` threads
+auto slice_atlas(const asset_image& image, std::size_t worker_count = 1)
+    -> std::expected<sliced_atlas, error_message_t>;
+
+// Whether every frame of atlas_frames lies inside an atlas image of this size
+auto atlas_fits_image(std::int32_t width, std::int32_t height) -> bool;
+
+// Copies one frame into `destination` as tightly packed RGBA8 (w * h * 4 bytes), whatever the
+// channel count of the PNG, with colour premultiplied by alpha so that filtering and mipmapping
+// do not bleed the colour of transparent texels into the card edges
+void slice_atlas_frame(const asset_image& image,
+                       const atlas_frame& frame,
+                       std::uint8_t*      destination,
+                       pixel_kernel       kernel = best_pixel_kernel());
+
+#endif // _GAME_ATLAS_CACHE_HPP__
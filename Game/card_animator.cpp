@@ -0,0 +1,238 @@
+#include "card_animator.hpp"
+
+#include <algorithm>
+
+namespace {
+
+// Penner's easeOutBounce: four parabolic arcs, each a quarter as high as the one before
+constexpr auto bounce_scale  = 7.5625f;
+constexpr auto bounce_period = 2.75f;
+
+// Smallest duration a tween can have, so the inverse stays finite
+constexpr auto min_duration = 1.0e-4f;
+
+} // namespace
+
+auto ease_card(card_easing easing, float t) -> std::pair<float, float>
+{
+    switch (easing)
+    {
+    case card_easing::ease_out_cubic:
+    {
+        const auto u     = 1.0f - t;
+        const auto eased = 1.0f - u * u * u;
+        return {eased, eased};
+    }
+    case card_easing::ease_in_out_cubic:
+    {
+        const auto u     = 2.0f - 2.0f * t;
+        const auto eased = t < 0.5f ? 4.0f * t * t * t : 1.0f - u * u * u * 0.5f;
+        return {eased, eased};
+    }
+    case card_easing::bounce:
+    {
+        // Start and height of the arc `t` is on
+        auto arc = 0.0f, base = 0.0f;
+        if (t >= 2.5f / bounce_period)
+        {
+            arc = 2.625f / bounce_period, base = 0.984375f;
+        }
+        else if (t >= 2.0f / bounce_period)
+        {
+            arc = 2.25f / bounce_period, base = 0.9375f;
+        }
+        else if (t >= 1.0f / bounce_period)
+        {
+            arc = 1.5f / bounce_period, base = 0.75f;
+        }
+        const auto u = t - arc;
+        return {t, bounce_scale * u * u + base};
+    }
+    case card_easing::linear:
+    default: return {t, t};
+    }
+}
+
+void card_animator::add(const card_tween& tween)
+{
+    if (count_ == 0)
+    {
+        epoch_ = tween.start;
+    }
+    if (count_ == blocks_.size() * lanes)
+    {
+        blocks_.emplace_back(); // Value-initialised: zero inverse durations, never done
+    }
+
+    auto&      b             = blocks_[count_ / lanes];
+    const auto lane          = count_ % lanes;
+    b.from_x[lane]           = tween.from_x;
+    b.from_y[lane]           = tween.from_y;
+    b.delta_x[lane]          = tween.to_x - tween.from_x;
+    b.delta_y[lane]          = tween.to_y - tween.from_y;
+    b.start[lane]            = float(tween.start - epoch_);
+    b.inverse_duration[lane] = 1.0f / std::max(tween.duration, min_duration);
+    b.easing[lane]           = std::int32_t(tween.easing);
+    b.index[lane]            = tween.index;
+    b.face_up[lane]          = tween.face_up ? 1 : 0;
+    b.x[lane]                = tween.from_x;
+    b.y[lane]                = tween.from_y;
+    b.done[lane]             = 0;
+    ++count_;
+
+    if (tween.index >= 0 && tween.index < 64)
+    {
+        animating_layers_ |= std::uint64_t(1) << tween.index;
+    }
+}
+
+void card_animator::clear()
+{
+    blocks_.clear();
+    count_            = 0;
+    animating_layers_ = 0;
+}
+
+void card_animator::move_lane(std::size_t from, std::size_t to)
+{
+    const auto& source = blocks_[from / lanes];
+    auto&       target = blocks_[to / lanes];
+    const auto  s      = from % lanes;
+    const auto  t      = to % lanes;
+
+    target.from_x[t]           = source.from_x[s];
+    target.from_y[t]           = source.from_y[s];
+    target.delta_x[t]          = source.delta_x[s];
+    target.delta_y[t]          = source.delta_y[s];
+    target.start[t]            = source.start[s];
+    target.inverse_duration[t] = source.inverse_duration[s];
+    target.easing[t]           = source.easing[s];
+    target.index[t]            = source.index[s];
+    target.face_up[t]          = source.face_up[s];
+    target.x[t]                = source.x[s];
+    target.y[t]                = source.y[s];
+    target.done[t]             = 0;
+}
+
+auto card_animator::update(double now) -> std::size_t
+{
+    const auto time = float(now - epoch_);
+
+    // The arithmetic of ease_card for every easing at once. Comparisons become 0 or 1 and the
+    // curves are blended with them, which keeps the lane loop free of branches for the
+    // vectorizer; the order of operations matches ease_card so the results agree closely.
+    auto finished = std::int32_t(0);
+    for (auto& b : blocks_)
+    {
+        for (auto lane = std::size_t(0); lane < lanes; ++lane)
+        {
+            const auto elapsed = (time - b.start[lane]) * b.inverse_duration[lane];
+            const auto t       = std::min(std::max(elapsed, 0.0f), 1.0f);
+
+            const auto u         = 1.0f - t;
+            const auto out_cubic = 1.0f - u * u * u;
+            const auto v         = 2.0f - 2.0f * t;
+            const auto first     = float(t < 0.5f);
+            const auto in_out =
+                first * (4.0f * t * t * t) + (1.0f - first) * (1.0f - v * v * v * 0.5f);
+
+            const auto past_1 = float(t >= 1.0f / bounce_period);
+            const auto past_2 = float(t >= 2.0f / bounce_period);
+            const auto past_3 = float(t >= 2.5f / bounce_period);
+            const auto arc    = past_1 * (1.5f / bounce_period) + past_2 * (0.75f / bounce_period) +
+                             past_3 * (0.375f / bounce_period);
+            const auto base   = past_1 * 0.75f + past_2 * 0.1875f + past_3 * 0.046875f;
+            const auto w      = t - arc;
+            const auto bounce = bounce_scale * w * w + base;
+
+            const auto easing    = b.easing[lane];
+            const auto is_out    = float(easing == std::int32_t(card_easing::ease_out_cubic));
+            const auto is_in_out = float(easing == std::int32_t(card_easing::ease_in_out_cubic));
+            const auto is_bounce = float(easing == std::int32_t(card_easing::bounce));
+            const auto curve =
+                is_out * out_cubic + is_in_out * in_out + (1.0f - is_out - is_in_out) * t;
+            const auto curve_y = is_bounce * bounce + (1.0f - is_bounce) * curve;
+
+            b.x[lane]    = b.from_x[lane] + b.delta_x[lane] * curve;
+            b.y[lane]    = b.from_y[lane] + b.delta_y[lane] * curve_y;
+            b.done[lane] = std::int32_t(elapsed >= 1.0f);
+            finished += b.done[lane];
+        }
+    }
+    if (finished == 0)
+    {
+        return 0;
+    }
+
+    // Close the gaps, keeping the order cards are drawn in
+    auto kept         = std::size_t(0);
+    animating_layers_ = 0;
+    for (auto i = std::size_t(0); i < count_; ++i)
+    {
+        const auto& b    = blocks_[i / lanes];
+        const auto  lane = i % lanes;
+        if (b.done[lane] != 0)
+        {
+            continue;
+        }
+        if (b.index[lane] >= 0 && b.index[lane] < 64)
+        {
+            animating_layers_ |= std::uint64_t(1) << b.index[lane];
+        }
+        if (kept != i)
+        {
+            move_lane(i, kept);
+        }
+        ++kept;
+    }
+    count_ = kept;
+    blocks_.resize((count_ + lanes - 1) / lanes);
+
+    // Reset what is left of the last block to inert lanes
+    if (count_ % lanes != 0)
+    {
+        auto& last = blocks_.back();
+        for (auto lane = count_ % lanes; lane < lanes; ++lane)
+        {
+            last.inverse_duration[lane] = 0.0f;
+            last.start[lane]            = 0.0f;
+            last.done[lane]             = 0;
+        }
+    }
+    return std::size_t(finished);
+}
+
+void card_animator::write_instances(std::uint64_t               resident_layers,
+                                    std::vector<card_instance>& instances) const
+{
+    const auto first = instances.size();
+    instances.resize(first + count_);
+    auto* out = instances.data() + first;
+    for (auto i = std::size_t(0); i < count_; i += lanes)
+    {
+        const auto& b     = blocks_[i / lanes];
+        const auto  count = std::min(lanes, count_ - i);
+        for (auto lane = std::size_t(0); lane < count; ++lane)
+        {
+            const auto layer =
+                resolve_card_layer(b.index[lane], b.face_up[lane] != 0, resident_layers);
+            out[i + lane] = {b.x[lane], b.y[lane], layer};
+        }
+    }
+}
+
+void card_animator::write_cards(std::vector<card>& cards) const
+{
+    const auto first = cards.size();
+    cards.resize(first + count_);
+    auto* out = cards.data() + first;
+    for (auto i = std::size_t(0); i < count_; i += lanes)
+    {
+        const auto& b     = blocks_[i / lanes];
+        const auto  count = std::min(lanes, count_ - i);
+        for (auto lane = std::size_t(0); lane < count; ++lane)
+        {
+            out[i + lane] = {b.x[lane], b.y[lane], b.index[lane], b.face_up[lane] != 0};
+        }
+    }
+}
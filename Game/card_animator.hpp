@@ -0,0 +1,99 @@
+#ifndef _GAME_CARD_ANIMATOR_HPP__
+#define _GAME_CARD_ANIMATOR_HPP__
+
+#include "cards.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// How a tween's progress is shaped. Both axes share the curve except for bounce, which moves x
+// linearly while y falls and bounces, as in the win cascade.
+enum class card_easing : std::int32_t
+{
+    linear            = 0,
+    ease_out_cubic    = 1, // Deal and snap-back: fast start, gentle landing
+    ease_in_out_cubic = 2, // Auto-complete
+    bounce            = 3  // Win cascade
+};
+
+// A card moving from one place to another. Before `start` it sits at the start point, and it
+// is dropped once `duration` has passed, so the caller draws it wherever it landed.
+struct card_tween
+{
+    float        from_x, from_y;
+    float        to_x, to_y;
+    double       start;    // Seconds, on the clock passed to update
+    float        duration; // Seconds
+    card_easing  easing;
+    std::int32_t index; // Texture array layer of the face, as in card
+    bool         face_up;
+};
+
+// Every moving card, stored as a structure of arrays in fixed blocks of `lanes` tweens. The
+// per-frame update runs over one block at a time with a constant trip count and no branches
+// (the easing curves are selected per lane), so the compiler turns it into SIMD without
+// intrinsics. The results are then written out as card_instance data for draw_card_instances.
+class card_animator
+{
+public:
+    static constexpr auto lanes = std::size_t(8);
+
+    void add(const card_tween& tween);
+    void clear();
+
+    // Evaluates every tween at `now` and drops the ones that have finished, keeping the order
+    // of the rest. Returns how many finished.
+    auto update(double now) -> std::size_t;
+
+    // Appends the cards as of the last update, in the order they were added, resolving layers
+    // against `resident_layers` as build_card_instances does
+    void write_instances(std::uint64_t               resident_layers,
+                         std::vector<card_instance>& instances) const;
+
+    // Appends the same cards with their faces left unresolved, for code that keeps them past
+    // this frame (table snapshots)
+    void write_cards(std::vector<card>& cards) const;
+
+    auto size() const -> std::size_t { return count_; }
+    auto empty() const -> bool { return count_ == 0; }
+
+    // Bit N set while a card whose face is layer N is moving
+    auto animating_layers() const -> std::uint64_t { return animating_layers_; }
+
+private:
+    // Unused lanes at the end of the last block have a zero inverse duration, so they never
+    // finish and are never read back
+    struct block
+    {
+        float        from_x[lanes], from_y[lanes];
+        float        delta_x[lanes], delta_y[lanes];
+        float        start[lanes];
+        float        inverse_duration[lanes];
+        std::int32_t easing[lanes];
+        std::int32_t index[lanes];
+        std::int32_t face_up[lanes];
+
+        // Written by update
+        float        x[lanes], y[lanes];
+        std::int32_t done[lanes];
+    };
+
+    void move_lane(std::size_t from, std::size_t to);
+
+    // Times are kept as floats relative to the first tween added since the animator was last
+    // empty, which keeps sub-millisecond precision for hours
+    double             epoch_ = 0.0;
+    std::vector<block> blocks_;
+    std::size_t        count_            = 0;
+    std::uint64_t      animating_layers_ = 0;
+};
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+// Progress along x and y of a tween `t` of the way through (0 to 1), one lane at a time; the
+// reference the vectorized update is checked against
+auto ease_card(card_easing easing, float t) -> std::pair<float, float>;
+
+#endif // _GAME_CARD_ANIMATOR_HPP__
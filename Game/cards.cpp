@@ -1,89 +1,102 @@
 #include "cards.hpp"
+#include "asset_pack.hpp"
+#include "atlas_cache.hpp"
+#include "profiler.hpp"
+#include "texture_loader.hpp"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+// clang-format off
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+// clang-format on
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <filesystem>
-#include <fstream>
 #include <ranges>
+#include <thread>
 
-auto compile_card_shader(std::string_view shader_relative_path, GLenum shader_type)
-    -> std::expected<GLuint, error_message_t> // shader id
+auto create_card_renderer(texture_loading loading, shader_caching caching)
+    -> std::expected<std::shared_ptr<card_renderer>, error_message_t>
 {
-    auto current_working_path = std::filesystem::current_path();
-    auto shader_path          = current_working_path / shader_relative_path;
+    PROFILE_SCOPE("create_card_renderer");
 
-    auto content_result = read_file_content(shader_path);
-    if (!content_result.has_value())
+    // Shader program, from the binary cache when it matches the sources and driver
+    auto program_result = build_program(card_shader_paths(), program_cache_path(), caching);
+    if (!program_result)
     {
-        return std::unexpected("Failed to read shader file: " + std::string(shader_relative_path));
+        return std::unexpected(program_result.error());
     }
-    auto shader_source = content_result.value();
-
-    auto           shader_id      = glCreateShader(shader_type);
-    constexpr auto shader_count   = 1;
-    const GLchar*  shader_src_ptr = shader_source.c_str();
-    glShaderSource(shader_id, shader_count, &shader_src_ptr, nullptr);
-    glCompileShader(shader_id);
-
-    return shader_id;
-}
-
-auto create_card_renderer() -> std::expected<std::shared_ptr<card_renderer>, error_message_t>
-{
-    // Compile shaders
-    auto vertex_compiled_result = compile_card_shader("Shaders/card.vert", GL_VERTEX_SHADER);
-    if (!vertex_compiled_result)
-    {
-        return std::unexpected("Failed to compile vertex shader: " +
-                               vertex_compiled_result.error());
-    }
-    auto vertex_shader_id = vertex_compiled_result.value();
+    auto program_id = program_result->program;
+    glUseProgram(program_id);
 
-    auto fragment_compiled_result = compile_card_shader("Shaders/card.frag", GL_FRAGMENT_SHADER);
-    if (!fragment_compiled_result)
+    auto [vao_id, vbo_id] = create_vao_vbo();
+    auto stream_result    = stream_buffer::create();
+    if (!stream_result)
     {
-        return std::unexpected("Failed to compile fragment shader: " +
-                               fragment_compiled_result.error());
+        return std::unexpected(stream_result.error());
     }
-    auto fragment_shader_id = fragment_compiled_result.value();
+    auto stream = std::make_shared<stream_buffer>(std::move(stream_result.value()));
+    attach_instance_buffer(vao_id, stream->buffer());
 
-    // Link shader program
-    auto program_id_result = link_shader_program(vertex_shader_id, fragment_shader_id);
-    if (!program_id_result)
+    auto card_renderer_ptr = std::make_shared<card_renderer>();
+    if (loading == texture_loading::streamed)
     {
-        return std::unexpected("Failed to link shader program: " + program_id_result.error());
+        // Storage is allocated by the loader once the atlas layout is known
+        constexpr auto texture_count = GLsizei(1);
+        glGenTextures(texture_count, &card_renderer_ptr->texture_array);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, card_renderer_ptr->texture_array);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        card_renderer_ptr->texture_loader =
+            std::make_shared<card_texture_loader>(std::thread::hardware_concurrency());
+        card_renderer_ptr->resident_layers = 0;
     }
-    auto program_id = program_id_result.value();
-
-    glDeleteShader(vertex_shader_id);
-    glDeleteShader(fragment_shader_id);
-    glUseProgram(program_id);
-
-    auto [vao_id, vbo_id] = create_vao_vbo();
-
-    // Load up the PNG
-    auto load_card_textures_result = load_card_textures();
-    if (!load_card_textures_result.has_value())
+    else
     {
-        return std::unexpected("Failed to load card textures: " +
-                               load_card_textures_result.error());
+        // Load up the PNG
+        auto load_card_textures_result = load_card_textures();
+        if (!load_card_textures_result.has_value())
+        {
+            return std::unexpected("Failed to load card textures: " +
+                                   load_card_textures_result.error());
+        }
+        card_renderer_ptr->texture_array = load_card_textures_result.value();
     }
 
-    auto card_renderer_ptr            = std::make_shared<card_renderer>();
     card_renderer_ptr->shader_program = program_id;
-    card_renderer_ptr->texture_array  = load_card_textures_result.value();
     card_renderer_ptr->vao            = vao_id;
     card_renderer_ptr->vbo            = vbo_id;
+    card_renderer_ptr->stream          = stream;
+    card_renderer_ptr->instance_buffer = stream->buffer();
     card_renderer_ptr->uProjection    = glGetUniformLocation(program_id, "uProjection");
-    card_renderer_ptr->uPosition      = glGetUniformLocation(program_id, "uPosition");
     card_renderer_ptr->uSize          = glGetUniformLocation(program_id, "uSize");
-    card_renderer_ptr->uCardIndex     = glGetUniformLocation(program_id, "uCardIndex");
-    card_renderer_ptr->uFaceUp        = glGetUniformLocation(program_id, "uFaceUp");
+    card_renderer_ptr->uCardTextures  = glGetUniformLocation(program_id, "uCardTextures");
+    card_renderer_ptr->shader_stats   = program_result->stats;
 
     return card_renderer_ptr;
 }
 
+void replace_card_shader(const std::shared_ptr<card_renderer>& cr, GLuint program_id)
+{
+    glDeleteProgram(cr->shader_program);
+    cr->shader_program = program_id;
+    cr->uProjection    = glGetUniformLocation(program_id, "uProjection");
+    cr->uSize          = glGetUniformLocation(program_id, "uSize");
+    cr->uCardTextures  = glGetUniformLocation(program_id, "uCardTextures");
+
+    const auto [left, right, bottom, top] = cr->projection_area;
+    set_card_projection(cr, left, right, bottom, top);
+    glUniform1i(cr->uCardTextures, 0);
+}
+
 // VAO, VBO, Vertex Array Object, Vertex Buffer Object
 [[nodiscard]]
 auto create_vao_vbo() -> std::pair<GLuint, GLuint>
@@ -99,15 +112,16 @@ auto create_vao_vbo() -> std::pair<GLuint, GLuint>
     glGenBuffers(item_count, &vbo_id);
     glBindBuffer(GL_ARRAY_BUFFER, vbo_id);
 
+    // Texture rows are uploaded top row first, so v runs down the card while y runs up
     auto vertices = std::array<GLfloat, 30>{
         // pos x   y    z    u    v
-        -0.5f, 0.5f,  0.0f, 0.0f, 1.0f, // TL
-        0.5f,  0.5f,  0.0f, 1.0f, 1.0f, // TR
-        0.5f,  -0.5f, 0.0f, 1.0f, 0.0f, // BR
+        -0.5f, 0.5f,  0.0f, 0.0f, 0.0f, // TL
+        0.5f,  0.5f,  0.0f, 1.0f, 0.0f, // TR
+        0.5f,  -0.5f, 0.0f, 1.0f, 1.0f, // BR
 
-        -0.5f, 0.5f,  0.0f, 0.0f, 1.0f, // TL (repeat)
-        0.5f,  -0.5f, 0.0f, 1.0f, 0.0f, // BR (repeat)
-        -0.5f, -0.5f, 0.0f, 0.0f, 0.0f  // BL
+        -0.5f, 0.5f,  0.0f, 0.0f, 0.0f, // TL (repeat)
+        0.5f,  -0.5f, 0.0f, 1.0f, 1.0f, // BR (repeat)
+        -0.5f, -0.5f, 0.0f, 0.0f, 1.0f  // BL
     };
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices.data(), GL_STATIC_DRAW);
 
@@ -140,61 +154,472 @@ auto create_vao_vbo() -> std::pair<GLuint, GLuint>
     return {vao_id, vbo_id};
 }
 
-void draw_cards(const std::shared_ptr<card_renderer>& cr)
+void build_card_instances(const std::vector<card>&    cards,
+                          std::uint64_t               resident_layers,
+                          std::vector<card_instance>& instances)
 {
-    static const auto demo_cards = std::vector<card>{
-        {200.0f, 700.0f, 0, true},  // Face up, near bottom-left
-        {400.0f, 700.0f, 0, false}, // Face down (shows back)
-        {600.0f, 700.0f, 13, true}  // e.g., Ace of Diamonds (index 13, adjust per JSON)
+    instances.resize(cards.size());
+    build_card_instances(cards, resident_layers, std::span(instances));
+}
+
+void build_card_instances(const std::vector<card>& cards,
+                          std::uint64_t            resident_layers,
+                          std::span<card_instance> instances)
+{
+    for (auto i = std::size_t(0); i < cards.size(); ++i)
+    {
+        const auto& card  = cards[i];
+        const auto  layer = resolve_card_layer(card.index, card.face_up, resident_layers);
+        instances[i]      = {card.x, card.y, layer};
+    }
+}
+
+namespace {
+
+// Rectangle in layout pixels, bottom-left origin
+struct cull_rect
+{
+    float left, bottom, right, top;
+
+    auto empty() const -> bool { return left >= right || bottom >= top; }
+};
+
+constexpr auto corner_width  = card_width_px * card_corner_fraction;
+constexpr auto corner_height = card_height_px * card_corner_fraction;
+
+// A card as rectangles: full width between the rows of its rounded corners, full height between
+// their columns, and the four corner squares (bottom left, bottom right, top left, top right).
+// The two bands are where it is sure to be opaque; together they are everywhere it can show.
+using card_areas = std::array<cull_rect, 6>;
+
+auto card_areas_of(const card_instance& instance) -> card_areas
+{
+    const auto left = instance.x - card_width_px * 0.5f, right = instance.x + card_width_px * 0.5f;
+    const auto bottom = instance.y - card_height_px * 0.5f;
+    const auto top    = instance.y + card_height_px * 0.5f;
+    return {{{left, bottom + corner_height, right, top - corner_height},
+             {left + corner_width, bottom, right - corner_width, top},
+             {left, bottom, left + corner_width, bottom + corner_height},
+             {right - corner_width, bottom, right, bottom + corner_height},
+             {left, top - corner_height, left + corner_width, top},
+             {right - corner_width, top - corner_height, right, top}}};
+}
+
+// Rectangles only ever cut corner squares down to slivers, yet a card moved straight towards
+// a corner by most of the corner's size has its own rounded corner hide the one underneath,
+// anti-aliased fade included (from 60% on, for card.frag's radius). Cards in the same place
+// hide all four: the one below then only adds to the fade of the one above.
+void cut_covered_corners(card_areas& areas, const card_instance& area, const card_instance& cover)
+{
+    const auto covers = [](float shift, float corner) {
+        return shift == 0.0f || (shift >= corner * 0.6f && shift <= corner);
     };
+    const auto dx = cover.x - area.x;
+    const auto dy = cover.y - area.y;
+    if (dx == 0.0f && covers(-dy, corner_height))
+    {
+        areas[2] = areas[3] = cull_rect{};
+    }
+    if (dx == 0.0f && covers(dy, corner_height))
+    {
+        areas[4] = areas[5] = cull_rect{};
+    }
+    if (dy == 0.0f && covers(-dx, corner_width))
+    {
+        areas[2] = areas[4] = cull_rect{};
+    }
+    if (dy == 0.0f && covers(dx, corner_width))
+    {
+        areas[3] = areas[5] = cull_rect{};
+    }
+}
+
+// Removes from `area` what `cover` hides of it, which is only ever a rectangle when `cover`
+// spans `area` in one direction and reaches over one of its edges
+void cut_covered(cull_rect& area, const cull_rect& cover)
+{
+    if (cover.left <= area.left && cover.right >= area.right)
+    {
+        if (cover.bottom <= area.bottom && cover.top > area.bottom)
+        {
+            area.bottom = std::min(cover.top, area.top);
+        }
+        if (cover.top >= area.top && cover.bottom < area.top)
+        {
+            area.top = std::max(cover.bottom, area.bottom);
+        }
+    }
+    if (cover.bottom <= area.bottom && cover.top >= area.top)
+    {
+        if (cover.left <= area.left && cover.right > area.left)
+        {
+            area.left = std::min(cover.right, area.right);
+        }
+        if (cover.right >= area.right && cover.left < area.right)
+        {
+            area.right = std::max(cover.left, area.left);
+        }
+    }
+}
+
+// Offset into the card, 0 to 1, as a card_instance extent: rounded outwards, so `floor` for
+// the left and top edges
+auto card_extent(float fraction, bool floor) -> std::uint16_t
+{
+    const auto scaled = std::clamp(fraction, 0.0f, 1.0f) * float(card_extent_full);
+    return std::uint16_t(floor ? std::floor(scaled) : std::ceil(scaled));
+}
 
-    constexpr float card_width_px  = 120.0f;
-    constexpr float card_height_px = 168.0f;
+} // namespace
+
+auto cull_card_instances(std::span<card_instance> instances, card_cull_stats& stats)
+    -> std::size_t
+{
+    // Trimmed edges stay this far inside the cover, against rounding gaps along the seam
+    constexpr auto seam_pixels  = 1.0f;
+    constexpr auto cover_window = std::size_t(52); // A deck: covers follow their card closely
+
+    auto kept = std::size_t(0);
+    for (auto i = std::size_t(0); i < instances.size(); ++i)
+    {
+        auto       instance   = instances[i];
+        auto       areas      = card_areas_of(instance);
+        const auto hidden     = [&areas] {
+            return std::ranges::all_of(areas, [](const auto& area) { return area.empty(); });
+        };
+        const auto last_cover = std::min(instances.size(), i + 1 + cover_window);
+        for (auto j = i + 1; j < last_cover && !hidden(); ++j)
+        {
+            const auto& cover = instances[j];
+            if (std::abs(cover.x - instance.x) >= card_width_px ||
+                std::abs(cover.y - instance.y) >= card_height_px)
+            {
+                continue;
+            }
+            const auto cover_areas = card_areas_of(cover);
+            for (const auto& cover_band : std::span(cover_areas).first(2))
+            {
+                for (auto& area : areas)
+                {
+                    if (!area.empty())
+                    {
+                        cut_covered(area, cover_band);
+                    }
+                }
+            }
+            cut_covered_corners(areas, instance, cover);
+        }
+
+        ++stats.cards;
+        stats.quad_pixels += double(card_width_px) * card_height_px;
+        if (hidden())
+        {
+            ++stats.hidden_cards;
+            continue;
+        }
+
+        // What is left of the card, widened by the seam and kept on the card
+        const auto card_left   = instance.x - card_width_px * 0.5f;
+        const auto card_top    = instance.y + card_height_px * 0.5f;
+        const auto card_right  = card_left + card_width_px;
+        const auto card_bottom = card_top - card_height_px;
+        auto       visible     = cull_rect{card_right, card_top, card_left, card_bottom};
+        for (const auto& area : areas)
+        {
+            if (!area.empty())
+            {
+                visible.left   = std::min(visible.left, area.left - seam_pixels);
+                visible.bottom = std::min(visible.bottom, area.bottom - seam_pixels);
+                visible.right  = std::max(visible.right, area.right + seam_pixels);
+                visible.top    = std::max(visible.top, area.top + seam_pixels);
+            }
+        }
+        instance.left   = card_extent((visible.left - card_left) / card_width_px, true);
+        instance.top    = card_extent((card_top - visible.top) / card_height_px, true);
+        instance.right  = card_extent((visible.right - card_left) / card_width_px, false);
+        instance.bottom = card_extent((card_top - visible.bottom) / card_height_px, false);
+        stats.visible_pixels += double(instance.right - instance.left) * card_width_px *
+                                double(instance.bottom - instance.top) * card_height_px /
+                                (double(card_extent_full) * card_extent_full);
+        instances[kept++] = instance;
+    }
+    return kept;
+}
+
+void attach_instance_buffer(GLuint vao_id, GLuint buffer_id)
+{
+    glBindVertexArray(vao_id);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer_id);
+
+    // Per-instance position attribute
+    constexpr auto position_attribute_index = GLuint(2);
+    constexpr auto position_axis_count      = 2;
+    glVertexAttribPointer(position_attribute_index,
+                          GLint(position_axis_count),     // position_size,
+                          GLenum(GL_FLOAT),               // position_type,
+                          GLboolean(GL_FALSE),            // position_normalized,
+                          GLsizei(sizeof(card_instance)), // position_stride,
+                          reinterpret_cast<GLvoid*>(offsetof(card_instance, x)));
+    glVertexAttribDivisor(position_attribute_index, 1);
+    glEnableVertexAttribArray(position_attribute_index);
+
+    // Per-instance texture layer attribute, integer so it reaches the shader unconverted
+    constexpr auto layer_attribute_index = GLuint(3);
+    glVertexAttribIPointer(layer_attribute_index,
+                           GLint(1),                       // layer_size,
+                           GLenum(GL_INT),                 // layer_type,
+                           GLsizei(sizeof(card_instance)), // layer_stride,
+                           reinterpret_cast<GLvoid*>(offsetof(card_instance, layer)));
+    glVertexAttribDivisor(layer_attribute_index, 1);
+    glEnableVertexAttribArray(layer_attribute_index);
+
+    // Per-instance visible part, normalized so it arrives as texture coordinates
+    constexpr auto visible_attribute_index = GLuint(4);
+    glVertexAttribPointer(visible_attribute_index,
+                          GLint(4),                       // visible_size,
+                          GLenum(GL_UNSIGNED_SHORT),      // visible_type,
+                          GLboolean(GL_TRUE),             // visible_normalized,
+                          GLsizei(sizeof(card_instance)), // visible_stride,
+                          reinterpret_cast<GLvoid*>(offsetof(card_instance, left)));
+    glVertexAttribDivisor(visible_attribute_index, 1);
+    glEnableVertexAttribArray(visible_attribute_index);
+
+    glBindVertexArray(0);
+}
+
+void set_card_projection(const std::shared_ptr<card_renderer>& cr,
+                         std::int32_t                          width,
+                         std::int32_t                          height)
+{
+    set_card_projection(cr, 0.0f, static_cast<float>(width), 0.0f, static_cast<float>(height));
+}
+
+void set_card_projection(const std::shared_ptr<card_renderer>& cr,
+                         float                                 left,
+                         float                                 right,
+                         float                                 bottom,
+                         float                                 top)
+{
+    const auto projection = glm::ortho(left, right, bottom, top, -1.0f, 1.0f);
+    cr->projection_area   = {left, right, bottom, top};
+    glUseProgram(cr->shader_program);
+    glUniformMatrix4fv(cr->uProjection, // location
+                       1,               // count
+                       GL_FALSE,        // transpose
+                       glm::value_ptr(projection));
+}
+
+void set_card_texture_lod(const std::shared_ptr<card_renderer>& cr, float min_lod, float bias)
+{
+    glBindTexture(GL_TEXTURE_2D_ARRAY, cr->texture_array);
+    glTexParameterf(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_LOD, min_lod);
+    glTexParameterf(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_LOD_BIAS, bias);
+}
+
+namespace {
+
+// One instanced draw of every instance in an allocation in cr->stream
+void draw_instance_allocation(const std::shared_ptr<card_renderer>&   cr,
+                              const stream_allocation<card_instance>& allocation)
+{
+    PROFILE_SCOPE("draw_cards");
+    PROFILE_GPU_SCOPE("draw_cards");
+
+    // The stream only changes buffers when it outgrows its storage
+    if (allocation.buffer != cr->instance_buffer)
+    {
+        attach_instance_buffer(cr->vao, allocation.buffer);
+        cr->instance_buffer = allocation.buffer;
+    }
 
-    // Bind shared resources (do this once per frame, outside per-card loop ideally)
+    // Bind shared resources once for the whole batch
     glBindVertexArray(cr->vao);
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D_ARRAY, cr->texture_array);
     glUniform2f(cr->uSize, card_width_px, card_height_px);
 
-    // Draw each card
-    for (const auto& card : demo_cards)
+    // Draw the quad (2 triangles, 6 verts) once per card, reading instances from the allocation
+    glDrawArraysInstancedBaseInstance(
+        GL_TRIANGLES, 0, 6, GLsizei(allocation.data.size()), allocation.first());
+    ++cr->draw_calls;
+
+    // Unbind (optional, good practice)
+    glBindVertexArray(0);
+}
+
+// Culls the batch in cr->cull_scratch and draws what it kept
+void draw_culled_scratch(const std::shared_ptr<card_renderer>& cr)
+{
+    const auto kept = cull_card_instances(cr->cull_scratch, cr->cull_stats);
+    if (kept == 0)
     {
-        glUniform2f(cr->uPosition, card.x, card.y);
-        glUniform1i(cr->uCardIndex, card.index);
-        glUniform1i(cr->uFaceUp, card.face_up ? 1 : 0);
+        return;
+    }
 
-        glDrawArrays(GL_TRIANGLES, 0, 6); // Draw the quad (2 triangles, 6 verts)
+    const auto allocation = cr->stream->allocate<card_instance>(kept);
+    if (allocation.data.size() != kept)
+    {
+        return;
     }
+    std::copy_n(cr->cull_scratch.begin(), kept, allocation.data.begin());
+    draw_instance_allocation(cr, allocation);
+}
 
-    // Unbind (optional, good practice)
-    glBindVertexArray(0);
+} // namespace
+
+void draw_cards(const std::shared_ptr<card_renderer>& cr, const std::vector<card>& cards)
+{
+    if (cards.empty())
+    {
+        return;
+    }
+    if (cr->cull_hidden_cards)
+    {
+        build_card_instances(cards, cr->resident_layers, cr->cull_scratch);
+        draw_culled_scratch(cr);
+        return;
+    }
+
+    const auto allocation = cr->stream->allocate<card_instance>(cards.size());
+    if (allocation.data.size() != cards.size())
+    {
+        return;
+    }
+    build_card_instances(cards, cr->resident_layers, allocation.data);
+    draw_instance_allocation(cr, allocation);
 }
 
-auto link_shader_program(GLuint vertex_shader_id, GLuint fragment_shader_id)
-    -> std::expected<GLuint, error_message_t>
+void draw_card_instances(const std::shared_ptr<card_renderer>& cr,
+                         const std::vector<card_instance>&     instances)
 {
-    auto program_id = glCreateProgram();
-    glAttachShader(program_id, vertex_shader_id);
-    glAttachShader(program_id, fragment_shader_id);
-    glLinkProgram(program_id);
+    if (instances.empty())
+    {
+        return;
+    }
+    if (cr->cull_hidden_cards)
+    {
+        cr->cull_scratch.assign(instances.begin(), instances.end());
+        draw_culled_scratch(cr);
+        return;
+    }
 
-    auto program_linked = GLint();
-    glGetProgramiv(program_id, GL_LINK_STATUS, &program_linked);
-    if (program_linked != GL_TRUE)
+    const auto allocation = cr->stream->allocate<card_instance>(instances.size());
+    if (allocation.data.size() != instances.size())
     {
-        auto       log_length  = GLsizei(0);
-        const auto size        = 1024;
-        auto       err_message = std::string(size, '\0');
-        glGetProgramInfoLog(program_id, size, &log_length, err_message.data());
-        return std::unexpected(err_message);
+        return;
     }
+    std::ranges::copy(instances, allocation.data.begin());
+    draw_instance_allocation(cr, allocation);
+}
+
+auto resize_card_layer_cache(card_layer_cache& cache, std::int32_t width, std::int32_t height)
+    -> std::expected<void, error_message_t>
+{
+    if (cache.framebuffer != 0 && cache.width == width && cache.height == height)
+    {
+        return {};
+    }
+    destroy_card_layer_cache(cache);
+
+    auto previous_framebuffer = GLint(0);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous_framebuffer);
+
+    glGenRenderbuffers(1, &cache.color);
+    glBindRenderbuffer(GL_RENDERBUFFER, cache.color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenFramebuffers(1, &cache.framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, cache.framebuffer);
+    glFramebufferRenderbuffer(
+        GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, cache.color);
+    const auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, GLuint(previous_framebuffer));
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        destroy_card_layer_cache(cache);
+        return std::unexpected(error_message_t("Card layer framebuffer is incomplete"));
+    }
+
+    cache.width  = width;
+    cache.height = height;
+    return {};
+}
+
+void render_card_layer_cache(const std::shared_ptr<card_renderer>& cr,
+                             const card_layer_cache&               cache,
+                             const std::vector<card>&              cards)
+{
+    PROFILE_SCOPE("render_card_layer_cache");
+
+    auto previous_framebuffer = GLint(0);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous_framebuffer);
+
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, cache.framebuffer);
+    glClear(GL_COLOR_BUFFER_BIT);
+    draw_cards(cr, cards);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, GLuint(previous_framebuffer));
+}
+
+void stamp_card_layer_cache(const std::shared_ptr<card_renderer>& cr,
+                            const card_layer_cache&               cache,
+                            const std::vector<card_instance>&     instances)
+{
+    PROFILE_SCOPE("stamp_card_layer_cache");
+
+    auto previous_framebuffer = GLint(0);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous_framebuffer);
+
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, cache.framebuffer);
+    draw_card_instances(cr, instances);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, GLuint(previous_framebuffer));
+}
 
-    return program_id;
+void present_card_layer_cache(const card_layer_cache& cache,
+                              std::int32_t            width,
+                              std::int32_t            height)
+{
+    PROFILE_GPU_SCOPE("present_card_layer_cache");
+
+    auto previous_framebuffer = GLint(0);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous_framebuffer);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, cache.framebuffer);
+    glBlitFramebuffer(0,
+                      0,
+                      cache.width,
+                      cache.height,
+                      0,
+                      0,
+                      width,
+                      height,
+                      GL_COLOR_BUFFER_BIT,
+                      width == cache.width && height == cache.height ? GL_NEAREST : GL_LINEAR);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, GLuint(previous_framebuffer));
+}
+
+void destroy_card_layer_cache(card_layer_cache& cache)
+{
+    if (cache.framebuffer != 0)
+    {
+        glDeleteFramebuffers(1, &cache.framebuffer);
+    }
+    if (cache.color != 0)
+    {
+        glDeleteRenderbuffers(1, &cache.color);
+    }
+    cache = {};
 }
 
 auto load_card_textures() -> std::expected<GLuint, error_message_t>
 {
+    PROFILE_SCOPE("load_card_textures");
+
+    // Prefer the cooked cache: already sliced, so the mapping goes straight to the GPU
+    if (auto cache_result = open_atlas_cache(atlas_cache_path()); cache_result.has_value())
+    {
+        return load_card_textures_from_cache(*cache_result.value());
+    }
+
     // --------------------------- Load the card texture atlas ---------------------------
     // Actual width, height, and channels will be set by stbi_load
     auto asset_image_result = load_png_data();
@@ -204,14 +629,15 @@ auto load_card_textures() -> std::expected<GLuint, error_message_t>
     }
     auto asset_image = asset_image_result.value();
 
-    // --------------------------- Load JSON data ---------------------------
-    // Load up JSON data and try to create textures
-    auto json_data_result = load_json_data();
-    if (!json_data_result.has_value())
+    // The frame layout is compiled in from cards.json, see atlas_layout.hpp. Frames are cut
+    // out into contiguous premultiplied RGBA8 layers whatever the PNG holds, a layer per thread.
+    const auto worker_count  = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    auto       sliced_result = slice_atlas(*asset_image, worker_count);
+    if (!sliced_result.has_value())
     {
-        return std::unexpected("Failed to load JSON data: " + json_data_result.error());
+        return std::unexpected(sliced_result.error());
     }
-    auto json_data = json_data_result.value();
+    const auto& sliced = sliced_result.value();
 
     // --------------------------- Create OpenGL texture array ---------------------------
     auto           card_texture_array = GLuint();
@@ -224,45 +650,81 @@ auto load_card_textures() -> std::expected<GLuint, error_message_t>
     glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
-    // Go through each card entry in the JSON and extract the texture coordinates
-
-    const auto  frames      = json_data["frames"];
-    const auto  num_layers  = static_cast<GLsizei>(frames.size());
-    auto        frames_itr  = frames.begin();
-    const auto& first_frame = frames_itr.value();
-    const auto  width       = first_frame["w"].get<int>();
-    const auto  height      = first_frame["h"].get<int>();
+    // Layers are tightly packed, so they all go up in one call
+    const auto num_layers = static_cast<GLsizei>(sliced.layer_count());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
     glTexImage3D(GL_TEXTURE_2D_ARRAY, // target
                  0,                   // level
                  GL_RGBA8,            // internal format
-                 width,
-                 height,
+                 sliced.layer_width,
+                 sliced.layer_height,
                  num_layers, // depth (number of layers)
                  0,          // border
                  GL_RGBA,
                  GL_UNSIGNED_BYTE, // type
-                 nullptr);         // data
+                 sliced.pixels.data());
 
-    for (const auto& [index, entry] : std::views::enumerate(frames.items()))
-    {
-        const auto& [card_name, frame_data] = entry;
+    // Cards are drawn well below their native size, so sample from a mip chain
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+    return card_texture_array;
+}
 
-        const auto x = frame_data["x"].get<int>();
-        const auto y = frame_data["y"].get<int>();
+auto load_card_textures_from_cache(const atlas_cache& cache) -> GLuint
+{
+    auto           card_texture_array = GLuint();
+    constexpr auto texture_count      = GLsizei(1);
+    glGenTextures(texture_count, &card_texture_array);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, card_texture_array);
 
-        // Load texture
-        auto pixel_data = asset_image->stride_of_data_at(x, y);
-        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, // target
-                        0,                   // level
-                        0,                   // xoffset
-                        0,                   // yoffset
-                        index,               // layer
-                        width,
-                        height,
-                        1, // depth
-                        GL_RGBA,
-                        GL_UNSIGNED_BYTE, // type
-                        pixel_data);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    const auto compressed      = cache.format() == atlas_format::bc3;
+    const auto internal_format = compressed ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_RGBA8;
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY,
+                   cache.mip_levels(),
+                   internal_format,
+                   cache.layer_width(),
+                   cache.layer_height(),
+                   cache.layer_count());
+
+    // Layers of a level are tightly packed, so every level goes up in one call
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    for (auto level = 0; level < cache.mip_levels(); ++level)
+    {
+        const auto& level_info = cache.level(level);
+        if (compressed)
+        {
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, // target
+                                      level,
+                                      0, // xoffset
+                                      0, // yoffset
+                                      0, // zoffset
+                                      GLsizei(level_info.width),
+                                      GLsizei(level_info.height),
+                                      cache.layer_count(), // depth (number of layers)
+                                      internal_format,
+                                      GLsizei(cache.level_size(level)),
+                                      cache.level_data(level));
+        }
+        else
+        {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, // target
+                            level,
+                            0, // xoffset
+                            0, // yoffset
+                            0, // zoffset
+                            GLsizei(level_info.width),
+                            GLsizei(level_info.height),
+                            cache.layer_count(), // depth (number of layers)
+                            GL_RGBA,
+                            GL_UNSIGNED_BYTE, // type
+                            cache.level_data(level));
+        }
     }
 
     return card_texture_array;
@@ -270,14 +732,18 @@ auto load_card_textures() -> std::expected<GLuint, error_message_t>
 
 auto load_json_data() -> std::expected<nlohmann::json, error_message_t>
 {
-    // Load JSON data from file
-    auto current_working_path = std::filesystem::current_path();
-    auto cards_path           = current_working_path / "Assets/cards.json";
+    PROFILE_SCOPE("load_json_data");
 
-    auto json_file_stream = std::ifstream(cards_path);
+    // Parsed straight from the pack (or loose file) mapping
+    auto asset_result = assets().read(card_atlas_json_asset);
+    if (!asset_result)
+    {
+        return std::unexpected(asset_result.error());
+    }
+    const auto text = asset_result->text();
     try
     {
-        return nlohmann::json::parse(json_file_stream); // This could throw
+        return nlohmann::json::parse(text.data(), text.data() + text.size()); // This could throw
     }
     catch (const std::exception& e)
     {
@@ -287,20 +753,23 @@ auto load_json_data() -> std::expected<nlohmann::json, error_message_t>
 
 auto load_png_data() -> std::expected<std::shared_ptr<asset_image>, error_message_t>
 {
-    // Set up the asset path
-    auto current_working_path = std::filesystem::current_path();
-    auto cards_path           = current_working_path / "Assets/cards.png";
-    if (!std::filesystem::exists(cards_path))
+    PROFILE_SCOPE("load_png_data");
+
+    auto asset_result = assets().read(card_atlas_png_asset);
+    if (!asset_result)
     {
-        return std::unexpected("Cards PNG file not found at path: " + cards_path.string());
+        return std::unexpected(asset_result.error());
     }
 
-    // Load the png data; width, height, and channels will be set by stbi_load
-    auto  width = 0, height = 0, channels = 0;
-    auto* raw_data = stbi_load(cards_path.string().c_str(), &width, &height, &channels, 0);
+    // Decode from the mapping; width, height, and channels will be set by stbi_load_from_memory
+    const auto bytes = asset_result->bytes;
+    auto       width = 0, height = 0, channels = 0;
+    auto*      raw_data =
+        stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(bytes.data()),
+                              static_cast<int>(bytes.size()), &width, &height, &channels, 0);
     if (raw_data == nullptr || width == 0 || height == 0 || channels == 0)
     {
-        return std::unexpected("Failed to load PNG data from file: " + cards_path.string());
+        return std::unexpected("Failed to decode PNG data: " + std::string(card_atlas_png_asset));
     }
 
     // Wrap the data and the image info in the asset_image object
@@ -308,31 +777,52 @@ auto load_png_data() -> std::expected<std::shared_ptr<asset_image>, error_messag
     return std::make_shared<asset_image>(data_ptr, width, height, channels);
 }
 
-// TODO: Clean up implementation
-auto read_file_content(const std::filesystem::path& path)
-    -> std::expected<std::string, error_message_t>
+auto pump_card_textures(const std::shared_ptr<card_renderer>& cr)
+    -> std::expected<bool, error_message_t>
 {
-    // Make sure the file exists
-    if (!std::filesystem::exists(path))
+    if (!cr->texture_loader)
     {
-        return std::unexpected("File does not exist: " + path.string());
+        return true;
     }
+    PROFILE_SCOPE("pump_card_textures");
 
-    // Attempt to open the file
-    auto file_stream = std::ifstream(path, std::ios::in);
-    if (!file_stream.is_open())
+    // A few layers per frame keeps the per-frame copy cost bounded
+    constexpr auto max_uploads_per_frame = std::int32_t(4);
+    auto           pump_result = cr->texture_loader->pump(cr->texture_array, max_uploads_per_frame);
+    if (!pump_result)
     {
-        return std::unexpected("Failed to open file: " + path.string());
+        return std::unexpected(pump_result.error());
     }
-    // Seek to the end to get the size
-    file_stream.seekg(0, std::ios::end);
 
-    // Set up a new string object to hold the content
-    const auto size    = file_stream.tellg();
-    auto       content = std::string(size, '\0');
+    cr->resident_layers = cr->texture_loader->resident_layers();
+    if (pump_result.value())
+    {
+        // Everything is resident; the loader and its staging memory are no longer needed
+        cr->texture_loader.reset();
+        cr->resident_layers = all_layers_resident;
+    }
+    return pump_result.value();
+}
+
+auto read_file_content(const std::filesystem::path& path)
+    -> std::expected<std::string, error_message_t>
+{
+    // Relative paths are asset names and may come from the pack; absolute ones are read as is
+    if (path.is_relative())
+    {
+        auto asset_result = assets().read(path.generic_string());
+        if (!asset_result)
+        {
+            return std::unexpected(asset_result.error());
+        }
+        return std::string(asset_result->text());
+    }
 
-    // Bring the reader back to the beginning of the file and read the content
-    file_stream.seekg(0);
-    file_stream.read(content.data(), size);
-    return content;
+    auto file_result = map_file(path);
+    if (!file_result)
+    {
+        return std::unexpected(file_result.error());
+    }
+    const auto bytes = file_result.value()->bytes();
+    return std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size());
 }
@@ -1,6 +1,9 @@
 #ifndef _GAME_CARDS_HPP__
 #define _GAME_CARDS_HPP__
 
+#include "atlas_layout.hpp"
+#include "shader_manager.hpp"
+#include "stream_buffer.hpp"
 #include "types.hpp"
 
 #include <nlohmann/json.hpp>
@@ -10,10 +13,17 @@
 #include <glad/gl.h>
 // clang-format on
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
 #include <expected>
 #include <memory>
+#include <span>
 #include <string_view>
+#include <vector>
+
+class atlas_cache;
+class card_texture_loader;
 
 // For holding image data from the large PNG tile map
 class asset_image
@@ -51,10 +61,102 @@ private:
 struct card
 {
     float        x, y;  // Position in pixel coordinates (bottom-left origin)
-    std::int32_t index; // 0-51 for face, 52 for back
+    std::int32_t index; // Texture array layer of the face, see card_face_layer
     bool         face_up;
 };
 
+// Size every card is drawn at
+constexpr auto card_width_px  = 120.0f;
+constexpr auto card_height_px = 168.0f;
+
+// Texture array layers and the card each one shows come from atlas_layout.hpp, generated from
+// Assets/cards.json at build time
+constexpr auto card_back_layer = atlas_back_layer;
+
+// Layer for a suit (clubs, diamonds, hearts, spades) and rank (ace = 0 ... king = 12)
+constexpr auto card_face_layer(std::int32_t suit, std::int32_t rank) -> std::int32_t
+{
+    return atlas_face_layers[std::size_t(suit)][std::size_t(rank)];
+}
+
+// The atlas the game is built against must hold exactly one frame per face plus a back, all the
+// same size (they share one texture array), and fit the 64-bit resident layer mask
+static_assert(atlas_frames.size() == 53, "The card atlas must hold 52 faces and a back");
+static_assert(std::ranges::all_of(atlas_frames,
+                                  [](const atlas_frame& frame) {
+                                      return frame.w == atlas_frames.front().w &&
+                                             frame.h == atlas_frames.front().h;
+                                  }),
+              "Every card atlas frame must be the same size");
+static_assert(card_back_layer >= 0, "The card atlas has no card back");
+static_assert(std::ranges::all_of(atlas_face_layers,
+                                  [](const auto& ranks) {
+                                      return std::ranges::all_of(ranks, [](std::int32_t layer) {
+                                          return layer >= 0 && layer != atlas_back_layer;
+                                      });
+                                  }),
+              "The card atlas is missing a face");
+
+// Drawn procedurally by card.frag while no real layer is resident yet
+constexpr auto placeholder_layer = std::int32_t(-1);
+
+// Bit N set when texture layer N can be sampled
+constexpr auto all_layers_resident = ~std::uint64_t(0);
+
+// Layer a card is drawn with: its face or the back, falling back to the back and then the
+// placeholder while the one it needs is not resident
+constexpr auto resolve_card_layer(std::int32_t index, bool face_up, std::uint64_t resident_layers)
+    -> std::int32_t
+{
+    const auto is_resident = [resident_layers](std::int32_t layer) {
+        return ((resident_layers >> layer) & 1) != 0;
+    };
+    const auto layer = face_up ? index : card_back_layer;
+    if (is_resident(layer))
+    {
+        return layer;
+    }
+    return is_resident(card_back_layer) ? card_back_layer : placeholder_layer;
+}
+
+// How create_card_renderer gets the card textures onto the GPU
+enum class texture_loading
+{
+    blocking, // Everything is uploaded before create_card_renderer returns
+    streamed  // Decoded on worker threads and uploaded by pump_card_textures
+};
+
+// Texture coordinate 1.0 in card_instance's visible part
+constexpr auto card_extent_full = std::uint16_t(0xFFFF);
+
+// Per-instance vertex data for one card; matches the instanced attributes in card.vert
+struct card_instance
+{
+    float        x, y;  // Position in pixel coordinates
+    std::int32_t layer; // Texture array layer, already resolved for face up/down
+
+    // Part of the card drawn, in texture coordinates (v runs down the card) scaled to
+    // card_extent_full. The whole card unless cull_card_instances trimmed it.
+    std::uint16_t left   = 0;
+    std::uint16_t top    = 0;
+    std::uint16_t right  = card_extent_full;
+    std::uint16_t bottom = card_extent_full;
+};
+
+// Fraction of the card's width and height its rounded corners take; card.frag fades them out
+// through alpha, so everything outside the corners is opaque
+constexpr auto card_corner_fraction = 0.1f;
+
+// What cull_card_instances did, summed over the batches it culled. Pixel counts are in the
+// units cards are laid out in, before any tile scale.
+struct card_cull_stats
+{
+    std::uint64_t cards          = 0;   // Instances culled
+    std::uint64_t hidden_cards   = 0;   // Dropped as fully covered
+    double        quad_pixels    = 0.0; // Area of the whole card quads, drawn without culling
+    double        visible_pixels = 0.0; // Area left to rasterize after trimming
+};
+
 // For holding ids of assets/shaders/etc.
 struct card_renderer
 {
@@ -63,38 +165,153 @@ struct card_renderer
     GLuint vao            = 0;
     GLuint vbo            = 0;
 
+    // Per-frame instance data is packed straight into the mapped stream buffer. The VAO's
+    // instance attributes read from instance_buffer and are re-pointed only when the stream
+    // reallocates its storage; each draw starts at its allocation as the base instance.
+    std::shared_ptr<stream_buffer> stream;
+    GLuint                         instance_buffer = 0;
+
+    // Only set while textures are streaming in; layers outside the mask draw a placeholder
+    std::shared_ptr<card_texture_loader> texture_loader;
+    std::uint64_t                        resident_layers = all_layers_resident;
+
     // The variables here match what is in the shader code
-    GLint uProjection = -1;
-    GLint uPosition   = -1;
-    GLint uSize       = -1;
-    GLint uCardIndex  = -1;
-    GLint uFaceUp     = -1;
+    GLint uProjection   = -1;
+    GLint uSize         = -1;
     GLint uCardTextures = -1;
+
+    // Left, right, bottom and top of the last projection set, applied again when the shader is
+    // replaced
+    std::array<float, 4> projection_area = {};
+
+    // How long the shader program took at startup and whether the binary cache provided it
+    program_build_stats shader_stats;
+
+    // Instanced draw calls issued so far
+    std::uint64_t draw_calls = 0;
+
+    // Whether batches are culled before they are drawn, and what that saved. Batches are built
+    // and culled here, in ordinary memory, and only what is kept is copied into the stream,
+    // whose mapping is write-only.
+    bool                       cull_hidden_cards = true;
+    card_cull_stats            cull_stats;
+    std::vector<card_instance> cull_scratch;
+};
+
+// Offscreen copy of the cards that are not moving. It is redrawn only when they change and
+// copied to the window every frame, so only dragged or animating cards are drawn per frame.
+struct card_layer_cache
+{
+    GLuint       framebuffer = 0;
+    GLuint       color       = 0; // RGBA8 renderbuffer
+    std::int32_t width       = 0;
+    std::int32_t height      = 0;
 };
 
 // -------------------- FUNCTIONS SECTION ---------------------
 
+// Packs cards into instance data, reusing the storage of `instances`. Cards whose layer is not
+// resident fall back to the card back, or to the procedural placeholder if that is missing too.
+void build_card_instances(const std::vector<card>&    cards,
+                          std::uint64_t               resident_layers,
+                          std::vector<card_instance>& instances);
+
+// As above, into exactly cards.size() instances, such as a stream_buffer allocation
+void build_card_instances(const std::vector<card>& cards,
+                          std::uint64_t            resident_layers,
+                          std::span<card_instance> instances);
+
+// Occlusion culling for a batch drawn back to front, such as the fanned tableau piles: drops
+// the instances that later ones cover completely and trims the rest to the part of the card the
+// later ones leave visible, through their rounded corners too. Only covers that span a card's
+// whole width or height and reach over one of its edges count, looked for among the next deck's
+// worth of instances, where a pile's own cards are: what is kept is a superset of what shows,
+// for a cost linear in the batch. Expects whole-card instances; the kept ones are moved to the
+// front in their order and their count returned.
+auto cull_card_instances(std::span<card_instance> instances, card_cull_stats& stats)
+    -> std::size_t;
+
+// Points the VAO's per-instance attributes (divisor 1) at `buffer_id`, from offset 0
+void attach_instance_buffer(GLuint vao_id, GLuint buffer_id);
+
 [[nodiscard]]
 auto create_vao_vbo() -> std::pair<GLuint, GLuint>;
 
-// Returns shader id or error message
-auto compile_card_shader(std::string_view shader_relative_path, GLenum shader_type)
-    -> std::expected<GLuint, error_message_t>;
+auto create_card_renderer(texture_loading loading = texture_loading::blocking,
+                          shader_caching  caching = shader_caching::enabled)
+    -> std::expected<std::shared_ptr<card_renderer>, error_message_t>;
+
+// Swaps in a rebuilt card shader program (see shader_reloader), deleting the old one and
+// restoring its uniforms
+void replace_card_shader(const std::shared_ptr<card_renderer>& cr, GLuint program_id);
+
+// Sets the orthographic projection for a framebuffer of the given size, bottom-left origin
+void set_card_projection(const std::shared_ptr<card_renderer>& cr,
+                         std::int32_t                          width,
+                         std::int32_t                          height);
+
+// Sets the orthographic projection that shows the given area of the layout, in pixels, across
+// the whole viewport
+void set_card_projection(const std::shared_ptr<card_renderer>& cr,
+                         float                                 left,
+                         float                                 right,
+                         float                                 bottom,
+                         float                                 top);
+
+// Limits the mip levels the card texture array is sampled from (GL_TEXTURE_MIN_LOD) and biases
+// the level picked (GL_TEXTURE_LOD_BIAS); see choose_card_texture_lod
+void set_card_texture_lod(const std::shared_ptr<card_renderer>& cr, float min_lod, float bias);
+
+// Draws every card with a single instanced draw call, packing them straight into cr->stream and
+// culling them there unless cr->cull_hidden_cards is off
+void draw_cards(const std::shared_ptr<card_renderer>& cr, const std::vector<card>& cards);
 
-auto create_card_renderer() -> std::expected<std::shared_ptr<card_renderer>, error_message_t>;
+// Draws instance data packed elsewhere (see card_animator) with a single instanced draw call,
+// culled as draw_cards does
+void draw_card_instances(const std::shared_ptr<card_renderer>& cr,
+                         const std::vector<card_instance>&     instances);
 
-void draw_cards(const std::shared_ptr<card_renderer>& cr);
+// (Re)allocates the cached layer for a framebuffer of the given size
+auto resize_card_layer_cache(card_layer_cache& cache, std::int32_t width, std::int32_t height)
+    -> std::expected<void, error_message_t>;
 
-auto link_shader_program(GLuint vertex_shader_id, GLuint fragment_shader_id)
-    -> std::expected<GLuint, error_message_t>;
+// Clears the cached layer with the current clear colour and draws `cards` into it
+void render_card_layer_cache(const std::shared_ptr<card_renderer>& cr,
+                             const card_layer_cache&               cache,
+                             const std::vector<card>&              cards);
+
+// Draws `instances` over what the cached layer already holds, without clearing it
+void stamp_card_layer_cache(const std::shared_ptr<card_renderer>& cr,
+                            const card_layer_cache&               cache,
+                            const std::vector<card_instance>&     instances);
+
+// Copies the cached layer into the bound draw framebuffer, stretched to `width` x `height` with
+// linear filtering when that is not the layer's own size
+void present_card_layer_cache(const card_layer_cache& cache,
+                              std::int32_t            width,
+                              std::int32_t            height);
+
+void destroy_card_layer_cache(card_layer_cache& cache);
 
 // True if loading card textures succeeded, false otherwise
 auto load_card_textures() -> std::expected<GLuint, error_message_t>;
 
+// Uploads every layer of a cooked atlas cache into a new texture array
+auto load_card_textures_from_cache(const atlas_cache& cache) -> GLuint;
+
+// Asset names of the card atlas, looked up through assets()
+constexpr auto card_atlas_png_asset  = std::string_view("Assets/cards.png");
+constexpr auto card_atlas_json_asset = std::string_view("Assets/cards.json");
+
 auto load_json_data() -> std::expected<nlohmann::json, error_message_t>;
 auto load_png_data() -> std::expected<std::shared_ptr<asset_image>, error_message_t>;
 
-// For reading shader code
+// Advances streamed texture loading; true once every layer is resident (always true when blocking)
+auto pump_card_textures(const std::shared_ptr<card_renderer>& cr)
+    -> std::expected<bool, error_message_t>;
+
+// For reading shader code. A relative path is an asset name, served from the pack when it holds
+// one; an absolute path is always read from disk.
 auto read_file_content(const std::filesystem::path& path)
     -> std::expected<std::string, error_message_t>;
 #endif // _GAME_CARDS_HPP__
@@ -0,0 +1,262 @@
+#include "deal_stats.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <thread>
+
+namespace {
+
+// Parsed contents of a deal file up to its last complete chunk
+struct deal_file_contents
+{
+    deal_file_header         header;
+    std::vector<deal_record> records;
+    std::size_t              valid_bytes;
+};
+
+template <typename value_t>
+auto read_value(const std::vector<char>& bytes, std::size_t offset) -> value_t
+{
+    auto value = value_t();
+    std::memcpy(&value, bytes.data() + offset, sizeof(value_t));
+    return value;
+}
+
+template <typename value_t>
+void write_column(std::vector<char>& out, std::span<const deal_record> records, auto field)
+{
+    for (const auto& record : records)
+    {
+        const auto value = value_t(field(record));
+        const auto first = reinterpret_cast<const char*>(&value);
+        out.insert(out.end(), first, first + sizeof(value_t));
+    }
+}
+
+auto load_deal_file(const std::filesystem::path& path)
+    -> std::expected<deal_file_contents, error_message_t>
+{
+    auto in = std::ifstream(path, std::ios::binary);
+    if (!in)
+    {
+        return std::unexpected("Failed to open deal file: " + path.string());
+    }
+    const auto bytes = std::vector<char>(std::istreambuf_iterator<char>(in), {});
+    if (bytes.size() < sizeof(deal_file_header))
+    {
+        return std::unexpected("Deal file is too small: " + path.string());
+    }
+
+    auto contents        = deal_file_contents{};
+    contents.header      = read_value<deal_file_header>(bytes, 0);
+    contents.valid_bytes = sizeof(deal_file_header);
+    if (contents.header.magic != deal_file_magic || contents.header.version != deal_file_version)
+    {
+        return std::unexpected("Not a deal file, or an unsupported version: " + path.string());
+    }
+
+    // Walk the chunks; anything after the last complete one is a torn write
+    auto offset = contents.valid_bytes;
+    while (offset + sizeof(deal_chunk_header) <= bytes.size())
+    {
+        const auto chunk = read_value<deal_chunk_header>(bytes, offset);
+        const auto next_seed =
+            contents.header.first_seed + std::uint64_t(contents.records.size());
+        const auto end = offset + sizeof(deal_chunk_header) + chunk.count * deal_record_bytes;
+        if (chunk.magic != deal_chunk_magic || chunk.first_seed != next_seed ||
+            end > bytes.size())
+        {
+            break;
+        }
+
+        const auto positions = offset + sizeof(deal_chunk_header);
+        const auto lengths   = positions + chunk.count * sizeof(std::uint32_t);
+        const auto outcomes  = lengths + chunk.count * sizeof(std::uint16_t);
+        const auto passes    = outcomes + chunk.count;
+        for (auto i = std::size_t(0); i < chunk.count; ++i)
+        {
+            auto record            = deal_record{};
+            record.seed            = chunk.first_seed + i;
+            record.positions       = read_value<std::uint32_t>(bytes, positions + i * 4);
+            record.solution_length = read_value<std::uint16_t>(bytes, lengths + i * 2);
+            record.outcome         = deal_outcome(bytes[outcomes + i]);
+            record.stock_passes    = std::uint8_t(bytes[passes + i]);
+            contents.records.push_back(record);
+        }
+        offset               = end;
+        contents.valid_bytes = end;
+    }
+    return contents;
+}
+
+} // namespace
+
+auto deal_stats_writer::open(const std::filesystem::path& path,
+                             std::uint8_t                 draw_count,
+                             std::uint64_t                first_seed)
+    -> std::expected<deal_stats_writer, error_message_t>
+{
+    auto       size_error = std::error_code();
+    const auto size       = std::filesystem::file_size(path, size_error);
+    if (!size_error && size > 0)
+    {
+        auto contents = load_deal_file(path);
+        if (!contents)
+        {
+            return std::unexpected(contents.error());
+        }
+        if (contents->header.draw_count != draw_count)
+        {
+            return std::unexpected("Deal file was written for a different draw count: " +
+                                   path.string());
+        }
+        if (contents->header.first_seed != first_seed)
+        {
+            return std::unexpected("Deal file starts at seed " +
+                                   std::to_string(contents->header.first_seed) + ", not " +
+                                   std::to_string(first_seed) + ": " + path.string());
+        }
+
+        auto resize_error = std::error_code();
+        std::filesystem::resize_file(path, contents->valid_bytes, resize_error);
+        if (resize_error)
+        {
+            return std::unexpected("Failed to truncate deal file: " + resize_error.message());
+        }
+
+        auto out = std::ofstream(path, std::ios::binary | std::ios::app);
+        if (!out)
+        {
+            return std::unexpected("Failed to reopen deal file: " + path.string());
+        }
+        return deal_stats_writer(std::move(out),
+                                 contents->header.first_seed + contents->records.size());
+    }
+
+    auto out = std::ofstream(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        return std::unexpected("Failed to create deal file: " + path.string());
+    }
+    const auto header = deal_file_header{deal_file_magic, deal_file_version, draw_count, 0,
+                                         first_seed};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.flush();
+    if (!out)
+    {
+        return std::unexpected("Failed to write deal file header: " + path.string());
+    }
+    return deal_stats_writer(std::move(out), first_seed);
+}
+
+auto deal_stats_writer::append_chunk(std::span<const deal_record> records)
+    -> std::expected<void, error_message_t>
+{
+    if (records.empty())
+    {
+        return {};
+    }
+    if (records.front().seed != next_seed_)
+    {
+        return std::unexpected("Chunk does not continue at seed " + std::to_string(next_seed_));
+    }
+
+    const auto header = deal_chunk_header{
+        deal_chunk_magic, std::uint32_t(records.size()), records.front().seed};
+    auto chunk = std::vector<char>(reinterpret_cast<const char*>(&header),
+                                   reinterpret_cast<const char*>(&header) + sizeof(header));
+    chunk.reserve(sizeof(header) + records.size() * deal_record_bytes);
+    write_column<std::uint32_t>(chunk, records, [](const auto& r) { return r.positions; });
+    write_column<std::uint16_t>(chunk, records, [](const auto& r) { return r.solution_length; });
+    write_column<std::uint8_t>(chunk, records, [](const auto& r) { return r.outcome; });
+    write_column<std::uint8_t>(chunk, records, [](const auto& r) { return r.stock_passes; });
+
+    // One write per chunk and a flush, so a crash leaves at most one torn chunk at the end
+    out_.write(chunk.data(), std::streamsize(chunk.size()));
+    out_.flush();
+    if (!out_)
+    {
+        return std::unexpected(error_message_t("Failed to append to deal file"));
+    }
+    next_seed_ += records.size();
+    return {};
+}
+
+auto analyse_deal(std::uint64_t         seed,
+                  std::uint8_t          draw_count,
+                  const solver_options& options,
+                  transposition_table&  table) -> deal_record
+{
+    auto deal_options         = options;
+    deal_options.thread_count = 1;
+    deal_options.table        = &table;
+
+    const auto deal   = deal_klondike(shuffle_deck(seed), draw_count);
+    const auto result = solve_klondike(deal, deal_options);
+
+    auto record      = deal_record{};
+    record.seed      = seed;
+    record.positions = std::uint32_t(
+        std::min<std::uint64_t>(result.nodes, std::numeric_limits<std::uint32_t>::max()));
+    switch (result.status)
+    {
+    case solve_status::solved:
+    {
+        record.outcome         = deal_outcome::winnable;
+        record.solution_length = std::uint16_t(result.moves.size());
+
+        // Replay the line to count how often it recycles the stock
+        auto state = deal;
+        for (auto move : result.moves)
+        {
+            apply_move(state, move);
+        }
+        record.stock_passes = state.stock_passes;
+        break;
+    }
+    case solve_status::unsolvable: record.outcome = deal_outcome::unwinnable; break;
+    case solve_status::unknown: record.outcome = deal_outcome::unknown; break;
+    }
+    return record;
+}
+
+void analyse_deals(std::uint64_t          first_seed,
+                   std::uint8_t           draw_count,
+                   const solver_options&  options,
+                   std::size_t            worker_count,
+                   std::span<deal_record> records)
+{
+    if (records.empty())
+    {
+        return;
+    }
+    worker_count            = std::clamp<std::size_t>(worker_count, 1, records.size());
+    const auto table_budget = options.memory_budget / worker_count;
+
+    auto next_index = std::atomic<std::size_t>(0);
+    auto workers    = std::vector<std::jthread>();
+    for (auto worker = std::size_t(0); worker < worker_count; ++worker)
+    {
+        workers.emplace_back([&] {
+            auto table = transposition_table(table_budget);
+            for (auto index = next_index++; index < records.size(); index = next_index++)
+            {
+                records[index] = analyse_deal(first_seed + index, draw_count, options, table);
+            }
+        });
+    }
+}
+
+auto read_deal_stats(const std::filesystem::path& path)
+    -> std::expected<std::vector<deal_record>, error_message_t>
+{
+    auto contents = load_deal_file(path);
+    if (!contents)
+    {
+        return std::unexpected(contents.error());
+    }
+    return std::move(contents->records);
+}
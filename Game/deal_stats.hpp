@@ -0,0 +1,113 @@
+#ifndef _GAME_DEAL_STATS_HPP__
+#define _GAME_DEAL_STATS_HPP__
+
+#include "solver.hpp"
+#include "types.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+
+// Offline classification of seeded deals, stored in a chunked columnar file:
+//
+//   deal_file_header
+//   chunk: deal_chunk_header | positions u32[n] | solution_length u16[n] | outcome u8[n]
+//          | stock_passes u8[n]
+//
+// Seeds are implicit (first_seed + index), and chunks are only ever appended whole, so the
+// file doubles as the checkpoint: reopening it drops a torn final chunk and resumes after the
+// last complete one.
+
+enum class deal_outcome : std::uint8_t
+{
+    unknown    = 0, // The search hit its position limit
+    winnable   = 1,
+    unwinnable = 2
+};
+
+struct deal_record
+{
+    std::uint64_t seed            = 0;
+    deal_outcome  outcome         = deal_outcome::unknown;
+    std::uint16_t solution_length = 0; // Moves in the first winning line found, not a minimum
+    std::uint8_t  stock_passes    = 0; // Times the winning line turns the waste over
+    std::uint32_t positions       = 0; // Search effort, saturated at UINT32_MAX
+};
+
+struct deal_file_header
+{
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint8_t  draw_count;
+    std::uint8_t  reserved;
+    std::uint64_t first_seed;
+};
+
+struct deal_chunk_header
+{
+    std::uint32_t magic;
+    std::uint32_t count;
+    std::uint64_t first_seed;
+};
+
+constexpr auto deal_file_magic   = std::uint32_t(0x534C4453); // "SDLS"
+constexpr auto deal_chunk_magic  = std::uint32_t(0x4B484344); // "DCHK"
+constexpr auto deal_file_version = std::uint16_t(1);
+
+// Bytes per record across all columns
+constexpr auto deal_record_bytes = sizeof(std::uint32_t) + sizeof(std::uint16_t) + 2;
+
+// Appends chunks of records to a deal file, creating it or resuming an existing one
+class deal_stats_writer
+{
+public:
+    // Opens `path` for appending. An existing file must have been written with the same draw
+    // count and first seed, so that resuming continues the range asked for; it is truncated to
+    // its last complete chunk and writing resumes after it.
+    static auto open(const std::filesystem::path& path,
+                     std::uint8_t                 draw_count,
+                     std::uint64_t                first_seed)
+        -> std::expected<deal_stats_writer, error_message_t>;
+
+    // First seed not yet in the file
+    auto next_seed() const -> std::uint64_t { return next_seed_; }
+
+    // Records must be consecutive seeds starting at next_seed(); flushed before returning
+    auto append_chunk(std::span<const deal_record> records)
+        -> std::expected<void, error_message_t>;
+
+private:
+    deal_stats_writer(std::ofstream out, std::uint64_t next_seed)
+        : out_(std::move(out))
+        , next_seed_(next_seed)
+    {
+    }
+
+    std::ofstream out_;
+    std::uint64_t next_seed_;
+};
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+// Deals `seed` and solves it single-threaded, reusing `table`
+auto analyse_deal(std::uint64_t         seed,
+                  std::uint8_t          draw_count,
+                  const solver_options& options,
+                  transposition_table&  table) -> deal_record;
+
+// Classifies seeds [first_seed, first_seed + records.size()) into `records`, one deal per
+// worker thread at a time. Each worker gets an equal share of options.memory_budget.
+void analyse_deals(std::uint64_t          first_seed,
+                   std::uint8_t           draw_count,
+                   const solver_options&  options,
+                   std::size_t            worker_count,
+                   std::span<deal_record> records);
+
+// Every record in complete chunks of a deal file
+auto read_deal_stats(const std::filesystem::path& path)
+    -> std::expected<std::vector<deal_record>, error_message_t>;
+
+#endif // _GAME_DEAL_STATS_HPP__
@@ -0,0 +1,38 @@
+#include "frame_pacer.hpp"
+
+auto frame_pacer::wait_timeout() const -> std::optional<double>
+{
+    if (continuous_ || pending_ != redraw_none)
+    {
+        return 0.0;
+    }
+    if (animating_ || streaming_ || compiling_)
+    {
+        return tick_seconds;
+    }
+    return std::nullopt;
+}
+
+auto frame_pacer::next_frame() -> frame_plan
+{
+    if (animating_)
+    {
+        pending_ |= redraw_dynamic;
+    }
+
+    auto plan = frame_plan{};
+    if (pending_ == redraw_none && !continuous_)
+    {
+        ++counters_.idle_waits;
+        return plan;
+    }
+
+    plan.render         = true;
+    plan.resize         = (pending_ & redraw_viewport) != 0;
+    plan.rebuild_static = (pending_ & (redraw_table | redraw_viewport)) != 0;
+    pending_            = redraw_none;
+
+    ++counters_.frames;
+    counters_.static_rebuilds += plan.rebuild_static ? 1 : 0;
+    return plan;
+}
@@ -0,0 +1,77 @@
+#ifndef _GAME_FRAME_PACER_HPP__
+#define _GAME_FRAME_PACER_HPP__
+
+#include <cstdint>
+#include <optional>
+
+// Why the next frame has to be drawn. Anything that changes what is on screen invalidates the
+// pacer with one of these; with nothing pending the game loop blocks in glfwWaitEvents.
+enum redraw_reason : std::uint32_t
+{
+    redraw_none     = 0,
+    redraw_table    = 1 << 0, // Cards in the static layer changed, so it is rebuilt
+    redraw_dynamic  = 1 << 1, // Only dragged or animating cards moved
+    redraw_viewport = 1 << 2, // Framebuffer resized or exposed; the static layer is reallocated
+};
+
+// What the loop has to do for one frame
+struct frame_plan
+{
+    bool render         = false; // Present a frame at all
+    bool rebuild_static = false; // Redraw the cached layer of cards that are not moving
+    bool resize         = false; // Reallocate the cached layer first
+};
+
+struct frame_counters
+{
+    std::uint64_t frames          = 0; // Frames presented
+    std::uint64_t static_rebuilds = 0; // Times the cached layer was redrawn
+    std::uint64_t idle_waits      = 0; // Loop iterations that blocked with nothing to draw
+};
+
+// Decides when the event-driven game loop draws and how long it may sleep. GLFW-free, so the
+// loop's behaviour over a sequence of events can be checked without a window.
+class frame_pacer
+{
+public:
+    // Seconds between frames while something moves on its own (animation, texture streaming)
+    static constexpr auto tick_seconds = 1.0 / 120.0;
+
+    frame_pacer() = default;
+
+    // Continuous mode renders every iteration, as the loop did before it was event driven
+    explicit frame_pacer(bool continuous)
+        : continuous_(continuous)
+    {
+    }
+
+    void invalidate(std::uint32_t reasons) { pending_ |= reasons; }
+
+    // Animations redraw their cards every tick until they stop
+    void set_animating(bool animating) { animating_ = animating; }
+
+    // Streaming textures need the loop to keep pumping uploads, but not to redraw
+    void set_streaming(bool streaming) { streaming_ = streaming; }
+
+    // Likewise a shader rebuild, whose completion is polled until it can be swapped in
+    void set_compiling(bool compiling) { compiling_ = compiling; }
+
+    // How long the loop may wait for events: nullopt blocks until one arrives, 0 only polls
+    auto wait_timeout() const -> std::optional<double>;
+
+    // Consumes the pending reasons and counts the frame; call once per loop iteration, after
+    // events have been handled
+    auto next_frame() -> frame_plan;
+
+    auto counters() const -> const frame_counters& { return counters_; }
+
+private:
+    std::uint32_t  pending_    = redraw_viewport; // The first frame allocates the layer
+    bool           animating_  = false;
+    bool           streaming_  = false;
+    bool           compiling_  = false;
+    bool           continuous_ = false;
+    frame_counters counters_;
+};
+
+#endif // _GAME_FRAME_PACER_HPP__
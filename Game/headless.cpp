@@ -0,0 +1,734 @@
+#include "headless.hpp"
+#include "cards.hpp"
+#include "render_scale.hpp"
+#include "solver.hpp"
+#include "table_grid.hpp"
+#include "table_layout.hpp"
+
+// clang-format off
+#include <glad/gl.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+// clang-format on
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <string_view>
+
+namespace {
+
+// Frames in flight before a GPU timer query is read back, so reading never stalls the pipeline
+constexpr auto timer_query_count = std::size_t(8);
+
+// Each scripted move stays on screen for this many frames
+constexpr auto frames_per_move = 2;
+
+auto has_extension(const char* extensions, std::string_view name) -> bool
+{
+    if (extensions == nullptr)
+    {
+        return false;
+    }
+    for (auto list = std::string_view(extensions); !list.empty();)
+    {
+        const auto end = std::min(list.find(' '), list.size());
+        if (list.substr(0, end) == name)
+        {
+            return true;
+        }
+        list.remove_prefix(std::min(end + 1, list.size()));
+    }
+    return false;
+}
+
+// EGL display, context and (when surfaceless contexts are unsupported) a tiny pbuffer.
+// Rendering always goes to a framebuffer object, so the surface size does not matter.
+class egl_context
+{
+public:
+    egl_context() = default;
+    ~egl_context()
+    {
+        if (display_ == EGL_NO_DISPLAY)
+        {
+            return;
+        }
+        eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (context_ != EGL_NO_CONTEXT)
+        {
+            eglDestroyContext(display_, context_);
+        }
+        if (surface_ != EGL_NO_SURFACE)
+        {
+            eglDestroySurface(display_, surface_);
+        }
+        eglTerminate(display_);
+    }
+
+    egl_context(const egl_context&)            = delete;
+    egl_context& operator=(const egl_context&) = delete;
+
+    auto create() -> std::expected<void, error_message_t>
+    {
+        const auto* client_extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        display_ = has_extension(client_extensions, "EGL_MESA_platform_surfaceless")
+                       ? eglGetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,
+                                               reinterpret_cast<void*>(EGL_DEFAULT_DISPLAY),
+                                               nullptr)
+                       : eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (display_ == EGL_NO_DISPLAY || !eglInitialize(display_, nullptr, nullptr))
+        {
+            display_ = EGL_NO_DISPLAY;
+            return std::unexpected(error_message_t("Failed to initialize an EGL display"));
+        }
+        if (!eglBindAPI(EGL_OPENGL_API))
+        {
+            return std::unexpected(error_message_t("EGL display does not support desktop GL"));
+        }
+
+        constexpr auto config_attributes = std::array<EGLint, 13>{EGL_SURFACE_TYPE,
+                                                                  EGL_PBUFFER_BIT,
+                                                                  EGL_RENDERABLE_TYPE,
+                                                                  EGL_OPENGL_BIT,
+                                                                  EGL_RED_SIZE,
+                                                                  8,
+                                                                  EGL_GREEN_SIZE,
+                                                                  8,
+                                                                  EGL_BLUE_SIZE,
+                                                                  8,
+                                                                  EGL_ALPHA_SIZE,
+                                                                  8,
+                                                                  EGL_NONE};
+        auto config       = EGLConfig();
+        auto config_count = EGLint(0);
+        if (!eglChooseConfig(display_, config_attributes.data(), &config, 1, &config_count) ||
+            config_count == 0)
+        {
+            return std::unexpected(error_message_t("No EGL config supports desktop GL"));
+        }
+
+        // The game asks for 4.6; Mesa's llvmpipe stops at 4.5, which the shaders also accept
+        for (const auto minor : {6, 5})
+        {
+            const auto context_attributes =
+                std::array<EGLint, 7>{EGL_CONTEXT_MAJOR_VERSION,
+                                      4,
+                                      EGL_CONTEXT_MINOR_VERSION,
+                                      minor,
+                                      EGL_CONTEXT_OPENGL_PROFILE_MASK,
+                                      EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                                      EGL_NONE};
+            context_ =
+                eglCreateContext(display_, config, EGL_NO_CONTEXT, context_attributes.data());
+            if (context_ != EGL_NO_CONTEXT)
+            {
+                break;
+            }
+        }
+        if (context_ == EGL_NO_CONTEXT)
+        {
+            return std::unexpected(error_message_t("Failed to create an OpenGL 4.5 EGL context"));
+        }
+
+        const auto* display_extensions = eglQueryString(display_, EGL_EXTENSIONS);
+        if (!has_extension(display_extensions, "EGL_KHR_surfaceless_context"))
+        {
+            constexpr auto pbuffer_attributes =
+                std::array<EGLint, 5>{EGL_WIDTH, 16, EGL_HEIGHT, 16, EGL_NONE};
+            surface_ = eglCreatePbufferSurface(display_, config, pbuffer_attributes.data());
+            if (surface_ == EGL_NO_SURFACE)
+            {
+                return std::unexpected(error_message_t("Failed to create an EGL pbuffer"));
+            }
+        }
+        if (!eglMakeCurrent(display_, surface_, surface_, context_))
+        {
+            return std::unexpected(error_message_t("Failed to make the EGL context current"));
+        }
+
+        if (gladLoadGL(reinterpret_cast<GLADloadfunc>(eglGetProcAddress)) == 0)
+        {
+            return std::unexpected(error_message_t("Failed to load OpenGL through EGL"));
+        }
+        return {};
+    }
+
+private:
+    EGLDisplay display_ = EGL_NO_DISPLAY;
+    EGLContext context_ = EGL_NO_CONTEXT;
+    EGLSurface surface_ = EGL_NO_SURFACE;
+};
+
+// Colour renderbuffer the frames are drawn into
+class offscreen_target
+{
+public:
+    offscreen_target(std::int32_t width, std::int32_t height)
+    {
+        glGenRenderbuffers(1, &color_);
+        glBindRenderbuffer(GL_RENDERBUFFER, color_);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+        glGenFramebuffers(1, &framebuffer_);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer_);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_);
+    }
+    ~offscreen_target()
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &framebuffer_);
+        glDeleteRenderbuffers(1, &color_);
+    }
+
+    offscreen_target(const offscreen_target&)            = delete;
+    offscreen_target& operator=(const offscreen_target&) = delete;
+
+    auto complete() const -> bool
+    {
+        return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    }
+
+private:
+    GLuint framebuffer_ = 0;
+    GLuint color_       = 0;
+};
+
+// Plays one deal through a fixed list of moves, then starts over, so every run draws the same
+// sequence of tables
+class scripted_scene
+{
+public:
+    explicit scripted_scene(std::uint64_t seed)
+        : deal_(deal_klondike(shuffle_deck(seed)))
+        , state_(deal_)
+    {
+        // A winning line when the solver finds one quickly, otherwise the first legal move of
+        // each position; either way the whole table gets shuffled around
+        const auto options = solver_options{
+            .thread_count = 1, .memory_budget = 16 << 20, .node_limit = 200'000};
+        auto result = solve_klondike(deal_, options);
+        if (result.status == solve_status::solved)
+        {
+            script_ = std::move(result.moves);
+            return;
+        }
+
+        auto state = deal_;
+        auto moves = move_list{};
+        for (auto step = 0; step < 300; ++step)
+        {
+            generate_moves(state, moves);
+            if (moves.size == 0)
+            {
+                break;
+            }
+            auto move = moves[0];
+            apply_move(state, move);
+            script_.push_back(move);
+        }
+    }
+
+    void advance()
+    {
+        if (next_ == script_.size())
+        {
+            state_ = deal_;
+            next_  = 0;
+            return;
+        }
+        auto move = script_[next_++];
+        apply_move(state_, move);
+    }
+
+    auto state() const -> const klondike_state& { return state_; }
+
+private:
+    klondike_state             deal_;
+    klondike_state             state_;
+    std::vector<klondike_move> script_;
+    std::size_t                next_ = 0;
+};
+
+auto dump_frame(const headless_options& options, std::int32_t frame)
+    -> std::expected<void, error_message_t>
+{
+    auto pixels = std::vector<std::uint8_t>(std::size_t(options.width) * options.height * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, options.width, options.height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+    auto name = std::array<char, 32>();
+    std::snprintf(name.data(), name.size(), "frame_%05d.png", frame);
+    const auto path = options.dump_directory / name.data();
+
+    // GL rows start at the bottom
+    stbi_flip_vertically_on_write(1);
+    const auto row_bytes = options.width * 4;
+    if (stbi_write_png(path.string().c_str(),
+                       options.width,
+                       options.height,
+                       4,
+                       pixels.data(),
+                       row_bytes) == 0)
+    {
+        return std::unexpected("Failed to write frame dump: " + path.string());
+    }
+    return {};
+}
+
+auto parse_integer(const char* text) -> std::expected<std::int64_t, error_message_t>
+{
+    auto*      end   = static_cast<char*>(nullptr);
+    const auto value = std::strtoll(text, &end, 10);
+    if (end == text || *end != '\0' || value < 0)
+    {
+        return std::unexpected("Expected a non-negative number, got: " + std::string(text));
+    }
+    return value;
+}
+
+} // namespace
+
+auto parse_headless_options(int argc, char** argv)
+    -> std::expected<headless_options, error_message_t>
+{
+    auto options = headless_options{};
+    for (auto i = 0; i < argc; ++i)
+    {
+        const auto argument = std::string_view(argv[i]);
+        if (argument == "--no-shader-cache")
+        {
+            options.shader_cache = false;
+            continue;
+        }
+        if (argument == "--no-cull")
+        {
+            options.cull_cards = false;
+            continue;
+        }
+        if (argument == "--table-sweep")
+        {
+            options.table_sweep = true;
+            continue;
+        }
+        if (argument == "--dump-dir" && i + 1 < argc)
+        {
+            options.dump_directory = argv[++i];
+            continue;
+        }
+        if (argument == "--render-scale" && i + 1 < argc)
+        {
+            auto scale = 0.0f;
+            if (std::sscanf(argv[++i], "%f", &scale) != 1 || scale < min_render_scale ||
+                scale > max_render_scale)
+            {
+                return std::unexpected("Expected --render-scale between 0.25 and 1, got: " +
+                                       std::string(argv[i]));
+            }
+            options.render_scale = scale;
+            continue;
+        }
+        if (argument == "--size" && i + 1 < argc)
+        {
+            auto width = 0, height = 0;
+            if (std::sscanf(argv[++i], "%dx%d", &width, &height) != 2 || width <= 0 ||
+                height <= 0)
+            {
+                return std::unexpected("Expected --size WIDTHxHEIGHT, got: " +
+                                       std::string(argv[i]));
+            }
+            options.width  = width;
+            options.height = height;
+            continue;
+        }
+
+        const auto is_number_option = argument == "--frames" || argument == "--warmup" ||
+                                      argument == "--seed" || argument == "--dump-frame" ||
+                                      argument == "--tables";
+        if (!is_number_option || i + 1 >= argc)
+        {
+            return std::unexpected("Unknown headless argument: " + std::string(argument));
+        }
+        const auto value = parse_integer(argv[++i]);
+        if (!value)
+        {
+            return std::unexpected(value.error());
+        }
+
+        if (argument == "--frames")
+        {
+            options.frame_count = std::int32_t(value.value());
+        }
+        else if (argument == "--warmup")
+        {
+            options.warmup = std::int32_t(value.value());
+        }
+        else if (argument == "--seed")
+        {
+            options.seed = std::uint64_t(value.value());
+        }
+        else if (argument == "--tables")
+        {
+            options.table_count = std::int32_t(value.value());
+        }
+        else
+        {
+            options.dump_frames.push_back(std::int32_t(value.value()));
+        }
+    }
+    return options;
+}
+
+auto run_headless(const headless_options& options)
+    -> std::expected<headless_report, error_message_t>
+{
+    auto context = egl_context();
+    if (auto result = context.create(); !result)
+    {
+        return std::unexpected(result.error());
+    }
+
+    auto report     = headless_report{};
+    report.renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+
+    // Scoped so every GL object is released while the context is still current
+    {
+        auto target = offscreen_target(options.width, options.height);
+        if (!target.complete())
+        {
+            return std::unexpected(error_message_t("Offscreen framebuffer is incomplete"));
+        }
+
+        auto renderer_result = create_card_renderer(
+            texture_loading::blocking,
+            options.shader_cache ? shader_caching::enabled : shader_caching::disabled);
+        if (!renderer_result)
+        {
+            return std::unexpected("Failed to create card renderer: " + renderer_result.error());
+        }
+        auto cr             = renderer_result.value();
+        report.shader_stats = cr->shader_stats;
+
+        auto grid = std::shared_ptr<table_grid_renderer>();
+        if (options.table_count > 0)
+        {
+            auto grid_result = create_table_grid_renderer(
+                options.shader_cache ? shader_caching::enabled : shader_caching::disabled);
+            if (!grid_result)
+            {
+                return std::unexpected("Failed to create table grid renderer: " +
+                                       grid_result.error());
+            }
+            grid             = grid_result.value();
+            const auto tiles = layout_table_grid(
+                options.table_count, options.width, options.height, table_metrics{});
+            set_table_grid_tiles(*grid, tiles);
+            set_table_grid_projection(*grid, options.width, options.height);
+        }
+
+        // The one table is fitted into the framebuffer like the window's; a grid keeps its
+        // projection in framebuffer pixels and scales every table into its tile
+        const auto viewport = fit_table_viewport(
+            table_metrics{}, options.width, options.height, options.render_scale);
+        if (grid)
+        {
+            set_card_projection(cr, options.width, options.height);
+        }
+        else
+        {
+            const auto& area = viewport.area;
+            const auto  lod  = choose_card_texture_lod(viewport);
+            set_card_projection(cr, area.left, area.right, area.bottom, area.top);
+            set_card_texture_lod(cr, lod.min_lod, lod.bias);
+        }
+        report.render_width  = viewport.render_width;
+        report.render_height = viewport.render_height;
+
+        // Below full render scale frames are drawn at the render size and stretched out
+        auto offscreen_framebuffer = GLint(0);
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &offscreen_framebuffer);
+        auto scene = card_layer_cache{};
+        if (viewport.scaled())
+        {
+            if (auto result =
+                    resize_card_layer_cache(scene, viewport.render_width, viewport.render_height);
+                !result)
+            {
+                return std::unexpected(result.error());
+            }
+        }
+
+        glDisable(GL_DEPTH_TEST);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+        glUniform1i(glGetUniformLocation(cr->shader_program, "uCardTextures"), 0);
+        glViewport(0, 0, viewport.render_width, viewport.render_height);
+
+        // A GL_TIMESTAMP pair per frame; a GL_TIME_ELAPSED query would overlap the profiler's
+        // GPU scopes inside the drawing
+        auto queries = std::array<GLuint, timer_query_count * 2>();
+        glGenQueries(GLsizei(queries.size()), queries.data());
+
+        const auto metrics = table_metrics{};
+        const auto total   = options.warmup + options.frame_count;
+        report.table_count = options.table_count;
+
+        // Every table plays its own deal, half of them a frame out of step
+        auto scenes = std::vector<scripted_scene>();
+        for (auto i = 0; i < std::max(options.table_count, 1); ++i)
+        {
+            scenes.emplace_back(options.seed + std::uint64_t(i));
+        }
+        auto tables                 = std::vector<std::vector<card>>(scenes.size());
+        auto timed_draw_calls_start = cr->draw_calls;
+        cr->cull_hidden_cards       = options.cull_cards;
+
+        // Counts fragment shader invocations of each timed frame's card drawing; the stretch to
+        // the framebuffer below full render scale is a blit, which drivers may shade or not
+        report.fragments_measured = GLAD_GL_VERSION_4_6 || GLAD_GL_ARB_pipeline_statistics_query;
+        auto fragment_queries     = std::vector<GLuint>();
+        if (report.fragments_measured)
+        {
+            fragment_queries.resize(std::size_t(options.frame_count));
+            glGenQueries(GLsizei(fragment_queries.size()), fragment_queries.data());
+        }
+        auto read_result = [&](std::int32_t frame) {
+            const auto pair  = frame % timer_query_count * 2;
+            auto       start = GLuint64(0);
+            auto       end   = GLuint64(0);
+            glGetQueryObjectui64v(queries[pair], GL_QUERY_RESULT, &start);
+            glGetQueryObjectui64v(queries[pair + 1], GL_QUERY_RESULT, &end);
+            if (frame >= options.warmup)
+            {
+                report.gpu_ms.push_back(double(end - start) / 1e6);
+            }
+        };
+
+        for (auto frame = 0; frame < total; ++frame)
+        {
+            if (frame == options.warmup)
+            {
+                timed_draw_calls_start = cr->draw_calls;
+                cr->cull_stats         = {};
+            }
+            const auto timed           = frame - options.warmup;
+            const auto count_fragments = report.fragments_measured && timed >= 0;
+
+            const auto cpu_start   = std::chrono::steady_clock::now();
+            report.cards_per_frame = 0;
+            for (auto i = std::size_t(0); i < scenes.size(); ++i)
+            {
+                if ((std::size_t(frame) + i) % frames_per_move == 0)
+                {
+                    scenes[i].advance();
+                }
+                layout_table(scenes[i].state(), metrics, tables[i]);
+                report.cards_per_frame += tables[i].size();
+            }
+
+            glQueryCounter(queries[frame % timer_query_count * 2], GL_TIMESTAMP);
+            if (count_fragments)
+            {
+                glBeginQuery(GL_FRAGMENT_SHADER_INVOCATIONS, fragment_queries[timed]);
+            }
+            if (viewport.scaled())
+            {
+                glBindFramebuffer(GL_DRAW_FRAMEBUFFER, scene.framebuffer);
+            }
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            cr->stream->begin_frame();
+            const auto submit_start = std::chrono::steady_clock::now();
+            if (grid)
+            {
+                draw_table_grid(cr, *grid, tables);
+            }
+            else
+            {
+                draw_cards(cr, tables.front());
+            }
+            const auto submit_end = std::chrono::steady_clock::now();
+            cr->stream->end_frame();
+            if (count_fragments)
+            {
+                glEndQuery(GL_FRAGMENT_SHADER_INVOCATIONS);
+            }
+            if (viewport.scaled())
+            {
+                glBindFramebuffer(GL_DRAW_FRAMEBUFFER, GLuint(offscreen_framebuffer));
+                present_card_layer_cache(scene, options.width, options.height);
+            }
+            glQueryCounter(queries[frame % timer_query_count * 2 + 1], GL_TIMESTAMP);
+            glFlush();
+
+            const auto cpu_end = std::chrono::steady_clock::now();
+            if (timed >= 0)
+            {
+                report.cpu_ms.push_back(
+                    std::chrono::duration<double, std::milli>(cpu_end - cpu_start).count());
+                report.submit_ms.push_back(
+                    std::chrono::duration<double, std::milli>(submit_end - submit_start).count());
+                if (std::ranges::find(options.dump_frames, timed) != options.dump_frames.end())
+                {
+                    if (auto result = dump_frame(options, timed); !result)
+                    {
+                        return std::unexpected(result.error());
+                    }
+                }
+            }
+
+            // Reuse of a query slot requires its previous result
+            if (frame + 1 >= std::int32_t(timer_query_count))
+            {
+                read_result(frame + 1 - std::int32_t(timer_query_count));
+            }
+        }
+        for (auto frame = std::max(total + 1 - std::int32_t(timer_query_count), 0); frame < total;
+             ++frame)
+        {
+            read_result(frame);
+        }
+        glDeleteQueries(GLsizei(queries.size()), queries.data());
+        for (const auto query : fragment_queries)
+        {
+            auto fragments = GLuint64(0);
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &fragments);
+            report.fragments += fragments;
+        }
+        if (!fragment_queries.empty())
+        {
+            glDeleteQueries(GLsizei(fragment_queries.size()), fragment_queries.data());
+        }
+        report.stream_stats = cr->stream->stats();
+        report.draw_calls   = cr->draw_calls - timed_draw_calls_start;
+        report.cull_stats   = cr->cull_stats;
+        destroy_card_layer_cache(scene);
+        if (grid)
+        {
+            destroy_table_grid_renderer(*grid);
+        }
+    }
+    return report;
+}
+
+auto run_offscreen(std::int32_t width, std::int32_t height, const std::function<void()>& body)
+    -> std::expected<void, error_message_t>
+{
+    auto context = egl_context();
+    if (auto result = context.create(); !result)
+    {
+        return std::unexpected(result.error());
+    }
+
+    auto target = offscreen_target(width, height);
+    if (!target.complete())
+    {
+        return std::unexpected(error_message_t("Offscreen framebuffer is incomplete"));
+    }
+    body();
+    return {};
+}
+
+auto summarize_frame_times(std::vector<double> times) -> frame_time_stats
+{
+    if (times.empty())
+    {
+        return {};
+    }
+    std::ranges::sort(times);
+
+    // Nearest-rank percentiles
+    const auto at = [&times](double percentile) {
+        const auto rank = std::size_t(percentile / 100.0 * double(times.size()) + 0.999999);
+        return times[std::clamp<std::size_t>(rank, 1, times.size()) - 1];
+    };
+
+    auto stats = frame_time_stats{};
+    stats.p50  = at(50.0);
+    stats.p90  = at(90.0);
+    stats.p99  = at(99.0);
+    stats.max  = times.back();
+    stats.mean = std::accumulate(times.begin(), times.end(), 0.0) / double(times.size());
+    return stats;
+}
+
+void print_headless_report(const headless_report& report)
+{
+    std::printf("Renderer: %s\n", report.renderer.c_str());
+    std::printf("Render:   %dx%d\n", report.render_width, report.render_height);
+    std::printf("Shaders:  %.3f ms (%s)\n",
+                report.shader_stats.milliseconds,
+                report.shader_stats.from_cache ? "binary cache" : "compiled");
+    std::printf("Stream:   %llu stalls, %.3f ms waiting on fences (max %.3f ms), "
+                "peak %zu of %zu bytes per frame\n",
+                static_cast<unsigned long long>(report.stream_stats.stalls),
+                report.stream_stats.wait_ms,
+                report.stream_stats.max_wait_ms,
+                report.stream_stats.peak_bytes,
+                report.stream_stats.region_bytes);
+    std::printf(
+        "%-12s %6s %9s %9s %9s %9s %9s\n", "", "frames", "p50", "p90", "p99", "max", "mean");
+
+    const auto print_row = [](const char* name, const std::vector<double>& times) {
+        const auto stats = summarize_frame_times(times);
+        std::printf("%-12s %6zu %9.3f %9.3f %9.3f %9.3f %9.3f\n",
+                    name,
+                    times.size(),
+                    stats.p50,
+                    stats.p90,
+                    stats.p99,
+                    stats.max,
+                    stats.mean);
+    };
+    print_row("CPU (ms)", report.cpu_ms);
+    print_row("Submit (ms)", report.submit_ms);
+    print_row("GPU (ms)", report.gpu_ms);
+
+    // Per timed frame; the pixel counts are card quads before and after culling
+    const auto  frames = double(std::max<std::size_t>(report.cpu_ms.size(), 1));
+    const auto& cull   = report.cull_stats;
+    if (report.fragments_measured)
+    {
+        std::printf("Fragments: %.0f per frame\n", double(report.fragments) / frames);
+    }
+    const auto drawn = cull.quad_pixels > 0.0 ? cull.visible_pixels / cull.quad_pixels : 1.0;
+    std::printf("Culling:  %.1f of %.1f cards hidden, %.0f of %.0f quad pixels drawn (%.1f%%)\n",
+                double(cull.hidden_cards) / frames,
+                double(cull.cards) / frames,
+                cull.visible_pixels / frames,
+                cull.quad_pixels / frames,
+                100.0 * drawn);
+}
+
+void print_table_scaling(const std::vector<headless_report>& reports)
+{
+    std::printf("%6s %12s %11s %11s %11s %11s %11s\n",
+                "tables",
+                "cards/frame",
+                "draws/frame",
+                "submit p50",
+                "submit p99",
+                "CPU p50",
+                "GPU p50");
+    for (const auto& report : reports)
+    {
+        const auto frames = std::max<std::size_t>(report.cpu_ms.size(), 1);
+        const auto submit = summarize_frame_times(report.submit_ms);
+        std::printf("%6d %12zu %11.2f %11.3f %11.3f %11.3f %11.3f\n",
+                    report.table_count,
+                    report.cards_per_frame,
+                    double(report.draw_calls) / double(frames),
+                    submit.p50,
+                    submit.p99,
+                    summarize_frame_times(report.cpu_ms).p50,
+                    summarize_frame_times(report.gpu_ms).p50);
+    }
+}
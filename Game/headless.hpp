@@ -0,0 +1,102 @@
+#ifndef _GAME_HEADLESS_HPP__
+#define _GAME_HEADLESS_HPP__
+
+#include "cards.hpp"
+#include "shader_manager.hpp"
+#include "stream_buffer.hpp"
+#include "types.hpp"
+
+#include <array>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Options for rendering the scripted benchmark scene without a window
+struct headless_options
+{
+    std::int32_t              width          = 1400;
+    std::int32_t              height         = 1000;
+    std::int32_t              frame_count    = 600;
+    std::int32_t              warmup         = 30; // Frames rendered before timing starts
+    std::uint64_t             seed           = 1;  // Deal played through by the script
+    std::vector<std::int32_t> dump_frames;         // Timed frames written out as PNG
+    std::filesystem::path     dump_directory = ".";
+    bool                      shader_cache   = true; // Load the program binary when it matches
+    bool                      cull_cards     = true; // card_renderer::cull_hidden_cards
+    float                     render_scale   = 1.0f; // See table_viewport
+
+    // 0 draws the one scripted table with draw_cards. N > 0 tiles N independent tables over the
+    // framebuffer, each playing its own deal, and draws them all with draw_table_grid.
+    std::int32_t table_count = 0;
+    bool         table_sweep = false; // Run once per count in headless_sweep_table_counts
+};
+
+// Table counts a --table-sweep run measures, 1x1 up to 16x16
+constexpr auto headless_sweep_table_counts = std::array<std::int32_t, 5>{1, 4, 16, 64, 256};
+
+// Percentiles of a set of frame times, in milliseconds
+struct frame_time_stats
+{
+    double p50  = 0.0;
+    double p90  = 0.0;
+    double p99  = 0.0;
+    double max  = 0.0;
+    double mean = 0.0;
+};
+
+// What a headless run measured; one entry per timed frame
+struct headless_report
+{
+    std::vector<double> cpu_ms;    // Layout, batching and draw submission
+    std::vector<double> gpu_ms;    // GL_TIMESTAMP pair around the frame's GL work
+    std::vector<double> submit_ms; // Packing instances and issuing the draws, layout excluded
+    std::string         renderer;
+    program_build_stats shader_stats; // Shader program at startup
+    stream_buffer_stats stream_stats; // Instance uploads, including time the CPU waited
+
+    std::int32_t  table_count     = 0; // As in headless_options
+    std::int32_t  render_width    = 0; // Size the cards were drawn at before the final stretch
+    std::int32_t  render_height   = 0;
+    std::size_t   cards_per_frame = 0;
+    std::uint64_t draw_calls      = 0; // Over the timed frames
+
+    // Fragment shader invocations drawing the cards of the timed frames, from pipeline statistics
+    // queries where the driver has them; cull_stats is the CPU's estimate of the same work either
+    // way
+    std::uint64_t   fragments          = 0;
+    bool            fragments_measured = false;
+    card_cull_stats cull_stats;
+};
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+// Parses the arguments that follow --headless: "--frames N", "--warmup N", "--size WxH",
+// "--seed N", "--dump-frame N" (repeatable), "--dump-dir DIR", "--no-shader-cache",
+// "--no-cull", "--render-scale S", "--tables N" and "--table-sweep"
+auto parse_headless_options(int argc, char** argv)
+    -> std::expected<headless_options, error_message_t>;
+
+// Creates an offscreen OpenGL context through EGL (surfaceless where Mesa offers it, a pbuffer
+// otherwise), renders the scripted scene into a framebuffer object for the requested number of
+// frames and returns the CPU and GPU time of each one. Assets and shaders are loaded from the
+// working directory, as in the windowed game.
+auto run_headless(const headless_options& options)
+    -> std::expected<headless_report, error_message_t>;
+
+// Runs `body` with a current offscreen context, for tests and tools that need GL but no window
+auto run_offscreen(std::int32_t width, std::int32_t height, const std::function<void()>& body)
+    -> std::expected<void, error_message_t>;
+
+auto summarize_frame_times(std::vector<double> times) -> frame_time_stats;
+
+// Prints the percentile table for a report
+void print_headless_report(const headless_report& report);
+
+// Prints how cards per frame, draw calls and CPU submit time scale over runs with different
+// table counts
+void print_table_scaling(const std::vector<headless_report>& reports);
+
+#endif // _GAME_HEADLESS_HPP__
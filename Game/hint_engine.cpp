@@ -0,0 +1,195 @@
+#include "hint_engine.hpp"
+#include "solver.hpp"
+
+#include <algorithm>
+
+namespace {
+
+// Nodes between clock reads; small enough that a step overruns its budget by microseconds
+constexpr auto clock_check_interval = std::uint32_t(16);
+
+// Weights of evaluate_position
+constexpr auto foundation_weight = 100;
+constexpr auto face_down_weight  = 30;
+constexpr auto empty_pile_weight = 10;
+constexpr auto stock_weight      = 2;
+
+} // namespace
+
+auto evaluate_position(const klondike_state& state) -> std::int32_t
+{
+    auto score = 0;
+    for (auto suit = 0; suit < suit_count; ++suit)
+    {
+        score += foundation_weight * foundation_count(state, suit);
+    }
+    for (auto pile = 0; pile < tableau_count; ++pile)
+    {
+        score -= face_down_weight * state.face_down[pile];
+        score += state.tableau_size[pile] == 0 ? empty_pile_weight : 0;
+    }
+    score -= stock_weight * (state.stock_size + state.waste_size);
+    return score;
+}
+
+hint_search::hint_search(const hint_options& options)
+    : options_(options)
+    , table_(options.table_size)
+{
+    stack_.reserve(std::size_t(options.max_depth) + 1);
+    path_.reserve(std::size_t(options.max_depth));
+}
+
+void hint_search::reset(const klondike_state& start)
+{
+    root_      = start;
+    state_     = start;
+    iteration_ = 0;
+    cut_       = false;
+    stack_.clear();
+    path_.clear();
+
+    best_        = hint_result{};
+    best_.score  = evaluate_position(start);
+    best_.solved = is_won(start);
+
+    auto moves = move_list{};
+    generate_moves(start, moves);
+    order_moves(start, moves);
+    if (moves.size > 0)
+    {
+        best_.line.push_back(moves[0]);
+    }
+    finished_ = moves.size == 0 || best_.solved;
+}
+
+auto hint_search::step(std::chrono::microseconds budget) -> bool
+{
+    const auto deadline = std::chrono::steady_clock::now() + budget;
+    for (auto count = std::uint32_t(1); !finished_; ++count)
+    {
+        if (count % clock_check_interval == 0 && std::chrono::steady_clock::now() >= deadline)
+        {
+            break;
+        }
+        advance();
+    }
+    return finished_;
+}
+
+void hint_search::begin_iteration()
+{
+    ++iteration_;
+    ++generation_;
+    cut_   = false;
+    state_ = root_;
+    path_.clear();
+    remember(root_.hash, iteration_);
+
+    // The best move so far goes first, so the new iteration refines it before anything else
+    auto& top = stack_.emplace_back();
+    generate_moves(state_, top.moves);
+    order_moves(state_, top.moves);
+    const auto first = top.moves.moves.begin();
+    const auto last  = first + std::ptrdiff_t(top.moves.size);
+    const auto best  = std::find_if(first, last, [&](const klondike_move& move) {
+        // The line holds moves as applied, with their flags filled in
+        const auto& played = best_.line.front();
+        return move.from == played.from && move.to == played.to && move.count == played.count;
+    });
+    if (best != last)
+    {
+        std::rotate(first, best, best + 1);
+    }
+}
+
+// One unit of work: starts an iteration, leaves a finished node or visits the next child
+void hint_search::advance()
+{
+    if (stack_.empty())
+    {
+        // An iteration that never reached its depth has seen the whole tree
+        if (iteration_ >= options_.max_depth || (iteration_ > 0 && !cut_))
+        {
+            finished_ = true;
+            return;
+        }
+        begin_iteration();
+        return;
+    }
+
+    auto& top = stack_.back();
+    if (top.next == top.moves.size)
+    {
+        stack_.pop_back();
+        if (stack_.empty())
+        {
+            best_.depth = iteration_;
+            return;
+        }
+        undo_move(state_, path_.back());
+        path_.pop_back();
+        return;
+    }
+
+    auto move = top.moves[top.next++];
+    apply_move(state_, move);
+    path_.push_back(move);
+    ++best_.nodes;
+
+    if (is_won(state_))
+    {
+        best_.line   = path_;
+        best_.score  = evaluate_position(state_);
+        best_.solved = true;
+        finished_    = true;
+        return;
+    }
+    if (const auto score = evaluate_position(state_); score > best_.score)
+    {
+        best_.line  = path_;
+        best_.score = score;
+    }
+
+    // Leaves and positions already searched from here go straight back to the parent
+    const auto remaining = iteration_ - std::int32_t(path_.size());
+    auto       descended = false;
+    if (remaining == 0)
+    {
+        cut_ = true;
+    }
+    else if (remember(state_.hash, remaining))
+    {
+        auto& child = stack_.emplace_back();
+        generate_moves(state_, child.moves);
+        order_moves(state_, child.moves);
+        descended = child.moves.size > 0;
+        if (!descended)
+        {
+            stack_.pop_back();
+        }
+    }
+    if (!descended)
+    {
+        undo_move(state_, move);
+        path_.pop_back();
+    }
+
+    if (best_.nodes >= options_.node_limit)
+    {
+        finished_ = true;
+    }
+}
+
+// False when the position was already searched this iteration with at least as many moves to
+// go; otherwise notes it. One entry per slot, newest wins.
+auto hint_search::remember(std::uint64_t hash, std::int32_t remaining) -> bool
+{
+    auto& entry = table_[hash & (table_.size() - 1)];
+    if (entry.generation == generation_ && entry.hash == hash && entry.remaining >= remaining)
+    {
+        return false;
+    }
+    entry = {hash, generation_, remaining};
+    return true;
+}
@@ -0,0 +1,97 @@
+#ifndef _GAME_HINT_ENGINE_HPP__
+#define _GAME_HINT_ENGINE_HPP__
+
+#include "klondike.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+struct hint_options
+{
+    std::int32_t  max_depth  = 24;     // Moves; iterative deepening stops at this depth
+    std::uint64_t node_limit = 250000; // Per position; the search is finished once spent
+    std::size_t   table_size = 1 << 16; // Transposition entries, a power of two
+};
+
+// The best line found so far from the position being searched
+struct hint_result
+{
+    std::vector<klondike_move> line;        // Empty only when there is no legal move
+    std::int32_t               score  = 0;  // evaluate_position where the line ends
+    std::int32_t               depth  = 0;  // Deepest iteration searched to the end
+    std::uint64_t              nodes  = 0;  // Positions visited since reset
+    bool                       solved = false; // The line wins the game
+
+    auto move() const -> std::optional<klondike_move>
+    {
+        return line.empty() ? std::nullopt : std::optional(line.front());
+    }
+};
+
+// Anytime search for the hint and auto-play keys. Iterative deepening over the solver's move
+// order, with the best root move of the last iteration tried first in the next, keeps the
+// line to the best-scoring position seen so far. The depth-first walk runs on an explicit
+// stack, so step() can stop after any node when its time budget is spent and carry on from
+// there on the next call: a caller with a frame to make spends a slice per frame and always
+// has an answer. Single-threaded; the caller decides which thread runs it.
+class hint_search
+{
+public:
+    explicit hint_search(const hint_options& options = {});
+
+    // Starts over from `start`. Until the first node is searched the best line is the first
+    // move in search order.
+    void reset(const klondike_state& start);
+
+    // Searches until `budget` has passed or the search is finished, checking the clock every
+    // few nodes. Returns whether it is finished: a win was found, the tree was exhausted, or the
+    // depth or node limit was reached.
+    auto step(std::chrono::microseconds budget) -> bool;
+
+    auto best() const -> const hint_result& { return best_; }
+    auto finished() const -> bool { return finished_; }
+
+    // The position searched, as of the last reset
+    auto root() const -> const klondike_state& { return root_; }
+
+private:
+    struct frame
+    {
+        move_list   moves;
+        std::size_t next = 0;
+    };
+
+    struct table_entry
+    {
+        std::uint64_t hash       = 0;
+        std::uint32_t generation = 0; // Iteration that wrote it; older entries are empty
+        std::int32_t  remaining  = 0; // Moves left to search below it
+    };
+
+    void begin_iteration();
+    void advance();
+    auto remember(std::uint64_t hash, std::int32_t remaining) -> bool;
+
+    hint_options               options_;
+    klondike_state             root_;
+    klondike_state             state_; // Where the walk is, root_ plus path_
+    std::vector<frame>         stack_;
+    std::vector<klondike_move> path_;
+    std::vector<table_entry>   table_;
+    std::uint32_t              generation_ = 0;
+    std::int32_t               iteration_  = 0;
+    bool                       cut_        = false; // The current iteration hit its depth
+    bool                       finished_   = true;
+    hint_result                best_;
+};
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+// How far along a position is: cards home, cards turned over, empty columns and cards left
+// in the stock and waste. Higher is better; only differences are meaningful.
+auto evaluate_position(const klondike_state& state) -> std::int32_t;
+
+#endif // _GAME_HINT_ENGINE_HPP__
@@ -0,0 +1,169 @@
+#include "hit_grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+auto rect_contains(const hit_rect& rect, float x, float y) -> bool
+{
+    return x >= rect.left && x <= rect.right && y >= rect.bottom && y <= rect.top;
+}
+
+auto overlap_area(const hit_rect& a, const hit_rect& b) -> float
+{
+    const auto width  = std::min(a.right, b.right) - std::max(a.left, b.left);
+    const auto height = std::min(a.top, b.top) - std::max(a.bottom, b.bottom);
+    return width > 0.0f && height > 0.0f ? width * height : 0.0f;
+}
+
+} // namespace
+
+void hit_grid::reset(float width, float height, float cell_width, float cell_height)
+{
+    cell_width_  = std::max(cell_width, 1.0f);
+    cell_height_ = std::max(cell_height, 1.0f);
+    columns_     = std::max(std::int32_t(std::ceil(width / cell_width_)), 1);
+    rows_        = std::max(std::int32_t(std::ceil(height / cell_height_)), 1);
+    cells_.assign(std::size_t(columns_) * rows_, {});
+    rects_.clear();
+    spans_.clear();
+}
+
+auto hit_grid::cell_x(float x) const -> std::int32_t
+{
+    return std::clamp(std::int32_t(std::floor(x / cell_width_)), 0, columns_ - 1);
+}
+
+auto hit_grid::cell_y(float y) const -> std::int32_t
+{
+    return std::clamp(std::int32_t(std::floor(y / cell_height_)), 0, rows_ - 1);
+}
+
+auto hit_grid::span_of(const hit_rect& rect) const -> cell_span
+{
+    return {cell_x(rect.left), cell_y(rect.bottom), cell_x(rect.right), cell_y(rect.top)};
+}
+
+void hit_grid::link(std::uint32_t id)
+{
+    const auto& span = spans_[id];
+    for (auto y = span.y0; y <= span.y1; ++y)
+    {
+        for (auto x = span.x0; x <= span.x1; ++x)
+        {
+            cells_[std::size_t(y) * columns_ + x].push_back(id);
+        }
+    }
+}
+
+void hit_grid::unlink(std::uint32_t id)
+{
+    const auto& span = spans_[id];
+    for (auto y = span.y0; y <= span.y1; ++y)
+    {
+        for (auto x = span.x0; x <= span.x1; ++x)
+        {
+            auto& cell = cells_[std::size_t(y) * columns_ + x];
+            auto  it   = std::find(cell.begin(), cell.end(), id);
+            *it        = cell.back();
+            cell.pop_back();
+        }
+    }
+}
+
+void hit_grid::set(std::uint32_t id, const hit_rect& rect)
+{
+    if (id >= rects_.size())
+    {
+        rects_.resize(id + 1);
+        spans_.resize(id + 1);
+    }
+    rects_[id] = rect;
+
+    const auto span = span_of(rect);
+    if (span == spans_[id])
+    {
+        return;
+    }
+    unlink(id);
+    spans_[id] = span;
+    link(id);
+}
+
+void hit_grid::remove(std::uint32_t id)
+{
+    if (contains(id))
+    {
+        unlink(id);
+        spans_[id] = {};
+    }
+}
+
+void hit_grid::truncate(std::uint32_t count)
+{
+    for (auto id = count; id < spans_.size(); ++id)
+    {
+        remove(id);
+    }
+    rects_.resize(std::min<std::size_t>(count, rects_.size()));
+    spans_.resize(rects_.size());
+}
+
+auto hit_grid::contains(std::uint32_t id) const -> bool
+{
+    return id < spans_.size() && spans_[id].x1 >= spans_[id].x0;
+}
+
+auto hit_grid::topmost(float x, float y) const -> std::optional<std::uint32_t>
+{
+    if (cells_.empty())
+    {
+        return std::nullopt;
+    }
+
+    auto best = std::optional<std::uint32_t>();
+    for (const auto id : cells_[std::size_t(cell_y(y)) * columns_ + cell_x(x)])
+    {
+        if ((!best || id > *best) && rect_contains(rects_[id], x, y))
+        {
+            best = id;
+        }
+    }
+    return best;
+}
+
+auto hit_grid::best_overlap(const hit_rect& rect) const -> std::optional<std::uint32_t>
+{
+    if (cells_.empty())
+    {
+        return std::nullopt;
+    }
+
+    const auto query     = span_of(rect);
+    auto       best      = std::optional<std::uint32_t>();
+    auto       best_area = 0.0f;
+    for (auto y = query.y0; y <= query.y1; ++y)
+    {
+        for (auto x = query.x0; x <= query.x1; ++x)
+        {
+            for (const auto id : cells_[std::size_t(y) * columns_ + x])
+            {
+                // Visit each id once: in the first cell its span shares with the query
+                const auto& span = spans_[id];
+                if (x != std::max(span.x0, query.x0) || y != std::max(span.y0, query.y0))
+                {
+                    continue;
+                }
+
+                const auto area = overlap_area(rects_[id], rect);
+                if (area > best_area || (area > 0.0f && area == best_area && id > *best))
+                {
+                    best      = id;
+                    best_area = area;
+                }
+            }
+        }
+    }
+    return best;
+}
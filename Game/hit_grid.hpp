@@ -0,0 +1,64 @@
+#ifndef _GAME_HIT_GRID_HPP__
+#define _GAME_HIT_GRID_HPP__
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Axis-aligned rectangle in table pixels, bottom-left origin. Edges are inclusive.
+struct hit_rect
+{
+    float left, bottom, right, top;
+};
+
+// Uniform grid over rectangles identified by small integers, for mouse picking. A higher id is
+// drawn later, so it wins when rectangles overlap. With cells about the size of the rectangles
+// each one lands in at most four cells, and a query only looks at the few ids sharing a cell,
+// however many are indexed. Rectangles past the grid edges are clamped into the border cells.
+class hit_grid
+{
+public:
+    // Clears the index and covers `width` x `height` pixels with cells of the given size
+    void reset(float width, float height, float cell_width, float cell_height);
+
+    // Inserts or moves `id`; cheap when it stays within the same cells
+    void set(std::uint32_t id, const hit_rect& rect);
+
+    void remove(std::uint32_t id);
+
+    // Removes every id from `count` on
+    void truncate(std::uint32_t count);
+
+    // Highest id whose rectangle contains the point
+    auto topmost(float x, float y) const -> std::optional<std::uint32_t>;
+
+    // Id whose rectangle overlaps `rect` by the largest area, the higher id on a tie
+    auto best_overlap(const hit_rect& rect) const -> std::optional<std::uint32_t>;
+
+    auto contains(std::uint32_t id) const -> bool;
+
+private:
+    // Inclusive range of cells a rectangle touches; empty when x1 < x0
+    struct cell_span
+    {
+        std::int32_t x0 = 0, y0 = 0, x1 = -1, y1 = -1;
+
+        auto operator==(const cell_span&) const -> bool = default;
+    };
+
+    auto cell_x(float x) const -> std::int32_t;
+    auto cell_y(float y) const -> std::int32_t;
+    auto span_of(const hit_rect& rect) const -> cell_span;
+    void link(std::uint32_t id);
+    void unlink(std::uint32_t id);
+
+    std::int32_t                            columns_     = 0;
+    std::int32_t                            rows_        = 0;
+    float                                   cell_width_  = 1.0f;
+    float                                   cell_height_ = 1.0f;
+    std::vector<std::vector<std::uint32_t>> cells_; // Unordered ids, row major
+    std::vector<hit_rect>                   rects_;
+    std::vector<cell_span>                  spans_;
+};
+
+#endif // _GAME_HIT_GRID_HPP__
@@ -1,9 +1,42 @@
 #include "keyboard.hpp"
+#include "profiler.hpp"
+#include "table_sim.hpp"
+
+#include <cstdio>
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode)
 {
+    // Presses are game input, recorded and acted on by the simulation: H shows a hint, P plays
+    // it and A sends every card home
+    auto* target = static_cast<table_window*>(glfwGetWindowUserPointer(window));
+    if (target != nullptr && action == GLFW_PRESS)
+    {
+        target->simulation->push(
+            {.kind = input_kind::key, .key = std::uint16_t(key), .time = glfwGetTime()});
+    }
+
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
     {
         glfwSetWindowShouldClose(window, GL_TRUE);
     }
+
+#if SOLITAIRE_PROFILER
+    // F9 starts a profiler capture; pressing it again writes the trace
+    if (key == GLFW_KEY_F9 && action == GLFW_PRESS)
+    {
+        auto result = toggle_profiler_capture();
+        if (!result)
+        {
+            std::fprintf(stderr, "Profiler capture failed: %s\n", result.error().c_str());
+        }
+        else if (result->empty())
+        {
+            std::printf("Profiler capture started\n");
+        }
+        else
+        {
+            std::printf("Profiler capture written to %s\n", result->string().c_str());
+        }
+    }
+#endif
 }
@@ -0,0 +1,529 @@
+#include "klondike.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <numeric>
+
+namespace {
+
+// Zobrist key layout: one key per (card, slot) where a slot is a depth in a tableau pile, the
+// stock or the waste, plus keys for each tableau face-down count and each foundation height
+constexpr auto stock_slot_base = tableau_count * tableau_capacity;
+constexpr auto waste_slot_base = stock_slot_base + stock_capacity;
+constexpr auto slot_count      = waste_slot_base + stock_capacity;
+
+struct zobrist_table
+{
+    std::array<std::uint64_t, deck_size * slot_count>               cards;
+    std::array<std::array<std::uint64_t, 8>, tableau_count>         face_down;
+    std::array<std::array<std::uint64_t, rank_count + 1>, suit_count> foundations;
+};
+
+// splitmix64, so keys and seeds expand identically on every platform and compiler
+constexpr auto splitmix64(std::uint64_t& state) -> std::uint64_t
+{
+    state += 0x9E3779B97F4A7C15ull;
+    auto z = state;
+    z      = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z      = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+constexpr auto make_zobrist_table() -> zobrist_table
+{
+    auto state = std::uint64_t(0x5EED5011'7A1BE5ull);
+    auto next  = [&state] { return splitmix64(state); };
+
+    auto table = zobrist_table{};
+    for (auto& key : table.cards)
+    {
+        key = next();
+    }
+    for (auto& pile : table.face_down)
+    {
+        for (auto& key : pile)
+        {
+            key = next();
+        }
+    }
+    for (auto& suit : table.foundations)
+    {
+        for (auto& key : suit)
+        {
+            key = next();
+        }
+    }
+    return table;
+}
+
+constexpr auto zobrist = make_zobrist_table();
+
+// xoshiro256**; std::mt19937 is portable but std::shuffle and the standard distributions are not
+class deal_random
+{
+public:
+    explicit deal_random(std::uint64_t seed)
+    {
+        for (auto& word : state_)
+        {
+            word = splitmix64(seed);
+        }
+    }
+
+    auto next() -> std::uint64_t
+    {
+        const auto result = std::rotl(state_[1] * 5, 7) * 9;
+        const auto t      = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = std::rotl(state_[3], 45);
+        return result;
+    }
+
+    // Uniform in [0, bound), rejecting the values that would bias the modulo
+    auto below(std::uint64_t bound) -> std::uint64_t
+    {
+        const auto threshold = (0 - bound) % bound;
+        while (true)
+        {
+            const auto value = next();
+            if (value >= threshold)
+            {
+                return value % bound;
+            }
+        }
+    }
+
+private:
+    std::array<std::uint64_t, 4> state_;
+};
+
+constexpr auto card_key(card_code card, std::int32_t slot) -> std::uint64_t
+{
+    return zobrist.cards[std::size_t(card) * slot_count + slot];
+}
+
+// Lookup tables avoid the divisions in card_rank/card_suit on the hot path
+template <typename value_t, typename function_t>
+constexpr auto make_card_table(function_t function) -> std::array<value_t, 64>
+{
+    auto table = std::array<value_t, 64>{};
+    for (auto card = 0; card < int(deck_size); ++card)
+    {
+        table[card] = value_t(function(card_code(card)));
+    }
+    return table;
+}
+
+constexpr auto card_ranks = make_card_table<std::int32_t>(card_rank);
+constexpr auto card_suits = make_card_table<std::int32_t>(card_suit);
+constexpr auto card_reds  = make_card_table<bool>(is_red);
+constexpr auto suit_reds  = std::array<bool, suit_count>{false, true, true, false};
+
+void push_move(move_list& moves, std::uint8_t from, std::uint8_t to, std::uint8_t count)
+{
+    moves.moves[moves.size++] = {from, to, count, 0};
+}
+
+// Moves `count` cards one at a time from the top of `source` to the top of `destination`,
+// which reverses their order; drawing and recycling are both this operation
+void transfer_stock_cards(klondike_state& state,
+                          std::uint8_t    from,
+                          std::uint8_t    to,
+                          std::uint8_t    count)
+{
+    auto&      source           = from == pile_stock ? state.stock : state.waste;
+    auto&      source_size      = from == pile_stock ? state.stock_size : state.waste_size;
+    auto&      destination      = to == pile_stock ? state.stock : state.waste;
+    auto&      destination_size = to == pile_stock ? state.stock_size : state.waste_size;
+    const auto source_base      = from == pile_stock ? stock_slot_base : waste_slot_base;
+    const auto destination_base = to == pile_stock ? stock_slot_base : waste_slot_base;
+
+    for (auto i = 0; i < count; ++i)
+    {
+        const auto card     = source[--source_size];
+        source[source_size] = 0;
+        state.hash ^= card_key(card, source_base + source_size);
+        state.hash ^= card_key(card, destination_base + destination_size);
+        destination[destination_size++] = card;
+    }
+}
+
+// Removes the top `count` cards of a pile into `cards` (bottom first)
+void take_cards(klondike_state& state, std::uint8_t pile, std::uint8_t count, card_code* cards)
+{
+    if (is_tableau(pile))
+    {
+        auto& size = state.tableau_size[pile];
+        size -= count;
+        for (auto i = 0; i < count; ++i)
+        {
+            cards[i]                      = state.tableau[pile][size + i];
+            state.tableau[pile][size + i] = 0;
+            state.hash ^= card_key(cards[i], pile * tableau_capacity + size + i);
+        }
+    }
+    else if (pile == pile_waste)
+    {
+        cards[0]                     = state.waste[--state.waste_size];
+        state.waste[state.waste_size] = 0;
+        state.hash ^= card_key(cards[0], waste_slot_base + state.waste_size);
+    }
+    else
+    {
+        const auto suit         = pile - pile_foundation;
+        const auto count_before = foundation_count(state, suit);
+        cards[0]                = make_card(suit, count_before - 1);
+        state.foundations -= std::uint16_t(1 << (suit * 4));
+        state.hash ^= zobrist.foundations[suit][count_before];
+        state.hash ^= zobrist.foundations[suit][count_before - 1];
+    }
+}
+
+// Places `count` cards (bottom first) on top of a pile
+void put_cards(klondike_state& state, std::uint8_t pile, std::uint8_t count, const card_code* cards)
+{
+    if (is_tableau(pile))
+    {
+        auto& size = state.tableau_size[pile];
+        for (auto i = 0; i < count; ++i)
+        {
+            state.hash ^= card_key(cards[i], pile * tableau_capacity + size);
+            state.tableau[pile][size++] = cards[i];
+        }
+    }
+    else if (pile == pile_waste)
+    {
+        state.hash ^= card_key(cards[0], waste_slot_base + state.waste_size);
+        state.waste[state.waste_size++] = cards[0];
+    }
+    else
+    {
+        const auto suit         = pile - pile_foundation;
+        const auto count_before = foundation_count(state, suit);
+        state.foundations += std::uint16_t(1 << (suit * 4));
+        state.hash ^= zobrist.foundations[suit][count_before];
+        state.hash ^= zobrist.foundations[suit][count_before + 1];
+    }
+}
+
+void set_face_down(klondike_state& state, std::int32_t pile, std::uint8_t count)
+{
+    state.hash ^= zobrist.face_down[pile][state.face_down[pile]];
+    state.face_down[pile] = count;
+    state.hash ^= zobrist.face_down[pile][count];
+}
+
+} // namespace
+
+void apply_move(klondike_state& state, klondike_move& move)
+{
+    move.flags = 0;
+    if (move.from == pile_stock || move.to == pile_stock)
+    {
+        transfer_stock_cards(state, move.from, move.to, move.count);
+        if (move.to == pile_stock)
+        {
+            ++state.stock_passes;
+        }
+        return;
+    }
+
+    auto cards = std::array<card_code, rank_count>();
+    take_cards(state, move.from, move.count, cards.data());
+    put_cards(state, move.to, move.count, cards.data());
+
+    // Turn over the card the move uncovered
+    if (is_tableau(move.from))
+    {
+        const auto size = state.tableau_size[move.from];
+        if (size > 0 && state.face_down[move.from] == size)
+        {
+            set_face_down(state, move.from, size - 1);
+            move.flags |= move_flag_flipped;
+        }
+    }
+}
+
+auto compute_hash(const klondike_state& state) -> std::uint64_t
+{
+    auto hash = std::uint64_t(0);
+    for (auto pile = 0; pile < tableau_count; ++pile)
+    {
+        for (auto depth = 0; depth < state.tableau_size[pile]; ++depth)
+        {
+            hash ^= card_key(state.tableau[pile][depth], pile * tableau_capacity + depth);
+        }
+        hash ^= zobrist.face_down[pile][state.face_down[pile]];
+    }
+    for (auto depth = 0; depth < state.stock_size; ++depth)
+    {
+        hash ^= card_key(state.stock[depth], stock_slot_base + depth);
+    }
+    for (auto depth = 0; depth < state.waste_size; ++depth)
+    {
+        hash ^= card_key(state.waste[depth], waste_slot_base + depth);
+    }
+    for (auto suit = 0; suit < suit_count; ++suit)
+    {
+        hash ^= zobrist.foundations[suit][foundation_count(state, suit)];
+    }
+    return hash;
+}
+
+auto deal_klondike(const std::array<card_code, deck_size>& deck, std::uint8_t draw_count)
+    -> klondike_state
+{
+    auto state       = klondike_state{};
+    state.draw_count = draw_count;
+
+    auto next = std::size_t(0);
+    for (auto row = 0; row < tableau_count; ++row)
+    {
+        for (auto pile = row; pile < tableau_count; ++pile)
+        {
+            state.tableau[pile][state.tableau_size[pile]++] = deck[next++];
+        }
+    }
+    for (auto pile = 0; pile < tableau_count; ++pile)
+    {
+        state.face_down[pile] = std::uint8_t(pile);
+    }
+
+    // Top of the stock is the back of the array, so the next card to deal goes last
+    for (auto i = deck_size; i > next; --i)
+    {
+        state.stock[state.stock_size++] = deck[i - 1];
+    }
+
+    state.hash = compute_hash(state);
+    return state;
+}
+
+auto shuffle_deck(std::uint64_t seed) -> std::array<card_code, deck_size>
+{
+    auto deck = std::array<card_code, deck_size>();
+    std::iota(deck.begin(), deck.end(), card_code(0));
+
+    // Fisher-Yates
+    auto random = deal_random(seed);
+    for (auto i = deck_size - 1; i > 0; --i)
+    {
+        std::swap(deck[i], deck[random.below(i + 1)]);
+    }
+    return deck;
+}
+
+void generate_moves(const klondike_state& state, move_list& moves)
+{
+    moves.size = 0;
+
+    // Gather each pile's top and run bottom once; -1 ranks mark empty piles
+    auto top_rank    = std::array<std::int32_t, tableau_count>();
+    auto top_red     = std::array<bool, tableau_count>();
+    auto bottom_rank = std::array<std::int32_t, tableau_count>();
+    auto empty_pile  = tableau_count;
+    for (auto pile = 0; pile < tableau_count; ++pile)
+    {
+        const auto size = state.tableau_size[pile];
+        if (size == 0)
+        {
+            top_rank[pile] = bottom_rank[pile] = -1;
+            empty_pile                         = std::min(empty_pile, pile);
+            continue;
+        }
+        const auto top    = state.tableau[pile][size - 1];
+        top_rank[pile]    = card_ranks[top];
+        top_red[pile]     = card_reds[top];
+        bottom_rank[pile] = card_ranks[state.tableau[pile][state.face_down[pile]]];
+
+        // Foundation moves first; search benefits from trying them early
+        if (top_rank[pile] == foundation_count(state, card_suits[top]))
+        {
+            push_move(
+                moves, std::uint8_t(pile), std::uint8_t(pile_foundation + card_suits[top]), 1);
+        }
+    }
+
+    const auto has_waste  = state.waste_size > 0;
+    const auto waste_top  = has_waste ? state.waste[state.waste_size - 1] : card_code(0);
+    const auto waste_rank = has_waste ? card_ranks[waste_top] : -1;
+    if (has_waste && waste_rank == foundation_count(state, card_suits[waste_top]))
+    {
+        push_move(moves, pile_waste, std::uint8_t(pile_foundation + card_suits[waste_top]), 1);
+    }
+
+    for (auto destination = 0; destination < tableau_count; ++destination)
+    {
+        if (top_rank[destination] < 0)
+        {
+            // Kings only ever go to the first empty pile; the empty piles are interchangeable
+            if (destination != empty_pile)
+            {
+                continue;
+            }
+            for (auto source = 0; source < tableau_count; ++source)
+            {
+                // Moving a whole pile onto an empty one gains nothing
+                const auto first_up = state.face_down[source];
+                if (bottom_rank[source] == rank_count - 1 && first_up > 0)
+                {
+                    push_move(moves,
+                              std::uint8_t(source),
+                              std::uint8_t(destination),
+                              std::uint8_t(state.tableau_size[source] - first_up));
+                }
+            }
+            if (waste_rank == rank_count - 1)
+            {
+                push_move(moves, pile_waste, std::uint8_t(destination), 1);
+            }
+            continue;
+        }
+
+        // The face-up run is a valid sequence, so the card that fits this destination is
+        // located by rank, and its colour follows from the run top's colour and the distance
+        const auto wanted = top_rank[destination] - 1;
+        const auto red    = top_red[destination];
+        if (wanted < 0)
+        {
+            continue; // nothing goes on an ace
+        }
+        for (auto source = 0; source < tableau_count; ++source)
+        {
+            const auto distance = wanted - top_rank[source];
+            if (source == destination || top_rank[source] < 0 || distance < 0 ||
+                wanted > bottom_rank[source])
+            {
+                continue;
+            }
+            if ((top_red[source] != ((distance & 1) != 0)) != red)
+            {
+                push_move(moves,
+                          std::uint8_t(source),
+                          std::uint8_t(destination),
+                          std::uint8_t(distance + 1));
+            }
+        }
+
+        if (has_waste && waste_rank == wanted && card_reds[waste_top] != red)
+        {
+            push_move(moves, pile_waste, std::uint8_t(destination), 1);
+        }
+
+        // Foundation back to tableau
+        for (auto suit = 0; suit < suit_count; ++suit)
+        {
+            if (foundation_count(state, suit) - 1 == wanted && suit_reds[suit] != red)
+            {
+                push_move(
+                    moves, std::uint8_t(pile_foundation + suit), std::uint8_t(destination), 1);
+            }
+        }
+    }
+
+    // Draw, or turn the waste over once the stock is empty
+    if (state.stock_size > 0)
+    {
+        push_move(moves, pile_stock, pile_waste, std::min(state.draw_count, state.stock_size));
+    }
+    else if (has_waste)
+    {
+        push_move(moves, pile_waste, pile_stock, state.waste_size);
+    }
+}
+
+auto is_legal_move(const klondike_state& state, const klondike_move& move) -> bool
+{
+    constexpr auto pile_end = pile_foundation + suit_count;
+    if (move.from >= pile_end || move.to >= pile_end || move.from == move.to || move.count == 0)
+    {
+        return false;
+    }
+
+    // Draw, or turn the waste over once the stock is empty
+    if (move.from == pile_stock || move.to == pile_stock)
+    {
+        if (move.from == pile_stock)
+        {
+            return move.to == pile_waste && state.stock_size > 0 &&
+                   move.count == std::min(state.draw_count, state.stock_size);
+        }
+        return move.from == pile_waste && state.stock_size == 0 && state.waste_size > 0 &&
+               move.count == state.waste_size;
+    }
+
+    // The card at the bottom of what moves; a tableau run is face up and already in sequence
+    auto card = card_code(0);
+    if (is_tableau(move.from))
+    {
+        const auto size = state.tableau_size[move.from];
+        if (move.count > size - state.face_down[move.from])
+        {
+            return false;
+        }
+        card = state.tableau[move.from][size - move.count];
+    }
+    else if (move.from == pile_waste)
+    {
+        if (move.count != 1 || state.waste_size == 0)
+        {
+            return false;
+        }
+        card = state.waste[state.waste_size - 1];
+    }
+    else
+    {
+        const auto suit  = move.from - pile_foundation;
+        const auto count = foundation_count(state, suit);
+        if (move.count != 1 || count == 0)
+        {
+            return false;
+        }
+        card = make_card(suit, count - 1);
+    }
+
+    if (is_foundation(move.to))
+    {
+        return move.count == 1 && card_suits[card] == move.to - pile_foundation &&
+               card_ranks[card] == foundation_count(state, card_suits[card]);
+    }
+    if (!is_tableau(move.to))
+    {
+        return false; // Nothing but a draw goes on the waste
+    }
+
+    // Kings to any empty pile, anything else onto the next rank up in the other colour
+    const auto size = state.tableau_size[move.to];
+    if (size == 0)
+    {
+        return card_ranks[card] == rank_count - 1;
+    }
+    const auto top = state.tableau[move.to][size - 1];
+    return card_ranks[top] == card_ranks[card] + 1 && card_reds[top] != card_reds[card];
+}
+
+void undo_move(klondike_state& state, const klondike_move& move)
+{
+    if (move.from == pile_stock || move.to == pile_stock)
+    {
+        transfer_stock_cards(state, move.to, move.from, move.count);
+        if (move.to == pile_stock)
+        {
+            --state.stock_passes;
+        }
+        return;
+    }
+
+    if ((move.flags & move_flag_flipped) != 0)
+    {
+        set_face_down(state, move.from, state.face_down[move.from] + 1);
+    }
+
+    auto cards = std::array<card_code, rank_count>();
+    take_cards(state, move.to, move.count, cards.data());
+    put_cards(state, move.from, move.count, cards.data());
+}
@@ -0,0 +1,132 @@
+#ifndef _GAME_KLONDIKE_HPP__
+#define _GAME_KLONDIKE_HPP__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Rendering-independent Klondike rules. Cards are 6-bit codes, suit * 13 + rank, with suits in
+// atlas order (clubs, diamonds, hearts, spades) and ranks from ace (0) to king (12).
+using card_code = std::uint8_t;
+
+constexpr auto deck_size        = std::size_t(52);
+constexpr auto suit_count       = 4;
+constexpr auto rank_count       = 13;
+constexpr auto tableau_count    = 7;
+constexpr auto tableau_capacity = 19; // 6 face-down cards under a king-to-ace run
+constexpr auto stock_capacity   = 24;
+
+constexpr auto make_card(std::int32_t suit, std::int32_t rank) -> card_code
+{
+    return card_code(suit * rank_count + rank);
+}
+constexpr auto card_suit(card_code card) -> std::int32_t { return card / rank_count; }
+constexpr auto card_rank(card_code card) -> std::int32_t { return card % rank_count; }
+constexpr auto is_red(card_code card) -> bool
+{
+    return card_suit(card) == 1 || card_suit(card) == 2;
+}
+
+// Pile ids used by moves
+enum pile_id : std::uint8_t
+{
+    pile_tableau    = 0, // 0..6
+    pile_waste      = 7,
+    pile_stock      = 8,
+    pile_foundation = 9 // 9..12, one per suit
+};
+
+constexpr auto is_tableau(std::uint8_t pile) -> bool { return pile < tableau_count; }
+constexpr auto is_foundation(std::uint8_t pile) -> bool { return pile >= pile_foundation; }
+
+// A move is 4 bytes. Stock moves transfer `count` cards between stock and waste one at a time,
+// which covers both drawing (stock -> waste) and recycling (waste -> stock).
+struct klondike_move
+{
+    std::uint8_t from;
+    std::uint8_t to;
+    std::uint8_t count;
+    std::uint8_t flags;
+
+    auto operator==(const klondike_move&) const -> bool = default;
+};
+
+// Set by apply_move when the move uncovered a face-down tableau card; undo_move needs it
+constexpr auto move_flag_flipped = std::uint8_t(1);
+
+struct klondike_state
+{
+    // Piles are stored bottom first; tableau cards below face_down[pile] are face down. Slots
+    // past the end of a pile are kept zeroed so equal positions compare equal. Cards keep a
+    // byte each: the generator and apply/undo index them directly on the hot path, and the
+    // packed form for storage is history_keyframe.
+    std::array<std::array<card_code, tableau_capacity>, tableau_count> tableau      = {};
+    std::array<std::uint8_t, tableau_count>                            tableau_size = {};
+    std::array<std::uint8_t, tableau_count>                            face_down    = {};
+    std::array<card_code, stock_capacity>                              stock        = {};
+    std::array<card_code, stock_capacity>                              waste        = {};
+    std::uint8_t                                                       stock_size   = 0;
+    std::uint8_t                                                       waste_size   = 0;
+
+    // Cards on each foundation, 4 bits per suit
+    std::uint16_t foundations = 0;
+
+    std::uint8_t draw_count   = 1;
+    std::uint8_t stock_passes = 0; // Times the waste has been recycled
+
+    // Zobrist hash of the card layout, kept up to date by apply_move/undo_move
+    std::uint64_t hash = 0;
+
+    auto operator==(const klondike_state&) const -> bool = default;
+};
+
+// Upper bound on legal moves in any position
+constexpr auto max_moves = std::size_t(96);
+
+struct move_list
+{
+    std::array<klondike_move, max_moves> moves = {};
+    std::size_t                          size  = 0;
+
+    auto begin() const { return moves.begin(); }
+    auto end() const { return moves.begin() + size; }
+    auto operator[](std::size_t index) const -> const klondike_move& { return moves[index]; }
+};
+
+constexpr auto foundation_count(const klondike_state& state, std::int32_t suit) -> std::int32_t
+{
+    return (state.foundations >> (suit * 4)) & 0xF;
+}
+
+constexpr auto is_won(const klondike_state& state) -> bool { return state.foundations == 0xDDDD; }
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+// Applies a move produced by generate_moves; fills in move.flags for undo_move
+void apply_move(klondike_state& state, klondike_move& move);
+
+// Full hash from scratch; equals state.hash whenever the incremental updates are right
+auto compute_hash(const klondike_state& state) -> std::uint64_t;
+
+// Standard deal: pile N gets N + 1 cards with the last one face up, deck[0] dealt first. The
+// remaining 24 cards form the stock with deck[28] on top.
+auto deal_klondike(const std::array<card_code, deck_size>& deck, std::uint8_t draw_count = 1)
+    -> klondike_state;
+
+// Deck order for a seed. Uses its own generator (xoshiro256** seeded through splitmix64) and
+// bounded draws, so a seed deals the same game on every platform and standard library.
+auto shuffle_deck(std::uint64_t seed) -> std::array<card_code, deck_size>;
+
+// Writes the useful moves into `moves`, foundation moves first. Legal moves that never help
+// are pruned: kings go only to the first empty tableau pile, a pile that is a whole face-up run
+// from a king is not moved to an empty one, and a king never leaves its foundation.
+void generate_moves(const klondike_state& state, move_list& moves);
+
+// Whether the rules allow `move` in `state`, flags ignored. Unlike generate_moves this accepts
+// the pruned moves too, so it is what checks moves that came from elsewhere.
+auto is_legal_move(const klondike_state& state, const klondike_move& move) -> bool;
+
+// Reverts a move previously applied to `state`
+void undo_move(klondike_state& state, const klondike_move& move);
+
+#endif // _GAME_KLONDIKE_HPP__
@@ -1,17 +1,30 @@
+#include "asset_pack.hpp"
 #include "cards.hpp"
+#include "headless.hpp"
 #include "keyboard.hpp"
+#include "mouse.hpp"
+#include "profiler.hpp"
+#include "render_scale.hpp"
+#include "shader_manager.hpp"
+#include "table_sim.hpp"
+#include "table_view.hpp"
 #include "types.hpp"
 #include "window.hpp"
 
 // clang-format off
 #include <glad/gl.h>
 #include <GLFW/glfw3.h> // Ordering is important and this file must be included after glad
-#include <glm/glm.hpp>
-#include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtc/type_ptr.hpp>
 // clang-format on
 
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
 
 constexpr auto generic_error = 1;
 constexpr auto no_error      = 0;
@@ -31,8 +44,110 @@ auto load_opengl() -> std::pair<bool, error_message_t>
 // ----------------------------------------------------------------
 /// @brief No description needed
 /// @return 0 for no error, everything else is error
-int main()
+int main(int argc, char** argv)
 {
+    // Offscreen benchmark run; needs no display
+    if (argc > 1 && std::string_view(argv[1]) == "--headless")
+    {
+        auto options = parse_headless_options(argc - 2, argv + 2);
+        if (!options)
+        {
+            std::cerr << options.error() << "\n";
+            return generic_error;
+        }
+        if (options->table_sweep)
+        {
+            auto reports = std::vector<headless_report>();
+            for (const auto table_count : headless_sweep_table_counts)
+            {
+                options->table_count = table_count;
+                auto report          = run_headless(options.value());
+                if (!report)
+                {
+                    std::cerr << "Headless run failed: " << report.error() << "\n";
+                    return generic_error;
+                }
+                reports.push_back(std::move(report.value()));
+            }
+            print_table_scaling(reports);
+            return no_error;
+        }
+        auto report = run_headless(options.value());
+        if (!report)
+        {
+            std::cerr << "Headless run failed: " << report.error() << "\n";
+            return generic_error;
+        }
+        print_headless_report(report.value());
+        return no_error;
+    }
+
+    // --continuous redraws every iteration instead of waiting for events, for profiling
+    // --profile-startup captures everything up to the last texture becoming resident
+    // --record FILE writes the session to a replay file
+    // --watch-shaders rebuilds and swaps in the card shaders whenever Shaders/ is edited
+    // --no-shader-cache always compiles the shaders from source, to time the cold path
+    // --loose-assets prefers files under Assets/ and Shaders/ to the asset pack
+    // --render-scale S draws at S times the framebuffer's resolution and scales the frame up
+    // --dynamic-resolution lowers the render scale while frames take the GPU over 1/60 s
+    auto continuous      = false;
+    auto profile_startup = false;
+    auto watch_shaders   = false;
+    auto shader_cache    = true;
+    auto loose_assets    = false;
+    auto dynamic_scaling = false;
+    auto render_scale    = max_render_scale;
+    auto record_path     = std::filesystem::path();
+    for (auto i = 1; i < argc; ++i)
+    {
+        const auto argument = std::string_view(argv[i]);
+        continuous |= argument == "--continuous";
+        profile_startup |= argument == "--profile-startup";
+        watch_shaders |= argument == "--watch-shaders";
+        shader_cache &= argument != "--no-shader-cache";
+        loose_assets |= argument == "--loose-assets";
+        dynamic_scaling |= argument == "--dynamic-resolution";
+        if (argument == "--record" && i + 1 < argc)
+        {
+            record_path = argv[++i];
+        }
+        else if (argument == "--render-scale" && i + 1 < argc &&
+                 std::sscanf(argv[++i], "%f", &render_scale) == 1)
+        {
+            render_scale = std::clamp(render_scale, min_render_scale, max_render_scale);
+        }
+    }
+
+    // Shader edits are made to the loose files, so watching them implies loading them
+    if (loose_assets || watch_shaders)
+    {
+        assets().set_lookup(asset_lookup::loose_first);
+    }
+    if (const auto& pack = assets().pack(); pack.has_value())
+    {
+        std::cout << "Asset pack: " << pack->path().string() << " (" << pack->entries().size()
+                  << " entries)\n";
+    }
+    else
+    {
+        std::cout << "Asset pack not found; loading loose files\n";
+    }
+
+    PROFILE_THREAD_NAME("main");
+#if SOLITAIRE_PROFILER
+    if (profile_startup)
+    {
+        begin_profiler_capture();
+    }
+#endif
+
+    // Startup timings are reported relative to this point
+    const auto startup_time = std::chrono::steady_clock::now();
+    const auto elapsed_ms   = [startup_time] {
+        const auto now = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(now - startup_time).count();
+    };
+
     // Init
     if (!glfwInit())
     {
@@ -65,52 +180,257 @@ int main()
         return generic_error;
     }
 
-    auto create_card_renderer_result = create_card_renderer();
+    // Textures stream in while the first frames are already on screen
+    auto create_card_renderer_result = create_card_renderer(
+        texture_loading::streamed,
+        shader_cache ? shader_caching::enabled : shader_caching::disabled);
     if (!create_card_renderer_result.has_value())
     {
         std::cout << "Failed to create card renderer: " << create_card_renderer_result.error();
         return generic_error;
     }
     auto cr = create_card_renderer_result.value();
+    std::cout << "Shader program: " << cr->shader_stats.milliseconds << " ms ("
+              << (cr->shader_stats.from_cache ? "binary cache" : "compiled") << ")\n";
+
+    // The watcher thread only wakes the loop; the rebuild is submitted and polled from here
+    auto shader_reload = std::unique_ptr<shader_reloader>();
+    if (watch_shaders)
+    {
+        shader_reload =
+            std::make_unique<shader_reloader>(card_shader_paths(), [] { glfwPostEmptyEvent(); });
+    }
 
     // OpenGL states (one-time)
+    glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
     glDisable(GL_DEPTH_TEST);
     glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    // Set projection
-    auto projection = glm::ortho(0.0f, // left
-                                 static_cast<float>(width),
-                                 0.0f,                       // bottom → now 0
-                                 static_cast<float>(height), // top   → now height
-                                 -1.0f,
-                                 1.0f);
-    glUniformMatrix4fv(cr->uProjection, // location
-                       1,               // count
-                       GL_FALSE,        // transpose
-                       glm::value_ptr(projection));
+    glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA); // card.frag writes premultiplied colour
 
     // Set texture sampler unit (one-time)
     glUniform1i(glGetUniformLocation(cr->shader_program, "uCardTextures"), 0);
 
+    // The table, dealt here and then handed to the simulation thread, which owns it from then on
+    auto view = table_view{};
+    reset_table(view, 1);
+    animate_deal(view, glfwGetTime());
+    if (!record_path.empty())
+    {
+        const auto now      = std::chrono::system_clock::now().time_since_epoch();
+        auto       recorder = replay_writer::create(
+            record_path,
+            1,
+            view.state.draw_count,
+            std::uint64_t(std::chrono::duration_cast<std::chrono::milliseconds>(now).count()));
+        if (!recorder)
+        {
+            std::cerr << recorder.error() << "\n";
+            return generic_error;
+        }
+        view.recorder = std::move(recorder.value());
+    }
+    auto simulation = table_simulation(std::move(view), glfwGetTime());
+
+    // The render loop keeps its own pacer: snapshots and window events invalidate it
+    auto pacer = frame_pacer(continuous);
+    pacer.set_streaming(true);
+    auto input = table_window{&simulation, &pacer, {}};
+
+    // Pointers map through the viewport the last frame was drawn with
+    auto framebuffer_width = 0, framebuffer_height = 0;
+    glfwGetFramebufferSize(window.get(), &framebuffer_width, &framebuffer_height);
+    input.viewport =
+        fit_table_viewport(table_metrics{}, framebuffer_width, framebuffer_height, render_scale);
+    glfwSetWindowUserPointer(window.get(), &input);
+
     // Exit app when ESC is pressed
     glfwSetKeyCallback(window.get(), key_callback);
+    glfwSetMouseButtonCallback(window.get(), mouse_button_callback);
+    glfwSetCursorPosCallback(window.get(), cursor_position_callback);
+    glfwSetFramebufferSizeCallback(window.get(), framebuffer_size_callback);
+    glfwSetWindowRefreshCallback(window.get(), window_refresh_callback);
+
+    // Cards that are not moving are drawn once into a cached layer and copied out every frame
+    auto renderer  = table_renderer{};
+    auto presenter = table_presenter{};
+
+    // Frames are timed on the GPU only when the render scale follows them
+    auto dynamic   = std::optional<dynamic_resolution>();
+    auto gpu_timer = std::optional<gpu_frame_timer>();
+    if (dynamic_scaling)
+    {
+        dynamic.emplace(dynamic_resolution_options{.max_scale = render_scale});
+        gpu_timer.emplace();
+    }
 
-    glViewport(0, 0, width, height);
+    // Input is applied on the simulation thread from here on; every snapshot it publishes
+    // wakes this loop
+    simulation.start([] { return glfwGetTime(); }, [] { glfwPostEmptyEvent(); });
 
-    // Game loop
+    // Render loop: sleeps in glfwWaitEvents until a snapshot, an animation or streaming needs a
+    // frame
+    auto first_frame_shown = false;
+    auto textures_loaded   = false;
     while (!glfwWindowShouldClose(window.get()))
     {
-        glfwPollEvents();
+        PROFILE_SCOPE("frame");
+        {
+            PROFILE_SCOPE("wait_events");
+            const auto timeout = pacer.wait_timeout();
+            if (!timeout)
+            {
+                glfwWaitEvents();
+            }
+            else if (*timeout > 0.0)
+            {
+                glfwWaitEventsTimeout(*timeout);
+            }
+            else
+            {
+                glfwPollEvents();
+            }
+        }
 
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        if (!textures_loaded)
+        {
+            const auto resident_before = cr->resident_layers;
+            auto       pump_result     = pump_card_textures(cr);
+            if (!pump_result)
+            {
+                std::cerr << "Failed to load card textures: " << pump_result.error() << "\n";
+                return generic_error;
+            }
+            if (cr->resident_layers != resident_before)
+            {
+                pacer.invalidate(redraw_table);
+            }
+            if (pump_result.value())
+            {
+                textures_loaded = true;
+                pacer.set_streaming(false);
+                std::cout << "Time to fully loaded: " << elapsed_ms() << " ms\n";
+#if SOLITAIRE_PROFILER
+                if (profile_startup)
+                {
+                    auto trace = toggle_profiler_capture();
+                    std::cout << (trace ? "Startup trace written to " + trace->string()
+                                        : "Startup trace failed: " + trace.error())
+                              << "\n";
+                }
+#endif
+            }
+        }
 
-        draw_cards(cr);
+        if (shader_reload)
+        {
+            if (auto reloaded = shader_reload->poll(); reloaded && reloaded->has_value())
+            {
+                replace_card_shader(cr, reloaded->value());
+                pacer.invalidate(redraw_table);
+                std::cout << "Reloaded card shaders\n";
+            }
+            else if (reloaded)
+            {
+                std::cerr << "Keeping the previous card shaders:\n" << reloaded->error() << "\n";
+            }
+            pacer.set_compiling(shader_reload->compiling());
+        }
 
-        glfwSwapBuffers(window.get());
+        receive_snapshot(presenter, simulation, pacer);
+        const auto plan = pacer.next_frame();
+        if (!plan.render)
+        {
+            continue;
+        }
+        // Minimized: nothing to draw into until the window is restored, which resizes it
+        glfwGetFramebufferSize(window.get(), &framebuffer_width, &framebuffer_height);
+        if (framebuffer_width == 0 || framebuffer_height == 0)
+        {
+            continue;
+        }
+        input.viewport = fit_table_viewport(table_metrics{},
+                                            framebuffer_width,
+                                            framebuffer_height,
+                                            dynamic ? dynamic->scale() : render_scale);
+
+        const auto alpha = presentation_alpha(presenter, glfwGetTime());
+        if (gpu_timer)
+        {
+            gpu_timer->begin();
+        }
+        if (auto draw_result = draw_snapshot_frame(cr,
+                                                   renderer,
+                                                   presenter.previous,
+                                                   presenter.current,
+                                                   alpha,
+                                                   plan,
+                                                   input.viewport);
+            !draw_result)
+        {
+            std::cerr << draw_result.error() << "\n";
+            return generic_error;
+        }
+        if (gpu_timer)
+        {
+            gpu_timer->end();
+
+            // The next frame starts over at the new scale, all of it redrawn
+            while (const auto gpu_ms = gpu_timer->poll())
+            {
+                if (dynamic->update(*gpu_ms))
+                {
+                    pacer.invalidate(redraw_viewport);
+                    std::cout << "Render scale: " << dynamic->scale() << "\n";
+                }
+            }
+        }
+
+        {
+            PROFILE_SCOPE("swap_buffers");
+            glfwSwapBuffers(window.get());
+        }
+        PROFILE_GPU_FRAME();
+        count_presented_input(presenter, latency_clock_ns());
+
+        // Caught up with the newest snapshot: nothing left to interpolate until the next one
+        if (alpha >= 1.0f)
+        {
+            pacer.set_animating(false);
+        }
+
+        if (!first_frame_shown)
+        {
+            first_frame_shown = true;
+            std::cout << "Time to first frame: " << elapsed_ms() << " ms\n";
+        }
     }
 
+    simulation.stop();
+    if (auto& recorder = simulation.view().recorder)
+    {
+        if (auto finished = recorder->finish(); !finished)
+        {
+            std::cerr << finished.error() << "\n";
+        }
+    }
+
+    const auto counters = simulation.counters();
+    std::cout << "Simulation: " << counters.ticks << " ticks, " << counters.events << " events ("
+              << counters.dropped_events << " dropped), " << counters.snapshots
+              << " snapshots\n";
+    std::cout << "Queue latency: mean " << counters.queue_latency.mean_ms() << " ms, max "
+              << counters.queue_latency.max_ms() << " ms\n";
+    std::cout << "Hint search: mean " << counters.hint_time.mean_ms() << " ms, max "
+              << counters.hint_time.max_ms() << " ms per tick\n";
+    std::cout << "Input to photon: mean " << presenter.input_to_photon.mean_ms() << " ms, max "
+              << presenter.input_to_photon.max_ms() << " ms\n";
+
+    shader_reload.reset();
+    gpu_timer.reset();
+    destroy_card_layer_cache(renderer.layer_cache);
+    destroy_card_layer_cache(renderer.scene);
+    cr.reset(); // Releases the mapped stream buffer while the context is current
+    PROFILE_RELEASE_GPU();
     glfwTerminate();
     return 0;
 }
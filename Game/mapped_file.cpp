@@ -0,0 +1,62 @@
+#include "mapped_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+mapped_file::~mapped_file()
+{
+    if (data_ != nullptr && size_ > 0)
+    {
+        munmap(const_cast<std::byte*>(data_), size_);
+    }
+}
+
+auto map_file(const std::filesystem::path& path)
+    -> std::expected<std::shared_ptr<mapped_file>, error_message_t>
+{
+    const auto fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return std::unexpected("Failed to open file for mapping: " + path.string());
+    }
+
+    struct stat file_info = {};
+    if (fstat(fd, &file_info) != 0)
+    {
+        close(fd);
+        return std::unexpected("Failed to stat file: " + path.string());
+    }
+
+    const auto size = static_cast<std::size_t>(file_info.st_size);
+    if (size == 0)
+    {
+        close(fd);
+        return std::make_shared<mapped_file>(nullptr, 0);
+    }
+
+    auto* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    close(fd);
+    if (address == MAP_FAILED)
+    {
+        return std::unexpected("Failed to map file: " + path.string());
+    }
+
+    return std::make_shared<mapped_file>(static_cast<const std::byte*>(address), size);
+}
+
+void evict_file_from_page_cache(const std::filesystem::path& path)
+{
+    const auto fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return;
+    }
+    fdatasync(fd);
+#if defined(POSIX_FADV_DONTNEED)
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+    close(fd);
+}
@@ -0,0 +1,44 @@
+#ifndef _GAME_MAPPED_FILE_HPP__
+#define _GAME_MAPPED_FILE_HPP__
+
+#include "types.hpp"
+
+#include <cstddef>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <span>
+
+// Read-only memory mapping of a whole file; unmapped when the object is destroyed
+class mapped_file
+{
+public:
+    mapped_file(const std::byte* data, std::size_t size)
+        : data_(data)
+        , size_(size)
+    {
+    }
+    ~mapped_file();
+
+    mapped_file(const mapped_file&)            = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    auto data() const -> const std::byte* { return data_; }
+    auto size() const -> std::size_t { return size_; }
+    auto bytes() const -> std::span<const std::byte> { return {data_, size_}; }
+
+private:
+    const std::byte* data_;
+    std::size_t      size_;
+};
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+// Maps the file at `path`; an empty file maps to an empty span
+auto map_file(const std::filesystem::path& path)
+    -> std::expected<std::shared_ptr<mapped_file>, error_message_t>;
+
+// Asks the OS to drop the file's cached pages so the next read comes from disk
+void evict_file_from_page_cache(const std::filesystem::path& path);
+
+#endif // _GAME_MAPPED_FILE_HPP__
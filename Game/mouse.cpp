@@ -0,0 +1,78 @@
+#include "mouse.hpp"
+#include "table_sim.hpp"
+
+namespace {
+
+auto window_of(GLFWwindow* window) -> table_window*
+{
+    return static_cast<table_window*>(glfwGetWindowUserPointer(window));
+}
+
+// Window coordinates have a top-left origin and may be scaled on HiDPI screens; the table is
+// laid out in table pixels with a bottom-left origin and fitted into the framebuffer
+auto to_table_point(GLFWwindow* window, const table_viewport& viewport, double x, double y)
+    -> table_point
+{
+    auto window_width = 0, window_height = 0, framebuffer_width = 0, framebuffer_height = 0;
+    glfwGetWindowSize(window, &window_width, &window_height);
+    glfwGetFramebufferSize(window, &framebuffer_width, &framebuffer_height);
+
+    const auto scale_x = window_width > 0 ? double(framebuffer_width) / window_width : 1.0;
+    const auto scale_y = window_height > 0 ? double(framebuffer_height) / window_height : 1.0;
+    return framebuffer_to_table(
+        viewport, float(x * scale_x), float(framebuffer_height - y * scale_y));
+}
+
+void push_pointer(table_window& target, input_kind kind, table_point point)
+{
+    target.simulation->push({.kind = kind, .x = point.x, .y = point.y, .time = glfwGetTime()});
+}
+
+} // namespace
+
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
+{
+    auto* target = window_of(window);
+    if (target == nullptr || button != GLFW_MOUSE_BUTTON_LEFT)
+    {
+        return;
+    }
+
+    auto x = 0.0, y = 0.0;
+    glfwGetCursorPos(window, &x, &y);
+    const auto point = to_table_point(window, target->viewport, x, y);
+    if (action == GLFW_PRESS)
+    {
+        push_pointer(*target, input_kind::pointer_down, point);
+    }
+    else if (action == GLFW_RELEASE)
+    {
+        push_pointer(*target, input_kind::pointer_up, point);
+    }
+}
+
+void cursor_position_callback(GLFWwindow* window, double x, double y)
+{
+    // Whether a card is held is the simulation's to know, so every move is passed on
+    if (auto* target = window_of(window); target != nullptr)
+    {
+        push_pointer(
+            *target, input_kind::pointer_move, to_table_point(window, target->viewport, x, y));
+    }
+}
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    if (auto* target = window_of(window); target != nullptr)
+    {
+        target->pacer->invalidate(redraw_viewport);
+    }
+}
+
+void window_refresh_callback(GLFWwindow* window)
+{
+    if (auto* target = window_of(window); target != nullptr)
+    {
+        target->pacer->invalidate(redraw_dynamic);
+    }
+}
@@ -0,0 +1,21 @@
+#ifndef _GAME_MOUSE_HPP__
+#define _GAME_MOUSE_HPP__
+
+// clang-format off
+#include <glad/gl.h>
+#include <GLFW/glfw3.h>
+// clang-format on
+
+// Window callbacks that feed the table_window set as the window's user pointer
+
+/// Queues presses and releases of the left mouse button, which pick up and let go of cards
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods);
+
+/// Queues cursor moves, which move the held card
+void cursor_position_callback(GLFWwindow* window, double x, double y);
+
+/// Redraws everything after a resize or when the window system lost the contents
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void window_refresh_callback(GLFWwindow* window);
+
+#endif // _GAME_MOUSE_HPP__
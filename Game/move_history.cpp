@@ -0,0 +1,138 @@
+#include "move_history.hpp"
+
+#include <algorithm>
+
+auto pack_keyframe(const klondike_state& state) -> history_keyframe
+{
+    auto keyframe         = history_keyframe{};
+    keyframe.tableau_size = state.tableau_size;
+    keyframe.face_down    = state.face_down;
+    keyframe.foundations  = state.foundations;
+    keyframe.stock_size   = state.stock_size;
+    keyframe.waste_size   = state.waste_size;
+    keyframe.draw_count   = state.draw_count;
+    keyframe.stock_passes = state.stock_passes;
+
+    auto out = keyframe.cards.begin();
+    for (auto pile = 0; pile < tableau_count; ++pile)
+    {
+        out = std::copy_n(state.tableau[pile].begin(), state.tableau_size[pile], out);
+    }
+    out = std::copy_n(state.stock.begin(), state.stock_size, out);
+    std::copy_n(state.waste.begin(), state.waste_size, out);
+    return keyframe;
+}
+
+auto unpack_keyframe(const history_keyframe& keyframe) -> klondike_state
+{
+    auto state         = klondike_state{};
+    state.tableau_size = keyframe.tableau_size;
+    state.face_down    = keyframe.face_down;
+    state.foundations  = keyframe.foundations;
+    state.stock_size   = keyframe.stock_size;
+    state.waste_size   = keyframe.waste_size;
+    state.draw_count   = keyframe.draw_count;
+    state.stock_passes = keyframe.stock_passes;
+
+    auto in = keyframe.cards.begin();
+    for (auto pile = 0; pile < tableau_count; ++pile)
+    {
+        std::copy_n(in, state.tableau_size[pile], state.tableau[pile].begin());
+        in += state.tableau_size[pile];
+    }
+    std::copy_n(in, state.stock_size, state.stock.begin());
+    in += state.stock_size;
+    std::copy_n(in, state.waste_size, state.waste.begin());
+
+    state.hash = compute_hash(state);
+    return state;
+}
+
+move_history::move_history(const klondike_state& start, std::uint32_t keyframe_interval)
+    : keyframe_interval_(std::max(keyframe_interval, 1u))
+    , state_(start)
+{
+    keyframes_.push_back(pack_keyframe(start));
+}
+
+void move_history::reset(const klondike_state& start)
+{
+    state_    = start;
+    position_ = 0;
+    size_     = 0;
+    keyframes_.clear();
+    keyframes_.push_back(pack_keyframe(start));
+}
+
+void move_history::apply(klondike_move move)
+{
+    // Drop the redo tail; the keyframe of the current position, if any, is still right
+    size_ = position_;
+    keyframes_.resize(position_ / keyframe_interval_ + 1);
+
+    if (position_ / moves_per_chunk == chunks_.size())
+    {
+        chunks_.push_back(std::make_unique<move_chunk>());
+    }
+
+    apply_move(state_, move);
+    (*chunks_[position_ / moves_per_chunk])[position_ % moves_per_chunk] = move;
+    size_ = ++position_;
+
+    if (position_ % keyframe_interval_ == 0)
+    {
+        keyframes_.push_back(pack_keyframe(state_));
+    }
+}
+
+auto move_history::undo() -> bool
+{
+    if (position_ == 0)
+    {
+        return false;
+    }
+    --position_;
+    undo_move(state_, move_at(position_));
+    return true;
+}
+
+auto move_history::redo() -> bool
+{
+    if (position_ == size_)
+    {
+        return false;
+    }
+    auto move = move_at(position_++);
+    apply_move(state_, move);
+    return true;
+}
+
+void move_history::jump_to(std::size_t position)
+{
+    position = std::min(position, size_);
+
+    // Walk there directly when that is shorter than replaying from the keyframe
+    const auto from_keyframe = position % keyframe_interval_;
+    const auto distance = position > position_ ? position - position_ : position_ - position;
+    if (distance > from_keyframe)
+    {
+        state_    = unpack_keyframe(keyframes_[position / keyframe_interval_]);
+        position_ = position - from_keyframe;
+    }
+
+    while (position_ < position)
+    {
+        redo();
+    }
+    while (position_ > position)
+    {
+        undo();
+    }
+}
+
+auto move_history::memory_bytes() const -> std::size_t
+{
+    return chunks_.size() * sizeof(move_chunk) +
+           chunks_.capacity() * sizeof(std::unique_ptr<move_chunk>) +
+           keyframes_.capacity() * sizeof(history_keyframe);
+}
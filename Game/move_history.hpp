@@ -0,0 +1,88 @@
+#ifndef _GAME_MOVE_HISTORY_HPP__
+#define _GAME_MOVE_HISTORY_HPP__
+
+#include "klondike.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// A position packed for the history: every card still on the table in pile order (tableau piles
+// bottom first, then stock, then waste) and the pile sizes. Foundations only need their heights.
+struct history_keyframe
+{
+    std::array<card_code, deck_size>        cards;
+    std::array<std::uint8_t, tableau_count> tableau_size;
+    std::array<std::uint8_t, tableau_count> face_down;
+    std::uint16_t                           foundations;
+    std::uint8_t                            stock_size;
+    std::uint8_t                            waste_size;
+    std::uint8_t                            draw_count;
+    std::uint8_t                            stock_passes;
+};
+
+static_assert(sizeof(history_keyframe) == 72);
+
+// Unlimited undo/redo for one game. Each move is kept as its 4-byte klondike_move, flip flag
+// included, in fixed-size chunks that are reused when the redo tail is dropped, so recording a
+// move never allocates on its own. Every `keyframe_interval` moves the position is packed into a
+// keyframe, and jumping anywhere in the game replays at most that many moves.
+class move_history
+{
+public:
+    static constexpr auto default_keyframe_interval = std::uint32_t(64);
+    static constexpr auto moves_per_chunk           = std::size_t(4096);
+
+    explicit move_history(const klondike_state& start,
+                          std::uint32_t         keyframe_interval = default_keyframe_interval);
+
+    // Starts over from `start`, keeping the storage
+    void reset(const klondike_state& start);
+
+    // Applies a move from generate_moves and records it; anything that could be redone is lost
+    void apply(klondike_move move);
+
+    // Steps back or forward one move; false at either end of the history
+    auto undo() -> bool;
+    auto redo() -> bool;
+
+    // Moves to the position after `position` moves, clamped to the recorded ones
+    void jump_to(std::size_t position);
+
+    auto state() const -> const klondike_state& { return state_; }
+
+    // Moves currently applied
+    auto position() const -> std::size_t { return position_; }
+
+    // Moves recorded, including the ones that can be redone
+    auto size() const -> std::size_t { return size_; }
+
+    auto move_at(std::size_t index) const -> const klondike_move&
+    {
+        return (*chunks_[index / moves_per_chunk])[index % moves_per_chunk];
+    }
+
+    // Heap memory held by the move chunks and keyframes
+    auto memory_bytes() const -> std::size_t;
+
+private:
+    using move_chunk = std::array<klondike_move, moves_per_chunk>;
+
+    std::uint32_t                            keyframe_interval_;
+    klondike_state                           state_;
+    std::size_t                              position_ = 0;
+    std::size_t                              size_     = 0;
+    std::vector<std::unique_ptr<move_chunk>> chunks_;
+    std::vector<history_keyframe>            keyframes_; // keyframes_[i] is position i * interval
+};
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+auto pack_keyframe(const klondike_state& state) -> history_keyframe;
+
+// Rebuilds the position, hash included
+auto unpack_keyframe(const history_keyframe& keyframe) -> klondike_state;
+
+#endif // _GAME_MOVE_HISTORY_HPP__
@@ -0,0 +1,336 @@
+#include "pixel_convert.hpp"
+
+#include <algorithm>
+#include <array>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+void convert_scalar(const std::uint8_t*     source,
+                    std::uint8_t*           destination,
+                    std::size_t             count,
+                    const pixel_conversion& conversion)
+{
+    const auto channels  = conversion.channels;
+    const auto has_color = channels >= 3;
+    for (auto i = std::size_t(0); i < count; ++i, source += channels, destination += 4)
+    {
+        const auto alpha = channels == 4   ? source[3]
+                           : channels == 2 ? source[1]
+                                           : std::uint8_t(255);
+        auto       red   = source[0];
+        auto       green = has_color ? source[1] : source[0];
+        auto       blue  = has_color ? source[2] : source[0];
+        if (conversion.premultiply)
+        {
+            red   = premultiply_channel(red, alpha);
+            green = premultiply_channel(green, alpha);
+            blue  = premultiply_channel(blue, alpha);
+        }
+        destination[0] = red;
+        destination[1] = green;
+        destination[2] = blue;
+        destination[3] = alpha;
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// Byte shuffles that spread four source pixels over 16 RGBA bytes, indexed by channel count.
+// A negative index writes zero; the alpha of sources without one is filled in afterwards.
+constexpr auto make_expand_shuffle(std::int32_t channels) -> std::array<std::int8_t, 16>
+{
+    auto shuffle = std::array<std::int8_t, 16>{};
+    for (auto pixel = 0; pixel < 4; ++pixel)
+    {
+        const auto base      = pixel * channels;
+        const auto has_color = channels >= 3;
+        shuffle[pixel * 4 + 0] = std::int8_t(base);
+        shuffle[pixel * 4 + 1] = std::int8_t(has_color ? base + 1 : base);
+        shuffle[pixel * 4 + 2] = std::int8_t(has_color ? base + 2 : base);
+        shuffle[pixel * 4 + 3] = std::int8_t(channels == 4   ? base + 3
+                                             : channels == 2 ? base + 1
+                                                             : -1);
+    }
+    return shuffle;
+}
+
+constexpr auto expand_shuffles = std::array{make_expand_shuffle(1),
+                                            make_expand_shuffle(2),
+                                            make_expand_shuffle(3),
+                                            make_expand_shuffle(4)};
+
+// Widens the alpha of RGBA pixels `first` and `first + 1` into the 16-bit lanes of their colour
+// channels; the alpha lanes get zero, and 255 is or-ed in so alpha multiplies back to itself
+constexpr auto make_alpha_shuffle(std::int32_t first) -> std::array<std::int8_t, 16>
+{
+    auto shuffle = std::array<std::int8_t, 16>{};
+    for (auto pixel = 0; pixel < 2; ++pixel)
+    {
+        for (auto channel = 0; channel < 4; ++channel)
+        {
+            const auto lane   = (pixel * 4 + channel) * 2;
+            shuffle[lane]     = std::int8_t(channel < 3 ? (first + pixel) * 4 + 3 : -1);
+            shuffle[lane + 1] = std::int8_t(-1);
+        }
+    }
+    return shuffle;
+}
+
+__attribute__((target("ssse3"))) auto load_shuffle(const std::array<std::int8_t, 16>& shuffle)
+    -> __m128i
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(shuffle.data()));
+}
+
+// (c * a + 128 + ((c * a + 128) >> 8)) >> 8 on 16-bit lanes, as premultiply_channel
+__attribute__((target("ssse3"))) auto divide_by_255(__m128i product) -> __m128i
+{
+    const auto rounded = _mm_add_epi16(product, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(rounded, _mm_srli_epi16(rounded, 8)), 8);
+}
+
+__attribute__((target("avx2"))) auto divide_by_255(__m256i product) -> __m256i
+{
+    const auto rounded = _mm256_add_epi16(product, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(rounded, _mm256_srli_epi16(rounded, 8)), 8);
+}
+
+__attribute__((target("ssse3"))) void convert_ssse3(const std::uint8_t*     source,
+                                                    std::uint8_t*           destination,
+                                                    std::size_t             count,
+                                                    const pixel_conversion& conversion)
+{
+    const auto channels = std::size_t(conversion.channels);
+    const auto expand   = load_shuffle(expand_shuffles[channels - 1]);
+    const auto opaque   = channels % 2 == 1 ? _mm_set1_epi32(std::int32_t(0xFF000000))
+                                            : _mm_setzero_si128();
+    const auto alpha_lo = load_shuffle(make_alpha_shuffle(0));
+    const auto alpha_hi = load_shuffle(make_alpha_shuffle(2));
+    const auto alpha_on = _mm_set1_epi64x(std::int64_t(0x00FF000000000000));
+    const auto zero     = _mm_setzero_si128();
+
+    // Every load reads 16 source bytes, whatever part of them the four pixels use
+    auto i = std::size_t(0);
+    for (; (count - i) * channels >= 16; i += 4, source += 4 * channels, destination += 16)
+    {
+        const auto packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+        auto       rgba   = _mm_or_si128(_mm_shuffle_epi8(packed, expand), opaque);
+        if (conversion.premultiply)
+        {
+            const auto lo_alpha = _mm_or_si128(_mm_shuffle_epi8(rgba, alpha_lo), alpha_on);
+            const auto hi_alpha = _mm_or_si128(_mm_shuffle_epi8(rgba, alpha_hi), alpha_on);
+            const auto lo = _mm_mullo_epi16(_mm_unpacklo_epi8(rgba, zero), lo_alpha);
+            const auto hi = _mm_mullo_epi16(_mm_unpackhi_epi8(rgba, zero), hi_alpha);
+            rgba          = _mm_packus_epi16(divide_by_255(lo), divide_by_255(hi));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination), rgba);
+    }
+    convert_scalar(source, destination, count - i, conversion);
+}
+
+// As convert_ssse3 with both 128-bit lanes in use: shuffles stay within a lane, so each lane
+// expands four pixels of its own
+__attribute__((target("avx2"))) void convert_avx2(const std::uint8_t*     source,
+                                                  std::uint8_t*           destination,
+                                                  std::size_t             count,
+                                                  const pixel_conversion& conversion)
+{
+    const auto channels = std::size_t(conversion.channels);
+    const auto shuffle  = load_shuffle(expand_shuffles[channels - 1]);
+    const auto expand   = _mm256_broadcastsi128_si256(shuffle);
+    const auto opaque   = channels % 2 == 1 ? _mm256_set1_epi32(std::int32_t(0xFF000000))
+                                            : _mm256_setzero_si256();
+    const auto alpha_lo = _mm256_broadcastsi128_si256(load_shuffle(make_alpha_shuffle(0)));
+    const auto alpha_hi = _mm256_broadcastsi128_si256(load_shuffle(make_alpha_shuffle(2)));
+    const auto alpha_on = _mm256_set1_epi64x(std::int64_t(0x00FF000000000000));
+    const auto zero     = _mm256_setzero_si256();
+
+    // The upper lane's 16-byte load starts four pixels in
+    auto i = std::size_t(0);
+    for (; (count - i) * channels >= 4 * channels + 16;
+         i += 8, source += 8 * channels, destination += 32)
+    {
+        const auto packed = _mm256_set_m128i(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 4 * channels)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(source)));
+        auto rgba = _mm256_or_si256(_mm256_shuffle_epi8(packed, expand), opaque);
+        if (conversion.premultiply)
+        {
+            // Unpacking is per lane too, and packing puts the pixels back in order
+            const auto lo_alpha = _mm256_or_si256(_mm256_shuffle_epi8(rgba, alpha_lo), alpha_on);
+            const auto hi_alpha = _mm256_or_si256(_mm256_shuffle_epi8(rgba, alpha_hi), alpha_on);
+            const auto lo = _mm256_mullo_epi16(_mm256_unpacklo_epi8(rgba, zero), lo_alpha);
+            const auto hi = _mm256_mullo_epi16(_mm256_unpackhi_epi8(rgba, zero), hi_alpha);
+            rgba          = _mm256_packus_epi16(divide_by_255(lo), divide_by_255(hi));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination), rgba);
+    }
+    convert_ssse3(source, destination, count - i, conversion);
+}
+
+#elif defined(__ARM_NEON)
+
+// ((c * a) + ((c * a + 128) >> 8) + 128) >> 8, the same rounding as premultiply_channel
+auto premultiply_neon(uint8x16_t color, uint8x16_t alpha) -> uint8x16_t
+{
+    auto lo = vmull_u8(vget_low_u8(color), vget_low_u8(alpha));
+    auto hi = vmull_u8(vget_high_u8(color), vget_high_u8(alpha));
+    lo      = vrsraq_n_u16(lo, lo, 8);
+    hi      = vrsraq_n_u16(hi, hi, 8);
+    return vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8));
+}
+
+// The structured loads and stores do the (de)interleaving, 16 pixels at a time
+void convert_neon(const std::uint8_t*     source,
+                  std::uint8_t*           destination,
+                  std::size_t             count,
+                  const pixel_conversion& conversion)
+{
+    const auto channels = std::size_t(conversion.channels);
+    const auto opaque   = vdupq_n_u8(255);
+
+    auto i = std::size_t(0);
+    for (; count - i >= 16; i += 16, source += 16 * channels, destination += 64)
+    {
+        auto rgba = uint8x16x4_t();
+        switch (channels)
+        {
+        case 1:
+        {
+            const auto grey = vld1q_u8(source);
+            rgba            = {{grey, grey, grey, opaque}};
+            break;
+        }
+        case 2:
+        {
+            const auto grey_alpha = vld2q_u8(source);
+            rgba = {{grey_alpha.val[0], grey_alpha.val[0], grey_alpha.val[0], grey_alpha.val[1]}};
+            break;
+        }
+        case 3:
+        {
+            const auto rgb = vld3q_u8(source);
+            rgba           = {{rgb.val[0], rgb.val[1], rgb.val[2], opaque}};
+            break;
+        }
+        default:
+            rgba = vld4q_u8(source);
+            break;
+        }
+        if (conversion.premultiply)
+        {
+            for (auto channel = 0; channel < 3; ++channel)
+            {
+                rgba.val[channel] = premultiply_neon(rgba.val[channel], rgba.val[3]);
+            }
+        }
+        vst4q_u8(destination, rgba);
+    }
+    convert_scalar(source, destination, count - i, conversion);
+}
+
+#endif
+
+auto is_supported(pixel_kernel kernel) -> bool
+{
+    static const auto kernels = supported_pixel_kernels();
+    return std::ranges::find(kernels, kernel) != kernels.end();
+}
+
+} // namespace
+
+auto supported_pixel_kernels() -> std::vector<pixel_kernel>
+{
+    auto kernels = std::vector{pixel_kernel::scalar};
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("ssse3"))
+    {
+        kernels.push_back(pixel_kernel::ssse3);
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        kernels.push_back(pixel_kernel::avx2);
+    }
+#elif defined(__ARM_NEON)
+    kernels.push_back(pixel_kernel::neon);
+#endif
+    return kernels;
+}
+
+auto best_pixel_kernel() -> pixel_kernel
+{
+    static const auto best = supported_pixel_kernels().back();
+    return best;
+}
+
+auto pixel_kernel_name(pixel_kernel kernel) -> std::string_view
+{
+    switch (kernel)
+    {
+    case pixel_kernel::scalar:
+        return "scalar";
+    case pixel_kernel::ssse3:
+        return "ssse3";
+    case pixel_kernel::avx2:
+        return "avx2";
+    case pixel_kernel::neon:
+        return "neon";
+    }
+    return "unknown";
+}
+
+void convert_pixels(const std::uint8_t*     source,
+                    std::uint8_t*           destination,
+                    std::size_t             count,
+                    const pixel_conversion& conversion,
+                    pixel_kernel            kernel)
+{
+    if (!is_supported(kernel))
+    {
+        kernel = pixel_kernel::scalar;
+    }
+    switch (kernel)
+    {
+#if defined(__x86_64__) || defined(__i386__)
+    case pixel_kernel::ssse3:
+        convert_ssse3(source, destination, count, conversion);
+        return;
+    case pixel_kernel::avx2:
+        convert_avx2(source, destination, count, conversion);
+        return;
+#elif defined(__ARM_NEON)
+    case pixel_kernel::neon:
+        convert_neon(source, destination, count, conversion);
+        return;
+#endif
+    default:
+        convert_scalar(source, destination, count, conversion);
+        return;
+    }
+}
+
+void convert_rect(const std::uint8_t*     source,
+                  std::size_t             source_stride,
+                  std::int32_t            width,
+                  std::int32_t            height,
+                  std::uint8_t*           destination,
+                  const pixel_conversion& conversion,
+                  pixel_kernel            kernel)
+{
+    const auto row_bytes = std::size_t(width) * 4;
+    for (auto row = 0; row < height; ++row)
+    {
+        const auto source_row = conversion.flip_rows ? height - 1 - row : row;
+        convert_pixels(source + std::size_t(source_row) * source_stride,
+                       destination + std::size_t(row) * row_bytes,
+                       std::size_t(width),
+                       conversion,
+                       kernel);
+    }
+}
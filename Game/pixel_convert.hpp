@@ -0,0 +1,61 @@
+#ifndef _GAME_PIXEL_CONVERT_HPP__
+#define _GAME_PIXEL_CONVERT_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Instruction set a conversion runs on. Every kernel writes exactly the bytes scalar does.
+enum class pixel_kernel : std::uint8_t
+{
+    scalar,
+    ssse3, // x86, 4 pixels per step
+    avx2,  // x86, 8 pixels per step
+    neon   // Arm, 16 pixels per step
+};
+
+// How decoded pixels become RGBA8
+struct pixel_conversion
+{
+    std::int32_t channels    = 4;     // Source bytes per pixel: grey, grey + alpha, RGB or RGBA
+    bool         premultiply = false; // Scale the colour by alpha, rounded to nearest
+    bool         flip_rows   = false; // convert_rect writes the bottom source row first
+};
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+// Kernels both this build and the CPU running it support, scalar first and fastest last
+auto supported_pixel_kernels() -> std::vector<pixel_kernel>;
+
+// Fastest supported kernel, detected on first use
+auto best_pixel_kernel() -> pixel_kernel;
+
+auto pixel_kernel_name(pixel_kernel kernel) -> std::string_view;
+
+// Exact round(color * alpha / 255) without a division, the way every kernel computes it
+constexpr auto premultiply_channel(std::uint8_t color, std::uint8_t alpha) -> std::uint8_t
+{
+    const auto scaled = std::uint32_t(color) * alpha + 128;
+    return std::uint8_t((scaled + (scaled >> 8)) >> 8);
+}
+
+// Converts `count` pixels into tightly packed RGBA8. Grey is replicated into RGB and sources
+// without alpha get 255. A kernel this machine does not support runs as scalar.
+void convert_pixels(const std::uint8_t*     source,
+                    std::uint8_t*           destination,
+                    std::size_t             count,
+                    const pixel_conversion& conversion,
+                    pixel_kernel            kernel = best_pixel_kernel());
+
+// Converts a width x height rectangle whose rows lie `source_stride` bytes apart, such as one
+// frame of an atlas, into width * height * 4 contiguous bytes
+void convert_rect(const std::uint8_t*     source,
+                  std::size_t             source_stride,
+                  std::int32_t            width,
+                  std::int32_t            height,
+                  std::uint8_t*           destination,
+                  const pixel_conversion& conversion,
+                  pixel_kernel            kernel = best_pixel_kernel());
+
+#endif // _GAME_PIXEL_CONVERT_HPP__
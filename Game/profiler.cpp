@@ -0,0 +1,409 @@
+#include "profiler.hpp"
+
+#if SOLITAIRE_PROFILER
+
+// clang-format off
+#include <glad/gl.h>
+// clang-format on
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+// Events kept per thread; a capture longer than this keeps the most recent ones
+constexpr auto ring_capacity = std::size_t(1) << 15;
+
+// Slots behind the head that may still be written by scopes closing after the capture ended
+constexpr auto ring_slack = std::size_t(64);
+
+constexpr auto gpu_queries_per_frame = std::size_t(32);
+
+struct thread_ring
+{
+    std::array<profile_event, ring_capacity> events;
+    std::atomic<std::uint64_t>               head          = 0;
+    std::uint64_t                            capture_first = 0; // head when the capture began
+    std::atomic<bool>                        in_use        = true;
+    std::string                              name;              // Guarded by the registry mutex
+};
+
+struct ring_registry
+{
+    std::mutex                                mutex;
+    std::vector<std::unique_ptr<thread_ring>> rings;
+};
+
+// GL_TIME_ELAPSED queries started during one frame
+struct gpu_query_set
+{
+    std::array<GLuint, gpu_queries_per_frame>        queries   = {};
+    std::array<const char*, gpu_queries_per_frame>   names     = {};
+    std::array<std::uint64_t, gpu_queries_per_frame> starts_ns = {};
+    std::size_t                                      used      = 0;
+};
+
+// Owned by the GL thread
+struct gpu_profiler_state
+{
+    std::array<gpu_query_set, 2> sets;
+    std::size_t                  current    = 0;
+    bool                         created    = false;
+    bool                         scope_open = false;
+    std::atomic<std::uint64_t>   dropped    = 0;
+};
+
+auto capturing        = std::atomic<bool>(false);
+auto capture_start_ns = std::atomic<std::uint64_t>(0);
+auto gpu_dropped_base = std::uint64_t(0);
+
+// Never destroyed: threads may still record while statics are torn down
+auto registry() -> ring_registry&
+{
+    static auto* instance = new ring_registry();
+    return *instance;
+}
+
+auto gpu_state() -> gpu_profiler_state&
+{
+    static auto* instance = new gpu_profiler_state();
+    return *instance;
+}
+
+auto now_ns() -> std::uint64_t
+{
+    return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now().time_since_epoch())
+                             .count());
+}
+
+// Releases the thread's ring for reuse when the thread exits
+struct ring_owner
+{
+    thread_ring*  ring  = nullptr;
+    std::uint32_t index = 0;
+
+    ~ring_owner()
+    {
+        if (ring != nullptr)
+        {
+            ring->in_use.store(false, std::memory_order_release);
+        }
+    }
+};
+
+thread_local auto this_thread_owner = ring_owner{};
+
+auto this_thread_ring() -> ring_owner&
+{
+    auto& owner = this_thread_owner;
+    if (owner.ring != nullptr)
+    {
+        return owner;
+    }
+
+    auto& rings = registry();
+    auto  lock  = std::scoped_lock(rings.mutex);
+
+    // Rings of finished threads are reused, but not mid-capture where they still hold events
+    if (!capturing.load(std::memory_order_acquire))
+    {
+        for (auto i = std::size_t(0); i < rings.rings.size(); ++i)
+        {
+            auto& ring = *rings.rings[i];
+            if (!ring.in_use.load(std::memory_order_acquire))
+            {
+                ring.in_use.store(true, std::memory_order_relaxed);
+                ring.name.clear();
+                owner = {&ring, std::uint32_t(i)};
+                return owner;
+            }
+        }
+    }
+
+    rings.rings.push_back(std::make_unique<thread_ring>());
+    auto& ring         = *rings.rings.back();
+    ring.head          = 0;
+    ring.capture_first = 0;
+    owner              = {&ring, std::uint32_t(rings.rings.size() - 1)};
+    return owner;
+}
+
+// Single producer: only the owning thread advances head
+void record(const char* name, std::uint64_t start_ns, std::uint64_t end_ns, profile_track track)
+{
+    const auto& owner = this_thread_ring();
+    auto&       ring  = *owner.ring;
+    const auto  head  = ring.head.load(std::memory_order_relaxed);
+
+    ring.events[head & (ring_capacity - 1)] = {
+        name, start_ns, end_ns - start_ns, owner.index, track};
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void write_json_string(std::ofstream& out, std::string_view text)
+{
+    out << '"';
+    for (const auto c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            out << '\\' << c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            out << ' ';
+        }
+        else
+        {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+} // namespace
+
+profile_scope::profile_scope(const char* name) noexcept
+    : name_(name)
+    , start_ns_(capturing.load(std::memory_order_relaxed) ? now_ns() : 0)
+{
+}
+
+profile_scope::~profile_scope()
+{
+    if (start_ns_ != 0)
+    {
+        record(name_, start_ns_, now_ns(), profile_track::cpu);
+    }
+}
+
+gpu_profile_scope::gpu_profile_scope(const char* name) noexcept
+    : active_(false)
+{
+    auto& gpu = gpu_state();
+    if (!capturing.load(std::memory_order_relaxed) || gpu.scope_open)
+    {
+        return;
+    }
+    if (!gpu.created)
+    {
+        for (auto& set : gpu.sets)
+        {
+            glGenQueries(GLsizei(set.queries.size()), set.queries.data());
+        }
+        gpu.created = true;
+    }
+
+    auto& set = gpu.sets[gpu.current];
+    if (set.used == set.queries.size())
+    {
+        gpu.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    set.names[set.used]     = name;
+    set.starts_ns[set.used] = now_ns();
+    glBeginQuery(GL_TIME_ELAPSED, set.queries[set.used]);
+    gpu.scope_open = true;
+    active_        = true;
+}
+
+gpu_profile_scope::~gpu_profile_scope()
+{
+    if (active_)
+    {
+        auto& gpu = gpu_state();
+        glEndQuery(GL_TIME_ELAPSED);
+        ++gpu.sets[gpu.current].used;
+        gpu.scope_open = false;
+    }
+}
+
+void set_profiler_thread_name(const char* name)
+{
+    auto& owner = this_thread_ring();
+    auto  lock  = std::scoped_lock(registry().mutex);
+    owner.ring->name = name;
+}
+
+void begin_profiler_capture()
+{
+    {
+        auto& rings = registry();
+        auto  lock  = std::scoped_lock(rings.mutex);
+        for (auto& ring : rings.rings)
+        {
+            ring->capture_first = ring->head.load(std::memory_order_acquire);
+        }
+    }
+    gpu_dropped_base = gpu_state().dropped.load(std::memory_order_relaxed);
+    capture_start_ns.store(now_ns(), std::memory_order_relaxed);
+    capturing.store(true, std::memory_order_release);
+}
+
+auto is_profiler_capturing() -> bool
+{
+    return capturing.load(std::memory_order_acquire);
+}
+
+auto end_profiler_capture() -> profile_capture
+{
+    capturing.store(false, std::memory_order_release);
+    const auto start = capture_start_ns.load(std::memory_order_relaxed);
+
+    auto  capture = profile_capture{};
+    auto& rings   = registry();
+    auto  lock    = std::scoped_lock(rings.mutex);
+    for (const auto& ring : rings.rings)
+    {
+        capture.thread_names.push_back(ring->name);
+
+        // Anything older than a ring's worth (less the slack still being written) was overwritten
+        const auto head   = ring->head.load(std::memory_order_acquire);
+        const auto oldest = head > ring_capacity - ring_slack ? head - (ring_capacity - ring_slack)
+                                                              : std::uint64_t(0);
+        const auto first  = std::max(ring->capture_first, oldest);
+        capture.dropped += first - ring->capture_first;
+        for (auto i = first; i < head; ++i)
+        {
+            auto event = ring->events[i & (ring_capacity - 1)];
+            if (event.start_ns < start)
+            {
+                continue;
+            }
+            event.start_ns -= start;
+            capture.events.push_back(event);
+        }
+    }
+    capture.dropped += gpu_state().dropped.load(std::memory_order_relaxed) - gpu_dropped_base;
+
+    std::ranges::sort(capture.events, [](const profile_event& a, const profile_event& b) {
+        return a.start_ns < b.start_ns;
+    });
+    return capture;
+}
+
+void profiler_gpu_frame()
+{
+    auto& gpu = gpu_state();
+    if (!gpu.created)
+    {
+        return;
+    }
+
+    // The other set was filled last frame; take what has finished and drop the rest
+    gpu.current = 1 - gpu.current;
+    auto& set   = gpu.sets[gpu.current];
+    for (auto i = std::size_t(0); i < set.used; ++i)
+    {
+        auto available = GLint(0);
+        glGetQueryObjectiv(set.queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == 0 || !capturing.load(std::memory_order_relaxed))
+        {
+            gpu.dropped.fetch_add(available == 0 ? 1 : 0, std::memory_order_relaxed);
+            continue;
+        }
+
+        auto elapsed_ns = GLuint64(0);
+        glGetQueryObjectui64v(set.queries[i], GL_QUERY_RESULT, &elapsed_ns);
+        record(set.names[i], set.starts_ns[i], set.starts_ns[i] + elapsed_ns, profile_track::gpu);
+    }
+    set.used = 0;
+}
+
+void release_profiler_gpu_queries()
+{
+    auto& gpu = gpu_state();
+    if (gpu.created)
+    {
+        for (auto& set : gpu.sets)
+        {
+            glDeleteQueries(GLsizei(set.queries.size()), set.queries.data());
+            set.used = 0;
+        }
+        gpu.created = false;
+    }
+}
+
+auto write_chrome_trace(const std::filesystem::path& path, const profile_capture& capture)
+    -> std::expected<void, error_message_t>
+{
+    auto out = std::ofstream(path);
+    if (!out)
+    {
+        return std::unexpected("Failed to create trace file: " + path.string());
+    }
+
+    // CPU scopes live under process 1, one row per thread; GPU scopes under process 2, placed
+    // at the CPU time their commands were issued
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"args\":{\"name\":\"GPU\"}}";
+    for (auto i = std::size_t(0); i < capture.thread_names.size(); ++i)
+    {
+        const auto& name = capture.thread_names[i];
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i
+            << ",\"args\":{\"name\":";
+        write_json_string(out, name.empty() ? "thread " + std::to_string(i) : name);
+        out << "}}";
+    }
+
+    auto number = std::array<char, 32>();
+    for (const auto& event : capture.events)
+    {
+        const auto gpu = event.track == profile_track::gpu;
+        out << ",\n{\"name\":";
+        write_json_string(out, event.name);
+        out << ",\"cat\":\"" << (gpu ? "gpu" : "cpu") << "\",\"ph\":\"X\",\"pid\":"
+            << (gpu ? 2 : 1) << ",\"tid\":" << event.thread;
+        std::snprintf(number.data(), number.size(), "%.3f", double(event.start_ns) / 1000.0);
+        out << ",\"ts\":" << number.data();
+        std::snprintf(number.data(), number.size(), "%.3f", double(event.duration_ns) / 1000.0);
+        out << ",\"dur\":" << number.data() << "}";
+    }
+    out << "\n]}\n";
+
+    if (!out)
+    {
+        return std::unexpected("Failed to write trace file: " + path.string());
+    }
+    return {};
+}
+
+auto toggle_profiler_capture() -> std::expected<std::filesystem::path, error_message_t>
+{
+    if (!is_profiler_capturing())
+    {
+        begin_profiler_capture();
+        return std::filesystem::path();
+    }
+
+    const auto capture = end_profiler_capture();
+
+    // First free solitaire_trace_NNN.json, so earlier captures are never overwritten
+    auto path = std::filesystem::path();
+    auto name = std::array<char, 32>();
+    for (auto index = 0;; ++index)
+    {
+        std::snprintf(name.data(), name.size(), "solitaire_trace_%03d.json", index);
+        path = name.data();
+        if (!std::filesystem::exists(path))
+        {
+            break;
+        }
+    }
+
+    if (auto result = write_chrome_trace(path, capture); !result)
+    {
+        return std::unexpected(result.error());
+    }
+    return path;
+}
+
+#endif // SOLITAIRE_PROFILER
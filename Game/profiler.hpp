@@ -0,0 +1,122 @@
+#ifndef _GAME_PROFILER_HPP__
+#define _GAME_PROFILER_HPP__
+
+// Frame profiler. CPU scopes are recorded into a fixed-size ring per thread that only its
+// owner writes, so recording is a clock read and two stores; GPU scopes wrap GL_TIME_ELAPSED
+// queries that are read back a frame later, and only once available, so the CPU never waits on
+// them. Nothing is recorded outside a capture. A finished capture is written as Chrome trace
+// JSON (chrome://tracing, Perfetto).
+//
+// Built in when SOLITAIRE_PROFILER is defined to 1 (the SOLITAIRE_PROFILER CMake option);
+// otherwise the macros below expand to nothing and none of this is compiled.
+
+#if SOLITAIRE_PROFILER
+
+#include "types.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+enum class profile_track : std::uint8_t
+{
+    cpu,
+    gpu
+};
+
+// One finished scope. Names must be string literals (or otherwise outlive the capture).
+struct profile_event
+{
+    const char*   name;
+    std::uint64_t start_ns;    // steady_clock, since the capture started
+    std::uint64_t duration_ns;
+    std::uint32_t thread;      // Index of the recording thread's ring
+    profile_track track;
+};
+
+// A finished capture, with the names of the threads that recorded into it
+struct profile_capture
+{
+    std::vector<profile_event> events;
+    std::vector<std::string>   thread_names; // Indexed by profile_event::thread
+    std::uint64_t              dropped = 0;  // Lost to ring wrap-around or late GPU results
+};
+
+// Records the time between construction and destruction as a CPU event
+class profile_scope
+{
+public:
+    explicit profile_scope(const char* name) noexcept;
+    ~profile_scope();
+
+    profile_scope(const profile_scope&)            = delete;
+    profile_scope& operator=(const profile_scope&) = delete;
+
+private:
+    const char*   name_;
+    std::uint64_t start_ns_;
+};
+
+// Brackets the GL commands issued during its lifetime with a GL_TIME_ELAPSED query. GL does not
+// nest these queries, so a GPU scope opened inside another one records nothing.
+class gpu_profile_scope
+{
+public:
+    explicit gpu_profile_scope(const char* name) noexcept;
+    ~gpu_profile_scope();
+
+    gpu_profile_scope(const gpu_profile_scope&)            = delete;
+    gpu_profile_scope& operator=(const gpu_profile_scope&) = delete;
+
+private:
+    bool active_;
+};
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+// Label for the calling thread in exported traces
+void set_profiler_thread_name(const char* name);
+
+void begin_profiler_capture();
+auto is_profiler_capturing() -> bool;
+
+// Stops recording and gathers every event recorded since begin_profiler_capture
+auto end_profiler_capture() -> profile_capture;
+
+// GL thread, once per frame after the swap: starts the next set of GPU queries and reads back
+// whatever the previous frame's set has finished
+void profiler_gpu_frame();
+
+// GL thread, before the context goes away
+void release_profiler_gpu_queries();
+
+auto write_chrome_trace(const std::filesystem::path& path, const profile_capture& capture)
+    -> std::expected<void, error_message_t>;
+
+// Starts a capture, or ends the running one and writes it to a numbered trace file in the
+// working directory. Returns the path written, or an empty path when a capture was started.
+auto toggle_profiler_capture() -> std::expected<std::filesystem::path, error_message_t>;
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b)       PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name)                                                                      \
+    const auto PROFILE_CONCAT(profile_scope_, __LINE__) = profile_scope(name)
+#define PROFILE_GPU_SCOPE(name)                                                                  \
+    const auto PROFILE_CONCAT(gpu_profile_scope_, __LINE__) = gpu_profile_scope(name)
+#define PROFILE_THREAD_NAME(name) set_profiler_thread_name(name)
+#define PROFILE_GPU_FRAME()       profiler_gpu_frame()
+#define PROFILE_RELEASE_GPU()     release_profiler_gpu_queries()
+
+#else
+
+#define PROFILE_SCOPE(name)
+#define PROFILE_GPU_SCOPE(name)
+#define PROFILE_THREAD_NAME(name)
+#define PROFILE_GPU_FRAME()
+#define PROFILE_RELEASE_GPU()
+
+#endif // SOLITAIRE_PROFILER
+
+#endif // _GAME_PROFILER_HPP__
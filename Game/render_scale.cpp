@@ -0,0 +1,159 @@
+#include "render_scale.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Share of the budget a new scale is aimed at, so that noise does not push it straight back over
+constexpr auto budget_headroom = 0.9;
+
+} // namespace
+
+dynamic_resolution::dynamic_resolution(const dynamic_resolution_options& options)
+    : options_(options)
+    , scale_(std::clamp(options.max_scale, min_render_scale, max_render_scale))
+{
+    options_.min_scale = std::clamp(options_.min_scale, min_render_scale, scale_);
+}
+
+auto dynamic_resolution::update(double gpu_ms) -> bool
+{
+    if (gpu_ms <= 0.0)
+    {
+        return false;
+    }
+
+    // Averaged from the first frame at this scale; the frames before it cost something else
+    smoothed_ms_ =
+        frames_at_scale_ == 0 ? gpu_ms : smoothed_ms_ + (gpu_ms - smoothed_ms_) * 0.1;
+    if (++frames_at_scale_ < options_.settle_frames)
+    {
+        return false;
+    }
+
+    const auto budget = options_.target_ms * budget_headroom;
+    auto       next   = scale_;
+    if (smoothed_ms_ > options_.target_ms)
+    {
+        // Down to the step where the cost is predicted to fit, and at least one step
+        const auto fits  = scale_ * std::sqrt(budget / smoothed_ms_);
+        const auto steps = std::floor(fits / options_.step + 1e-3);
+        next             = std::min(float(steps) * options_.step, scale_ - options_.step);
+    }
+    else
+    {
+        const auto up        = scale_ + options_.step;
+        const auto predicted = smoothed_ms_ * (up / scale_) * (up / scale_);
+        if (predicted < budget)
+        {
+            next = up;
+        }
+    }
+    next = std::clamp(next, options_.min_scale, options_.max_scale);
+    if (next == scale_)
+    {
+        return false;
+    }
+
+    scale_           = next;
+    frames_at_scale_ = 0;
+    return true;
+}
+
+gpu_frame_timer::gpu_frame_timer()
+{
+    glGenQueries(GLsizei(queries_.size()), queries_.data());
+}
+
+gpu_frame_timer::~gpu_frame_timer()
+{
+    glDeleteQueries(GLsizei(queries_.size()), queries_.data());
+}
+
+void gpu_frame_timer::begin()
+{
+    // A pair is only reused once its result has been read
+    const auto pairs = queries_.size() / 2;
+    timing_          = begun_ - read_ < pairs;
+    if (timing_)
+    {
+        glQueryCounter(queries_[begun_ % pairs * 2], GL_TIMESTAMP);
+    }
+}
+
+void gpu_frame_timer::end()
+{
+    if (timing_)
+    {
+        glQueryCounter(queries_[begun_ % (queries_.size() / 2) * 2 + 1], GL_TIMESTAMP);
+        ++begun_;
+        timing_ = false;
+    }
+}
+
+auto gpu_frame_timer::poll() -> std::optional<double>
+{
+    if (read_ == begun_)
+    {
+        return std::nullopt;
+    }
+
+    // The end is written after the start, so once it is available both are
+    const auto pair      = read_ % (queries_.size() / 2) * 2;
+    auto       available = GLint(0);
+    glGetQueryObjectiv(queries_[pair + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == 0)
+    {
+        return std::nullopt;
+    }
+    auto start = GLuint64(0), end = GLuint64(0);
+    glGetQueryObjectui64v(queries_[pair], GL_QUERY_RESULT, &start);
+    glGetQueryObjectui64v(queries_[pair + 1], GL_QUERY_RESULT, &end);
+    ++read_;
+    return double(end - start) / 1e6;
+}
+
+auto fit_table_viewport(const table_metrics& metrics,
+                        std::int32_t         framebuffer_width,
+                        std::int32_t         framebuffer_height,
+                        float                render_scale) -> table_viewport
+{
+    auto viewport               = table_viewport{};
+    viewport.framebuffer_width  = std::max(framebuffer_width, 1);
+    viewport.framebuffer_height = std::max(framebuffer_height, 1);
+
+    const auto width  = float(viewport.framebuffer_width);
+    const auto height = float(viewport.framebuffer_height);
+    viewport.scale    = std::min(width / metrics.width, height / metrics.height);
+
+    // Centred, so the extra space is split between both sides
+    const auto shown_width  = width / viewport.scale;
+    const auto shown_height = height / viewport.scale;
+    viewport.area.left      = (metrics.width - shown_width) * 0.5f;
+    viewport.area.bottom    = (metrics.height - shown_height) * 0.5f;
+    viewport.area.right     = viewport.area.left + shown_width;
+    viewport.area.top       = viewport.area.bottom + shown_height;
+
+    const auto scale       = std::clamp(render_scale, min_render_scale, max_render_scale);
+    viewport.render_width  = std::max(std::int32_t(std::lround(width * scale)), 1);
+    viewport.render_height = std::max(std::int32_t(std::lround(height * scale)), 1);
+    return viewport;
+}
+
+auto framebuffer_to_table(const table_viewport& viewport, float x, float y) -> table_point
+{
+    return {viewport.area.left + x / viewport.scale, viewport.area.bottom + y / viewport.scale};
+}
+
+auto choose_card_texture_lod(const table_viewport& viewport, float texel_width)
+    -> card_texture_lod
+{
+    const auto shown_width = card_width_px * viewport.scale;
+    const auto lod         = std::log2(texel_width / shown_width);
+
+    auto result    = card_texture_lod{};
+    result.min_lod = std::max(std::floor(lod), 0.0f);
+    result.bias    = std::log2(float(viewport.render_width) / float(viewport.framebuffer_width));
+    return result;
+}
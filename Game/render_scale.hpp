@@ -0,0 +1,128 @@
+#ifndef _GAME_RENDER_SCALE_HPP__
+#define _GAME_RENDER_SCALE_HPP__
+
+#include "table_layout.hpp"
+
+// clang-format off
+#include <glad/gl.h>
+// clang-format on
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+// Render scales the game accepts. Below a quarter the cards stop being legible; above one the
+// scene would be supersampled, which a single linear blit down does not filter well.
+constexpr auto min_render_scale = 0.25f;
+constexpr auto max_render_scale = 1.0f;
+
+// How a table laid out at table_metrics size is shown in a framebuffer of any size and aspect:
+// scaled uniformly to fit and centred, with the margins showing more of the table. The cards
+// are drawn at the render size, the framebuffer size times the render scale, and scaled up to
+// the framebuffer when that is smaller.
+struct table_viewport
+{
+    std::int32_t framebuffer_width  = 0;
+    std::int32_t framebuffer_height = 0;
+    std::int32_t render_width       = 0;
+    std::int32_t render_height      = 0;
+    float        scale              = 1.0f; // Framebuffer pixels per table pixel
+    hit_rect     area               = {};   // Table pixels shown, framebuffer edge to edge
+
+    auto scaled() const -> bool
+    {
+        return render_width != framebuffer_width || render_height != framebuffer_height;
+    }
+};
+
+// Mip limits for the card texture array, see choose_card_texture_lod
+struct card_texture_lod
+{
+    float min_lod = 0.0f; // Finest level sampled: none sharper than the cards are shown at
+    float bias    = 0.0f; // Negative while rendering below the framebuffer's resolution
+};
+
+struct dynamic_resolution_options
+{
+    double       target_ms     = 1000.0 / 60.0; // GPU time a frame should stay within
+    float        min_scale     = 0.5f;
+    float        max_scale     = max_render_scale;
+    float        step          = 0.125f; // Scales change by whole steps; each change reallocates
+    std::int32_t settle_frames = 30;     // Frames measured at a scale before it may change
+};
+
+// Picks the render scale from measured GPU frame times. A frame's cost goes with its pixel
+// count, the square of the scale, so a scale over budget drops straight to where the cost
+// should fit with some headroom, while a scale is only raised a step at a time and only when
+// the step up is predicted to fit as well. Every change waits for settle_frames of timings at
+// the current scale, so it never flickers between two.
+class dynamic_resolution
+{
+public:
+    explicit dynamic_resolution(const dynamic_resolution_options& options = {});
+
+    // Adds one frame's GPU time; true when scale() changed, after which the render targets
+    // have to be reallocated
+    auto update(double gpu_ms) -> bool;
+
+    auto scale() const -> float { return scale_; }
+
+    // Frame time averaged over the frames at the current scale
+    auto smoothed_ms() const -> double { return smoothed_ms_; }
+
+private:
+    dynamic_resolution_options options_;
+    float                      scale_           = max_render_scale;
+    double                     smoothed_ms_     = 0.0;
+    std::int32_t               frames_at_scale_ = 0;
+};
+
+// GL_TIMESTAMP pairs around whole frames, read back without stalling: a frame's time is picked
+// up a few frames later, once the GPU has got that far. Frames begun while every query is still
+// in flight are not timed. Timestamps, unlike GL_TIME_ELAPSED, may be taken while profiler GPU
+// scopes have a time query open.
+class gpu_frame_timer
+{
+public:
+    gpu_frame_timer();
+    ~gpu_frame_timer();
+
+    gpu_frame_timer(const gpu_frame_timer&)            = delete;
+    gpu_frame_timer& operator=(const gpu_frame_timer&) = delete;
+
+    void begin();
+    void end();
+
+    // Milliseconds of the oldest timed frame whose result has come in, if any
+    auto poll() -> std::optional<double>;
+
+private:
+    std::array<GLuint, 8> queries_{}; // Start and end of four frames
+    std::uint64_t         begun_  = 0;  // Frames timed so far
+    std::uint64_t         read_   = 0; // Results read so far
+    bool                  timing_ = false;
+};
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+// Fits the table into the framebuffer. The render scale is clamped to the supported range and
+// the render size rounded to whole pixels, at least one each way.
+auto fit_table_viewport(const table_metrics& metrics,
+                        std::int32_t         framebuffer_width,
+                        std::int32_t         framebuffer_height,
+                        float                render_scale = max_render_scale)
+    -> table_viewport;
+
+// Table position under a framebuffer pixel, bottom-left origin
+auto framebuffer_to_table(const table_viewport& viewport, float x, float y) -> table_point;
+
+// Mip limits for cards drawn through `viewport` from layers `texel_width` texels wide. Nothing
+// finer is sampled than the level just above the size a card takes up in the framebuffer, so
+// small cards never touch the full-size level. When rendering below the framebuffer's
+// resolution the bias moves sampling back to the level the framebuffer needs, not the blurrier
+// one the render size alone would pick.
+auto choose_card_texture_lod(const table_viewport& viewport,
+                             float                 texel_width = float(atlas_frames.front().w))
+    -> card_texture_lod;
+
+#endif // _GAME_RENDER_SCALE_HPP__
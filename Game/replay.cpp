@@ -0,0 +1,379 @@
+#include "replay.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <string>
+
+namespace {
+
+constexpr auto fnv_prime = 0x100000001B3ull;
+
+auto to_pixel(float value) -> std::int16_t
+{
+    return std::int16_t(std::clamp(std::lround(value), -32768l, 32767l));
+}
+
+auto step_error(std::uint64_t step, const char* what) -> error_message_t
+{
+    return "Replay step " + std::to_string(step) + ": " + what;
+}
+
+} // namespace
+
+auto replay_checksum(std::span<const std::byte> bytes, std::uint64_t seed) -> std::uint64_t
+{
+    auto hash  = seed;
+    auto index = std::size_t(0);
+    for (; index + sizeof(std::uint64_t) <= bytes.size(); index += sizeof(std::uint64_t))
+    {
+        auto word = std::uint64_t(0);
+        std::memcpy(&word, bytes.data() + index, sizeof(word));
+        hash = (hash ^ word) * fnv_prime;
+    }
+    for (; index < bytes.size(); ++index)
+    {
+        hash = (hash ^ std::uint64_t(bytes[index])) * fnv_prime;
+    }
+    return hash;
+}
+
+// -------------------- Writer ---------------------
+
+replay_writer::replay_writer(std::ofstream         out,
+                             const klondike_state& deal,
+                             std::uint32_t         keyframe_interval,
+                             std::uint64_t         checksum)
+    : out_(std::move(out))
+    , state_(deal)
+    , keyframe_interval_(keyframe_interval)
+    , checksum_(checksum)
+{
+    buffer_.reserve(buffered_events);
+    index_.push_back({0, 0, pack_keyframe(deal)});
+}
+
+auto replay_writer::create(const std::filesystem::path& path,
+                           std::uint64_t                seed,
+                           std::uint8_t                 draw_count,
+                           std::uint64_t                start_time,
+                           std::uint32_t                keyframe_interval)
+    -> std::expected<replay_writer, error_message_t>
+{
+    auto out = std::ofstream(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+    {
+        return std::unexpected("Failed to create replay file: " + path.string());
+    }
+
+    const auto header =
+        replay_header{replay_magic, replay_version, draw_count, 0, seed, start_time};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!out)
+    {
+        return std::unexpected("Failed to write replay header: " + path.string());
+    }
+
+    const auto checksum = replay_checksum(std::as_bytes(std::span(&header, 1)));
+    return replay_writer(std::move(out),
+                         deal_klondike(shuffle_deck(seed), draw_count),
+                         std::max(keyframe_interval, 1u),
+                         checksum);
+}
+
+void replay_writer::write(const void* data, std::size_t size)
+{
+    // Every block is a whole number of words, so the checksum streams across writes
+    const auto bytes = std::span(static_cast<const std::byte*>(data), size);
+    checksum_        = replay_checksum(bytes, checksum_);
+    out_.write(static_cast<const char*>(data), std::streamsize(size));
+}
+
+void replay_writer::record(const replay_event& event)
+{
+    buffer_.push_back(event);
+    ++event_count_;
+    if (is_replay_step(event.kind))
+    {
+        ++step_count_;
+        if (step_count_ % keyframe_interval_ == 0)
+        {
+            index_.push_back({step_count_, event_count_, pack_keyframe(state_)});
+        }
+    }
+    if (buffer_.size() == buffered_events)
+    {
+        // A failed write leaves the stream bad, which finish() reports
+        [[maybe_unused]] auto result = flush();
+    }
+}
+
+void replay_writer::record_move(std::uint32_t time, const klondike_move& move)
+{
+    auto applied = move;
+    apply_move(state_, applied);
+    record({time, replay_event_kind::move, 0, 0, applied, 0, 0});
+}
+
+void replay_writer::record_undo(std::uint32_t time, const klondike_move& move)
+{
+    undo_move(state_, move);
+    record({time, replay_event_kind::undo, 0, 0, move, 0, 0});
+}
+
+void replay_writer::record_redo(std::uint32_t time, const klondike_move& move)
+{
+    auto applied = move;
+    apply_move(state_, applied);
+    record({time, replay_event_kind::redo, 0, 0, applied, 0, 0});
+}
+
+void replay_writer::record_pointer(std::uint32_t time, replay_event_kind kind, float x, float y)
+{
+    record({time, kind, 0, 0, {}, to_pixel(x), to_pixel(y)});
+}
+
+void replay_writer::record_key(std::uint32_t time, std::uint16_t key)
+{
+    record({time, replay_event_kind::key, 0, key, {}, 0, 0});
+}
+
+auto replay_writer::flush() -> std::expected<void, error_message_t>
+{
+    write(buffer_.data(), buffer_.size() * sizeof(replay_event));
+    buffer_.clear();
+    out_.flush();
+    if (!out_)
+    {
+        return std::unexpected(error_message_t("Failed to write replay events"));
+    }
+    return {};
+}
+
+auto replay_writer::finish() -> std::expected<void, error_message_t>
+{
+    if (auto result = flush(); !result)
+    {
+        return result;
+    }
+    write(index_.data(), index_.size() * sizeof(replay_index_entry));
+
+    const auto footer = replay_footer{event_count_,
+                                      index_.size(),
+                                      step_count_,
+                                      state_.hash,
+                                      keyframe_interval_,
+                                      replay_footer_magic,
+                                      checksum_};
+    out_.write(reinterpret_cast<const char*>(&footer), sizeof(footer));
+    out_.close();
+    if (!out_)
+    {
+        return std::unexpected(error_message_t("Failed to finish replay file"));
+    }
+    return {};
+}
+
+// -------------------- Reader ---------------------
+
+replay_reader::replay_reader(std::shared_ptr<mapped_file> file)
+    : file_(std::move(file))
+    , header_(reinterpret_cast<const replay_header*>(file_->data()))
+    , footer_(reinterpret_cast<const replay_footer*>(file_->data() + file_->size() -
+                                                     sizeof(replay_footer)))
+{
+    const auto* events = reinterpret_cast<const replay_event*>(file_->data() + sizeof(*header_));
+    events_            = {events, footer_->event_count};
+    index_ = {reinterpret_cast<const replay_index_entry*>(events + footer_->event_count),
+              footer_->index_count};
+}
+
+auto replay_reader::open(const std::filesystem::path& path)
+    -> std::expected<replay_reader, error_message_t>
+{
+    auto file = map_file(path);
+    if (!file)
+    {
+        return std::unexpected(file.error());
+    }
+
+    const auto& mapping = *file.value();
+    if (mapping.size() < sizeof(replay_header) + sizeof(replay_footer))
+    {
+        return std::unexpected("Replay file is too small: " + path.string());
+    }
+
+    const auto* header = reinterpret_cast<const replay_header*>(mapping.data());
+    if (header->magic != replay_magic)
+    {
+        return std::unexpected("Not a replay file: " + path.string());
+    }
+    if (header->version != replay_version)
+    {
+        return std::unexpected("Unsupported replay version " + std::to_string(header->version) +
+                               ": " + path.string());
+    }
+
+    const auto  body_size = mapping.size() - sizeof(replay_footer);
+    const auto* footer    = reinterpret_cast<const replay_footer*>(mapping.data() + body_size);
+    if (footer->magic != replay_footer_magic)
+    {
+        return std::unexpected("Replay file is unfinished or truncated: " + path.string());
+    }
+
+    // Counts are checked one at a time so a corrupt one cannot overflow the expected size
+    const auto max_records = mapping.size() / sizeof(replay_event);
+    if (footer->event_count > max_records || footer->index_count > max_records ||
+        footer->index_count == 0 ||
+        sizeof(replay_header) + footer->event_count * sizeof(replay_event) +
+                footer->index_count * sizeof(replay_index_entry) !=
+            body_size)
+    {
+        return std::unexpected("Replay file sizes do not match its footer: " + path.string());
+    }
+    if (replay_checksum(mapping.bytes().first(body_size)) != footer->checksum)
+    {
+        return std::unexpected("Replay checksum mismatch: " + path.string());
+    }
+
+    auto replay = replay_reader(std::move(file.value()));
+    if (replay.index_.front().step != 0 || replay.index_.front().event != 0)
+    {
+        return std::unexpected("Replay index does not start at the deal: " + path.string());
+    }
+    return replay;
+}
+
+auto replay_reader::deal() const -> klondike_state
+{
+    return deal_klondike(shuffle_deck(header_->seed), header_->draw_count);
+}
+
+auto replay_reader::state_at(std::uint64_t step) const -> klondike_state
+{
+    step = std::min(step, step_count());
+
+    // Last keyframe at or before the step
+    const auto entry = std::prev(std::upper_bound(
+        index_.begin(), index_.end(), step, [](std::uint64_t target, const auto& candidate) {
+            return target < candidate.step;
+        }));
+
+    auto state   = unpack_keyframe(entry->keyframe);
+    auto current = entry->step;
+    for (auto event = entry->event; current < step; ++event)
+    {
+        const auto& recorded = events_[event];
+        if (!is_replay_step(recorded.kind))
+        {
+            continue;
+        }
+        if (recorded.kind == replay_event_kind::undo)
+        {
+            undo_move(state, recorded.move);
+        }
+        else
+        {
+            auto move = recorded.move;
+            apply_move(state, move);
+        }
+        ++current;
+    }
+    return state;
+}
+
+auto verify_replay(const replay_reader& replay) -> std::expected<replay_summary, error_message_t>
+{
+    auto history = move_history(replay.deal(), std::numeric_limits<std::uint32_t>::max());
+    auto index   = replay.index();
+    auto next    = std::size_t(0);
+    auto step    = std::uint64_t(0);
+    auto time    = std::uint32_t(0);
+
+    // Keyframes recorded at the position reached after `step` steps and `events` events
+    const auto check_keyframes = [&](std::uint64_t events) -> bool {
+        for (; next < index.size() && index[next].step == step; ++next)
+        {
+            if (index[next].event != events ||
+                unpack_keyframe(index[next].keyframe) != history.state())
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    if (!check_keyframes(0))
+    {
+        return std::unexpected(step_error(0, "keyframe does not match the deal"));
+    }
+
+    const auto events = replay.events();
+    for (auto event = std::size_t(0); event < events.size(); ++event)
+    {
+        const auto& recorded = events[event];
+        if (recorded.time < time)
+        {
+            return std::unexpected(step_error(step, "time runs backwards"));
+        }
+        time = recorded.time;
+
+        switch (recorded.kind)
+        {
+        case replay_event_kind::move:
+        {
+            // Any legal move, not just the ones generate_moves offers the solver
+            auto move  = recorded.move;
+            move.flags = 0;
+            if (!is_legal_move(history.state(), move))
+            {
+                return std::unexpected(step_error(step, "illegal move"));
+            }
+            history.apply(move);
+            if (history.move_at(history.position() - 1) != recorded.move)
+            {
+                return std::unexpected(step_error(step, "move flags do not match"));
+            }
+            break;
+        }
+        case replay_event_kind::undo:
+            if (history.position() == 0 || history.move_at(history.position() - 1) != recorded.move)
+            {
+                return std::unexpected(step_error(step, "undo does not match the last move"));
+            }
+            history.undo();
+            break;
+        case replay_event_kind::redo:
+            if (history.position() == history.size() ||
+                history.move_at(history.position()) != recorded.move)
+            {
+                return std::unexpected(step_error(step, "redo does not match the undone move"));
+            }
+            history.redo();
+            break;
+        case replay_event_kind::pointer_down:
+        case replay_event_kind::pointer_move:
+        case replay_event_kind::pointer_up:
+        case replay_event_kind::key: continue;
+        default: return std::unexpected(step_error(step, "unknown event"));
+        }
+
+        ++step;
+        if (!check_keyframes(event + 1))
+        {
+            return std::unexpected(step_error(step, "keyframe does not match the position"));
+        }
+    }
+
+    if (step != replay.step_count() || next != index.size())
+    {
+        return std::unexpected(error_message_t("Replay footer does not match its events"));
+    }
+    if (history.state().hash != replay.footer().final_hash)
+    {
+        return std::unexpected(error_message_t("Replay final position does not match"));
+    }
+    return replay_summary{step, events.size(), history.state().hash, is_won(history.state())};
+}
@@ -0,0 +1,192 @@
+#ifndef _GAME_REPLAY_HPP__
+#define _GAME_REPLAY_HPP__
+
+#include "klondike.hpp"
+#include "mapped_file.hpp"
+#include "move_history.hpp"
+#include "types.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <vector>
+
+// A recorded session: the deal and every timestamped input and move, laid out as
+//
+//   replay_header | replay_event[event_count] | replay_index_entry[index_count] | replay_footer
+//
+// Events are fixed size, so the file streams out as the game is played and event N sits at a
+// known offset. Moves, undos and redos all carry the move they applied or reverted, so the
+// position can be rebuilt from any keyframe without the history before it. Every
+// keyframe_interval of those steps the index gets a packed keyframe, and seeking to a step
+// replays at most one interval. The footer, written last, holds the counts and a checksum of
+// everything before it; a session that never finished has no footer and does not open.
+constexpr auto replay_magic        = std::uint32_t(0x4C505253); // "SRPL"
+constexpr auto replay_footer_magic = std::uint32_t(0x444E4552); // "REND"
+constexpr auto replay_version      = std::uint16_t(1);
+
+struct replay_header
+{
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint8_t  draw_count;
+    std::uint8_t  reserved;
+    std::uint64_t seed;
+    std::uint64_t start_time; // Wall clock at the start, milliseconds since the Unix epoch
+};
+
+enum class replay_event_kind : std::uint8_t
+{
+    move         = 1, // Applied `move`
+    undo         = 2, // Reverted `move`
+    redo         = 3, // Applied `move` again
+    pointer_down = 4,
+    pointer_move = 5,
+    pointer_up   = 6,
+    key          = 7 // `key` pressed
+};
+
+struct replay_event
+{
+    std::uint32_t     time; // Milliseconds since the session started
+    replay_event_kind kind;
+    std::uint8_t      reserved;
+    std::uint16_t     key;  // GLFW key code of key events
+    klondike_move     move; // Moves, undos and redos, flip flag included
+    std::int16_t      x, y; // Pointer events, in table pixels
+};
+
+struct replay_index_entry
+{
+    std::uint64_t    step;  // Moves, undos and redos before the keyframe
+    std::uint64_t    event; // First event after it
+    history_keyframe keyframe;
+};
+
+struct replay_footer
+{
+    std::uint64_t event_count;
+    std::uint64_t index_count;
+    std::uint64_t step_count;
+    std::uint64_t final_hash; // klondike_state::hash at the end
+    std::uint32_t keyframe_interval;
+    std::uint32_t magic;
+    std::uint64_t checksum; // replay_checksum of every byte before the footer
+};
+
+static_assert(sizeof(replay_header) == 24);
+static_assert(sizeof(replay_event) == 16);
+static_assert(sizeof(replay_index_entry) == 88);
+static_assert(sizeof(replay_footer) == 48);
+
+constexpr auto is_replay_step(replay_event_kind kind) -> bool
+{
+    return kind == replay_event_kind::move || kind == replay_event_kind::undo ||
+           kind == replay_event_kind::redo;
+}
+
+// Records a session to a file as it is played. Events are buffered and written in blocks, so
+// recording costs the game loop a copy; nothing is readable until finish() writes the footer.
+class replay_writer
+{
+public:
+    static constexpr auto default_keyframe_interval = std::uint32_t(64);
+    static constexpr auto buffered_events           = std::size_t(1024);
+
+    // Creates `path` for the deal of `seed`, replacing any existing file
+    static auto create(const std::filesystem::path& path,
+                       std::uint64_t                seed,
+                       std::uint8_t                 draw_count,
+                       std::uint64_t                start_time,
+                       std::uint32_t keyframe_interval = default_keyframe_interval)
+        -> std::expected<replay_writer, error_message_t>;
+
+    // Moves as passed to or returned by apply_move, so undos carry the flip flag
+    void record_move(std::uint32_t time, const klondike_move& move);
+    void record_undo(std::uint32_t time, const klondike_move& move);
+    void record_redo(std::uint32_t time, const klondike_move& move);
+    void record_pointer(std::uint32_t time, replay_event_kind kind, float x, float y);
+    void record_key(std::uint32_t time, std::uint16_t key);
+
+    // Writes out buffered events
+    auto flush() -> std::expected<void, error_message_t>;
+
+    // Writes the index and footer and closes the file
+    auto finish() -> std::expected<void, error_message_t>;
+
+    auto state() const -> const klondike_state& { return state_; }
+    auto step_count() const -> std::uint64_t { return step_count_; }
+
+private:
+    replay_writer(std::ofstream         out,
+                  const klondike_state& deal,
+                  std::uint32_t         keyframe_interval,
+                  std::uint64_t         checksum);
+
+    void record(const replay_event& event);
+    void write(const void* data, std::size_t size);
+
+    std::ofstream                   out_;
+    klondike_state                  state_;
+    std::uint32_t                   keyframe_interval_;
+    std::uint64_t                   checksum_;
+    std::uint64_t                   event_count_ = 0;
+    std::uint64_t                   step_count_  = 0;
+    std::vector<replay_event>       buffer_;
+    std::vector<replay_index_entry> index_;
+};
+
+// Read-only view of a finished replay, straight from a mapping of the file
+class replay_reader
+{
+public:
+    // Maps `path` and checks the header, sizes and checksum; events are not parsed
+    static auto open(const std::filesystem::path& path)
+        -> std::expected<replay_reader, error_message_t>;
+
+    auto header() const -> const replay_header& { return *header_; }
+    auto footer() const -> const replay_footer& { return *footer_; }
+    auto events() const -> std::span<const replay_event> { return events_; }
+    auto index() const -> std::span<const replay_index_entry> { return index_; }
+    auto step_count() const -> std::uint64_t { return footer_->step_count; }
+
+    // The position before any step
+    auto deal() const -> klondike_state;
+
+    // The position after `step` moves, undos and redos, rebuilt from the nearest keyframe.
+    // Assumes the recorded moves are legal; verify_replay checks that.
+    auto state_at(std::uint64_t step) const -> klondike_state;
+
+private:
+    explicit replay_reader(std::shared_ptr<mapped_file> file);
+
+    std::shared_ptr<mapped_file>        file_;
+    const replay_header*                header_;
+    const replay_footer*                footer_;
+    std::span<const replay_event>       events_;
+    std::span<const replay_index_entry> index_;
+};
+
+// What re-simulating a replay found
+struct replay_summary
+{
+    std::uint64_t steps      = 0;
+    std::uint64_t events     = 0;
+    std::uint64_t final_hash = 0;
+    bool          won        = false;
+};
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+// 64-bit FNV-1a over 8-byte words, continuing from `seed`
+auto replay_checksum(std::span<const std::byte> bytes, std::uint64_t seed = 0xCBF29CE484222325ull)
+    -> std::uint64_t;
+
+// Replays every step from the deal: moves must be legal, undos and redos must match the moves
+// they revert or reapply, and every keyframe and the final hash must match the position reached
+auto verify_replay(const replay_reader& replay) -> std::expected<replay_summary, error_message_t>;
+
+#endif // _GAME_REPLAY_HPP__
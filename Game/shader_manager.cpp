@@ -0,0 +1,473 @@
+#include "shader_manager.hpp"
+#include "asset_pack.hpp"
+#include "cards.hpp"
+#include "mapped_file.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <utility>
+
+namespace {
+
+constexpr auto fnv_offset = 0xCBF29CE484222325ull;
+constexpr auto fnv_prime  = 0x100000001B3ull;
+
+auto hash_bytes(std::string_view bytes, std::uint64_t hash) -> std::uint64_t
+{
+    for (const auto byte : bytes)
+    {
+        hash = (hash ^ std::uint8_t(byte)) * fnv_prime;
+    }
+    // Ends every part, so moving text from one part to the next changes the key
+    return (hash ^ 0xFF) * fnv_prime;
+}
+
+auto shader_info_log(GLuint shader_id) -> std::string
+{
+    auto length = GLint(0);
+    glGetShaderiv(shader_id, GL_INFO_LOG_LENGTH, &length);
+    auto log = std::string(std::size_t(std::max(length, 1)), '\0');
+    glGetShaderInfoLog(shader_id, GLsizei(log.size()), &length, log.data());
+    log.resize(std::size_t(length));
+    return log;
+}
+
+auto program_info_log(GLuint program_id) -> std::string
+{
+    auto length = GLint(0);
+    glGetProgramiv(program_id, GL_INFO_LOG_LENGTH, &length);
+    auto log = std::string(std::size_t(std::max(length, 1)), '\0');
+    glGetProgramInfoLog(program_id, GLsizei(log.size()), &length, log.data());
+    log.resize(std::size_t(length));
+    return log;
+}
+
+// Empty when the shader compiled, "name: log" otherwise
+auto shader_errors(GLuint shader_id, std::string_view name) -> std::string
+{
+    auto compiled = GLint(GL_FALSE);
+    glGetShaderiv(shader_id, GL_COMPILE_STATUS, &compiled);
+    if (compiled == GL_TRUE)
+    {
+        return {};
+    }
+    return std::string(name) + ": " + shader_info_log(shader_id);
+}
+
+auto milliseconds_since(std::chrono::steady_clock::time_point start) -> double
+{
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::milli>(elapsed).count();
+}
+
+// Edits are made to the loose files, so a reload reads those even when a pack is mounted
+auto loose_shader_paths(const shader_paths& paths) -> shader_paths
+{
+    const auto resolve = [](const std::filesystem::path& path) {
+        return path.is_relative()
+                   ? assets().loose_path(path.generic_string()).value_or(path)
+                   : path;
+    };
+    return {resolve(paths.vertex), resolve(paths.fragment)};
+}
+
+} // namespace
+
+auto card_shader_paths() -> shader_paths
+{
+    return {"Shaders/card.vert", "Shaders/card.frag"};
+}
+
+auto program_cache_path() -> std::filesystem::path
+{
+    return assets().root() / "Assets/card.program";
+}
+
+auto read_shader_sources(const shader_paths& paths)
+    -> std::expected<shader_sources, error_message_t>
+{
+    auto vertex = read_file_content(paths.vertex);
+    if (!vertex)
+    {
+        return std::unexpected("Failed to read shader file: " + vertex.error());
+    }
+    auto fragment = read_file_content(paths.fragment);
+    if (!fragment)
+    {
+        return std::unexpected("Failed to read shader file: " + fragment.error());
+    }
+    return shader_sources{std::move(vertex.value()), std::move(fragment.value())};
+}
+
+auto gl_driver_string() -> std::string
+{
+    auto driver = std::string();
+    for (const auto name : {GL_VENDOR, GL_RENDERER, GL_VERSION})
+    {
+        const auto* value = reinterpret_cast<const char*>(glGetString(name));
+        driver += value != nullptr ? value : "";
+        driver += '\n';
+    }
+    return driver;
+}
+
+auto program_cache_key(const shader_sources& sources, std::string_view driver) -> std::uint64_t
+{
+    auto hash = hash_bytes(sources.vertex, fnv_offset);
+    hash      = hash_bytes(sources.fragment, hash);
+    return hash_bytes(driver, hash);
+}
+
+auto compile_shader(std::string_view source, GLenum shader_type, std::string_view name)
+    -> std::expected<GLuint, error_message_t>
+{
+    PROFILE_SCOPE("compile_shader");
+    auto          shader_id     = glCreateShader(shader_type);
+    const GLchar* source_ptr    = source.data();
+    const auto    source_length = GLint(source.size());
+    glShaderSource(shader_id, 1, &source_ptr, &source_length);
+    glCompileShader(shader_id);
+
+    if (auto errors = shader_errors(shader_id, name); !errors.empty())
+    {
+        glDeleteShader(shader_id);
+        return std::unexpected(errors);
+    }
+    return shader_id;
+}
+
+auto link_shader_program(GLuint vertex_shader_id, GLuint fragment_shader_id)
+    -> std::expected<GLuint, error_message_t>
+{
+    PROFILE_SCOPE("link_shader_program");
+    auto program_id = glCreateProgram();
+    glProgramParameteri(program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(program_id, vertex_shader_id);
+    glAttachShader(program_id, fragment_shader_id);
+    glLinkProgram(program_id);
+
+    auto program_linked = GLint();
+    glGetProgramiv(program_id, GL_LINK_STATUS, &program_linked);
+    if (program_linked != GL_TRUE)
+    {
+        auto log = program_info_log(program_id);
+        glDeleteProgram(program_id);
+        return std::unexpected(log);
+    }
+
+    glDetachShader(program_id, vertex_shader_id);
+    glDetachShader(program_id, fragment_shader_id);
+    return program_id;
+}
+
+auto load_program_binary(const std::filesystem::path& path, std::uint64_t key)
+    -> std::expected<GLuint, error_message_t>
+{
+    PROFILE_SCOPE("load_program_binary");
+    auto format_count = GLint(0);
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    if (format_count == 0)
+    {
+        return std::unexpected(error_message_t("The driver offers no program binary formats"));
+    }
+
+    auto file = map_file(path);
+    if (!file)
+    {
+        return std::unexpected(file.error());
+    }
+    const auto& mapping = *file.value();
+    if (mapping.size() < sizeof(program_cache_header))
+    {
+        return std::unexpected("Program cache is too small: " + path.string());
+    }
+
+    auto header = program_cache_header{};
+    std::memcpy(&header, mapping.data(), sizeof(header));
+    if (header.magic != program_cache_magic || header.version != program_cache_version)
+    {
+        return std::unexpected("Not a program cache of this version: " + path.string());
+    }
+    if (header.key != key)
+    {
+        return std::unexpected("Program cache is stale: " + path.string());
+    }
+    if (header.size != mapping.size() - sizeof(header))
+    {
+        return std::unexpected("Program cache is truncated: " + path.string());
+    }
+
+    // The driver may still refuse a binary from an older build of itself
+    auto program_id = glCreateProgram();
+    glProgramBinary(program_id,
+                    GLenum(header.format),
+                    mapping.data() + sizeof(header),
+                    GLsizei(header.size));
+    auto program_linked = GLint();
+    glGetProgramiv(program_id, GL_LINK_STATUS, &program_linked);
+    if (program_linked != GL_TRUE)
+    {
+        glDeleteProgram(program_id);
+        return std::unexpected("Program cache was rejected by the driver: " + path.string());
+    }
+    return program_id;
+}
+
+auto save_program_binary(const std::filesystem::path& path, std::uint64_t key, GLuint program)
+    -> std::expected<void, error_message_t>
+{
+    PROFILE_SCOPE("save_program_binary");
+    auto length = GLint(0);
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+    {
+        return std::unexpected(error_message_t("The driver returned no program binary"));
+    }
+
+    auto binary  = std::vector<char>(std::size_t(length));
+    auto written = GLsizei(0);
+    auto format  = GLenum(0);
+    glGetProgramBinary(program, length, &written, &format, binary.data());
+    const auto header = program_cache_header{
+        program_cache_magic, program_cache_version, format, 0, key, std::uint64_t(written)};
+
+    auto directory_error = std::error_code();
+    std::filesystem::create_directories(path.parent_path(), directory_error);
+
+    // Write to a temporary file and rename, so a half-written cache is never picked up
+    auto temporary_path = path;
+    temporary_path += ".tmp";
+    {
+        auto out = std::ofstream(temporary_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(binary.data(), written);
+        if (!out)
+        {
+            return std::unexpected("Failed to write program cache: " + temporary_path.string());
+        }
+    }
+
+    auto rename_error = std::error_code();
+    std::filesystem::rename(temporary_path, path, rename_error);
+    if (rename_error)
+    {
+        return std::unexpected("Failed to move program cache into place: " +
+                               rename_error.message());
+    }
+    return {};
+}
+
+auto build_program(const shader_paths&          paths,
+                   const std::filesystem::path& cache_path,
+                   shader_caching               caching)
+    -> std::expected<built_program, error_message_t>
+{
+    PROFILE_SCOPE("build_program");
+    const auto start = std::chrono::steady_clock::now();
+
+    auto sources = read_shader_sources(paths);
+    if (!sources)
+    {
+        return std::unexpected(sources.error());
+    }
+
+    const auto key = program_cache_key(sources.value(), gl_driver_string());
+    if (caching == shader_caching::enabled)
+    {
+        if (auto cached = load_program_binary(cache_path, key); cached)
+        {
+            return built_program{cached.value(), {milliseconds_since(start), true}};
+        }
+    }
+
+    auto vertex = compile_shader(
+        sources->vertex, GL_VERTEX_SHADER, paths.vertex.filename().string());
+    if (!vertex)
+    {
+        return std::unexpected("Failed to compile vertex shader: " + vertex.error());
+    }
+    auto fragment = compile_shader(
+        sources->fragment, GL_FRAGMENT_SHADER, paths.fragment.filename().string());
+    if (!fragment)
+    {
+        glDeleteShader(vertex.value());
+        return std::unexpected("Failed to compile fragment shader: " + fragment.error());
+    }
+
+    auto program = link_shader_program(vertex.value(), fragment.value());
+    glDeleteShader(vertex.value());
+    glDeleteShader(fragment.value());
+    if (!program)
+    {
+        return std::unexpected("Failed to link shader program: " + program.error());
+    }
+
+    const auto milliseconds = milliseconds_since(start);
+    if (caching == shader_caching::enabled)
+    {
+        // A cache that cannot be written only costs the next launch a compile
+        [[maybe_unused]] auto saved = save_program_binary(cache_path, key, program.value());
+    }
+    return built_program{program.value(), {milliseconds, false}};
+}
+
+// -------------------- Async compilation ---------------------
+
+pending_program::pending_program(const shader_sources& sources)
+{
+    PROFILE_SCOPE("submit_program");
+    if (GLAD_GL_KHR_parallel_shader_compile)
+    {
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF); // As many as the driver likes
+    }
+
+    const auto submit = [](const std::string& source, GLenum shader_type) {
+        auto          shader_id  = glCreateShader(shader_type);
+        const GLchar* source_ptr = source.c_str();
+        glShaderSource(shader_id, 1, &source_ptr, nullptr);
+        glCompileShader(shader_id);
+        return shader_id;
+    };
+    vertex_   = submit(sources.vertex, GL_VERTEX_SHADER);
+    fragment_ = submit(sources.fragment, GL_FRAGMENT_SHADER);
+
+    // Linking is queued behind the compiles; a failed compile shows up as a failed link
+    program_ = glCreateProgram();
+    glProgramParameteri(program_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(program_, vertex_);
+    glAttachShader(program_, fragment_);
+    glLinkProgram(program_);
+}
+
+pending_program::~pending_program()
+{
+    // Zero when finish() handed the program out
+    glDeleteProgram(program_);
+    glDeleteShader(vertex_);
+    glDeleteShader(fragment_);
+}
+
+auto pending_program::ready() const -> bool
+{
+    if (!GLAD_GL_KHR_parallel_shader_compile || program_ == 0)
+    {
+        return true;
+    }
+    auto completed = GLint(GL_FALSE);
+    glGetProgramiv(program_, GL_COMPLETION_STATUS_KHR, &completed);
+    return completed == GL_TRUE;
+}
+
+auto pending_program::finish() -> std::expected<GLuint, error_message_t>
+{
+    PROFILE_SCOPE("finish_program");
+    auto errors = shader_errors(vertex_, "vertex shader");
+    if (auto fragment_errors = shader_errors(fragment_, "fragment shader");
+        !fragment_errors.empty())
+    {
+        errors += errors.empty() ? fragment_errors : "\n" + fragment_errors;
+    }
+    if (!errors.empty())
+    {
+        return std::unexpected(errors);
+    }
+
+    auto program_linked = GLint();
+    glGetProgramiv(program_, GL_LINK_STATUS, &program_linked);
+    if (program_linked != GL_TRUE)
+    {
+        return std::unexpected("Failed to link shader program: " + program_info_log(program_));
+    }
+
+    glDetachShader(program_, vertex_);
+    glDetachShader(program_, fragment_);
+    return std::exchange(program_, 0);
+}
+
+// -------------------- Hot reload ---------------------
+
+shader_watcher::shader_watcher(std::vector<std::filesystem::path> files,
+                               std::function<void()>              on_change,
+                               std::chrono::milliseconds          interval)
+    : files_(std::move(files))
+    , on_change_(std::move(on_change))
+    , interval_(interval)
+    , stamps_(read_stamps(files_))
+    , thread_([this](std::stop_token stop_token) { watch(stop_token); })
+{
+}
+
+auto shader_watcher::read_stamps(const std::vector<std::filesystem::path>& files)
+    -> std::vector<file_stamp>
+{
+    auto stamps = std::vector<file_stamp>();
+    for (const auto& file : files)
+    {
+        // Each call clears the error it is given, so one shared code would only report the last
+        auto time_error = std::error_code();
+        auto size_error = std::error_code();
+        auto stamp      = file_stamp{std::filesystem::last_write_time(file, time_error),
+                                      std::filesystem::file_size(file, size_error)};
+        stamps.push_back(time_error || size_error ? file_stamp{} : stamp);
+    }
+    return stamps;
+}
+
+void shader_watcher::watch(std::stop_token stop_token)
+{
+    PROFILE_THREAD_NAME("shader watcher");
+
+    // Only ever woken early by a stop request
+    auto mutex = std::mutex();
+    auto wake  = std::condition_variable_any();
+    while (!stop_token.stop_requested())
+    {
+        {
+            auto lock = std::unique_lock(mutex);
+            wake.wait_for(lock, stop_token, interval_, [] { return false; });
+        }
+
+        auto current = read_stamps(files_);
+        if (current != stamps_ && !stop_token.stop_requested())
+        {
+            stamps_  = std::move(current);
+            changed_ = true;
+            if (on_change_)
+            {
+                on_change_();
+            }
+        }
+    }
+}
+
+shader_reloader::shader_reloader(shader_paths paths, std::function<void()> on_change)
+    : paths_(loose_shader_paths(paths))
+    , watcher_({paths_.vertex, paths_.fragment}, std::move(on_change))
+{
+}
+
+auto shader_reloader::poll() -> std::optional<std::expected<GLuint, error_message_t>>
+{
+    // Changes made while a rebuild is in flight are picked up once it finishes
+    if (!pending_ && watcher_.take_changed())
+    {
+        auto sources = read_shader_sources(paths_);
+        if (!sources)
+        {
+            return std::unexpected(sources.error());
+        }
+        pending_.emplace(sources.value());
+    }
+    if (!pending_ || !pending_->ready())
+    {
+        return std::nullopt;
+    }
+
+    auto program = pending_->finish();
+    pending_.reset();
+    return program;
+}
@@ -0,0 +1,197 @@
+#ifndef _GAME_SHADER_MANAGER_HPP__
+#define _GAME_SHADER_MANAGER_HPP__
+
+#include "types.hpp"
+
+// clang-format off
+#include <glad/gl.h>
+// clang-format on
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Linked programs are cached on disk as returned by glGetProgramBinary. The file is laid out as:
+//   program_cache_header | binary[size]
+// The key hashes the shader sources and the driver string, so editing a shader or updating the
+// driver makes the cache stale and the program is compiled from source again.
+constexpr auto program_cache_magic   = std::uint32_t(0x47525053); // "SPRG"
+constexpr auto program_cache_version = std::uint32_t(1);
+
+struct program_cache_header
+{
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t format; // Binary format the driver reported, handed back to glProgramBinary
+    std::uint32_t reserved;
+    std::uint64_t key;
+    std::uint64_t size; // Bytes of binary after the header
+};
+
+// Where a program's sources are read from; relative paths are asset names, see read_file_content
+struct shader_paths
+{
+    std::filesystem::path vertex;
+    std::filesystem::path fragment;
+};
+
+struct shader_sources
+{
+    std::string vertex;
+    std::string fragment;
+};
+
+enum class shader_caching
+{
+    enabled, // Load the program binary when it matches, write it after compiling
+    disabled // Always compile from source, for measuring the cold path
+};
+
+// How the program in use was obtained
+struct program_build_stats
+{
+    double milliseconds = 0.0; // Reading sources to a usable program
+    bool   from_cache   = false;
+};
+
+struct built_program
+{
+    GLuint              program = 0;
+    program_build_stats stats;
+};
+
+// A program whose shaders are compiling and linking. With GL_KHR_parallel_shader_compile the
+// driver does the work on its own threads and ready() is polled each frame; without it the
+// driver compiles when the status is first queried, which finish() does.
+class pending_program
+{
+public:
+    // GL thread only. Submits both shaders and the link without waiting on any of them.
+    explicit pending_program(const shader_sources& sources);
+    ~pending_program();
+
+    pending_program(const pending_program&)            = delete;
+    pending_program& operator=(const pending_program&) = delete;
+
+    // True once finish() will not block
+    auto ready() const -> bool;
+
+    // The linked program, or every compile and link error. Call once.
+    auto finish() -> std::expected<GLuint, error_message_t>;
+
+private:
+    GLuint vertex_   = 0;
+    GLuint fragment_ = 0;
+    GLuint program_  = 0;
+};
+
+// Polls the modification times of a set of files on its own thread and raises a flag when any
+// of them changes. `on_change` runs on that thread, to wake a loop blocked waiting for events.
+class shader_watcher
+{
+public:
+    shader_watcher(std::vector<std::filesystem::path> files,
+                   std::function<void()>              on_change,
+                   std::chrono::milliseconds          interval = std::chrono::milliseconds(250));
+
+    shader_watcher(const shader_watcher&)            = delete;
+    shader_watcher& operator=(const shader_watcher&) = delete;
+
+    // True once for every batch of changes seen since the last call
+    auto take_changed() -> bool { return changed_.exchange(false); }
+
+private:
+    struct file_stamp
+    {
+        std::filesystem::file_time_type write_time;
+        std::uintmax_t                  size = 0;
+
+        auto operator==(const file_stamp&) const -> bool = default;
+    };
+
+    // Missing files read as an empty stamp, so deleting or recreating one is a change too
+    static auto read_stamps(const std::vector<std::filesystem::path>& files)
+        -> std::vector<file_stamp>;
+
+    void watch(std::stop_token stop_token);
+
+    std::vector<std::filesystem::path> files_;
+    std::function<void()>              on_change_;
+    std::chrono::milliseconds          interval_;
+    std::atomic<bool>                  changed_ = false;
+
+    // Taken before the thread starts, so edits made right after construction are seen;
+    // only the watching thread touches them afterwards
+    std::vector<file_stamp> stamps_;
+
+    std::jthread thread_;
+};
+
+// Dev-mode hot reload of one program: rebuilds it in the background whenever its sources
+// change. The program in use is only replaced once the new one has linked, so the game keeps
+// drawing with the old shaders while the new ones compile, and keeps them if the edit is broken.
+// Asset names are resolved to their loose files, since those are what gets edited.
+class shader_reloader
+{
+public:
+    shader_reloader(shader_paths paths, std::function<void()> on_change);
+
+    // GL thread, once per loop iteration. Returns the new program when a rebuild finishes, or
+    // why it failed.
+    auto poll() -> std::optional<std::expected<GLuint, error_message_t>>;
+
+    // A rebuild is in flight and poll() needs calling again soon
+    auto compiling() const -> bool { return pending_.has_value(); }
+
+private:
+    shader_paths                   paths_;
+    shader_watcher                 watcher_;
+    std::optional<pending_program> pending_;
+};
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+auto card_shader_paths() -> shader_paths;
+
+// Next to the asset pack, like the atlas cache
+auto program_cache_path() -> std::filesystem::path;
+
+auto read_shader_sources(const shader_paths& paths)
+    -> std::expected<shader_sources, error_message_t>;
+
+// Vendor, renderer and version of the current context; a driver update changes it
+auto gl_driver_string() -> std::string;
+
+auto program_cache_key(const shader_sources& sources, std::string_view driver) -> std::uint64_t;
+
+// Compiles one shader and checks GL_COMPILE_STATUS; errors carry `name` and the full info log
+auto compile_shader(std::string_view source, GLenum shader_type, std::string_view name)
+    -> std::expected<GLuint, error_message_t>;
+
+// Links a program that can be retrieved with glGetProgramBinary; errors carry the full info log
+auto link_shader_program(GLuint vertex_shader_id, GLuint fragment_shader_id)
+    -> std::expected<GLuint, error_message_t>;
+
+// A program created from the cache at `path`, if the file holds a binary for `key` that the
+// driver accepts
+auto load_program_binary(const std::filesystem::path& path, std::uint64_t key)
+    -> std::expected<GLuint, error_message_t>;
+
+auto save_program_binary(const std::filesystem::path& path, std::uint64_t key, GLuint program)
+    -> std::expected<void, error_message_t>;
+
+// Loads the program from the binary cache, or compiles it from source and refreshes the cache
+auto build_program(const shader_paths&          paths,
+                   const std::filesystem::path& cache_path,
+                   shader_caching               caching = shader_caching::enabled)
+    -> std::expected<built_program, error_message_t>;
+
+#endif // _GAME_SHADER_MANAGER_HPP__
@@ -0,0 +1,412 @@
+#include "solver.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+transposition_table::transposition_table(std::size_t budget_bytes)
+{
+    const auto entries = std::bit_floor(
+        std::max(budget_bytes / sizeof(std::atomic<std::uint64_t>), std::size_t(1024)));
+    slots_ = std::make_unique<std::atomic<std::uint64_t>[]>(entries); // Zeroed, so empty
+    mask_  = entries - 1;
+}
+
+auto transposition_table::insert(std::uint64_t hash) -> bool
+{
+    // The generation replaces the hash's top byte; never zero, so no key looks like a new slot
+    const auto key = (hash & hash_mask) | generation_;
+    for (auto probe = std::size_t(0); probe < probe_limit; ++probe)
+    {
+        auto& slot     = slots_[(key + probe) & mask_];
+        auto  expected = slot.load(std::memory_order_relaxed);
+        if (expected == key)
+        {
+            return false;
+        }
+        // Slots from before the last clear are free
+        if ((expected & ~hash_mask) != generation_)
+        {
+            if (slot.compare_exchange_strong(expected, key, std::memory_order_relaxed))
+            {
+                size_.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            // Another thread claimed the slot first, possibly with this same position
+            if (expected == key)
+            {
+                return false;
+            }
+        }
+    }
+    overflows_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void transposition_table::clear()
+{
+    // Moving to the next generation frees every slot at once; only when the tag wraps are the
+    // slots zeroed, so that no entry from 255 clears ago matches again
+    generation_ += generation_step;
+    if (generation_ == 0)
+    {
+        for (auto index = std::size_t(0); index <= mask_; ++index)
+        {
+            slots_[index].store(0, std::memory_order_relaxed);
+        }
+        generation_ = generation_step;
+    }
+    size_.store(0, std::memory_order_relaxed);
+    overflows_.store(0, std::memory_order_relaxed);
+}
+
+namespace {
+
+// How often a thread publishes its node count and checks for cancellation
+constexpr auto node_check_interval = std::uint64_t(1024);
+
+struct solver_task
+{
+    klondike_state             state;
+    std::vector<klondike_move> path;
+};
+
+// Per-thread search state
+struct worker_context
+{
+    std::size_t   index = 0;
+    std::uint64_t nodes = 0; // Not yet added to the shared count
+};
+
+struct worker_queue
+{
+    std::mutex              mutex;
+    std::deque<solver_task> tasks;
+    std::atomic<bool>       empty{true};
+};
+
+// A foundation move nothing could ever need undone: every card that could be placed on the
+// moving card is already home. Taking it as the only move prunes a lot of symmetric search.
+auto is_safe_foundation_move(const klondike_state& state, const klondike_move& move) -> bool
+{
+    if (!is_foundation(move.to) || is_foundation(move.from))
+    {
+        return false;
+    }
+    const auto suit = move.to - pile_foundation;
+    const auto rank = foundation_count(state, suit);
+    if (rank <= 1)
+    {
+        return true;
+    }
+    const auto red       = suit == 1 || suit == 2;
+    const auto opposite0 = foundation_count(state, red ? 0 : 1);
+    const auto opposite1 = foundation_count(state, red ? 3 : 2);
+    const auto same      = foundation_count(state, 3 - suit);
+    return opposite0 >= rank && opposite1 >= rank && same >= rank - 1;
+}
+
+// Search order: moves that turn over a face-down card, then foundation moves, waste plays,
+// the stock, tableau rearrangements and finally cards taken back off the foundations
+auto move_priority(const klondike_state& state, const klondike_move& move) -> std::int32_t
+{
+    if (is_tableau(move.from))
+    {
+        const auto face_up = state.tableau_size[move.from] - state.face_down[move.from];
+        if (move.count == face_up && state.face_down[move.from] > 0)
+        {
+            return 5;
+        }
+        return is_foundation(move.to) ? 4 : 1;
+    }
+    if (move.from == pile_waste)
+    {
+        return move.to == pile_stock ? 2 : 3;
+    }
+    return move.from == pile_stock ? 2 : 0;
+}
+
+class parallel_search
+{
+public:
+    parallel_search(const solver_options& options,
+                    std::size_t           thread_count,
+                    std::stop_token       stop_token)
+        : options_(options)
+        , stop_token_(std::move(stop_token))
+        , owned_table_(options.table != nullptr
+                           ? nullptr
+                           : std::make_unique<transposition_table>(options.memory_budget))
+        , table_(options.table != nullptr ? *options.table : *owned_table_)
+        , queues_(thread_count)
+        , idle_(std::int32_t(thread_count))
+    {
+    }
+
+    auto run(const klondike_state& start) -> solve_result
+    {
+        // Cancelled before it began: nodes are only counted against the token in batches, so a
+        // short search would otherwise run to the end regardless
+        if (stop_token_.stop_requested())
+        {
+            return solve_result{};
+        }
+        if (!owned_table_)
+        {
+            table_.clear();
+        }
+        table_.insert(start.hash);
+        push_task(0, solver_task{start, {}});
+        {
+            auto workers = std::vector<std::jthread>();
+            for (auto index = std::size_t(0); index < queues_.size(); ++index)
+            {
+                workers.emplace_back([this, index] { work(index); });
+            }
+        }
+
+        auto result  = solve_result{};
+        result.nodes = nodes_.load();
+        if (solved_)
+        {
+            result.status = solve_status::solved;
+            result.moves  = std::move(solution_);
+        }
+        else if (incomplete_ || stop_token_.stop_requested())
+        {
+            result.status = solve_status::unknown;
+        }
+        else
+        {
+            result.status = solve_status::unsolvable;
+        }
+        return result;
+    }
+
+private:
+    void work(std::size_t index)
+    {
+        auto worker = worker_context{index};
+        auto task   = solver_task{};
+        while (!finished_.load(std::memory_order_relaxed))
+        {
+            if (!next_task(index, task))
+            {
+                // Nothing queued anywhere and nobody running means the tree is exhausted
+                if (pending_.load() == 0)
+                {
+                    break;
+                }
+                if (stop_token_.stop_requested())
+                {
+                    finished_   = true;
+                    incomplete_ = true;
+                    break;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+
+            idle_.fetch_sub(1);
+            search(worker, task.state, task.path);
+            idle_.fetch_add(1);
+            pending_.fetch_sub(1);
+        }
+        nodes_.fetch_add(worker.nodes);
+    }
+
+    // Own queue from the back (depth first), other queues from the front (largest subtrees)
+    auto next_task(std::size_t index, solver_task& task) -> bool
+    {
+        if (pop_task(queues_[index], task, true))
+        {
+            return true;
+        }
+        for (auto offset = std::size_t(1); offset < queues_.size(); ++offset)
+        {
+            if (pop_task(queues_[(index + offset) % queues_.size()], task, false))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static auto pop_task(worker_queue& queue, solver_task& task, bool back) -> bool
+    {
+        if (queue.empty.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+        auto lock = std::scoped_lock(queue.mutex);
+        if (queue.tasks.empty())
+        {
+            return false;
+        }
+        if (back)
+        {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        else
+        {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        queue.empty.store(queue.tasks.empty(), std::memory_order_relaxed);
+        return true;
+    }
+
+    void push_task(std::size_t index, solver_task task)
+    {
+        pending_.fetch_add(1);
+        auto& queue = queues_[index];
+        auto  lock  = std::scoped_lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+        queue.empty.store(false, std::memory_order_relaxed);
+    }
+
+    // Counts a node; false once the search should stop
+    auto count_node(worker_context& worker) -> bool
+    {
+        if (++worker.nodes < node_check_interval)
+        {
+            return !finished_.load(std::memory_order_relaxed);
+        }
+        const auto total = nodes_.fetch_add(worker.nodes) + worker.nodes;
+        worker.nodes     = 0;
+        if (stop_token_.stop_requested() ||
+            (options_.node_limit != 0 && total >= options_.node_limit))
+        {
+            incomplete_ = true;
+            finished_   = true;
+        }
+        return !finished_.load(std::memory_order_relaxed);
+    }
+
+    auto search(worker_context& worker, klondike_state& state, std::vector<klondike_move>& path)
+        -> bool
+    {
+        if (!count_node(worker))
+        {
+            return false;
+        }
+        if (is_won(state))
+        {
+            auto lock = std::scoped_lock(solution_mutex_);
+            if (!solved_)
+            {
+                solved_   = true;
+                solution_ = path;
+            }
+            finished_ = true;
+            return true;
+        }
+        if (std::int32_t(path.size()) >= options_.max_depth)
+        {
+            incomplete_ = true;
+            return false;
+        }
+
+        auto moves = move_list{};
+        generate_moves(state, moves);
+        order_moves(state, moves);
+
+        for (auto i = std::size_t(0); i < moves.size; ++i)
+        {
+            // Hand the remaining siblings to idle threads, once this thread's queue has drained
+            if (i + 1 < moves.size && idle_.load(std::memory_order_relaxed) > 0 &&
+                queues_[worker.index].empty.load(std::memory_order_relaxed))
+            {
+                for (auto j = i + 1; j < moves.size; ++j)
+                {
+                    auto child = solver_task{state, path};
+                    auto move  = moves[j];
+                    apply_move(child.state, move);
+                    if (table_.insert(child.state.hash))
+                    {
+                        child.path.push_back(move);
+                        push_task(worker.index, std::move(child));
+                    }
+                }
+                moves.size = i + 1;
+            }
+
+            auto move = moves[i];
+            apply_move(state, move);
+            if (table_.insert(state.hash))
+            {
+                path.push_back(move);
+                if (search(worker, state, path))
+                {
+                    return true;
+                }
+                path.pop_back();
+            }
+            undo_move(state, move);
+        }
+        return false;
+    }
+
+    const solver_options                 options_;
+    const std::stop_token                stop_token_;
+    std::unique_ptr<transposition_table> owned_table_;
+    transposition_table&                 table_;
+    std::deque<worker_queue>             queues_;
+    std::atomic<std::size_t>             pending_{0}; // Tasks queued or being searched
+    std::atomic<std::int32_t>            idle_;       // Threads looking for work
+    std::atomic<bool>                    finished_{false};
+    std::atomic<bool>                    incomplete_{false};
+    std::atomic<std::uint64_t>           nodes_{0};
+
+    std::mutex                 solution_mutex_;
+    bool                       solved_ = false;
+    std::vector<klondike_move> solution_;
+};
+
+} // namespace
+
+void order_moves(const klondike_state& state, move_list& moves)
+{
+    auto priorities = std::array<std::int32_t, max_moves>();
+    for (auto i = std::size_t(0); i < moves.size; ++i)
+    {
+        if (is_safe_foundation_move(state, moves[i]))
+        {
+            moves.moves[0] = moves[i];
+            moves.size     = 1;
+            return;
+        }
+        priorities[i] = move_priority(state, moves[i]);
+    }
+
+    // Insertion sort; lists are short and equal priorities keep generator order
+    for (auto i = std::size_t(1); i < moves.size; ++i)
+    {
+        const auto move     = moves[i];
+        const auto priority = priorities[i];
+        auto       j        = i;
+        for (; j > 0 && priorities[j - 1] < priority; --j)
+        {
+            moves.moves[j] = moves.moves[j - 1];
+            priorities[j]  = priorities[j - 1];
+        }
+        moves.moves[j] = move;
+        priorities[j]  = priority;
+    }
+}
+
+auto solve_klondike(const klondike_state& start,
+                    const solver_options& options,
+                    std::stop_token       stop_token) -> solve_result
+{
+    const auto thread_count =
+        options.thread_count != 0
+            ? options.thread_count
+            : std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+
+    auto search = parallel_search(options, thread_count, std::move(stop_token));
+    return search.run(start);
+}
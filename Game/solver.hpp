@@ -0,0 +1,90 @@
+#ifndef _GAME_SOLVER_HPP__
+#define _GAME_SOLVER_HPP__
+
+#include "klondike.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stop_token>
+#include <vector>
+
+// Set of visited positions shared by every solver thread. Open addressing over an array of
+// atomic 64-bit hashes; inserting is a compare-exchange on the first free slot, so threads
+// never take a lock. Once the probe window is full the table simply stops remembering, which
+// costs search time but never correctness. Entries carry the generation they were inserted in,
+// in the hash's top byte, so clearing is a generation bump rather than a pass over the slots.
+class transposition_table
+{
+public:
+    // Sized to the largest power-of-two entry count that fits in `budget_bytes`
+    explicit transposition_table(std::size_t budget_bytes);
+
+    // True when `hash` was not in the table and has now been added
+    auto insert(std::uint64_t hash) -> bool;
+
+    // Forgets every position; not to be called while other threads insert
+    void clear();
+
+    auto capacity() const -> std::size_t { return mask_ + 1; }
+    auto size() const -> std::size_t { return size_.load(std::memory_order_relaxed); }
+
+    // Inserts that found no free slot and were not remembered
+    auto overflows() const -> std::size_t { return overflows_.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr auto probe_limit     = std::size_t(16);
+    static constexpr auto hash_mask       = std::uint64_t(0x00FF'FFFF'FFFF'FFFF);
+    static constexpr auto generation_step = hash_mask + 1;
+
+    std::unique_ptr<std::atomic<std::uint64_t>[]> slots_;
+    std::size_t                                   mask_       = 0;
+    std::uint64_t                                 generation_ = generation_step;
+    std::atomic<std::size_t>                      size_{0};
+    std::atomic<std::size_t>                      overflows_{0};
+};
+
+enum class solve_status
+{
+    solved,
+    unsolvable,
+    unknown // Cancelled, or a node or depth limit cut the search short
+};
+
+struct solver_options
+{
+    std::size_t   thread_count  = 0;        // 0 uses every hardware thread
+    std::size_t   memory_budget = 64 << 20; // Bytes for the transposition table
+    std::uint64_t node_limit    = 0;        // 0 for no limit
+    std::int32_t  max_depth     = 400;      // Moves; deeper lines count as incomplete
+
+    // Cleared and reused instead of allocating a table from memory_budget, which is what
+    // callers solving many deals back to back want; clearing costs nothing per solve
+    transposition_table* table = nullptr;
+};
+
+struct solve_result
+{
+    solve_status               status = solve_status::unknown;
+    std::vector<klondike_move> moves;     // Winning line from the start position when solved
+    std::uint64_t              nodes = 0; // Positions expanded across all threads
+};
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+// Search order shared by every search over Klondike moves: moves that turn over a face-down
+// card, then foundation moves, waste plays, the stock, tableau rearrangements and finally cards
+// taken back off the foundations. A foundation move nothing could ever need undone becomes the
+// only move.
+void order_moves(const klondike_state& state, move_list& moves);
+
+// Depth-first search from `start` on a work-stealing pool. Threads that run dry steal
+// unexplored siblings from the bottom of another thread's queue, and a thread splits its
+// remaining siblings off as soon as any other thread is idle. Returns as soon as one thread
+// finds a win or `stop_token` is triggered.
+auto solve_klondike(const klondike_state& start,
+                    const solver_options& options,
+                    std::stop_token       stop_token = {}) -> solve_result;
+
+#endif // _GAME_SOLVER_HPP__
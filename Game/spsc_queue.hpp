@@ -0,0 +1,80 @@
+#ifndef _GAME_SPSC_QUEUE_HPP__
+#define _GAME_SPSC_QUEUE_HPP__
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+// Keeps the two ends of a queue on separate cache lines, so the producer and the consumer do not
+// invalidate each other's line on every operation
+constexpr auto cache_line_bytes = std::size_t(64);
+
+// Bounded lock-free queue between exactly one producer thread and one consumer thread. Indices
+// only ever grow and are masked into the ring, so full and empty need no spare slot. Each side
+// keeps a copy of the other side's index and only reloads it when the ring looks full (producer)
+// or empty (consumer), so an uncontended push or pop touches no shared cache line but its own.
+template <typename T, std::size_t Capacity>
+class spsc_queue
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "spsc_queue capacity must be a power of two");
+
+public:
+    static constexpr auto capacity = Capacity;
+
+    // Producer only. False, leaving the queue as it was, when it is full.
+    auto push(const T& value) -> bool
+    {
+        const auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ == Capacity)
+        {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ == Capacity)
+            {
+                return false;
+            }
+        }
+        slots_[tail & mask] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. The oldest value, or nullopt when the queue is empty.
+    auto pop() -> std::optional<T>
+    {
+        const auto head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_)
+        {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_)
+            {
+                return std::nullopt;
+            }
+        }
+        auto value = std::optional<T>(slots_[head & mask]);
+        head_.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+    // Either side; only a snapshot while the other side is running
+    auto empty() const -> bool
+    {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr auto mask = Capacity - 1;
+
+    // Written by the consumer
+    alignas(cache_line_bytes) std::atomic<std::size_t> head_ = 0;
+    std::size_t tail_cache_                                  = 0;
+
+    // Written by the producer
+    alignas(cache_line_bytes) std::atomic<std::size_t> tail_ = 0;
+    std::size_t head_cache_                                  = 0;
+
+    alignas(cache_line_bytes) std::array<T, Capacity> slots_{};
+};
+
+#endif // _GAME_SPSC_QUEUE_HPP__
@@ -0,0 +1,203 @@
+#include "stream_buffer.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <utility>
+
+namespace {
+
+constexpr auto storage_flags = GLbitfield(GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT |
+                                          GL_MAP_COHERENT_BIT);
+
+// How long one glClientWaitSync may block before the wait loop goes round again
+constexpr auto fence_poll_nanoseconds = GLuint64(1'000'000);
+
+auto align_up(std::size_t offset, std::size_t alignment) -> std::size_t
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+auto stream_buffer::create(std::size_t region_bytes, std::size_t region_count)
+    -> std::expected<stream_buffer, error_message_t>
+{
+    auto stream          = stream_buffer();
+    stream.region_count_ = std::clamp<std::size_t>(region_count, 1, max_regions);
+    if (!stream.allocate_storage(std::max<std::size_t>(region_bytes, 256)))
+    {
+        return std::unexpected(error_message_t("Failed to map the stream buffer persistently"));
+    }
+    return stream;
+}
+
+stream_buffer::stream_buffer(stream_buffer&& other) noexcept
+    : buffer_(std::exchange(other.buffer_, 0))
+    , mapping_(std::exchange(other.mapping_, nullptr))
+    , region_bytes_(other.region_bytes_)
+    , region_count_(other.region_count_)
+    , region_(other.region_)
+    , cursor_(other.cursor_)
+    , fences_(std::exchange(other.fences_, {}))
+    , retired_(std::move(other.retired_))
+    , stats_(other.stats_)
+{
+    other.retired_.clear();
+}
+
+stream_buffer& stream_buffer::operator=(stream_buffer&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        buffer_       = std::exchange(other.buffer_, 0);
+        mapping_      = std::exchange(other.mapping_, nullptr);
+        region_bytes_ = other.region_bytes_;
+        region_count_ = other.region_count_;
+        region_       = other.region_;
+        cursor_       = other.cursor_;
+        fences_       = std::exchange(other.fences_, {});
+        retired_      = std::move(other.retired_);
+        stats_        = other.stats_;
+        other.retired_.clear();
+    }
+    return *this;
+}
+
+stream_buffer::~stream_buffer()
+{
+    release();
+}
+
+void stream_buffer::release()
+{
+    // Deleting a buffer also unmaps it; the context is assumed to still be current
+    for (auto& fence : fences_)
+    {
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    for (const auto& retired : retired_)
+    {
+        glDeleteSync(retired.fence);
+        glDeleteBuffers(1, &retired.buffer);
+    }
+    retired_.clear();
+    if (buffer_ != 0)
+    {
+        glDeleteBuffers(1, &buffer_);
+        buffer_  = 0;
+        mapping_ = nullptr;
+    }
+}
+
+auto stream_buffer::allocate_storage(std::size_t region_bytes) -> bool
+{
+    const auto size = GLsizeiptr(region_bytes * region_count_);
+    glGenBuffers(1, &buffer_);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+    glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, storage_flags);
+    mapping_ = static_cast<std::byte*>(
+        glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, storage_flags));
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    region_bytes_       = region_bytes;
+    region_             = 0;
+    cursor_             = 0;
+    stats_.region_bytes = region_bytes;
+    return mapping_ != nullptr;
+}
+
+void stream_buffer::begin_frame()
+{
+    region_ = (region_ + 1) % region_count_;
+    cursor_ = 0;
+    ++stats_.frames;
+    wait_for_region();
+
+    // Storage replaced by a larger one goes once the GPU has read the last of it
+    std::erase_if(retired_, [](const retired_buffer& retired) {
+        if (glClientWaitSync(retired.fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        {
+            return false;
+        }
+        glDeleteSync(retired.fence);
+        glDeleteBuffers(1, &retired.buffer);
+        return true;
+    });
+}
+
+void stream_buffer::end_frame()
+{
+    auto& fence = fences_[region_];
+    glDeleteSync(fence);
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+void stream_buffer::wait_for_region()
+{
+    auto& fence = fences_[region_];
+    if (fence == nullptr)
+    {
+        return;
+    }
+
+    // Only a fence that has not signalled yet counts as a stall
+    if (glClientWaitSync(fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+    {
+        PROFILE_SCOPE("stream_buffer_wait");
+        const auto start = std::chrono::steady_clock::now();
+        while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, fence_poll_nanoseconds) ==
+               GL_TIMEOUT_EXPIRED)
+        {
+        }
+        const auto waited = std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() - start)
+                                .count();
+        ++stats_.stalls;
+        stats_.wait_ms += waited;
+        stats_.max_wait_ms = std::max(stats_.max_wait_ms, waited);
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
+
+auto stream_buffer::allocate_bytes(std::size_t bytes, std::size_t alignment) -> std::size_t
+{
+    auto start  = region_ * region_bytes_;
+    auto offset = align_up(start + cursor_, alignment);
+    if (offset + bytes > start + region_bytes_)
+    {
+        if (bytes + alignment <= region_bytes_)
+        {
+            // Fence what has been drawn so far and carry on in the next region
+            ++stats_.wraps;
+            end_frame();
+            begin_frame();
+        }
+        else
+        {
+            // Earlier allocations this frame keep pointing into the old storage, so it stays
+            // mapped until the GPU is done with it
+            ++stats_.grows;
+            retired_.push_back({buffer_, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)});
+            for (auto& fence : fences_)
+            {
+                glDeleteSync(fence);
+                fence = nullptr;
+            }
+            if (!allocate_storage(std::max(region_bytes_ * 2, std::bit_ceil(bytes + alignment))))
+            {
+                return 0; // allocate hands out nothing while the mapping is missing
+            }
+        }
+        start  = region_ * region_bytes_;
+        offset = align_up(start + cursor_, alignment);
+    }
+
+    cursor_           = offset + bytes - start;
+    stats_.peak_bytes = std::max(stats_.peak_bytes, cursor_);
+    return offset;
+}
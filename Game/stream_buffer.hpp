@@ -0,0 +1,120 @@
+#ifndef _GAME_STREAM_BUFFER_HPP__
+#define _GAME_STREAM_BUFFER_HPP__
+
+#include "types.hpp"
+
+// clang-format off
+#include <glad/gl.h>
+// clang-format on
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// Where one allocation landed. `first` is the offset in elements, which is what a draw takes as
+// its base instance or first vertex, so the vertex layout never has to be re-pointed.
+template <typename T>
+struct stream_allocation
+{
+    std::span<T> data;
+    GLuint       buffer = 0;
+    GLintptr     offset = 0; // Bytes from the start of `buffer`
+
+    auto first() const -> GLuint { return GLuint(offset / GLintptr(sizeof(T))); }
+};
+
+struct stream_buffer_stats
+{
+    std::uint64_t frames       = 0;   // Regions handed out
+    std::uint64_t stalls       = 0;   // Times the CPU caught up with the GPU and had to wait
+    double        wait_ms      = 0.0; // Total time spent waiting on fences
+    double        max_wait_ms  = 0.0;
+    std::uint64_t wraps        = 0; // Regions that filled up before the frame ended
+    std::uint64_t grows        = 0; // Times the storage was reallocated for a larger batch
+    std::size_t   peak_bytes   = 0; // Most bytes written into one region
+    std::size_t   region_bytes = 0;
+};
+
+// Per-frame dynamic vertex data, written straight into GPU-visible memory. The buffer is
+// allocated once with glBufferStorage and stays mapped (persistent and coherent), split into
+// `region_count` regions used round robin, one per frame. A fence placed when a frame ends
+// guards its region; reusing the region first waits for that fence, which only blocks when
+// the CPU is more than `region_count - 1` frames ahead of the GPU. That wait is measured.
+//
+// Anything that draws per-frame data (card instances, debug overlays, text) allocates its span
+// here, fills it in place and draws from `buffer` at `first`, with no glBufferData and so no
+// implicit synchronisation or driver reallocation.
+class stream_buffer
+{
+public:
+    static constexpr auto default_region_bytes = std::size_t(64 * 1024);
+    static constexpr auto max_regions          = std::size_t(4);
+
+    // GL thread only
+    static auto create(std::size_t region_bytes = default_region_bytes,
+                       std::size_t region_count = 3)
+        -> std::expected<stream_buffer, error_message_t>;
+
+    stream_buffer(stream_buffer&& other) noexcept;
+    stream_buffer& operator=(stream_buffer&& other) noexcept;
+    ~stream_buffer();
+
+    stream_buffer(const stream_buffer&)            = delete;
+    stream_buffer& operator=(const stream_buffer&) = delete;
+
+    // Moves on to the next region, waiting for the GPU to be done with it
+    void begin_frame();
+
+    // Fences the commands issued so far, which are the last to read the current region
+    void end_frame();
+
+    // `count` elements for this frame. Allocations stay valid until the frame ends; calling
+    // begin_frame/end_frame is optional, a full region simply moves on to the next one. Empty
+    // only if larger storage was needed and could not be allocated.
+    template <typename T>
+    auto allocate(std::size_t count) -> stream_allocation<T>
+    {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto offset = allocate_bytes(count * sizeof(T), sizeof(T));
+        if (mapping_ == nullptr)
+        {
+            return {};
+        }
+        return {{reinterpret_cast<T*>(mapping_ + offset), count}, buffer_, GLintptr(offset)};
+    }
+
+    auto buffer() const -> GLuint { return buffer_; }
+    auto stats() const -> const stream_buffer_stats& { return stats_; }
+
+private:
+    // Storage reallocated mid-frame, deleted once the GPU has finished with it
+    struct retired_buffer
+    {
+        GLuint buffer;
+        GLsync fence;
+    };
+
+    stream_buffer() = default;
+
+    // Byte offset of `bytes` free bytes at a multiple of `alignment` from the buffer start
+    auto allocate_bytes(std::size_t bytes, std::size_t alignment) -> std::size_t;
+    auto allocate_storage(std::size_t region_bytes) -> bool;
+    void wait_for_region();
+    void release();
+
+    GLuint                          buffer_       = 0;
+    std::byte*                      mapping_      = nullptr;
+    std::size_t                     region_bytes_ = 0;
+    std::size_t                     region_count_ = 0;
+    std::size_t                     region_       = 0;
+    std::size_t                     cursor_       = 0; // Bytes used in the current region
+    std::array<GLsync, max_regions> fences_       = {};
+    std::vector<retired_buffer>     retired_;
+    stream_buffer_stats             stats_;
+};
+
+#endif // _GAME_STREAM_BUFFER_HPP__
@@ -0,0 +1,216 @@
+#include "table_grid.hpp"
+#include "asset_pack.hpp"
+#include "profiler.hpp"
+
+// clang-format off
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+// clang-format on
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// Binding point of the TableTiles block in table_grid.vert
+constexpr auto tile_binding = GLuint(0);
+
+// The quad in create_vao_vbo: 2 triangles, 6 verts
+constexpr auto quad_vertex_count = GLuint(6);
+
+} // namespace
+
+auto table_grid_shader_paths() -> shader_paths
+{
+    return {"Shaders/table_grid.vert", "Shaders/card.frag"};
+}
+
+auto table_grid_program_cache_path() -> std::filesystem::path
+{
+    return assets().root() / "Assets/table_grid.program";
+}
+
+auto layout_table_grid(std::int32_t         count,
+                       std::int32_t         width,
+                       std::int32_t         height,
+                       const table_metrics& metrics) -> std::vector<table_tile>
+{
+    if (count <= 0)
+    {
+        return {};
+    }
+    const auto columns = std::int32_t(std::ceil(std::sqrt(double(count))));
+    const auto rows    = (count + columns - 1) / columns;
+    const auto cell_w  = float(width) / float(columns);
+    const auto cell_h  = float(height) / float(rows);
+    const auto scale   = std::min(cell_w / metrics.width, cell_h / metrics.height);
+
+    // Centred in the cell; rows run down from the top while y runs up
+    const auto inset_x = (cell_w - metrics.width * scale) * 0.5f;
+    const auto inset_y = (cell_h - metrics.height * scale) * 0.5f;
+
+    auto tiles = std::vector<table_tile>();
+    tiles.reserve(std::size_t(count));
+    for (auto i = 0; i < count; ++i)
+    {
+        const auto column = i % columns;
+        const auto row    = i / columns;
+        tiles.push_back({float(column) * cell_w + inset_x,
+                         float(height) - float(row + 1) * cell_h + inset_y,
+                         scale});
+    }
+    return tiles;
+}
+
+auto create_table_grid_renderer(shader_caching caching)
+    -> std::expected<std::shared_ptr<table_grid_renderer>, error_message_t>
+{
+    PROFILE_SCOPE("create_table_grid_renderer");
+
+    if (!GLAD_GL_VERSION_4_6 && !GLAD_GL_ARB_shader_draw_parameters)
+    {
+        return std::unexpected(
+            error_message_t("Drawing a table grid needs GL_ARB_shader_draw_parameters"));
+    }
+
+    auto program_result =
+        build_program(table_grid_shader_paths(), table_grid_program_cache_path(), caching);
+    if (!program_result)
+    {
+        return std::unexpected(program_result.error());
+    }
+
+    auto grid            = std::make_shared<table_grid_renderer>();
+    grid->shader_program = program_result->program;
+    grid->shader_stats   = program_result->stats;
+    grid->uProjection    = glGetUniformLocation(grid->shader_program, "uProjection");
+    grid->uSize          = glGetUniformLocation(grid->shader_program, "uSize");
+    grid->uCardTextures  = glGetUniformLocation(grid->shader_program, "uCardTextures");
+
+    glUseProgram(grid->shader_program);
+    glUniform1i(grid->uCardTextures, 0);
+    glUniform2f(grid->uSize, card_width_px, card_height_px);
+
+    glGenBuffers(1, &grid->tile_buffer);
+    return grid;
+}
+
+void set_table_grid_tiles(table_grid_renderer& grid, std::span<const table_tile> tiles)
+{
+    // Tiles only change with the table count or the framebuffer size, so plain uploads will do
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, grid.tile_buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER,
+                 GLsizeiptr(std::max<std::size_t>(tiles.size_bytes(), sizeof(table_tile))),
+                 tiles.data(),
+                 GL_STATIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    grid.tile_count = tiles.size();
+}
+
+void set_table_grid_projection(const table_grid_renderer& grid,
+                               std::int32_t               width,
+                               std::int32_t               height)
+{
+    const auto projection = glm::ortho(0.0f, // left
+                                       static_cast<float>(width),
+                                       0.0f, // bottom
+                                       static_cast<float>(height),
+                                       -1.0f,
+                                       1.0f);
+    glUseProgram(grid.shader_program);
+    glUniformMatrix4fv(grid.uProjection, // location
+                       1,                // count
+                       GL_FALSE,         // transpose
+                       glm::value_ptr(projection));
+}
+
+void draw_table_grid(const std::shared_ptr<card_renderer>& cr,
+                     table_grid_renderer&                  grid,
+                     std::span<const std::vector<card>>    tables)
+{
+    PROFILE_SCOPE("draw_table_grid");
+    PROFILE_GPU_SCOPE("draw_table_grid");
+
+    const auto table_count = std::min(tables.size(), grid.tile_count);
+    auto       card_count  = std::size_t(0);
+    for (const auto& cards : tables.first(table_count))
+    {
+        card_count += cards.size();
+    }
+    if (card_count == 0)
+    {
+        return;
+    }
+
+    // Each table is culled on its own, in ordinary memory, and the next one packed right after
+    // what it kept; base instances are relative until the stream says where they landed
+    auto& scratch = cr->cull_scratch;
+    scratch.resize(card_count);
+    grid.commands.resize(table_count);
+    auto first = std::size_t(0);
+    for (auto i = std::size_t(0); i < table_count; ++i)
+    {
+        const auto& cards = tables[i];
+        const auto  batch = std::span(scratch).subspan(first, cards.size());
+        build_card_instances(cards, cr->resident_layers, batch);
+        const auto kept = cr->cull_hidden_cards ? cull_card_instances(batch, cr->cull_stats)
+                                                : batch.size();
+        grid.commands[i] = {quad_vertex_count, GLuint(kept), 0, GLuint(first)};
+        first += kept;
+    }
+
+    // Commands and instances share one allocation, commands in the leading slots, so a wrap to
+    // the next region or a grow of the storage can never separate them: the region fenced at
+    // the end of this frame holds both
+    constexpr auto command_bytes = sizeof(draw_arrays_indirect_command);
+    const auto     command_slots =
+        (table_count * command_bytes + sizeof(card_instance) - 1) / sizeof(card_instance);
+    const auto instances = cr->stream->allocate<card_instance>(command_slots + first);
+    if (instances.data.size() != command_slots + first)
+    {
+        return;
+    }
+    std::copy_n(scratch.begin(), first, instances.data.begin() + command_slots);
+    for (auto& command : grid.commands)
+    {
+        command.base_instance += instances.first() + GLuint(command_slots);
+    }
+    std::memcpy(std::as_writable_bytes(instances.data).data(),
+                grid.commands.data(),
+                table_count * command_bytes);
+
+    // The stream only changes buffers when it outgrows its storage
+    if (instances.buffer != cr->instance_buffer)
+    {
+        attach_instance_buffer(cr->vao, instances.buffer);
+        cr->instance_buffer = instances.buffer;
+    }
+
+    glUseProgram(grid.shader_program);
+    glBindVertexArray(cr->vao);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, cr->texture_array);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, tile_binding, grid.tile_buffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, instances.buffer);
+
+    // Every table in one call; gl_DrawIDARB tells the shader which tile a card belongs to
+    glMultiDrawArraysIndirect(GL_TRIANGLES,
+                              reinterpret_cast<const void*>(instances.offset),
+                              GLsizei(table_count),
+                              0); // tightly packed
+    ++cr->draw_calls;
+
+    // Everything else draws with the card program and expects it bound
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glBindVertexArray(0);
+    glUseProgram(cr->shader_program);
+}
+
+void destroy_table_grid_renderer(table_grid_renderer& grid)
+{
+    glDeleteBuffers(1, &grid.tile_buffer);
+    glDeleteProgram(grid.shader_program);
+    grid = table_grid_renderer{};
+}
@@ -0,0 +1,96 @@
+#ifndef _GAME_TABLE_GRID_HPP__
+#define _GAME_TABLE_GRID_HPP__
+
+#include "cards.hpp"
+#include "shader_manager.hpp"
+#include "table_layout.hpp"
+#include "types.hpp"
+
+// clang-format off
+#include <glad/gl.h>
+// clang-format on
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <vector>
+
+// Where one table of a grid goes: its layout, made for the full table_metrics, is scaled by
+// `scale` and moved so its bottom-left corner lands on `x, y` in framebuffer pixels. Matches an
+// element of the std430 TableTiles block in table_grid.vert.
+struct table_tile
+{
+    float x, y;
+    float scale;
+    float unused = 0.0f;
+};
+
+// Matches what glMultiDrawArraysIndirect reads from GL_DRAW_INDIRECT_BUFFER
+struct draw_arrays_indirect_command
+{
+    GLuint count;
+    GLuint instance_count;
+    GLuint first;
+    GLuint base_instance;
+};
+
+// Draws many independent tables in one submission. Every table's cards are packed back to back
+// into the card renderer's stream, next to one indirect command per table; a single
+// glMultiDrawArraysIndirect then draws them all, and table_grid.vert places each table in its
+// tile by the index of the draw. However many tables there are, a frame makes the same handful
+// of GL calls, so only the packing grows with the table count.
+struct table_grid_renderer
+{
+    GLuint shader_program = 0;
+    GLuint tile_buffer    = 0; // Shader storage holding one table_tile per table
+
+    GLint uProjection   = -1;
+    GLint uSize         = -1;
+    GLint uCardTextures = -1;
+
+    std::size_t         tile_count = 0;
+    program_build_stats shader_stats;
+
+    // The frame's commands, built next to the culled instances in card_renderer::cull_scratch
+    // and copied into the stream with them
+    std::vector<draw_arrays_indirect_command> commands;
+};
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+auto table_grid_shader_paths() -> shader_paths;
+
+// Next to the card program's cache
+auto table_grid_program_cache_path() -> std::filesystem::path;
+
+// Tiles for `count` tables in a near-square grid over a width x height framebuffer, first table
+// top left, in rows. Each table keeps the aspect of `metrics` and is centred in its cell.
+auto layout_table_grid(std::int32_t         count,
+                       std::int32_t         width,
+                       std::int32_t         height,
+                       const table_metrics& metrics) -> std::vector<table_tile>;
+
+// Needs GL_ARB_shader_draw_parameters (core in 4.6) for the draw index in the vertex shader
+auto create_table_grid_renderer(shader_caching caching = shader_caching::enabled)
+    -> std::expected<std::shared_ptr<table_grid_renderer>, error_message_t>;
+
+// Uploads the tiles that draw_table_grid places tables into
+void set_table_grid_tiles(table_grid_renderer& grid, std::span<const table_tile> tiles);
+
+// Sets the orthographic projection for a framebuffer of the given size, bottom-left origin
+void set_table_grid_projection(const table_grid_renderer& grid,
+                               std::int32_t               width,
+                               std::int32_t               height);
+
+// Draws tables[i] into tile i with one glMultiDrawArraysIndirect, using the quad VAO, texture
+// array and stream of `cr`, culling each table as draw_cards does. Tables beyond the uploaded
+// tiles are not drawn.
+void draw_table_grid(const std::shared_ptr<card_renderer>& cr,
+                     table_grid_renderer&                  grid,
+                     std::span<const std::vector<card>>    tables);
+
+void destroy_table_grid_renderer(table_grid_renderer& grid);
+
+#endif // _GAME_TABLE_GRID_HPP__
@@ -0,0 +1,112 @@
+#include "table_layout.hpp"
+
+#include <algorithm>
+
+namespace {
+
+constexpr auto column_count = tableau_count;
+
+auto face_layer(card_code code) -> std::int32_t
+{
+    return card_face_layer(card_suit(code), card_rank(code));
+}
+
+} // namespace
+
+auto pile_origin(const table_metrics& metrics, std::int32_t column, bool top_row) -> table_point
+{
+    // Seven columns spread across the width between the margins
+    const auto usable = metrics.width - 2.0f * metrics.margin - card_width_px;
+    const auto step   = usable / float(column_count - 1);
+    const auto x      = metrics.margin + card_width_px * 0.5f + step * float(column);
+
+    const auto top_y = metrics.height - metrics.margin - card_height_px * 0.5f;
+    const auto y     = top_row ? top_y : top_y - card_height_px - metrics.margin * 0.5f;
+    return {x, y};
+}
+
+auto card_bounds(const card& c) -> hit_rect
+{
+    return {c.x - card_width_px * 0.5f,
+            c.y - card_height_px * 0.5f,
+            c.x + card_width_px * 0.5f,
+            c.y + card_height_px * 0.5f};
+}
+
+auto pile_bounds(const klondike_state& state, const table_metrics& metrics, std::uint8_t pile)
+    -> hit_rect
+{
+    if (is_tableau(pile))
+    {
+        // Same steps as layout_table, down to the last card
+        const auto origin = pile_origin(metrics, pile, false);
+        auto       y      = origin.y;
+        for (auto depth = 0; depth + 1 < state.tableau_size[pile]; ++depth)
+        {
+            y -= depth >= state.face_down[pile] ? metrics.face_up_step : metrics.face_down_step;
+        }
+        auto bounds = card_bounds({origin.x, y, 0, true});
+        bounds.top  = origin.y + card_height_px * 0.5f;
+        return bounds;
+    }
+
+    if (pile == pile_waste)
+    {
+        const auto origin = pile_origin(metrics, 1, true);
+        const auto fanned = std::min<std::int32_t>(state.draw_count, state.waste_size);
+        auto       bounds = card_bounds({origin.x, origin.y, 0, true});
+        bounds.right += float(std::max(fanned - 1, 0)) * metrics.waste_step;
+        return bounds;
+    }
+
+    const auto column = pile == pile_stock ? 0 : 3 + (pile - pile_foundation);
+    const auto origin = pile_origin(metrics, column, true);
+    return card_bounds({origin.x, origin.y, 0, true});
+}
+
+void layout_table(const klondike_state& state,
+                  const table_metrics&  metrics,
+                  std::vector<card>&    cards)
+{
+    cards.clear();
+
+    // Stock: face down, stacked
+    const auto stock = pile_origin(metrics, 0, true);
+    for (auto i = 0; i < state.stock_size; ++i)
+    {
+        cards.push_back({stock.x, stock.y, face_layer(state.stock[i]), false});
+    }
+
+    // Waste: the cards a draw-three game can see are fanned, the rest stacked under them
+    const auto waste   = pile_origin(metrics, 1, true);
+    const auto fanned  = std::min<std::int32_t>(state.draw_count, state.waste_size);
+    const auto stacked = state.waste_size - fanned;
+    for (auto i = 0; i < state.waste_size; ++i)
+    {
+        const auto offset = std::max(i - stacked, 0) * metrics.waste_step;
+        cards.push_back({waste.x + offset, waste.y, face_layer(state.waste[i]), true});
+    }
+
+    // Foundations: every card placed so far, stacked
+    for (auto suit = 0; suit < suit_count; ++suit)
+    {
+        const auto origin = pile_origin(metrics, 3 + suit, true);
+        for (auto rank = 0; rank < foundation_count(state, suit); ++rank)
+        {
+            cards.push_back({origin.x, origin.y, card_face_layer(suit, rank), true});
+        }
+    }
+
+    // Tableau: fanned downwards, with face-down cards packed closer together
+    for (auto pile = 0; pile < tableau_count; ++pile)
+    {
+        const auto origin = pile_origin(metrics, pile, false);
+        auto       y      = origin.y;
+        for (auto depth = 0; depth < state.tableau_size[pile]; ++depth)
+        {
+            const auto face_up = depth >= state.face_down[pile];
+            cards.push_back({origin.x, y, face_layer(state.tableau[pile][depth]), face_up});
+            y -= face_up ? metrics.face_up_step : metrics.face_down_step;
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef _GAME_TABLE_LAYOUT_HPP__
+#define _GAME_TABLE_LAYOUT_HPP__
+
+#include "cards.hpp"
+#include "hit_grid.hpp"
+#include "klondike.hpp"
+
+#include <vector>
+
+// Where the piles of a Klondike table go on screen. Positions are card centres in pixels with
+// a bottom-left origin, matching what draw_cards expects.
+struct table_metrics
+{
+    float width  = 1400.0f;
+    float height = 1000.0f;
+    float margin = 40.0f;
+
+    // Vertical step between cards fanned down a tableau pile
+    float face_down_step = 14.0f;
+    float face_up_step   = 34.0f;
+
+    // Horizontal step between the waste cards left visible by a draw-three game
+    float waste_step = 26.0f;
+};
+
+struct table_point
+{
+    float x, y;
+};
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+// Centre of the top-row slot (stock, waste, gap, four foundations) or tableau pile `column`
+auto pile_origin(const table_metrics& metrics, std::int32_t column, bool top_row) -> table_point;
+
+// Rectangle `c` covers on screen
+auto card_bounds(const card& c) -> hit_rect;
+
+// Area a card dropped onto pile `pile` (a pile_id) has to overlap: the empty slot, or every
+// card of a fanned pile
+auto pile_bounds(const klondike_state& state, const table_metrics& metrics, std::uint8_t pile)
+    -> hit_rect;
+
+// Lays out every card of `state`, back to front, reusing the storage of `cards`. Stock, waste
+// and foundation cards are stacked so the batch always holds all 52 cards.
+void layout_table(const klondike_state& state,
+                  const table_metrics&  metrics,
+                  std::vector<card>&    cards);
+
+#endif // _GAME_TABLE_LAYOUT_HPP__
@@ -0,0 +1,315 @@
+#include "table_sim.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <span>
+#include <utility>
+
+namespace {
+
+// GLFW key codes of letters are their upper-case ASCII codes
+constexpr auto key_auto_complete = std::uint16_t('A');
+constexpr auto key_hint          = std::uint16_t('H');
+constexpr auto key_play          = std::uint16_t('P');
+
+// Replay files store milliseconds on the same clock as the events
+auto replay_time(const input_event& event) -> std::uint32_t
+{
+    return std::uint32_t(event.time * 1000.0);
+}
+
+} // namespace
+
+void latency_counter::add(std::uint64_t ns)
+{
+    ++count;
+    total_ns += ns;
+    max_ns = std::max(max_ns, ns);
+}
+
+auto latency_counter::mean_ms() const -> double
+{
+    return count == 0 ? 0.0 : double(total_ns) / double(count) / 1e6;
+}
+
+auto latency_counter::max_ms() const -> double
+{
+    return double(max_ns) / 1e6;
+}
+
+auto latency_clock_ns() -> std::uint64_t
+{
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+table_simulation::table_simulation(table_view view, double now)
+    : view_(std::move(view))
+    , time_(now)
+{
+    // The render loop has a table to show before the first tick
+    hint_.reset(view_.state);
+    publish(view_.pacer.next_frame());
+}
+
+table_simulation::~table_simulation()
+{
+    stop();
+}
+
+auto table_simulation::push(input_event event) -> bool
+{
+    event.queued_ns = latency_clock_ns();
+    if (!queue_.push(event))
+    {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    pushed_.fetch_add(1, std::memory_order_release);
+    pushed_.notify_one();
+    return true;
+}
+
+void table_simulation::advance_to(double now)
+{
+    PROFILE_SCOPE("advance_simulation");
+
+    // After sleeping through an idle stretch there is nothing to catch up on
+    if (now - time_ > max_catch_up_ticks * tick_seconds)
+    {
+        time_ = now - tick_seconds;
+    }
+    while (time_ + tick_seconds <= now)
+    {
+        time_ += tick_seconds;
+        tick();
+    }
+}
+
+void table_simulation::tick()
+{
+    ++tick_;
+    ++counters_.ticks;
+
+    const auto now_ns = latency_clock_ns();
+    while (const auto event = queue_.pop())
+    {
+        counters_.queue_latency.add(now_ns - std::min(now_ns, event->queued_ns));
+        input_ns_ = std::max(input_ns_, event->queued_ns);
+        apply(*event);
+        ++counters_.events;
+    }
+
+    animate_table(view_, time_);
+    update_hint();
+    if (const auto plan = view_.pacer.next_frame(); plan.render)
+    {
+        publish(plan);
+    }
+}
+
+void table_simulation::publish(const frame_plan& plan)
+{
+    auto& snapshot = snapshots_.write_slot();
+    take_table_snapshot(view_, snapshot);
+    static_version_ += plan.rebuild_static ? 1 : 0;
+    snapshot.tick           = tick_;
+    snapshot.time           = time_;
+    snapshot.static_version = static_version_;
+    snapshot.input_ns       = input_ns_;
+    snapshots_.publish();
+    ++counters_.snapshots;
+
+    if (on_publish_)
+    {
+        on_publish_();
+    }
+}
+
+void table_simulation::apply(const input_event& event)
+{
+    const auto point = table_point{event.x, event.y};
+    switch (event.kind)
+    {
+    case input_kind::pointer_down:
+        if (view_.recorder)
+        {
+            view_.recorder->record_pointer(
+                replay_time(event), replay_event_kind::pointer_down, point.x, point.y);
+        }
+        begin_drag(view_, point);
+        break;
+    case input_kind::pointer_move:
+        // Only a held card follows the cursor, so other moves are neither applied nor recorded
+        if (view_.drag)
+        {
+            if (view_.recorder)
+            {
+                view_.recorder->record_pointer(
+                    replay_time(event), replay_event_kind::pointer_move, point.x, point.y);
+            }
+            move_drag(view_, point);
+        }
+        break;
+    case input_kind::pointer_up:
+        if (view_.recorder)
+        {
+            view_.recorder->record_pointer(
+                replay_time(event), replay_event_kind::pointer_up, point.x, point.y);
+        }
+        end_drag(view_);
+        break;
+    case input_kind::key:
+        if (view_.recorder)
+        {
+            view_.recorder->record_key(replay_time(event), event.key);
+        }
+        apply_key(event.key, event.time);
+        break;
+    }
+}
+
+void table_simulation::apply_key(std::uint16_t key, double time)
+{
+    // Moves made earlier in this tick are not searched yet; the answer is then the first move
+    // in search order
+    if (hint_.root().hash != view_.state.hash)
+    {
+        hint_.reset(view_.state);
+    }
+    const auto& best = hint_.best();
+
+    // A sends everything home: the whole line when the search found a win, otherwise every
+    // card that can go up to the foundations
+    if (key == key_auto_complete)
+    {
+        if (best.solved)
+        {
+            play_moves(view_, best.line, time);
+        }
+        else
+        {
+            auto_complete(view_, time);
+        }
+    }
+    else if (key == key_hint && best.move())
+    {
+        show_hint(view_, *best.move(), time);
+    }
+    else if (key == key_play && best.move())
+    {
+        play_moves(view_, std::span(best.line).first(1), time);
+    }
+}
+
+// A changed game restarts the search, whose answer was for a position that is gone
+void table_simulation::update_hint()
+{
+    if (hint_.root().hash != view_.state.hash)
+    {
+        hint_.reset(view_.state);
+    }
+    if (hint_.finished())
+    {
+        return;
+    }
+    PROFILE_SCOPE("hint_search");
+    const auto start = latency_clock_ns();
+    hint_.step(hint_budget);
+    counters_.hint_time.add(latency_clock_ns() - start);
+}
+
+void table_simulation::start(std::function<double()> clock, std::function<void()> on_publish)
+{
+    on_publish_ = std::move(on_publish);
+    thread_     = std::jthread(
+        [this, clock = std::move(clock)](std::stop_token stop) { run(stop, clock); });
+}
+
+void table_simulation::stop()
+{
+    if (!thread_.joinable())
+    {
+        return;
+    }
+    thread_.request_stop();
+    pushed_.fetch_add(1, std::memory_order_release); // Wakes an idle wait
+    pushed_.notify_one();
+    thread_.join();
+    on_publish_ = {};
+}
+
+void table_simulation::run(std::stop_token stop, const std::function<double()>& clock)
+{
+    PROFILE_THREAD_NAME("simulation");
+    while (!stop.stop_requested())
+    {
+        const auto pushed = pushed_.load(std::memory_order_acquire);
+        advance_to(clock());
+
+        // Nothing moves on its own and nothing is left to search, so the next tick that matters
+        // is the next event. Anything pushed since the load above changes the counter and
+        // returns at once.
+        if (view_.animator.empty() && queue_.empty() && hint_.finished())
+        {
+            pushed_.wait(pushed, std::memory_order_acquire);
+            continue;
+        }
+
+        const auto until_tick = time_ + tick_seconds - clock();
+        if (until_tick > 0.0)
+        {
+            std::this_thread::sleep_for(std::chrono::duration<double>(until_tick));
+        }
+    }
+}
+
+auto table_simulation::counters() const -> simulation_counters
+{
+    auto counters           = counters_;
+    counters.dropped_events = dropped_.load(std::memory_order_relaxed);
+    return counters;
+}
+
+auto receive_snapshot(table_presenter&  presenter,
+                      table_simulation& simulation,
+                      frame_pacer&      pacer) -> bool
+{
+    if (!simulation.acquire_snapshot())
+    {
+        return false;
+    }
+    std::swap(presenter.previous, presenter.current);
+    presenter.current = simulation.snapshot();
+
+    const auto& previous = presenter.previous;
+    const auto& current  = presenter.current;
+    const auto  restatic = current.static_version != previous.static_version ||
+                          current.cascading != previous.cascading;
+    pacer.invalidate(restatic ? redraw_table : redraw_dynamic);
+    pacer.set_animating(!current.moving_cards.empty());
+    return true;
+}
+
+auto presentation_alpha(const table_presenter& presenter, double now) -> float
+{
+    const auto span = presenter.current.time - presenter.previous.time;
+    if (span <= 0.0)
+    {
+        return 1.0f;
+    }
+    const auto shown = now - table_simulation::tick_seconds - presenter.previous.time;
+    return float(std::clamp(shown / span, 0.0, 1.0));
+}
+
+void count_presented_input(table_presenter& presenter, std::uint64_t now_ns)
+{
+    const auto input_ns = presenter.current.input_ns;
+    if (input_ns == 0 || input_ns <= presenter.shown_input_ns)
+    {
+        return;
+    }
+    presenter.input_to_photon.add(now_ns - std::min(now_ns, input_ns));
+    presenter.shown_input_ns = input_ns;
+}
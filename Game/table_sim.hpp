@@ -0,0 +1,182 @@
+#ifndef _GAME_TABLE_SIM_HPP__
+#define _GAME_TABLE_SIM_HPP__
+
+#include "frame_pacer.hpp"
+#include "hint_engine.hpp"
+#include "spsc_queue.hpp"
+#include "table_view.hpp"
+#include "triple_buffer.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stop_token>
+#include <thread>
+
+enum class input_kind : std::uint8_t
+{
+    pointer_down,
+    pointer_move,
+    pointer_up,
+    key
+};
+
+// One window event on its way from the GLFW callbacks to the simulation thread
+struct input_event
+{
+    input_kind    kind;
+    float         x = 0.0f, y = 0.0f; // Pointer events, in table pixels
+    std::uint16_t key = 0;            // Key presses, as a GLFW key code
+    double        time = 0.0;         // Seconds on the simulation clock when it happened
+    std::uint64_t queued_ns = 0;      // Steady clock at push, set by table_simulation::push
+};
+
+// Count, mean and worst case of one latency
+struct latency_counter
+{
+    std::uint64_t count    = 0;
+    std::uint64_t total_ns = 0;
+    std::uint64_t max_ns   = 0;
+
+    void add(std::uint64_t ns);
+    auto mean_ms() const -> double;
+    auto max_ms() const -> double;
+};
+
+struct simulation_counters
+{
+    std::uint64_t   ticks          = 0;
+    std::uint64_t   events         = 0; // Applied to the table
+    std::uint64_t   dropped_events = 0; // Pushed while the queue was full
+    std::uint64_t   snapshots      = 0; // Published to the render side
+    latency_counter queue_latency;      // Push to the tick that applied the event
+    latency_counter hint_time;          // Spent on the hint search, per tick that ran it
+};
+
+// Input events the window can queue before the simulation catches up; far more than arrive in
+// one tick
+constexpr auto input_queue_capacity = std::size_t(1024);
+
+// Runs the game on its own thread, decoupled from input and rendering. The window callbacks
+// push timestamped events into a lock-free queue; the simulation drains it at a fixed tick
+// rate, advances the table_view it owns and publishes what changed as an immutable
+// table_snapshot through a triple buffer, which the render loop reads and interpolates between.
+// Ticks only run while something moves or the hint search has work left: an idle table sleeps
+// until the next event arrives.
+//
+// Whenever the game changes, the hint search starts over from the new position and gets a
+// slice of every tick until it is finished, so the hint (H), play (P) and auto-complete (A)
+// keys always find an answer ready without ever holding up a tick.
+//
+// Without start() nothing runs on its own and advance_to drives the ticks on the calling
+// thread, which is how tests feed synthetic event streams headlessly and deterministically.
+class table_simulation
+{
+public:
+    static constexpr auto tick_seconds = frame_pacer::tick_seconds;
+
+    // Ticks run back to back to catch up after a stall; further behind, the clock skips ahead
+    static constexpr auto max_catch_up_ticks = 8;
+
+    // What a tick may spend on the hint search, a quarter of the tick
+    static constexpr auto hint_budget = std::chrono::microseconds(2000);
+
+    // Takes over `view`; the simulation clock starts at `now`
+    table_simulation(table_view view, double now);
+    ~table_simulation();
+
+    table_simulation(const table_simulation&)                    = delete;
+    auto operator=(const table_simulation&) -> table_simulation& = delete;
+
+    // Producer thread only (the window callbacks). Stamps the event and wakes the simulation;
+    // false when the queue was full and the event was dropped.
+    auto push(input_event event) -> bool;
+
+    // Runs every whole tick up to `now` on the calling thread; each applies the queued events,
+    // advances the animations and publishes a snapshot if anything changed. Not while started.
+    void advance_to(double now);
+
+    // Ticks on a thread of its own against `clock` until stop. `on_publish` runs on that thread
+    // after every published snapshot, to wake the render loop.
+    void start(std::function<double()> clock, std::function<void()> on_publish = {});
+    void stop();
+
+    // Render thread only: moves to the newest snapshot, false if none was published since
+    auto acquire_snapshot() -> bool { return snapshots_.acquire(); }
+    auto snapshot() const -> const table_snapshot& { return snapshots_.read_slot(); }
+
+    // The simulation's own state, only to be touched while its thread is not running
+    auto view() -> table_view& { return view_; }
+    auto hint() const -> const hint_search& { return hint_; }
+    auto counters() const -> simulation_counters;
+
+private:
+    void run(std::stop_token stop, const std::function<double()>& clock);
+    void tick();
+    void apply(const input_event& event);
+    void apply_key(std::uint16_t key, double time);
+    void update_hint();
+    void publish(const frame_plan& plan);
+
+    table_view                                    view_;
+    spsc_queue<input_event, input_queue_capacity> queue_;
+    triple_buffer<table_snapshot>                 snapshots_;
+    hint_search                                   hint_;
+
+    double                time_; // Simulation clock as of the last tick
+    std::uint64_t         tick_           = 0;
+    std::uint64_t         static_version_ = 0;
+    std::uint64_t         input_ns_       = 0; // Push time of the newest event applied
+    simulation_counters   counters_;
+    std::function<void()> on_publish_;
+
+    // Bumped by every push, so the idle thread can wait on it
+    std::atomic<std::uint64_t> pushed_  = 0;
+    std::atomic<std::uint64_t> dropped_ = 0;
+
+    std::jthread thread_;
+};
+
+// The render loop's end of a table_simulation: the two newest snapshots, to interpolate
+// between, and how long input takes to reach the screen
+struct table_presenter
+{
+    table_snapshot  previous;
+    table_snapshot  current;
+    std::uint64_t   shown_input_ns = 0; // Newest input already counted as on screen
+    latency_counter input_to_photon;    // Push to the swap of the first frame showing it
+};
+
+// What the window callbacks act on, set as the window's user pointer: input goes to the
+// simulation, exposes and resizes straight to the render loop's pacer. The render loop keeps
+// `viewport` at the one its last frame was drawn with, so pointers map to what is on screen.
+struct table_window
+{
+    table_simulation* simulation = nullptr;
+    frame_pacer*      pacer      = nullptr;
+    table_viewport    viewport;
+};
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+// Steady clock in nanoseconds, the clock input latencies are measured on
+auto latency_clock_ns() -> std::uint64_t;
+
+// Takes the newest snapshot from `simulation` if there is one and invalidates `pacer` with
+// what it changed. The pacer keeps ticking while the snapshot has moving cards, so frames
+// between snapshots are interpolated; the loop stops it once alpha reaches 1. Returns whether a
+// snapshot arrived.
+auto receive_snapshot(table_presenter&  presenter,
+                      table_simulation& simulation,
+                      frame_pacer&      pacer) -> bool;
+
+// How far between the previous and the current snapshot to draw at `now`: frames are shown
+// one tick behind the simulation, so there always is a newer snapshot to move towards
+auto presentation_alpha(const table_presenter& presenter, double now) -> float;
+
+// Call after swapping in a frame drawn from presenter.current; counts its input as shown
+void count_presented_input(table_presenter& presenter, std::uint64_t now_ns);
+
+#endif // _GAME_TABLE_SIM_HPP__
@@ -0,0 +1,555 @@
+#include "table_view.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+
+namespace {
+
+// Seconds each animation takes, and between one card and the next where they are staggered
+constexpr auto deal_seconds          = 0.3f;
+constexpr auto deal_stagger          = 0.035;
+constexpr auto snap_back_seconds     = 0.18f;
+constexpr auto auto_complete_seconds = 0.35f;
+constexpr auto auto_complete_stagger = 0.09;
+constexpr auto cascade_stagger       = 0.4;
+constexpr auto play_seconds          = 0.3f;
+constexpr auto play_stagger          = 0.12;
+constexpr auto hint_seconds          = 0.45f;
+
+// How far towards its destination a hinted card jumps before settling back
+constexpr auto hint_reach = 0.35f;
+
+// Horizontal speeds of the cascade, in pixels per second
+constexpr auto cascade_min_speed = 180.0f;
+constexpr auto cascade_max_speed = 420.0f;
+
+// Lays the cards out again and moves the ones that changed place in the indices
+void relayout_table(table_view& view)
+{
+    layout_table(view.state, view.metrics, view.cards);
+    for (auto i = std::size_t(0); i < view.cards.size(); ++i)
+    {
+        view.card_index.set(std::uint32_t(i), card_bounds(view.cards[i]));
+    }
+    view.card_index.truncate(std::uint32_t(view.cards.size()));
+
+    for (auto pile = std::uint8_t(0); pile < tableau_count; ++pile)
+    {
+        view.pile_index.set(pile, pile_bounds(view.state, view.metrics, pile));
+    }
+    for (auto suit = 0; suit < suit_count; ++suit)
+    {
+        const auto pile = std::uint8_t(pile_foundation + suit);
+        view.pile_index.set(pile, pile_bounds(view.state, view.metrics, pile));
+    }
+}
+
+auto is_animating(const table_view& view, const card& c) -> bool
+{
+    return ((view.animator.animating_layers() >> c.index) & 1) != 0;
+}
+
+// Top card of a tableau pile or the waste, which is what a move to a foundation takes
+auto top_card(const klondike_state& state, std::uint8_t pile) -> card_code
+{
+    return is_tableau(pile) ? state.tableau[pile][state.tableau_size[pile] - 1]
+                            : state.waste[state.waste_size - 1];
+}
+
+auto layer_of(card_code code) -> std::int32_t
+{
+    return card_face_layer(card_suit(code), card_rank(code));
+}
+
+// Every card leaves its foundation in turn, kings first, and bounces off one side of the table.
+// Tweens are added last launch first, so the cards still waiting are drawn in pile order.
+void start_cascade(table_view& view)
+{
+    constexpr auto launches = suit_count * rank_count;
+
+    view.cascading = true;
+    view.drag.reset();
+    view.animator.clear();
+    for (auto launch = launches; launch-- > 0;)
+    {
+        const auto suit   = launch % suit_count;
+        const auto rank   = rank_count - 1 - launch / suit_count;
+        const auto origin = pile_origin(view.metrics, 3 + suit, true);
+
+        // Direction and speed vary from card to card, but the same way every game
+        const auto random = std::uint32_t(launch + 1) * 2654435761u;
+        const auto speed  = cascade_min_speed + float(random >> 24) / 255.0f *
+                                                   (cascade_max_speed - cascade_min_speed);
+        const auto to_x   = (random & 0x100) != 0 ? view.metrics.width + card_width_px
+                                                  : -card_width_px;
+        view.animator.add({origin.x,
+                           origin.y,
+                           to_x,
+                           card_height_px * 0.5f,
+                           view.clock + cascade_stagger * launch,
+                           std::abs(to_x - origin.x) / speed,
+                           card_easing::bounce,
+                           card_face_layer(suit, rank),
+                           true});
+    }
+}
+
+// Cards indexed by face layer, which is unique per card whether face up or not
+auto cards_by_layer(const std::vector<card>& cards) -> std::array<const card*, 64>
+{
+    auto by_layer = std::array<const card*, 64>{};
+    for (const auto& c : cards)
+    {
+        if (std::uint32_t(c.index) < by_layer.size())
+        {
+            by_layer[std::size_t(c.index)] = &c;
+        }
+    }
+    return by_layer;
+}
+
+auto drop_pile_of(const table_view& view, const card& held) -> std::optional<std::uint8_t>
+{
+    if (const auto pile = view.pile_index.best_overlap(card_bounds(held)))
+    {
+        return std::uint8_t(*pile);
+    }
+    return std::nullopt;
+}
+
+// The part of a frame shared by views and snapshots: `renderer` already holds the moving
+// cards as animated instances and dynamic cards, drawn in that order over `static_cards`
+auto draw_layers(const std::shared_ptr<card_renderer>& cr,
+                 table_renderer&                       renderer,
+                 const std::vector<card>&              static_cards,
+                 bool                                  cascading,
+                 const frame_plan&                     plan,
+                 const table_viewport&                 viewport)
+    -> std::expected<void, error_message_t>
+{
+    const auto width  = viewport.framebuffer_width;
+    const auto height = viewport.framebuffer_height;
+    if (plan.resize)
+    {
+        const auto& area = viewport.area;
+        const auto  lod  = choose_card_texture_lod(viewport);
+        glViewport(0, 0, viewport.render_width, viewport.render_height);
+        set_card_projection(cr, area.left, area.right, area.bottom, area.top);
+        set_card_texture_lod(cr, lod.min_lod, lod.bias);
+        if (auto result = resize_card_layer_cache(
+                renderer.layer_cache, viewport.render_width, viewport.render_height);
+            !result)
+        {
+            return std::unexpected(result.error());
+        }
+
+        // Below full resolution the frame is put together at the render size first
+        if (!viewport.scaled())
+        {
+            destroy_card_layer_cache(renderer.scene);
+        }
+        else if (auto result = resize_card_layer_cache(
+                     renderer.scene, viewport.render_width, viewport.render_height);
+                 !result)
+        {
+            return std::unexpected(result.error());
+        }
+    }
+
+    // Every batch this frame is packed into the stream's next region
+    cr->stream->begin_frame();
+
+    if (cascading)
+    {
+        // A reallocated layer starts out empty; otherwise the trails are kept
+        if (plan.resize)
+        {
+            render_card_layer_cache(cr, renderer.layer_cache, static_cards);
+        }
+        stamp_card_layer_cache(cr, renderer.layer_cache, renderer.animated_cards);
+        present_card_layer_cache(renderer.layer_cache, width, height);
+        cr->stream->end_frame();
+        return {};
+    }
+
+    if (plan.rebuild_static)
+    {
+        render_card_layer_cache(cr, renderer.layer_cache, static_cards);
+    }
+
+    auto window_framebuffer = GLint(0);
+    if (viewport.scaled())
+    {
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &window_framebuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, renderer.scene.framebuffer);
+    }
+    present_card_layer_cache(
+        renderer.layer_cache, viewport.render_width, viewport.render_height);
+    draw_card_instances(cr, renderer.animated_cards);
+    draw_cards(cr, renderer.dynamic_cards);
+    if (viewport.scaled())
+    {
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, GLuint(window_framebuffer));
+        present_card_layer_cache(renderer.scene, width, height);
+    }
+    cr->stream->end_frame();
+    return {};
+}
+
+} // namespace
+
+void reset_table(table_view& view, std::uint64_t seed, std::uint8_t draw_count)
+{
+    load_table(view, deal_klondike(shuffle_deck(seed), draw_count));
+}
+
+void load_table(table_view& view, const klondike_state& state)
+{
+    view.state = state;
+    view.drag.reset();
+    view.animator.clear();
+    view.cascading = false;
+    view.card_index.reset(view.metrics.width, view.metrics.height, card_width_px, card_height_px);
+    view.pile_index.reset(view.metrics.width, view.metrics.height, card_width_px, card_height_px);
+    relayout_table(view);
+    view.pacer.invalidate(redraw_table);
+}
+
+void animate_deal(table_view& view, double now)
+{
+    // The tableau is laid out last, pile by pile. Cards fly face down in the order they are
+    // dealt: across the piles a row at a time.
+    const auto stock = pile_origin(view.metrics, 0, true);
+    auto       first = view.cards.size();
+    for (auto pile = 0; pile < tableau_count; ++pile)
+    {
+        first -= view.state.tableau_size[pile];
+    }
+    for (auto pile = 0; pile < tableau_count; ++pile)
+    {
+        for (auto row = 0; row < view.state.tableau_size[pile]; ++row)
+        {
+            const auto& dealt = view.cards[first++];
+            const auto  order = row * tableau_count - row * (row - 1) / 2 + (pile - row);
+            view.animator.add({stock.x,
+                               stock.y,
+                               dealt.x,
+                               dealt.y,
+                               now + deal_stagger * order,
+                               deal_seconds,
+                               card_easing::ease_out_cubic,
+                               dealt.index,
+                               false});
+        }
+    }
+    view.pacer.invalidate(redraw_table);
+}
+
+void auto_complete(table_view& view, double now)
+{
+    if (view.drag || view.cascading)
+    {
+        return;
+    }
+
+    auto moves  = move_list{};
+    auto before = std::vector<card>();
+    auto start  = now;
+    for (;;)
+    {
+        generate_moves(view.state, moves);
+        const auto up = std::find_if(moves.begin(), moves.end(), [](const auto& move) {
+            return is_foundation(move.to) && move.from != pile_stock;
+        });
+        if (up == moves.end())
+        {
+            break;
+        }
+
+        // Fly from where the card is now, as laid out before the move
+        const auto layer = layer_of(top_card(view.state, up->from));
+        layout_table(view.state, view.metrics, before);
+        const auto from = std::find_if(
+            before.begin(), before.end(), [layer](const auto& c) { return c.index == layer; });
+        const auto to = pile_origin(view.metrics, up->to - pile_foundation + 3, true);
+
+        auto move = *up;
+        apply_move(view.state, move);
+        if (view.recorder)
+        {
+            view.recorder->record_move(std::uint32_t(now * 1000.0), move);
+        }
+        view.animator.add({from->x,
+                           from->y,
+                           to.x,
+                           to.y,
+                           start,
+                           auto_complete_seconds,
+                           card_easing::ease_in_out_cubic,
+                           layer,
+                           true});
+        start += auto_complete_stagger;
+    }
+    relayout_table(view);
+    view.pacer.invalidate(redraw_table);
+}
+
+void play_moves(table_view& view, std::span<const klondike_move> moves, double now)
+{
+    // A card that is already moving would be drawn twice
+    if (moves.empty() || view.drag || view.cascading || !view.animator.empty())
+    {
+        return;
+    }
+
+    // Every card that moves flies once, from where it is now to where the last move leaves it,
+    // setting off with the first move that takes it somewhere
+    constexpr auto not_moved  = std::int32_t(-1);
+    auto           first_move = std::array<std::int32_t, 64>();
+    first_move.fill(not_moved);
+    auto before = std::vector<card>();
+    auto after  = std::vector<card>();
+    layout_table(view.state, view.metrics, before);
+    const auto start = cards_by_layer(before);
+    for (auto i = std::size_t(0); i < moves.size(); ++i)
+    {
+        auto move = moves[i];
+        apply_move(view.state, move);
+        if (view.recorder)
+        {
+            view.recorder->record_move(std::uint32_t(now * 1000.0), move);
+        }
+        layout_table(view.state, view.metrics, after);
+        const auto was = cards_by_layer(before);
+        for (const auto& c : after)
+        {
+            const auto* old = was[std::size_t(c.index)];
+            if (first_move[std::size_t(c.index)] == not_moved && old != nullptr &&
+                (old->x != c.x || old->y != c.y))
+            {
+                first_move[std::size_t(c.index)] = std::int32_t(i);
+            }
+        }
+        std::swap(before, after);
+    }
+    relayout_table(view);
+
+    // Earlier moves are added first and, within a move, cards in drawing order
+    for (auto i = std::int32_t(0); i < std::int32_t(moves.size()); ++i)
+    {
+        for (const auto& c : view.cards)
+        {
+            if (first_move[std::size_t(c.index)] != i)
+            {
+                continue;
+            }
+            const auto* from = start[std::size_t(c.index)];
+            view.animator.add({from->x,
+                               from->y,
+                               c.x,
+                               c.y,
+                               now + play_stagger * i,
+                               play_seconds,
+                               card_easing::ease_in_out_cubic,
+                               c.index,
+                               c.face_up});
+        }
+    }
+    view.pacer.invalidate(redraw_table);
+}
+
+void show_hint(table_view& view, const klondike_move& move, double now)
+{
+    // A card that is already moving would be drawn twice
+    if (view.drag || view.cascading || !view.animator.empty())
+    {
+        return;
+    }
+
+    auto state = view.state;
+    auto moved = move;
+    apply_move(state, moved);
+    auto after = std::vector<card>();
+    layout_table(state, view.metrics, after);
+    const auto to = cards_by_layer(after);
+    for (const auto& c : view.cards)
+    {
+        const auto* target = to[std::size_t(c.index)];
+        if (target == nullptr || (target->x == c.x && target->y == c.y))
+        {
+            continue;
+        }
+        view.animator.add({c.x + (target->x - c.x) * hint_reach,
+                           c.y + (target->y - c.y) * hint_reach,
+                           c.x,
+                           c.y,
+                           now,
+                           hint_seconds,
+                           card_easing::ease_out_cubic,
+                           c.index,
+                           c.face_up});
+    }
+    view.pacer.invalidate(redraw_table);
+}
+
+void animate_table(table_view& view, double now)
+{
+    view.clock = now;
+    if (!view.animator.empty() && view.animator.update(now) > 0 && !view.cascading)
+    {
+        view.pacer.invalidate(redraw_table); // Landed cards join the static layer
+    }
+    if (view.animator.empty() && !view.cascading && !view.drag && is_won(view.state))
+    {
+        start_cascade(view);
+    }
+    view.pacer.set_animating(!view.animator.empty());
+}
+
+auto card_under(const table_view& view, table_point point) -> std::optional<std::size_t>
+{
+    return view.card_index.topmost(point.x, point.y);
+}
+
+void begin_drag(table_view& view, table_point point)
+{
+    const auto picked = card_under(view, point);
+    if (view.cascading || !picked || !view.cards[*picked].face_up ||
+        is_animating(view, view.cards[*picked]))
+    {
+        return;
+    }
+
+    const auto& held = view.cards[*picked];
+    view.drag = card_drag{*picked, {point.x - held.x, point.y - held.y}, drop_pile_of(view, held)};
+    view.pacer.invalidate(redraw_table);
+}
+
+void move_drag(table_view& view, table_point point)
+{
+    if (!view.drag)
+    {
+        return;
+    }
+
+    auto& held = view.cards[view.drag->card];
+    held.x     = point.x - view.drag->grab_offset.x;
+    held.y     = point.y - view.drag->grab_offset.y;
+    view.card_index.set(std::uint32_t(view.drag->card), card_bounds(held));
+    view.drag->drop_pile = drop_pile_of(view, held);
+    view.pacer.invalidate(redraw_dynamic);
+}
+
+void end_drag(table_view& view)
+{
+    if (!view.drag)
+    {
+        return;
+    }
+
+    // Nothing was played, so the layout puts the card back at the same index
+    const auto index    = view.drag->card;
+    const auto released = view.cards[index];
+    view.drag.reset();
+    relayout_table(view);
+
+    const auto& rest = view.cards[index];
+    view.animator.add({released.x,
+                       released.y,
+                       rest.x,
+                       rest.y,
+                       view.clock,
+                       snap_back_seconds,
+                       card_easing::ease_out_cubic,
+                       released.index,
+                       true});
+    view.pacer.invalidate(redraw_table);
+}
+
+void split_table_layers(const table_view&  view,
+                        std::vector<card>& static_cards,
+                        std::vector<card>& dynamic_cards)
+{
+    static_cards.clear();
+    dynamic_cards.clear();
+    if (view.cascading)
+    {
+        return; // Every card is in the air or gone
+    }
+    for (auto i = std::size_t(0); i < view.cards.size(); ++i)
+    {
+        if (view.drag && view.drag->card == i)
+        {
+            dynamic_cards.push_back(view.cards[i]);
+        }
+        else if (!is_animating(view, view.cards[i]))
+        {
+            static_cards.push_back(view.cards[i]);
+        }
+    }
+}
+
+void take_table_snapshot(const table_view& view, table_snapshot& snapshot)
+{
+    split_table_layers(view, snapshot.static_cards, snapshot.moving_cards);
+
+    // The dragged card, if any, goes back on top of the animated ones
+    const auto dragged = snapshot.moving_cards.size();
+    view.animator.write_cards(snapshot.moving_cards);
+    std::ranges::rotate(snapshot.moving_cards,
+                        snapshot.moving_cards.begin() + std::ptrdiff_t(dragged));
+    snapshot.cascading = view.cascading;
+}
+
+void interpolate_moving_cards(const table_snapshot& previous,
+                              const table_snapshot& current,
+                              float                 alpha,
+                              std::vector<card>&    cards)
+{
+    const auto was = cards_by_layer(previous.moving_cards);
+    cards.clear();
+    for (const auto& c : current.moving_cards)
+    {
+        const auto* from =
+            std::uint32_t(c.index) < was.size() ? was[std::size_t(c.index)] : nullptr;
+        if (from == nullptr)
+        {
+            cards.push_back(c);
+            continue;
+        }
+        cards.push_back({from->x + (c.x - from->x) * alpha,
+                         from->y + (c.y - from->y) * alpha,
+                         c.index,
+                         c.face_up});
+    }
+}
+
+auto draw_table_frame(const std::shared_ptr<card_renderer>& cr,
+                      table_renderer&                       renderer,
+                      const table_view&                     view,
+                      const frame_plan&                     plan,
+                      const table_viewport&                 viewport)
+    -> std::expected<void, error_message_t>
+{
+    split_table_layers(view, renderer.static_cards, renderer.dynamic_cards);
+    renderer.animated_cards.clear();
+    view.animator.write_instances(cr->resident_layers, renderer.animated_cards);
+    return draw_layers(cr, renderer, renderer.static_cards, view.cascading, plan, viewport);
+}
+
+auto draw_snapshot_frame(const std::shared_ptr<card_renderer>& cr,
+                         table_renderer&                       renderer,
+                         const table_snapshot&                 previous,
+                         const table_snapshot&                 current,
+                         float                                 alpha,
+                         const frame_plan&                     plan,
+                         const table_viewport&                 viewport)
+    -> std::expected<void, error_message_t>
+{
+    // Animated and dragged cards are one batch here, already in drawing order
+    interpolate_moving_cards(previous, current, alpha, renderer.moving_cards);
+    build_card_instances(renderer.moving_cards, cr->resident_layers, renderer.animated_cards);
+    renderer.dynamic_cards.clear();
+    return draw_layers(cr, renderer, current.static_cards, current.cascading, plan, viewport);
+}
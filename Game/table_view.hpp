@@ -0,0 +1,155 @@
+#ifndef _GAME_TABLE_VIEW_HPP__
+#define _GAME_TABLE_VIEW_HPP__
+
+#include "card_animator.hpp"
+#include "frame_pacer.hpp"
+#include "hit_grid.hpp"
+#include "klondike.hpp"
+#include "render_scale.hpp"
+#include "replay.hpp"
+#include "table_layout.hpp"
+
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+// A card picked up with the mouse
+struct card_drag
+{
+    std::size_t                 card;        // Index into table_view::cards
+    table_point                 grab_offset; // Cursor position relative to the card centre
+    std::optional<std::uint8_t> drop_pile;   // Tableau or foundation the card overlaps most
+};
+
+// The interactive table: the game being played, where its cards are on screen and what the
+// mouse is holding. Every change invalidates the pacer with what has to be redrawn, and keeps
+// the hit-test indices in step with the cards. Input is recorded when a recorder is attached.
+// `cards` always holds where cards come to rest; cards still on their way there are drawn by
+// the animator instead and left out of the static layer until they land.
+struct table_view
+{
+    klondike_state               state;
+    table_metrics                metrics;
+    std::vector<card>            cards;      // Back to front
+    hit_grid                     card_index; // Ids are indices into cards
+    hit_grid                     pile_index; // Ids are pile_id values of the drop targets
+    std::optional<card_drag>     drag;
+    frame_pacer                  pacer;
+    std::optional<replay_writer> recorder;
+    card_animator                animator;
+    double                       clock     = 0.0;   // Seconds, as of the last animate_table
+    bool                         cascading = false; // Won: cards bounce off, leaving trails
+};
+
+// What a table_view shows as of one simulation tick, kept apart from the view so that another
+// thread can draw it. Cards keep their faces unresolved; the render side resolves them against
+// whatever textures are resident when it draws.
+struct table_snapshot
+{
+    std::uint64_t     tick = 0;
+    double            time = 0.0;     // Seconds on the simulation clock
+    std::vector<card> static_cards;   // As split_table_layers
+    std::vector<card> moving_cards;   // Animated cards, then the dragged card on top
+    std::uint64_t     static_version = 0; // Changes whenever static_cards does
+    bool              cascading      = false;
+    std::uint64_t     input_ns       = 0; // Push time of the newest input applied, or 0
+};
+
+// GL resources and scratch storage for drawing a table_view, reused every frame
+struct table_renderer
+{
+    card_layer_cache           layer_cache;
+    card_layer_cache           scene; // The whole frame below full render scale, see table_viewport
+    std::vector<card>          static_cards;
+    std::vector<card>          dynamic_cards;
+    std::vector<card_instance> animated_cards;
+    std::vector<card>          moving_cards; // Interpolated between two snapshots
+};
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+// Deals `seed`, lays it out and indexes it
+void reset_table(table_view& view, std::uint64_t seed, std::uint8_t draw_count = 1);
+
+// Shows `state`, dropping any drag and animation, and lays it out and indexes it
+void load_table(table_view& view, const klondike_state& state);
+
+// Deals the tableau again visually: its cards fly out from the stock one after another,
+// starting at `now`
+void animate_deal(table_view& view, double now);
+
+// Plays every card that can go up to a foundation, flying them there one after another. Once a
+// won game has finished animating, animate_table starts the win cascade.
+void auto_complete(table_view& view, double now);
+
+// Plays `moves` in order, as the auto-play keys do: every card that moves flies from where it
+// is to where the last move leaves it, setting off with the first move that moves it. Does
+// nothing while other cards are moving.
+void play_moves(table_view& view, std::span<const klondike_move> moves, double now);
+
+// Shows `move` without playing it: the cards it would move jump part of the way there and
+// settle back. Does nothing while other cards are moving.
+void show_hint(table_view& view, const klondike_move& move, double now);
+
+// Advances the animations to `now`: landed cards rejoin the static layer, and the pacer keeps
+// ticking while anything is still moving
+void animate_table(table_view& view, double now);
+
+// Topmost card whose rectangle contains `point`
+auto card_under(const table_view& view, table_point point) -> std::optional<std::size_t>;
+
+// Picks up the face-up card under `point` unless it is moving; it leaves the static layer, so
+// that is rebuilt
+void begin_drag(table_view& view, table_point point);
+
+// Moves the held card with the cursor and finds where it would land; only the dynamic layer
+// is redrawn
+void move_drag(table_view& view, table_point point);
+
+// Lets go of the held card, which slides back to its pile
+void end_drag(table_view& view);
+
+// Splits the table into the cards that stay put and the dragged card drawn over them every
+// frame; animated cards are in neither
+void split_table_layers(const table_view&  view,
+                        std::vector<card>& static_cards,
+                        std::vector<card>& dynamic_cards);
+
+// Fills the cards and cascade flag of `snapshot` from `view`, reusing its storage
+void take_table_snapshot(const table_view& view, table_snapshot& snapshot);
+
+// The moving cards of `current`, each `alpha` (0 to 1) of the way from where it was in
+// `previous`. Cards that only just started moving are where `current` has them.
+void interpolate_moving_cards(const table_snapshot& previous,
+                              const table_snapshot& current,
+                              float                 alpha,
+                              std::vector<card>&    cards);
+
+// Draws a frame the pacer asked for into the bound framebuffer: reallocates and rebuilds the
+// cached static layer when the plan says so, copies it out and draws the moving cards on top.
+// During the win cascade the moving cards are drawn into the cached layer instead, which is
+// never cleared, so every frame leaves its copy behind as a trail. A resize plan also takes up
+// `viewport`'s projection, render size and texture LOD; other frames have to keep to the same
+// viewport. Below full render scale the frame is drawn at the render size and stretched out.
+auto draw_table_frame(const std::shared_ptr<card_renderer>& cr,
+                      table_renderer&                       renderer,
+                      const table_view&                     view,
+                      const frame_plan&                     plan,
+                      const table_viewport&                 viewport)
+    -> std::expected<void, error_message_t>;
+
+// The same for a snapshot handed over by the simulation thread, with its moving cards
+// interpolated from `previous` by `alpha`. The static layer is rebuilt from `current`.
+auto draw_snapshot_frame(const std::shared_ptr<card_renderer>& cr,
+                         table_renderer&                       renderer,
+                         const table_snapshot&                 previous,
+                         const table_snapshot&                 current,
+                         float                                 alpha,
+                         const frame_plan&                     plan,
+                         const table_viewport&                 viewport)
+    -> std::expected<void, error_message_t>;
+
+#endif // _GAME_TABLE_VIEW_HPP__
@@ -0,0 +1,451 @@
+#include "texture_compression.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace {
+
+using color3 = std::array<float, 3>;
+
+auto pack_565(const color3& color) -> std::uint16_t
+{
+    const auto r = std::clamp(int(std::lround(color[0] * 31.0f / 255.0f)), 0, 31);
+    const auto g = std::clamp(int(std::lround(color[1] * 63.0f / 255.0f)), 0, 63);
+    const auto b = std::clamp(int(std::lround(color[2] * 31.0f / 255.0f)), 0, 31);
+    return std::uint16_t((r << 11) | (g << 5) | b);
+}
+
+auto unpack_565(std::uint16_t packed) -> std::array<int, 3>
+{
+    const auto r = (packed >> 11) & 31;
+    const auto g = (packed >> 5) & 63;
+    const auto b = packed & 31;
+    return {(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)};
+}
+
+auto color_palette(std::uint16_t c0, std::uint16_t c1) -> std::array<std::array<int, 3>, 4>
+{
+    const auto a = unpack_565(c0);
+    const auto b = unpack_565(c1);
+
+    auto palette = std::array<std::array<int, 3>, 4>{a, b, {}, {}};
+    for (auto channel = 0; channel < 3; ++channel)
+    {
+        palette[2][channel] = (2 * a[channel] + b[channel]) / 3;
+        palette[3][channel] = (a[channel] + 2 * b[channel]) / 3;
+    }
+    return palette;
+}
+
+// Picks the nearest palette entry per pixel; returns packed indices and total squared error
+auto fit_color_indices(const std::uint8_t* block, std::uint16_t c0, std::uint16_t c1)
+    -> std::pair<std::uint32_t, std::int64_t>
+{
+    const auto palette = color_palette(c0, c1);
+
+    auto indices = std::uint32_t(0);
+    auto error   = std::int64_t(0);
+    for (auto pixel = 0; pixel < 16; ++pixel)
+    {
+        auto best_index = 0;
+        auto best_error = std::numeric_limits<int>::max();
+        for (auto entry = 0; entry < 4; ++entry)
+        {
+            auto entry_error = 0;
+            for (auto channel = 0; channel < 3; ++channel)
+            {
+                const auto delta = int(block[pixel * 4 + channel]) - palette[entry][channel];
+                entry_error += delta * delta;
+            }
+            if (entry_error < best_error)
+            {
+                best_error = entry_error;
+                best_index = entry;
+            }
+        }
+        indices |= std::uint32_t(best_index) << (pixel * 2);
+        error += best_error;
+    }
+    return {indices, error};
+}
+
+// 4-colour mode needs c0 > c1; swapping the endpoints swaps index pairs 0<->1 and 2<->3
+void order_endpoints(std::uint16_t& c0, std::uint16_t& c1, std::uint32_t& indices)
+{
+    if (c0 < c1)
+    {
+        std::swap(c0, c1);
+        indices ^= 0x55555555u;
+    }
+    else if (c0 == c1)
+    {
+        indices = 0;
+    }
+}
+
+void encode_color_block(const std::uint8_t* block, std::uint8_t* output)
+{
+    // Principal axis of the block's colours via power iteration on the covariance
+    auto mean = color3{};
+    for (auto pixel = 0; pixel < 16; ++pixel)
+    {
+        for (auto channel = 0; channel < 3; ++channel)
+        {
+            mean[channel] += block[pixel * 4 + channel] / 16.0f;
+        }
+    }
+
+    auto covariance = std::array<float, 9>{};
+    for (auto pixel = 0; pixel < 16; ++pixel)
+    {
+        auto delta = color3{};
+        for (auto channel = 0; channel < 3; ++channel)
+        {
+            delta[channel] = block[pixel * 4 + channel] - mean[channel];
+        }
+        for (auto row = 0; row < 3; ++row)
+        {
+            for (auto column = 0; column < 3; ++column)
+            {
+                covariance[row * 3 + column] += delta[row] * delta[column];
+            }
+        }
+    }
+
+    auto axis = color3{1.0f, 1.0f, 1.0f};
+    for (auto iteration = 0; iteration < 8; ++iteration)
+    {
+        auto next = color3{};
+        for (auto row = 0; row < 3; ++row)
+        {
+            next[row] = covariance[row * 3] * axis[0] + covariance[row * 3 + 1] * axis[1] +
+                        covariance[row * 3 + 2] * axis[2];
+        }
+        const auto length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+        if (length < 1e-6f)
+        {
+            break;
+        }
+        axis = {next[0] / length, next[1] / length, next[2] / length};
+    }
+
+    // Endpoints are the extreme projections onto the axis
+    auto min_t = std::numeric_limits<float>::max();
+    auto max_t = std::numeric_limits<float>::lowest();
+    for (auto pixel = 0; pixel < 16; ++pixel)
+    {
+        auto t = 0.0f;
+        for (auto channel = 0; channel < 3; ++channel)
+        {
+            t += (block[pixel * 4 + channel] - mean[channel]) * axis[channel];
+        }
+        min_t = std::min(min_t, t);
+        max_t = std::max(max_t, t);
+    }
+
+    auto endpoint = [&](float t) {
+        return color3{mean[0] + axis[0] * t, mean[1] + axis[1] * t, mean[2] + axis[2] * t};
+    };
+    auto c0               = pack_565(endpoint(max_t));
+    auto c1               = pack_565(endpoint(min_t));
+    auto [indices, error] = fit_color_indices(block, c0, c1);
+
+    // One least-squares pass: solve for the endpoints that best fit the chosen indices
+    constexpr auto weights = std::array<float, 4>{1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+    auto           aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    auto           ax = color3{}, bx = color3{};
+    for (auto pixel = 0; pixel < 16; ++pixel)
+    {
+        const auto a = weights[(indices >> (pixel * 2)) & 3];
+        const auto b = 1.0f - a;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (auto channel = 0; channel < 3; ++channel)
+        {
+            ax[channel] += a * block[pixel * 4 + channel];
+            bx[channel] += b * block[pixel * 4 + channel];
+        }
+    }
+    const auto determinant = aa * bb - ab * ab;
+    if (std::abs(determinant) > 1e-3f)
+    {
+        auto refined0 = color3{};
+        auto refined1 = color3{};
+        for (auto channel = 0; channel < 3; ++channel)
+        {
+            refined0[channel] = (bb * ax[channel] - ab * bx[channel]) / determinant;
+            refined1[channel] = (aa * bx[channel] - ab * ax[channel]) / determinant;
+        }
+
+        const auto r0                   = pack_565(refined0);
+        const auto r1                   = pack_565(refined1);
+        const auto [r_indices, r_error] = fit_color_indices(block, r0, r1);
+        if (r_error < error)
+        {
+            c0      = r0;
+            c1      = r1;
+            indices = r_indices;
+        }
+    }
+
+    order_endpoints(c0, c1, indices);
+
+    output[0] = std::uint8_t(c0 & 0xFF);
+    output[1] = std::uint8_t(c0 >> 8);
+    output[2] = std::uint8_t(c1 & 0xFF);
+    output[3] = std::uint8_t(c1 >> 8);
+    for (auto i = 0; i < 4; ++i)
+    {
+        output[4 + i] = std::uint8_t(indices >> (i * 8));
+    }
+}
+
+auto alpha_palette(std::uint8_t a0, std::uint8_t a1) -> std::array<int, 8>
+{
+    auto palette = std::array<int, 8>{a0, a1};
+    if (a0 > a1)
+    {
+        for (auto i = 1; i < 7; ++i)
+        {
+            palette[i + 1] = ((7 - i) * a0 + i * a1) / 7;
+        }
+    }
+    else
+    {
+        for (auto i = 1; i < 5; ++i)
+        {
+            palette[i + 1] = ((5 - i) * a0 + i * a1) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+    return palette;
+}
+
+void encode_alpha_block(const std::uint8_t* block, std::uint8_t* output)
+{
+    auto min_alpha = std::uint8_t(255);
+    auto max_alpha = std::uint8_t(0);
+    for (auto pixel = 0; pixel < 16; ++pixel)
+    {
+        min_alpha = std::min(min_alpha, block[pixel * 4 + 3]);
+        max_alpha = std::max(max_alpha, block[pixel * 4 + 3]);
+    }
+
+    // Eight-value mode spanning the block's range; a flat block keeps every index at 0
+    const auto palette = alpha_palette(max_alpha, min_alpha);
+    auto       indices = std::uint64_t(0);
+    if (max_alpha != min_alpha)
+    {
+        for (auto pixel = 0; pixel < 16; ++pixel)
+        {
+            const auto alpha      = int(block[pixel * 4 + 3]);
+            auto       best_index = 0;
+            for (auto entry = 1; entry < 8; ++entry)
+            {
+                if (std::abs(palette[entry] - alpha) < std::abs(palette[best_index] - alpha))
+                {
+                    best_index = entry;
+                }
+            }
+            indices |= std::uint64_t(best_index) << (pixel * 3);
+        }
+    }
+
+    output[0] = max_alpha;
+    output[1] = min_alpha;
+    for (auto i = 0; i < 6; ++i)
+    {
+        output[2 + i] = std::uint8_t(indices >> (i * 8));
+    }
+}
+
+auto blocks_across(std::int32_t size) -> std::int32_t
+{
+    return (size + 3) / 4;
+}
+
+} // namespace
+
+auto bc3_image_size(std::int32_t width, std::int32_t height) -> std::size_t
+{
+    return std::size_t(blocks_across(width)) * blocks_across(height) * bc3_block_bytes;
+}
+
+auto decode_bc3(const std::uint8_t* blocks, std::int32_t width, std::int32_t height)
+    -> std::vector<std::uint8_t>
+{
+    auto rgba = std::vector<std::uint8_t>(std::size_t(width) * height * 4);
+    for (auto block_y = 0; block_y < blocks_across(height); ++block_y)
+    {
+        for (auto block_x = 0; block_x < blocks_across(width); ++block_x, blocks += bc3_block_bytes)
+        {
+            const auto alphas        = alpha_palette(blocks[0], blocks[1]);
+            auto       alpha_indices = std::uint64_t(0);
+            for (auto i = 0; i < 6; ++i)
+            {
+                alpha_indices |= std::uint64_t(blocks[2 + i]) << (i * 8);
+            }
+
+            const auto c0      = std::uint16_t(blocks[8] | (blocks[9] << 8));
+            const auto c1      = std::uint16_t(blocks[10] | (blocks[11] << 8));
+            const auto colors  = color_palette(c0, c1);
+            auto       indices = std::uint32_t(0);
+            for (auto i = 0; i < 4; ++i)
+            {
+                indices |= std::uint32_t(blocks[12 + i]) << (i * 8);
+            }
+
+            for (auto pixel = 0; pixel < 16; ++pixel)
+            {
+                const auto x = block_x * 4 + pixel % 4;
+                const auto y = block_y * 4 + pixel / 4;
+                if (x >= width || y >= height)
+                {
+                    continue;
+                }
+
+                auto*      destination = rgba.data() + (std::size_t(y) * width + x) * 4;
+                const auto color       = colors[(indices >> (pixel * 2)) & 3];
+                destination[0]         = std::uint8_t(color[0]);
+                destination[1]         = std::uint8_t(color[1]);
+                destination[2]         = std::uint8_t(color[2]);
+                destination[3]         = std::uint8_t(alphas[(alpha_indices >> (pixel * 3)) & 7]);
+            }
+        }
+    }
+    return rgba;
+}
+
+void encode_bc3_block(const std::uint8_t* block_rgba, std::uint8_t* output)
+{
+    encode_alpha_block(block_rgba, output);
+    encode_color_block(block_rgba, output + 8);
+}
+
+auto encode_bc3(const std::uint8_t* rgba, std::int32_t width, std::int32_t height)
+    -> std::vector<std::uint8_t>
+{
+    auto encoded = std::vector<std::uint8_t>(bc3_image_size(width, height));
+    auto output  = encoded.data();
+    auto block   = std::array<std::uint8_t, 64>();
+    for (auto block_y = 0; block_y < blocks_across(height); ++block_y)
+    {
+        for (auto block_x = 0; block_x < blocks_across(width); ++block_x, output += bc3_block_bytes)
+        {
+            for (auto pixel = 0; pixel < 16; ++pixel)
+            {
+                const auto x      = std::min(block_x * 4 + pixel % 4, width - 1);
+                const auto y      = std::min(block_y * 4 + pixel / 4, height - 1);
+                const auto source = rgba + (std::size_t(y) * width + x) * 4;
+                std::copy_n(source, 4, block.data() + pixel * 4);
+            }
+            encode_bc3_block(block.data(), output);
+        }
+    }
+    return encoded;
+}
+
+auto encode_bc3_layers(const std::vector<std::vector<mip_level>>& layer_chains,
+                       std::size_t                                worker_count)
+    -> std::vector<std::vector<std::vector<std::uint8_t>>>
+{
+    if (layer_chains.empty())
+    {
+        return {};
+    }
+
+    const auto layer_count = layer_chains.size();
+    const auto level_count = layer_chains.front().size();
+    auto       encoded     = std::vector<std::vector<std::vector<std::uint8_t>>>(
+        level_count, std::vector<std::vector<std::uint8_t>>(layer_count));
+
+    // Every (level, layer) pair is an independent job; level 0 jobs go first as they are biggest
+    const auto job_count = level_count * layer_count;
+    auto       next_job  = std::atomic<std::size_t>(0);
+    {
+        auto workers = std::vector<std::jthread>();
+        for (auto i = std::size_t(0); i < std::clamp<std::size_t>(worker_count, 1, job_count); ++i)
+        {
+            workers.emplace_back([&] {
+                for (auto job = next_job.fetch_add(1); job < job_count; job = next_job.fetch_add(1))
+                {
+                    const auto  level  = job / layer_count;
+                    const auto  layer  = job % layer_count;
+                    const auto& source = layer_chains[layer][level];
+                    encoded[level][layer] =
+                        encode_bc3(source.pixels.data(), source.width, source.height);
+                }
+            });
+        }
+    }
+    return encoded;
+}
+
+auto generate_mip_chain(const std::uint8_t* rgba, std::int32_t width, std::int32_t height)
+    -> std::vector<mip_level>
+{
+    auto chain = std::vector<mip_level>();
+    chain.reserve(std::size_t(mip_level_count(width, height)));
+    chain.push_back({width, height, {rgba, rgba + std::size_t(width) * height * 4}});
+
+    while (chain.back().width > 1 || chain.back().height > 1)
+    {
+        const auto& parent = chain.back();
+        auto        child  = mip_level{};
+        child.width        = std::max(parent.width / 2, 1);
+        child.height       = std::max(parent.height / 2, 1);
+        child.pixels.resize(std::size_t(child.width) * child.height * 4);
+
+        // 2x2 box filter; odd edges fold the last row/column into the neighbouring texel
+        for (auto y = 0; y < child.height; ++y)
+        {
+            const auto y0 = std::min(y * 2, parent.height - 1);
+            const auto y1 = std::min(y * 2 + 1, parent.height - 1);
+            for (auto x = 0; x < child.width; ++x)
+            {
+                const auto x0 = std::min(x * 2, parent.width - 1);
+                const auto x1 = std::min(x * 2 + 1, parent.width - 1);
+                for (auto channel = 0; channel < 4; ++channel)
+                {
+                    const auto texel = [&](std::int32_t tx, std::int32_t ty) {
+                        const auto offset = (std::size_t(ty) * parent.width + tx) * 4 + channel;
+                        return int(parent.pixels[offset]);
+                    };
+                    const auto sum = texel(x0, y0) + texel(x1, y0) + texel(x0, y1) + texel(x1, y1);
+                    child.pixels[(std::size_t(y) * child.width + x) * 4 + channel] =
+                        std::uint8_t((sum + 2) / 4);
+                }
+            }
+        }
+        chain.push_back(std::move(child));
+    }
+    return chain;
+}
+
+auto mip_level_count(std::int32_t width, std::int32_t height) -> std::int32_t
+{
+    return std::int32_t(std::bit_width(std::uint32_t(std::max({width, height, 1}))));
+}
+
+auto psnr(const std::uint8_t* a, const std::uint8_t* b, std::size_t size) -> double
+{
+    auto squared_error = 0.0;
+    for (auto i = std::size_t(0); i < size; ++i)
+    {
+        const auto delta = double(a[i]) - double(b[i]);
+        squared_error += delta * delta;
+    }
+    if (squared_error == 0.0)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+    const auto mean_squared_error = squared_error / double(size);
+    return 10.0 * std::log10(255.0 * 255.0 / mean_squared_error);
+}
@@ -0,0 +1,52 @@
+#ifndef _GAME_TEXTURE_COMPRESSION_HPP__
+#define _GAME_TEXTURE_COMPRESSION_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// BC3 (S3TC DXT5): 16 bytes per 4x4 block, an interpolated alpha block followed by a
+// 565 colour block. Every desktop GL driver exposes it via GL_EXT_texture_compression_s3tc.
+constexpr auto bc3_block_bytes = std::size_t(16);
+
+// One level of an RGBA8 image
+struct mip_level
+{
+    std::int32_t              width  = 0;
+    std::int32_t              height = 0;
+    std::vector<std::uint8_t> pixels; // Tightly packed RGBA8, or BC3 blocks once encoded
+};
+
+// -------------------- FUNCTIONS SECTION ---------------------
+
+// Size in bytes of a BC3 encoded image, counting partial edge blocks as whole blocks
+auto bc3_image_size(std::int32_t width, std::int32_t height) -> std::size_t;
+
+// Decodes BC3 blocks back to tightly packed RGBA8
+auto decode_bc3(const std::uint8_t* blocks, std::int32_t width, std::int32_t height)
+    -> std::vector<std::uint8_t>;
+
+// Encodes one 4x4 RGBA8 block (row major, 64 bytes) into 16 bytes of BC3
+void encode_bc3_block(const std::uint8_t* block_rgba, std::uint8_t* output);
+
+// Encodes a tightly packed RGBA8 image; edge blocks replicate the last row/column
+auto encode_bc3(const std::uint8_t* rgba, std::int32_t width, std::int32_t height)
+    -> std::vector<std::uint8_t>;
+
+// Encodes the mip chains of `layer_count` layers to BC3, spreading (layer, level) jobs over
+// `worker_count` threads. Result is indexed [level][layer].
+auto encode_bc3_layers(const std::vector<std::vector<mip_level>>& layer_chains,
+                       std::size_t                                worker_count)
+    -> std::vector<std::vector<std::vector<std::uint8_t>>>;
+
+// Box-filtered chain from level 0 (copied) down to 1x1
+auto generate_mip_chain(const std::uint8_t* rgba, std::int32_t width, std::int32_t height)
+    -> std::vector<mip_level>;
+
+// floor(log2(max(width, height))) + 1
+auto mip_level_count(std::int32_t width, std::int32_t height) -> std::int32_t;
+
+// Peak signal-to-noise ratio in dB over `size` bytes; infinity for identical inputs
+auto psnr(const std::uint8_t* a, const std::uint8_t* b, std::size_t size) -> double;
+
+#endif // _GAME_TEXTURE_COMPRESSION_HPP__
@@ -0,0 +1,287 @@
+#include "texture_loader.hpp"
+#include "profiler.hpp"
+#include "texture_compression.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+card_texture_loader::card_texture_loader(std::size_t worker_count)
+    : coordinator_([this, worker_count](std::stop_token stop_token) {
+        decode(stop_token, std::max<std::size_t>(worker_count, 1));
+    })
+{
+}
+
+card_texture_loader::~card_texture_loader()
+{
+    coordinator_.request_stop();
+    if (coordinator_.joinable())
+    {
+        coordinator_.join();
+    }
+
+    // Uploads still in flight are abandoned; the context is assumed to still be current
+    for (const auto& upload : pending_uploads_)
+    {
+        glDeleteSync(upload.fence);
+    }
+    if (storage_allocated_)
+    {
+        glDeleteBuffers(GLsizei(upload_buffers_.size()), upload_buffers_.data());
+    }
+}
+
+void card_texture_loader::decode(std::stop_token stop_token, std::size_t worker_count)
+{
+    PROFILE_THREAD_NAME("texture coordinator");
+    PROFILE_SCOPE("decode_atlas");
+
+    // Cooked cache: every layer is already sliced, so all of them are ready at once
+    if (auto cache_result = open_atlas_cache(atlas_cache_path()); cache_result.has_value())
+    {
+        cache_ = cache_result.value();
+
+        auto lock     = std::scoped_lock(mutex_);
+        layer_width_  = cache_->layer_width();
+        layer_height_ = cache_->layer_height();
+        for (auto layer = 0; layer < cache_->layer_count(); ++layer)
+        {
+            decoded_layers_.push_back(layer);
+        }
+        layer_count_ = cache_->layer_count();
+        return;
+    }
+
+    // The frame layout is compiled in, so only the PNG needs decoding
+    auto image_result = load_png_data();
+    if (!image_result)
+    {
+        auto lock = std::scoped_lock(mutex_);
+        error_    = "Failed to load card textures: " + image_result.error();
+        return;
+    }
+
+    const auto& frames      = atlas_frames;
+    const auto& image       = *image_result.value();
+    const auto  layer_bytes = std::size_t(frames.front().w) * frames.front().h * 4;
+    if (!atlas_fits_image(image.width(), image.height()))
+    {
+        auto lock = std::scoped_lock(mutex_);
+        error_    = "Atlas frames lie outside the card image";
+        return;
+    }
+    pixels_.resize(layer_bytes * frames.size());
+
+    // Publish the layout first so the GL thread can allocate storage while slicing runs
+    {
+        auto lock     = std::scoped_lock(mutex_);
+        layer_width_  = frames.front().w;
+        layer_height_ = frames.front().h;
+        layer_count_  = std::int32_t(frames.size());
+    }
+
+    // Each worker claims layers until none are left and queues them as soon as they are cut
+    auto next_layer = std::atomic<std::size_t>(0);
+    auto workers    = std::vector<std::jthread>();
+    for (auto i = std::size_t(0); i < std::min(worker_count, frames.size()); ++i)
+    {
+        workers.emplace_back([&] {
+            PROFILE_THREAD_NAME("texture slicer");
+            for (auto layer = next_layer.fetch_add(1);
+                 layer < frames.size() && !stop_token.stop_requested();
+                 layer = next_layer.fetch_add(1))
+            {
+                PROFILE_SCOPE("slice_atlas_frame");
+                slice_atlas_frame(image, frames[layer], pixels_.data() + layer * layer_bytes);
+
+                auto lock = std::scoped_lock(mutex_);
+                decoded_layers_.push_back(std::int32_t(layer));
+            }
+        });
+    }
+}
+
+auto card_texture_loader::layer_uploads(std::int32_t layer) const -> std::vector<level_upload>
+{
+    if (!cache_)
+    {
+        const auto bytes = std::size_t(layer_width_) * layer_height_ * 4;
+        return {{0, layer_width_, layer_height_, 0, bytes, pixels_.data() + layer * bytes}};
+    }
+
+    auto uploads = std::vector<level_upload>();
+    auto offset  = std::size_t(0);
+    for (auto level = 0; level < cache_->mip_levels(); ++level)
+    {
+        const auto& level_info = cache_->level(level);
+        uploads.push_back({level,
+                           GLsizei(level_info.width),
+                           GLsizei(level_info.height),
+                           offset,
+                           std::size_t(level_info.layer_stride),
+                           cache_->level_layer_data(level, layer)});
+        // Keep every level's start 4-byte aligned inside the PBO
+        offset += (level_info.layer_stride + 3) & ~std::uint64_t(3);
+    }
+    return uploads;
+}
+
+auto card_texture_loader::pump(GLuint texture_array, std::int32_t max_uploads)
+    -> std::expected<bool, error_message_t>
+{
+    // Retire uploads the GPU has finished with
+    std::erase_if(pending_uploads_, [this](const pending_upload& upload) {
+        const auto status = glClientWaitSync(upload.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+            return false;
+        }
+        glDeleteSync(upload.fence);
+        slot_busy_[upload.slot] = false;
+        resident_layers_ |= std::uint64_t(1) << upload.layer;
+        return true;
+    });
+
+    // Take as many decoded layers as there are free upload slots
+    auto layers      = std::vector<std::int32_t>();
+    auto layer_count = std::int32_t(0);
+    {
+        auto lock = std::scoped_lock(mutex_);
+        if (!error_.empty())
+        {
+            return std::unexpected(error_);
+        }
+
+        const auto upload_budget =
+            std::min<std::ptrdiff_t>(std::ranges::count(slot_busy_, false), max_uploads);
+        while (!decoded_layers_.empty() && std::ssize(layers) < upload_budget)
+        {
+            layers.push_back(decoded_layers_.front());
+            decoded_layers_.pop_front();
+        }
+        layer_count = layer_count_;
+    }
+
+    if (layer_count == 0)
+    {
+        return false; // Layout not known yet
+    }
+
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture_array);
+    if (!storage_allocated_)
+    {
+        // Cooked caches carry their own mip chain; decoded PNGs get one generated at the end
+        const auto level_count     = cache_ ? cache_->mip_levels()
+                                            : mip_level_count(layer_width_, layer_height_);
+        const auto internal_format = cache_ && cache_->format() == atlas_format::bc3
+                                         ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+                                         : GL_RGBA8;
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY,
+                       level_count,
+                       internal_format,
+                       layer_width_,
+                       layer_height_,
+                       layer_count);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY,
+                        GL_TEXTURE_MAX_LEVEL,
+                        cache_ ? level_count - 1 : 0);
+
+        // Each slot holds every level of one layer
+        const auto uploads    = layer_uploads(0);
+        const auto slot_bytes = GLsizeiptr(uploads.back().offset + uploads.back().bytes);
+
+        glGenBuffers(GLsizei(upload_buffers_.size()), upload_buffers_.data());
+        for (const auto buffer : upload_buffers_)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, slot_bytes, nullptr, GL_STREAM_DRAW);
+        }
+        storage_allocated_ = true;
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    for (const auto layer : layers)
+    {
+        const auto slot    = std::size_t(std::ranges::find(slot_busy_, false) - slot_busy_.begin());
+        const auto uploads = layer_uploads(layer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, upload_buffers_[slot]);
+
+        auto* mapped = static_cast<std::uint8_t*>(
+            glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
+                             0,
+                             GLsizeiptr(uploads.back().offset + uploads.back().bytes),
+                             GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+        if (mapped == nullptr)
+        {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            return std::unexpected("Failed to map texture upload buffer");
+        }
+        for (const auto& upload : uploads)
+        {
+            std::memcpy(mapped + upload.offset, upload.pixels, upload.bytes);
+        }
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+        // Source data comes from the bound PBO, so the pointers are offsets
+        for (const auto& upload : uploads)
+        {
+            const auto* pbo_offset = reinterpret_cast<const GLvoid*>(upload.offset);
+            if (cache_ && cache_->format() == atlas_format::bc3)
+            {
+                glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, // target
+                                          upload.level,
+                                          0,     // xoffset
+                                          0,     // yoffset
+                                          layer, // layer
+                                          upload.width,
+                                          upload.height,
+                                          1, // depth
+                                          GL_COMPRESSED_RGBA_S3TC_DXT5_EXT,
+                                          GLsizei(upload.bytes),
+                                          pbo_offset);
+            }
+            else
+            {
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, // target
+                                upload.level,
+                                0,     // xoffset
+                                0,     // yoffset
+                                layer, // layer
+                                upload.width,
+                                upload.height,
+                                1, // depth
+                                GL_RGBA,
+                                GL_UNSIGNED_BYTE, // type
+                                pbo_offset);
+            }
+        }
+
+        slot_busy_[slot] = true;
+        pending_uploads_.push_back({layer, slot, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)});
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    // Make sure the fences reach the GPU so they can signal without a later flush
+    if (!layers.empty())
+    {
+        glFlush();
+    }
+
+    const auto all_layers = layer_count >= 64 ? ~std::uint64_t(0)
+                                              : (std::uint64_t(1) << layer_count) - 1;
+    if (resident_layers_ != all_layers)
+    {
+        return false;
+    }
+
+    if (!cache_)
+    {
+        // Level 0 of every layer is in; fill in the rest of the chain
+        glTexParameteri(GL_TEXTURE_2D_ARRAY,
+                        GL_TEXTURE_MAX_LEVEL,
+                        mip_level_count(layer_width_, layer_height_) - 1);
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    }
+    return true;
+}
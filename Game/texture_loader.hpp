@@ -0,0 +1,88 @@
+#ifndef _GAME_TEXTURE_LOADER_HPP__
+#define _GAME_TEXTURE_LOADER_HPP__
+
+#include "atlas_cache.hpp"
+#include "types.hpp"
+
+// clang-format off
+#include <glad/gl.h>
+// clang-format on
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Streams the card atlas into a texture array without blocking the render thread. A
+// coordinator thread maps the cooked cache or, failing that, decodes the PNG and slices the
+// frames across worker threads. pump() runs on the GL thread each frame: it copies decoded
+// layers (every mip level of them, when they come from the cache) into pixel buffer objects,
+// issues the texture uploads and marks a layer resident once the fence placed after its
+// upload has signalled.
+class card_texture_loader
+{
+public:
+    explicit card_texture_loader(std::size_t worker_count);
+    ~card_texture_loader();
+
+    card_texture_loader(const card_texture_loader&)            = delete;
+    card_texture_loader& operator=(const card_texture_loader&) = delete;
+
+    // GL thread only. Uploads at most `max_uploads` layers; true once every layer is resident.
+    auto pump(GLuint texture_array, std::int32_t max_uploads)
+        -> std::expected<bool, error_message_t>;
+
+    // Bit N set when texture layer N can be sampled
+    auto resident_layers() const -> std::uint64_t { return resident_layers_; }
+
+private:
+    struct pending_upload
+    {
+        std::int32_t layer;
+        std::size_t  slot;
+        GLsync       fence;
+    };
+
+    // One mip level of one layer, placed at `offset` inside an upload slot
+    struct level_upload
+    {
+        GLint       level;
+        GLsizei     width;
+        GLsizei     height;
+        std::size_t offset;
+        std::size_t bytes;
+        const void* pixels;
+    };
+
+    static constexpr auto upload_slot_count = std::size_t(4);
+
+    void decode(std::stop_token stop_token, std::size_t worker_count);
+    auto layer_uploads(std::int32_t layer) const -> std::vector<level_upload>;
+
+    // Shared with the decoding threads, guarded by mutex_
+    std::mutex               mutex_;
+    std::deque<std::int32_t> decoded_layers_;
+    std::int32_t             layer_width_  = 0;
+    std::int32_t             layer_height_ = 0;
+    std::int32_t             layer_count_  = 0;
+    error_message_t          error_;
+
+    // Written before the layout is published, read-only afterwards
+    std::shared_ptr<atlas_cache> cache_;
+    std::vector<std::uint8_t>    pixels_;
+
+    // GL thread state
+    bool                                  storage_allocated_ = false;
+    std::array<GLuint, upload_slot_count> upload_buffers_    = {};
+    std::array<bool, upload_slot_count>   slot_busy_         = {};
+    std::vector<pending_upload>           pending_uploads_;
+    std::uint64_t                         resident_layers_ = 0;
+
+    std::jthread coordinator_;
+};
+
+#endif // _GAME_TEXTURE_LOADER_HPP__
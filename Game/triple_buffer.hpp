@@ -0,0 +1,53 @@
+#ifndef _GAME_TRIPLE_BUFFER_HPP__
+#define _GAME_TRIPLE_BUFFER_HPP__
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Hands whole values from one writer thread to one reader thread without locks or waiting. Of
+// the three slots the writer owns one, the reader owns one and the third is the hand-over:
+// publishing swaps the written slot into the hand-over, acquiring swaps it out again. The reader
+// always gets the newest published value complete, never a half-written one; values it had no
+// time to read are skipped. Slots are reused, so values holding vectors keep their capacity.
+template <typename T>
+class triple_buffer
+{
+public:
+    // Writer only: the slot to fill before publish. It still holds whatever was last written
+    // into it, two publishes ago.
+    auto write_slot() -> T& { return slots_[write_]; }
+
+    // Writer only: makes the write slot the newest value and takes a free one to write next
+    void publish()
+    {
+        write_ = shared_.exchange(std::uint8_t(write_ | fresh_bit), std::memory_order_acq_rel) &
+                 index_mask;
+    }
+
+    // Reader only: moves to the newest published value. False, keeping the current one, when
+    // nothing was published since the last call.
+    auto acquire() -> bool
+    {
+        if ((shared_.load(std::memory_order_relaxed) & fresh_bit) == 0)
+        {
+            return false;
+        }
+        read_ = shared_.exchange(read_, std::memory_order_acq_rel) & index_mask;
+        return true;
+    }
+
+    // Reader only: the value acquired last; value-initialised before the first
+    auto read_slot() const -> const T& { return slots_[read_]; }
+
+private:
+    static constexpr auto index_mask = std::uint8_t(3);
+    static constexpr auto fresh_bit  = std::uint8_t(4); // Set while the hand-over slot is unread
+
+    std::array<T, 3>          slots_{};
+    std::uint8_t              write_  = 0;
+    std::uint8_t              read_   = 2;
+    std::atomic<std::uint8_t> shared_ = 1;
+};
+
+#endif // _GAME_TRIPLE_BUFFER_HPP__
@@ -1,22 +1,38 @@
-#version 460 core
+#version 450 core
 
 in vec2 TexCoord;
+flat in int Layer;
 out vec4 FragColor;
 
-uniform sampler2DArray uCardTextures;  // 54 layers: 52 cards + back + empty
-uniform int uCardIndex;                // 0..53  (calculated on CPU)
-uniform bool uFaceUp;
+uniform sampler2DArray uCardTextures;  // One layer per atlas frame, see atlas_layout.hpp
 
 void main()
 {
-    int layer = uFaceUp ? uCardIndex : 52;  // 52 = back, 53 = optional empty
+    vec4 texel;
+    if (Layer < 0)
+    {
+        // Placeholder back while the real layer is still streaming in
+        vec2 border = step(vec2(0.06), TexCoord) * step(TexCoord, vec2(0.94));
+        float stripe = step(0.5, fract((TexCoord.x + TexCoord.y) * 12.0));
+        texel = vec4(mix(vec3(0.95), mix(vec3(0.55, 0.1, 0.1), vec3(0.45, 0.05, 0.05), stripe),
+                         border.x * border.y), 1.0);
+    }
+    else
+    {
+        // Layers are premultiplied when the atlas is sliced, see slice_atlas_frame
+        texel = texture(uCardTextures, vec3(TexCoord, Layer));
+    }
 
-    vec3 texColor = texture(uCardTextures, vec3(TexCoord, layer)).rgb;
-
-    // Optional: slight rounding of corners (simple discard)
+    // Rounded corners as coverage instead of a discard, so the shader never discards; the fill
+    // rate saving comes from the trimmed quads cull_card_instances emits. The fade lies a pixel
+    // outside the radius, which keeps the straight edges hard. The corners take
+    // card_corner_fraction of the card each way, which cull_card_instances relies on.
+    const float cornerFraction = 0.1;
     vec2 uv = abs(TexCoord - 0.5) * 2.0;
-    float corner = length(max(uv - vec2(0.8), 0.0));
-    if (corner > 0.2) discard;  // adjust for roundness
+    float corner = length(max(uv - vec2(1.0 - 2.0 * cornerFraction), 0.0));
+    float edge = 2.0 * cornerFraction;
+    float coverage = 1.0 - smoothstep(edge, edge + fwidth(corner), corner);
 
-    FragColor = vec4(texColor, 1.0);
+    // Stays premultiplied; blended with GL_ONE, GL_ONE_MINUS_SRC_ALPHA
+    FragColor = texel * coverage;
 }
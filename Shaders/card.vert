@@ -1,27 +1,32 @@
-#version 460 core
+#version 450 core
 
-// Attributes
-layout (location = 0) in vec2 aPos;
+// Per-vertex attributes (shared quad); the corners follow from the texture coordinates
 layout (location = 1) in vec2 aTexCoord;
 
+// Per-instance attributes (one entry per card)
+layout (location = 2) in vec2 aInstancePosition; // card center in pixels
+layout (location = 3) in int  aInstanceLayer;    // texture layer, resolved on CPU
+layout (location = 4) in vec4 aInstanceVisible;  // left, top, right, bottom of the part drawn, in
+                                                 // texture coordinates (see cull_card_instances)
+
 out vec2 TexCoord;
+flat out int Layer;
 
 uniform mat4 uProjection;   // orthographic projection
-uniform vec2 uPosition;     // card center in NDC
-uniform vec2 uSize;         // card size in NDC
-uniform bool uFaceUp;
-uniform int uSuit;
-uniform int uRank;
+uniform vec2 uSize;         // card size in pixels
 
 void main()
 {
+    // Only the visible part of the card is rasterized; v runs down the card while y runs up
+    vec2 uv = mix(aInstanceVisible.xy, aInstanceVisible.zw, aTexCoord);
+    vec2 localPos = vec2(uv.x - 0.5, 0.5 - uv.y);
+
     // Transform from local space -> NDC
-    vec2 worldPos = aPos * uSize + uPosition;
+    vec2 worldPos = localPos * uSize + aInstancePosition;
     gl_Position = uProjection * vec4(worldPos, 0.0, 1.0);
 
-    // Give the value back?
-    TexCoord = aTexCoord;
+    TexCoord = uv;
 
-    // Pass card info to fragment shader
-    // For now we just use it to flip texture when face down
+    // Face-down cards already point at the back layer
+    Layer = aInstanceLayer;
 }
@@ -0,0 +1,40 @@
+#version 450 core
+#extension GL_ARB_shader_draw_parameters : require
+
+// Per-vertex attributes (shared quad); the corners follow from the texture coordinates
+layout (location = 1) in vec2 aTexCoord;
+
+// Per-instance attributes (one entry per card)
+layout (location = 2) in vec2 aInstancePosition; // card center in pixels, within its table
+layout (location = 3) in int  aInstanceLayer;    // texture layer, resolved on CPU
+layout (location = 4) in vec4 aInstanceVisible;  // left, top, right, bottom of the part drawn, in
+                                                 // texture coordinates (see cull_card_instances)
+
+// One tile per table, indexed by the draw of the multi-draw that holds its cards; see table_tile
+layout (std430, binding = 0) readonly buffer TableTiles
+{
+    vec4 tiles[]; // xy = bottom-left corner in pixels, z = scale
+};
+
+out vec2 TexCoord;
+flat out int Layer;
+
+uniform mat4 uProjection;   // orthographic projection of the whole framebuffer
+uniform vec2 uSize;         // card size in pixels, before the tile's scale
+
+void main()
+{
+    // Only the visible part of the card is rasterized; v runs down the card while y runs up
+    vec2 uv = mix(aInstanceVisible.xy, aInstanceVisible.zw, aTexCoord);
+    vec2 localPos = vec2(uv.x - 0.5, 0.5 - uv.y);
+
+    // Local space -> table -> tile -> NDC
+    vec4 tile = tiles[gl_DrawIDARB];
+    vec2 tablePos = localPos * uSize + aInstancePosition;
+    gl_Position = uProjection * vec4(tile.xy + tablePos * tile.z, 0.0, 1.0);
+
+    TexCoord = uv;
+
+    // Face-down cards already point at the back layer
+    Layer = aInstanceLayer;
+}